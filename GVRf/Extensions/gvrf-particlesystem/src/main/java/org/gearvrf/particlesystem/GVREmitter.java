@@ -15,16 +15,16 @@
 
 package org.gearvrf.particlesystem;
 
-import android.util.Pair;
-
 import org.gearvrf.GVRContext;
+import org.gearvrf.GVRDrawFrameListener;
+import org.gearvrf.GVRMaterial;
+import org.gearvrf.GVRParticleSystem;
 import org.gearvrf.GVRSceneObject;
 import org.gearvrf.GVRTexture;
-import org.gearvrf.GVRTransform;
 import org.joml.Vector3f;
 import org.joml.Vector4f;
 
-import java.util.ArrayList;
+import java.lang.ref.WeakReference;
 
 
 /**
@@ -32,28 +32,31 @@ import java.util.ArrayList;
  * This class is used to set up the the behaviour of the particle system in general.
  * Also, this is used to set the specific particle properties.
  *
- * Every emitter has a set of scene objects as its children. These scene
- * objects each have a mesh attached to them, with the number of vertices in the mesh
- * being equal to the emit rate of the emitter, i.e., every second a new scene object with a mesh
- * having an emitRate number of vertices is added to the emitter as a child.
- * These vertices act as the particles of the system. Consequently, all those
- * children objects which have exceeded their age limits are deleted every second.
+ * The particles of an emitter are simulated natively by a {@link GVRParticleSystem}
+ * which writes them to the vertices of a single point mesh, attached to a child
+ * scene object of the emitter. Every frame the emitter emits the particles due
+ * since the previous frame as one batch, and the particles which exceeded their
+ * age are dropped. The particle system has room for ( emit rate * age ) particles,
+ * or at least the emit rate in burst mode, and is made again if that grows.
  *
+ * With {@link #setEvaluateOnGPU(boolean)} the particles are computed by the vertex
+ * shader instead, and only the emitted particles are written to the mesh. In both
+ * modes the particle scene object is culled with bounds computed from the particle
+ * properties, unless {@link #setParticleVolume(float, float, float)} is called.
  */
 
 class GVREmitter extends GVRSceneObject {
 
-    private int MAX_EMIT_RATE = 500;
+    private int MAX_EMIT_RATE = 100000;
 
     protected int mEmitRate = 300;
     protected boolean mEnableEmitter = true;
     protected GVRContext mGVRContext = null;
 
-
-    //list of active scene objects containing particle meshes,
-    // and their corresponding spawn times.
-    protected ArrayList<Pair<GVRSceneObject, Float>> meshInfo = null;
-
+    //shape the particles are emitted from
+    protected int mShape = GVRParticleSystem.POINT;
+    protected float mShapeWidth = 1.0f;
+    protected float mShapeHeight = 1.0f;
 
     //particle properties
     protected float mMaxAge = 1.5f;
@@ -67,136 +70,148 @@ class GVREmitter extends GVRSceneObject {
     private boolean mFadeWithAge = false;
     private GVRTexture mParticleTexture;
 
-    //attributes of the particles generated every second.
-    protected float[] mParticlePositions;
-    protected float[] mParticleVelocities;
-    protected float [] mParticleGenTimes;
-
     protected boolean burstMode = false;
     private boolean executeOnce = true;
 
-    //values corresponding to the particles which degine the bounding volume of the system.
-    private float[] particleBoundingVolume;
-    private float[] BVSpawnTimes;
-    private float[] BVVelocities;
+    //bounds of the particles relative to the emitter, computed if null
+    private float[] mVolume = null;
+    private boolean mEvaluateOnGPU = false;
+
+    private GVRParticleSystem mParticleSystem = null;
+    private GVRSceneObject mParticleObject = null;
+    private Particles mParticles = null;
+    private float mEmitCount = 0;
+    private volatile boolean mSettingsChanged = true;
+    private final GVRDrawFrameListenerImpl mFrameListener;
 
-    private float currTime = 0;
-    ArrayList<Integer> idxsToDelete;
-    
     public GVREmitter(GVRContext gvrContext)
     {
         super(gvrContext);
         mGVRContext = gvrContext;
-        meshInfo = new ArrayList<Pair<GVRSceneObject, Float>>();
-        idxsToDelete = new ArrayList<Integer>();
         mEnvironmentAcceleration = new Vector3f(0.0f,0.0f,0.0f);
         mColor = new Vector4f(1.0f, 1.0f, 1.0f, 1.0f);
-        setParticleVolume(100,100,100);
+        mFrameListener = new GVRDrawFrameListenerImpl(this);
+        mGVRContext.registerDrawFrameListener(mFrameListener);
     }
 
     /**
-     * Iterate over the active meshes and delete the ones whose every particle
-     * has exceeded the maximum age limit.
-     * <p>
-     * Particle meshes are generated for upto one second in the future.
-     * Therefore the maximum time particle mesh should be allowed to remain
-     * in the scene is (maxAge of the particles + one second).
-     * <p>
+     * Emit the particles due since the previous frame in one batch,
+     * then advance all the particles and write them to the mesh.
+     * Any shape-specific per-frame operations go here.
+     *
+     * @param frameTime Seconds since the previous frame
      */
 
-    protected void onDrawFrame() {
-
-        int numActiveMeshes = meshInfo.size();
-        for (int i = 0; i < numActiveMeshes; i++)
+    protected void onDrawFrame(float frameTime)
+    {
+        if (mSettingsChanged)
+        {
+            mSettingsChanged = false;
+            updateParticleSystem();
+        }
+        if (mEnableEmitter)
         {
-            float currMeshSpawnTime = meshInfo.get(i).second;
-            if (currTime - currMeshSpawnTime > mMaxAge + 1) {
-                GVRSceneObject toDelete = meshInfo.get(i).first;
-                GVREmitter.this.removeChildObject(toDelete);
-                idxsToDelete.add(i);
+            if ( burstMode )
+            {
+                if ( executeOnce )
+                {
+                    mParticleSystem.emit(mEmitRate);
+                    executeOnce = false;
+                }
+            }
+            else
+            {
+                mEmitCount += mEmitRate * frameTime;
+                int count = (int) mEmitCount;
+                mEmitCount -= count;
+                mParticleSystem.emit(count);
             }
         }
-        for( int i = idxsToDelete.size() - 1; i >=0; i -- ) {
-            meshInfo.remove((int)idxsToDelete.get(i));
+        mParticleSystem.step(frameTime);
+        if (mEvaluateOnGPU)
+        {
+            mParticles.getMaterial().setFloat("u_time", mParticleSystem.getTime());
         }
-
-        idxsToDelete.clear();
     }
 
     /**
-     * If the burst mode is on, emit the particles only once.
-     *
-     * @param particlePositions
-     * @param particleVelocities
-     * @param particleTimeStamps
+     * Make the particle system if it does not have room for all
+     * the particles, and pass it the particle properties.
      */
 
-    protected  void emitWithBurstCheck(float[] particlePositions, float[] particleVelocities,
-                         float[] particleTimeStamps)
+    private void updateParticleSystem()
     {
-        if ( burstMode )
+        int capacity = (int) Math.ceil(mEmitRate * mMaxAge);
+
+        // a burst emits mEmitRate particles at once, however short they live
+        if (burstMode)
+        {
+            capacity = Math.max(capacity, mEmitRate);
+        }
+        capacity += 1;
+
+        if ((mParticleSystem == null) || (mParticleSystem.getCapacity() < capacity) ||
+            (mParticleSystem.isStateless() != mEvaluateOnGPU))
         {
-            if ( executeOnce )
+            if (mParticleObject != null)
             {
-                emit(particlePositions, particleVelocities, particleTimeStamps);
-                executeOnce = false;
+                removeChildObject(mParticleObject);
             }
+            mParticleSystem = new GVRParticleSystem(mGVRContext, capacity, mEvaluateOnGPU);
+            mParticles = new Particles(mGVRContext, mEvaluateOnGPU);
+            mParticleObject = mParticles.makeParticleObject(mParticleSystem.getMesh());
+            mParticleObject.attachComponent(mParticleSystem);
+            addChildObject(mParticleObject);
+        }
+        mParticles.setTexture(mParticleTexture);
+        mParticles.setColor(mColor);
+        mParticleSystem.setShape(mShape, mShapeWidth, mShapeHeight);
+        mParticleSystem.setVelocityRange(minVelocity.x, minVelocity.y, minVelocity.z,
+                maxVelocity.x, maxVelocity.y, maxVelocity.z);
+        mParticleSystem.setAcceleration(mEnvironmentAcceleration.x, mEnvironmentAcceleration.y,
+                mEnvironmentAcceleration.z);
+        mParticleSystem.setLifetime(mMaxAge);
+        mParticleSystem.setNoise(mNoiseFactor);
+        mParticleSystem.setSize(mParticleSize, mParticleSizeRate);
+        mParticleSystem.setColors(new float[] { 1, 1, 1, 1 },
+                new float[] { 1, 1, 1, mFadeWithAge ? 0 : 1 });
+        if (mVolume != null)
+        {
+            mParticleSystem.setBounds(-mVolume[0] / 2, -mVolume[1] / 2, -mVolume[2] / 2,
+                    mVolume[0] / 2, mVolume[1] / 2, mVolume[2] / 2);
         }
         else
         {
-            emit(particlePositions, particleVelocities, particleTimeStamps);
+            mParticleSystem.updateBounds();
+        }
+        if (mEvaluateOnGPU)
+        {
+            GVRMaterial material = mParticles.getMaterial();
+
+            material.setVec4("u_start_color", 1, 1, 1, 1);
+            material.setVec4("u_end_color", 1, 1, 1, mFadeWithAge ? 0 : 1);
+            material.setVec3("u_acceleration", mEnvironmentAcceleration.x,
+                    mEnvironmentAcceleration.y, mEnvironmentAcceleration.z);
+            material.setFloat("u_lifetime", mMaxAge);
+            material.setFloat("u_noise", mNoiseFactor);
+            material.setFloat("u_size", mParticleSize);
+            material.setFloat("u_size_rate", mParticleSizeRate);
         }
-
     }
 
     /**
-     * Append the bounding volume particle positions, times and velocities to the existing mesh
-     * before creating a new scene object with this mesh attached to it.
-     * Also, append every created scene object and its creation time to corresponding array lists.
-     *
-     * @param particlePositions
-     * @param particleVelocities
-     * @param particleTimeStamps
+     * Apply the changed settings on the next frame.
      */
-
-    private void emit(float[] particlePositions, float[] particleVelocities,
-                      float[] particleTimeStamps)
+    protected void settingsChanged()
     {
-        float[] allParticlePositions = new float[particlePositions.length + particleBoundingVolume.length];
-        System.arraycopy(particlePositions, 0, allParticlePositions, 0, particlePositions.length);
-        System.arraycopy(particleBoundingVolume, 0, allParticlePositions,
-                        particlePositions.length, particleBoundingVolume.length);
-
-        float[] allSpawnTimes = new float[particleTimeStamps.length + BVSpawnTimes.length];
-        System.arraycopy(particleTimeStamps, 0, allSpawnTimes, 0, particleTimeStamps.length);
-        System.arraycopy(BVSpawnTimes, 0, allSpawnTimes, particleTimeStamps.length, BVSpawnTimes.length);
-
-        float[] allParticleVelocities = new float[particleVelocities.length + BVVelocities.length];
-        System.arraycopy(particleVelocities, 0, allParticleVelocities, 0, particleVelocities.length);
-        System.arraycopy(BVVelocities, 0, allParticleVelocities, particleVelocities.length, BVVelocities.length);
-
-
-        Particles particleMesh = new Particles(mGVRContext, mMaxAge,
-                mParticleSize, mEnvironmentAcceleration, mParticleSizeRate, mFadeWithAge,
-                mParticleTexture, mColor, mNoiseFactor);
-
-
-        GVRSceneObject particleObject = particleMesh.makeParticleMesh(allParticlePositions,
-                allParticleVelocities, allSpawnTimes);
-
-        this.addChildObject(particleObject);
-        meshInfo.add(Pair.create(particleObject, currTime));
+        mSettingsChanged = true;
     }
 
-
     /**
-     * Create a bouding volume for the particle system centered at its position with
-     * the specified width, height and depth. This is important to do because the parent scene
-     * object might fall outside the viewing frustum and cause the entire system to be
-     * culled.
-     * This function creates 8 particles (mesh vertices) with very large spawning time
-     * attributes (i.e. they are always discarded) which define the volume of the system. The
-     * system is assumed to stay inside this volume.
+     * Set the bouding volume of the particle system centered at the emitter with
+     * the specified width, height and depth, instead of the volume computed from
+     * the shape, velocities, acceleration, noise and age of the particles.
+     * The system is assumed to stay inside this volume.
      * @param width volume length (along x-axis)
      * @param height volume height (along y-axis)
      * @param depth volume depth (along z-axis)
@@ -204,52 +219,24 @@ class GVREmitter extends GVRSceneObject {
 
     public void setParticleVolume(final float width, final float height, final float depth)
     {
-        final GVRTransform thisTransform = this.getTransform();
-        if (null != mGVRContext) {
-            mGVRContext.runOnGlThread(new Runnable() {
-                @Override
-                public void run() {Vector3f center = new Vector3f(thisTransform.getPositionX(),
-                        thisTransform.getPositionY(), thisTransform.getPositionZ());
-
-                    particleBoundingVolume = new float[]{center.x - width/2, center.y - height/2, center.z - depth/2,
-                            center.x - width/2, center.y - height/2, center.z + depth/2,
-                            center.x + width/2, center.y - height/2, center.z + depth/2,
-                            center.x + width/2, center.y - height/2, center.z - depth/2,
-
-                            center.x - width/2, center.y + height/2, center.z - depth/2,
-                            center.x - width/2, center.y + height/2, center.z + depth/2,
-                            center.x + width/2, center.y + height/2, center.z + depth/2,
-                            center.x - width/2, center.y + height/2, center.z - depth/2};
-
-                    BVSpawnTimes = new float[]{Float.MAX_VALUE, 0, Float.MAX_VALUE, 0, Float.MAX_VALUE,
-                            0, Float.MAX_VALUE, 0, Float.MAX_VALUE, 0, Float.MAX_VALUE, 0,
-                            Float.MAX_VALUE, 0, Float.MAX_VALUE, 0};
-
-                    BVVelocities = new float[24];
-                    for ( int i = 0; i < 24; i ++ )
-                        BVVelocities[i] = 0;
-
-                }
-            });
-        }
-
-
+        mVolume = new float[] { width, height, depth };
+        settingsChanged();
     }
 
-    protected void tickClock(float time)
+    /**
+     * @param gpu True to compute the particles in the vertex shader from their
+     *            spawn time, so that only new particles are written every frame.
+     *            The particles are emitted again when this changes.
+     */
+    public void setEvaluateOnGPU(boolean gpu)
     {
-        currTime = time;
-
-        for (int i = 0; i < meshInfo.size(); i ++)
-        {
-            GVRSceneObject obj = meshInfo.get(i).first;
-            obj.getRenderData().getMaterial().setFloat("u_time", time);
-        }
+        mEvaluateOnGPU = gpu;
+        settingsChanged();
     }
 
     /**
      * @param emitRate The rate( #particles/second ) at which this emitter emits particles.
-     *                 Currently clamped to 600 particles/second.
+     *                 Currently clamped to 100000 particles/second.
      */
     public void setEmitRate(int emitRate)
     {
@@ -257,6 +244,7 @@ class GVREmitter extends GVRSceneObject {
             mEmitRate = MAX_EMIT_RATE;
         else
             mEmitRate = emitRate;
+        settingsChanged();
     }
 
     /**
@@ -276,6 +264,7 @@ class GVREmitter extends GVRSceneObject {
     public void setParticleAge ( float age )
     {
         mMaxAge = age;
+        settingsChanged();
     }
 
     /**
@@ -284,6 +273,7 @@ class GVREmitter extends GVRSceneObject {
     public void setParticleSize ( float size )
     {
         mParticleSize = size;
+        settingsChanged();
     }
 
     /**
@@ -293,16 +283,9 @@ class GVREmitter extends GVRSceneObject {
      */
     public void setVelocityRange( final Vector3f minV, final Vector3f maxV )
     {
-        if (null != mGVRContext) {
-            mGVRContext.runOnGlThread(new Runnable() {
-
-                @Override
-                public void run() {
-                    minVelocity = minV;
-                    maxVelocity = maxV;
-                }
-            });
-        }
+        minVelocity = minV;
+        maxVelocity = maxV;
+        settingsChanged();
     }
 
     /**
@@ -312,18 +295,18 @@ class GVREmitter extends GVRSceneObject {
     public void setEnvironmentAcceleration( Vector3f acceleration )
     {
         mEnvironmentAcceleration = acceleration;
+        settingsChanged();
     }
 
     /**
      *
-     * @param rate The rate at which the particle size should increase or decrease. Lower value
-     *             clamped to 1.0f
+     * @param rate The rate at which the particle size should increase or decrease per second.
+     *             The size does not go below zero.
      */
-
-    //todo: need to vary particle size in v shader wrt this value
     public void setParticleSizeChangeRate( float rate )
     {
         mParticleSizeRate = rate;
+        settingsChanged();
     }
 
     /**
@@ -333,6 +316,7 @@ class GVREmitter extends GVRSceneObject {
     public void setFadeWithAge ( boolean fade )
     {
         mFadeWithAge = fade;
+        settingsChanged();
     }
 
     /**
@@ -342,6 +326,7 @@ class GVREmitter extends GVRSceneObject {
     public void setBurstMode(boolean mode)
     {
         burstMode = mode;
+        settingsChanged();
     }
 
     /**
@@ -350,6 +335,7 @@ class GVREmitter extends GVRSceneObject {
     public void setParticleTexture(GVRTexture tex)
     {
         mParticleTexture = tex;
+        settingsChanged();
     }
 
     /**
@@ -359,11 +345,24 @@ class GVREmitter extends GVRSceneObject {
     public void  setColorMultiplier( Vector4f color )
     {
         mColor = color;
+        settingsChanged();
     }
 
     /**
+     * Each particle drifts in its own random direction at a constant
+     * speed of up to the noise factor, in units per second.
+     * The drift is picked when the particle is emitted and does not
+     * change over its life, so it is the same whether the particles
+     * are simulated natively or evaluated on the GPU, and the bounds
+     * computed for culling contain it.
+     * <p>
+     * Earlier versions displaced each particle by up to the noise
+     * factor with simplex noise which changed every frame. The drift
+     * grows with the age of the particle instead, so a factor tuned
+     * for the old noise spreads long lived particles further.
      *
-     * @param noise Noise factor from 0 to 1.
+     * @param noise Noise factor from 0 to 1, the maximum speed of the random drift
+     *              of the particles.
      */
     public void setNoiseFactor(float noise)
     {
@@ -373,18 +372,44 @@ class GVREmitter extends GVRSceneObject {
             noise = 1;
 
         mNoiseFactor = noise;
+        settingsChanged();
     }
 
     /**
-     * Unregister and remove all the child objects with meshes from this emitter
+     * Stop emitting and remove the particles from this emitter
      */
     public void clearSystem()
     {
+        mGVRContext.unregisterDrawFrameListener(mFrameListener);
         int nchildren = this.getChildrenCount();
         for( int i = 0; i < nchildren; i ++ )
         {
             this.removeChildObject(this.getChildByIndex(0));
         }
+        mParticleObject = null;
+        if (mParticleSystem != null)
+        {
+            mParticleSystem.clear();
+        }
+    }
+
+    private static final class GVRDrawFrameListenerImpl implements GVRDrawFrameListener {
+
+        private final WeakReference<GVREmitter> mRef;
+
+        GVRDrawFrameListenerImpl(final GVREmitter emitter) {
+            mRef = new WeakReference<GVREmitter>(emitter);
+        }
+
+        @Override
+        public void onDrawFrame(float frameTime) {
+
+            final GVREmitter emitter = mRef.get();
+            if (null != emitter)
+            {
+                emitter.onDrawFrame(frameTime);
+            }
+        }
     }
 
 }
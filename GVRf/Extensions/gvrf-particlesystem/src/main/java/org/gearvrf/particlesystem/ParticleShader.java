@@ -16,6 +16,7 @@
 package org.gearvrf.particlesystem;
 
 import org.gearvrf.GVRContext;
+import org.gearvrf.GVRParticleSystem;
 import org.gearvrf.GVRShader;
 import org.gearvrf.GVRShaderData;
 import org.gearvrf.GVRShaderTemplate;
@@ -28,9 +29,8 @@ public class ParticleShader extends GVRShaderTemplate
 
     public ParticleShader(GVRContext context)
     {
-        super("float4 u_color; float3 u_acceleration; float u_particle_age; float u_size_change_rate; " +
-                "float u_time, float u_particle_size; float u_fade; float u_noise_factor", "sampler2D u_texture",
-                "float3 a_position float2 a_texcoord float3 a_normal", GVRShader.GLSLESVersion.VULKAN);
+        super("float4 u_color", "sampler2D u_texture",
+                GVRParticleSystem.VERTEX_DESCRIPTOR, GVRShader.GLSLESVersion.VULKAN);
 
         fragTemplate = TextFile.readTextFile(context.getContext(), R.raw.particle_frag);
         vtxTemplate = TextFile.readTextFile(context.getContext(), R.raw.particle_vert);
@@ -42,12 +42,6 @@ public class ParticleShader extends GVRShaderTemplate
     protected void setMaterialDefaults(GVRShaderData material)
     {
         material.setVec4("u_color", 1, 1, 1, 1);
-        material.setFloat("u_particle_age", 1);
-        material.setVec3("u_acceleration", 0,0,0);
-        material.setFloat("u_size_change_rate", 1);
-        material.setFloat("u_time",0);
-        material.setFloat("u_particle_size", 10);
-        material.setFloat("u_fade", 0);
     }
 
 }
@@ -17,6 +17,9 @@ package org.gearvrf.physics;
 
 import android.os.Handler;
 import android.os.HandlerThread;
+import android.os.Looper;
+
+import java.util.concurrent.CountDownLatch;
 
 /**
  * This class represents the Physics context
@@ -45,6 +48,40 @@ public class GVRPhysicsContext {
         return mHandler.post(r);
     }
 
+    /**
+     * Run a task on the physics thread and wait until it is done.
+     * The task is run right away when called on the physics thread.
+     *
+     * @param r task to run
+     * @return false if the task could not be run
+     */
+    public boolean runOnPhysicsThreadAndWait(final Runnable r) {
+        if (Looper.myLooper() == mHandlerThread.getLooper()) {
+            r.run();
+            return true;
+        }
+        final CountDownLatch cdl = new CountDownLatch(1);
+        boolean posted = mHandler.post(new Runnable() {
+            @Override
+            public void run() {
+                try {
+                    r.run();
+                } finally {
+                    cdl.countDown();
+                }
+            }
+        });
+        if (!posted) {
+            return false;
+        }
+        try {
+            cdl.await();
+        } catch (final InterruptedException exc) {
+            throw new IllegalStateException("Interrupted waiting for the physics thread");
+        }
+        return true;
+    }
+
     public boolean runDelayedOnPhysicsThread(Runnable r, long delayMillis) {
         return mHandler.postDelayed(r, delayMillis);
     }
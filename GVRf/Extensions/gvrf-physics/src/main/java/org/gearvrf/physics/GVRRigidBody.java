@@ -129,10 +129,18 @@ public class GVRRigidBody extends GVRPhysicsWorldObject {
      * <tr><td>STATIC</td><td>Collides with other objects, does not move</td></tr>
      * <tr><td>KINEMATIC</td><td>Collides with other objects, moved by application</td></tr>
      * </table>
+     * A body in a world which changes between dynamic and static or kinematic
+     * is taken out of the world and added again with a new collision shape.
+     * The change is made on the physics thread.
      */
-    public void setSimulationType(int type)
+    public void setSimulationType(final int type)
     {
-        Native3DRigidBody.setSimulationType(getNative(), type);
+        mPhysicsContext.runOnPhysicsThread(new Runnable() {
+            @Override
+            public void run() {
+                Native3DRigidBody.setSimulationType(getNative(), type);
+            }
+        });
     }
 
     /**
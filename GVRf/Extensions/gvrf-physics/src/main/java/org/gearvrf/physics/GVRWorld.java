@@ -18,10 +18,16 @@ package org.gearvrf.physics;
 import android.os.SystemClock;
 import android.util.LongSparseArray;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
 import org.gearvrf.GVRComponent;
 import org.gearvrf.GVRContext;
+import org.gearvrf.GVRDrawFrameListener;
+import org.gearvrf.GVRMesh;
 import org.gearvrf.GVRSceneObject;
 import org.gearvrf.GVRSceneObject.ComponentVisitor;
+import org.gearvrf.IEvents;
 import org.gearvrf.ISceneObjectEvents;
 
 /**
@@ -35,6 +41,47 @@ public class GVRWorld extends GVRComponent {
     private final GVRPhysicsContext mPhysicsContext;
     private GVRWorldTask mWorldTask;
     private static final long DEFAULT_INTERVAL = 15;
+    private static final int MAX_FIXED_STEPS = 4;
+
+    // Layout of the native ContactEvent structure
+    private static final int CONTACT_EVENT_SIZE = 48;
+    private static final int CONTACT_BODY_B = 8;
+    private static final int CONTACT_NORMAL = 16;
+    private static final int CONTACT_DISTANCE = 28;
+    private static final int CONTACT_TYPE = 44;
+    private static final int CONTACT_ENTER = 0;
+    private static final int CONTACT_STAY = 1;
+    private static final int CONTACT_EXIT = 2;
+    /** Batch of rays from {@code from} to {@code to}, see {@link #queryScene} */
+    public static final int QUERY_RAY = 0;
+    /** Batch of spheres of radius {@code size[0]} swept from {@code from} to {@code to} */
+    public static final int QUERY_SPHERE_SWEEP = 1;
+    /** Batch of boxes with half extents {@code size} swept from {@code from} to {@code to} */
+    public static final int QUERY_BOX_SWEEP = 2;
+    /** Batch of spheres of radius {@code size[0]} centered at {@code from} */
+    public static final int QUERY_SPHERE_OVERLAP = 3;
+    /** Batch of boxes with half extents {@code size} centered at {@code from} */
+    public static final int QUERY_BOX_OVERLAP = 4;
+
+    /**
+     * Size of a query in bytes. Each query holds, in native byte order,
+     * {@code float from[3], to[3], size[3], rotation[4]} (box orientation
+     * as x, y, z, w) followed by {@code int collidesWith}, the collision
+     * groups of the bodies to test.
+     */
+    public static final int QUERY_SIZE = 56;
+
+    /**
+     * Size of a query hit in bytes. Each hit holds, in native byte order,
+     * {@code long body} (0 if nothing was hit), {@code float point[3],
+     * normal[3], fraction} and {@code int query}, the index of the query.
+     */
+    public static final int QUERY_HIT_SIZE = 40;
+
+    private ByteBuffer mContactEvents = ByteBuffer.allocateDirect(64 * CONTACT_EVENT_SIZE)
+                                                  .order(ByteOrder.nativeOrder());
+    private final float[] mContactNormal = new float[3];
+    private volatile boolean mInterpolated = false;
 
     static {
         System.loadLibrary("gvrf-physics");
@@ -182,33 +229,272 @@ public class GVRWorld extends GVRComponent {
         mWorldTask.stop();
     }
 
-    private void generateCollisionEvents() {
-        GVRCollisionInfo collisionInfos[] = NativePhysics3DWorld.listCollisions(getNative());
-
-        String onEnter = "onEnter";
-        String onExit = "onExit";
-
-        for (GVRCollisionInfo info : collisionInfos) {
-            if (info.isHit) {
-                sendCollisionEvent(info, onEnter);
-            } else if (mRigidBodies.get(info.bodyA) != null
-                    && mRigidBodies.get(info.bodyB) != null) {
-                // If both bodies are in the scene.
-                sendCollisionEvent(info, onExit);
+    /**
+     * Select which collision events are generated.
+     * <p>
+     * By default {@link ICollisionEvents#onEnter} is called when two bodies
+     * start touching and {@link ICollisionEvents#onExit} when they stop, with
+     * the normal and distance of their first contact point.
+     *
+     * @param reportStay      call {@link ICollisionStayEvents#onStay} after each
+     *                        step for the bodies which remain in contact
+     * @param reportAllPoints generate onEnter and onStay for every contact point
+     *                        between two bodies instead of only the first one
+     */
+    public void setContactReporting(final boolean reportStay, final boolean reportAllPoints) {
+        mPhysicsContext.runOnPhysicsThread(new Runnable() {
+            @Override
+            public void run() {
+                NativePhysics3DWorld.setContactReporting(getNative(), reportStay, reportAllPoints);
+            }
+        });
+    }
+
+    /**
+     * Allocate a buffer for {@link #queryScene} queries or hits.
+     *
+     * @param count    number of queries or hits
+     * @param itemSize {@link #QUERY_SIZE} or {@link #QUERY_HIT_SIZE}
+     * @return direct buffer in native byte order
+     */
+    public static ByteBuffer allocateQueryBuffer(int count, int itemSize) {
+        return ByteBuffer.allocateDirect(count * itemSize).order(ByteOrder.nativeOrder());
+    }
+
+    /**
+     * Run a batch of ray, sweep or overlap queries against the bodies
+     * in the world with one call.
+     * <p>
+     * Rays and sweeps give one hit per query, the closest one, in the order
+     * of the queries. The body of the hit is 0 if nothing was hit. Overlaps
+     * give a hit for every body touching the query shape. Only the bodies
+     * whose collision group is in the {@code collidesWith} mask of a query
+     * are tested.
+     * <p>
+     * The queries run on the physics thread so the world is not stepped
+     * meanwhile. This waits for the step in progress, if any, to finish.
+     *
+     * @param type       one of the QUERY_ constants
+     * @param queries    direct buffer of queries, see {@link #QUERY_SIZE}
+     * @param numQueries number of queries in the buffer
+     * @param hits       direct buffer to get the hits, see {@link #QUERY_HIT_SIZE}
+     * @return number of hits, for overlaps it may be more than fit in the buffer
+     */
+    public int queryScene(final int type, final ByteBuffer queries, final int numQueries,
+                          final ByteBuffer hits) {
+        final int[] result = { 0 };
+
+        mPhysicsContext.runOnPhysicsThreadAndWait(new Runnable() {
+            @Override
+            public void run() {
+                result[0] = NativePhysics3DWorld.queryScene(getNative(), type, queries,
+                                                            numQueries, hits);
+            }
+        });
+        return result[0];
+    }
+
+    /**
+     * Get the rigid body of a hit returned by {@link #queryScene}.
+     *
+     * @param hits  buffer passed to queryScene
+     * @param index index of the hit
+     * @return body which was hit or null
+     */
+    public GVRRigidBody getHitBody(ByteBuffer hits, int index) {
+        return mRigidBodies.get(hits.getLong(index * QUERY_HIT_SIZE));
+    }
+
+    /**
+     * Save the state of the simulation.
+     * <p>
+     * The snapshot holds the poses, velocities and activation of the bodies,
+     * the constraint impulses and the cached contacts which warm start the
+     * solver. Restoring it and stepping with the same inputs always gives the
+     * same results. It is only valid for this world in this process.
+     * <p>
+     * The snapshot is taken on the physics thread so the world is not
+     * stepped meanwhile. This waits for the step in progress, if any, to finish.
+     *
+     * @param buffer direct buffer to get the snapshot, may be null
+     * @return size of the snapshot in bytes, nothing is written if
+     *         it does not fit in the buffer
+     */
+    public int snapshot(final ByteBuffer buffer) {
+        final int[] result = { 0 };
+
+        mPhysicsContext.runOnPhysicsThreadAndWait(new Runnable() {
+            @Override
+            public void run() {
+                result[0] = NativePhysics3DWorld.snapshot(getNative(), buffer);
             }
+        });
+        return result[0];
+    }
+
+    /**
+     * Restore a snapshot saved by {@link #snapshot}.
+     * The world must contain the same bodies and constraints as when the
+     * snapshot was taken. It is restored on the physics thread.
+     *
+     * @param buffer direct buffer holding the snapshot up to its limit
+     * @return false if the snapshot does not match the world
+     */
+    public boolean restore(final ByteBuffer buffer) {
+        final boolean[] result = { false };
+
+        mPhysicsContext.runOnPhysicsThreadAndWait(new Runnable() {
+            @Override
+            public void run() {
+                result[0] = NativePhysics3DWorld.restore(getNative(), buffer, buffer.limit());
+            }
+        });
+        return result[0];
+    }
+
+    /**
+     * Keep a history of snapshots in native memory for rolling back.
+     * Changing the size discards the snapshots already saved.
+     *
+     * @param count number of snapshots kept by {@link #saveSnapshot}
+     */
+    public void setSnapshotHistory(final int count) {
+        mPhysicsContext.runOnPhysicsThread(new Runnable() {
+            @Override
+            public void run() {
+                NativePhysics3DWorld.setSnapshotHistory(getNative(), count);
+            }
+        });
+    }
+
+    /**
+     * Save a snapshot in the history, replacing the oldest one.
+     * It is taken on the physics thread.
+     *
+     * @param frame number to restore the snapshot with
+     * @return false if there is no history
+     */
+    public boolean saveSnapshot(final long frame) {
+        final boolean[] result = { false };
+
+        mPhysicsContext.runOnPhysicsThreadAndWait(new Runnable() {
+            @Override
+            public void run() {
+                result[0] = NativePhysics3DWorld.saveSnapshot(getNative(), frame);
+            }
+        });
+        return result[0];
+    }
+
+    /**
+     * Restore a snapshot from the history on the physics thread.
+     *
+     * @param frame number passed to {@link #saveSnapshot}
+     * @return false if the snapshot is no longer in the history
+     */
+    public boolean restoreSnapshot(final long frame) {
+        final boolean[] result = { false };
+
+        mPhysicsContext.runOnPhysicsThreadAndWait(new Runnable() {
+            @Override
+            public void run() {
+                result[0] = NativePhysics3DWorld.restoreSnapshot(getNative(), frame);
+            }
+        });
+        return result[0];
+    }
+
+    /**
+     * Save the collision data for a static mesh.
+     * <p>
+     * Static and kinematic bodies with a {@link org.gearvrf.GVRMeshCollider}
+     * collide with the triangles of the mesh. Finding the triangles quickly
+     * needs a hierarchy of bounding volumes which takes a while to build
+     * for large meshes. It can be saved once and loaded with
+     * {@link #loadCollisionMesh} instead of being built again.
+     *
+     * @param mesh mesh to save the collision data for
+     * @return data to pass to {@link #loadCollisionMesh}, null if the
+     *         mesh has no triangles
+     */
+    public static byte[] saveCollisionMesh(GVRMesh mesh) {
+        return NativePhysics3DWorld.saveCollisionMesh(mesh.getNative());
+    }
+
+    /**
+     * Use collision data saved by {@link #saveCollisionMesh} for a mesh.
+     * The data is kept until {@link #unloadCollisionMesh} is called,
+     * which must be done before the mesh is no longer used.
+     *
+     * @param mesh mesh the data was saved for
+     * @param data saved collision data
+     * @return true if loaded, false if the data does not match the mesh
+     */
+    public static boolean loadCollisionMesh(GVRMesh mesh, byte[] data) {
+        return NativePhysics3DWorld.loadCollisionMesh(mesh.getNative(), data);
+    }
+
+    /**
+     * Discard the collision data loaded for a mesh. Bodies using it keep it
+     * until they are removed.
+     *
+     * @param mesh mesh passed to {@link #loadCollisionMesh}
+     */
+    public static void unloadCollisionMesh(GVRMesh mesh) {
+        NativePhysics3DWorld.unloadCollisionMesh(mesh.getNative());
+    }
+
+    private void generateCollisionEvents() {
+        int n = NativePhysics3DWorld.listContactEvents(getNative(), mContactEvents, true);
+
+        if (n * CONTACT_EVENT_SIZE > mContactEvents.capacity()) {
+            mContactEvents = ByteBuffer.allocateDirect(2 * n * CONTACT_EVENT_SIZE)
+                                       .order(ByteOrder.nativeOrder());
+            NativePhysics3DWorld.listContactEvents(getNative(), mContactEvents, false);
         }
+        for (int i = 0; i < n; ++i) {
+            int offset = i * CONTACT_EVENT_SIZE;
+            GVRRigidBody bodyA = mRigidBodies.get(mContactEvents.getLong(offset));
+            GVRRigidBody bodyB = mRigidBodies.get(mContactEvents.getLong(offset + CONTACT_BODY_B));
+
+            // Only if both bodies are in the scene.
+            if (bodyA == null || bodyB == null) {
+                continue;
+            }
+            float[] normal = mContactNormal;
+            float distance = mContactEvents.getFloat(offset + CONTACT_DISTANCE);
+
+            normal[0] = mContactEvents.getFloat(offset + CONTACT_NORMAL);
+            normal[1] = mContactEvents.getFloat(offset + CONTACT_NORMAL + 4);
+            normal[2] = mContactEvents.getFloat(offset + CONTACT_NORMAL + 8);
 
+            switch (mContactEvents.getInt(offset + CONTACT_TYPE)) {
+                case CONTACT_ENTER:
+                    sendCollisionEvent(bodyA, bodyB, ICollisionEvents.class, "onEnter", normal, distance);
+                    break;
+
+                case CONTACT_STAY:
+                    sendCollisionEvent(bodyA, bodyB, ICollisionStayEvents.class, "onStay", normal, distance);
+                    break;
+
+                case CONTACT_EXIT:
+                    sendCollisionEvent(bodyA, bodyB, ICollisionEvents.class, "onExit", normal, distance);
+                    break;
+            }
+        }
     }
 
-    private void sendCollisionEvent(GVRCollisionInfo info, String eventName) {
-        GVRSceneObject bodyA = mRigidBodies.get(info.bodyA).getOwnerObject();
-        GVRSceneObject bodyB = mRigidBodies.get(info.bodyB).getOwnerObject();
+    private void sendCollisionEvent(GVRRigidBody rigidBodyA, GVRRigidBody rigidBodyB,
+                                    Class<? extends IEvents> eventsClass, String eventName,
+                                    float[] normal, float distance) {
+        GVRSceneObject bodyA = rigidBodyA.getOwnerObject();
+        GVRSceneObject bodyB = rigidBodyB.getOwnerObject();
 
-        getGVRContext().getEventManager().sendEvent(bodyA, ICollisionEvents.class, eventName,
-                bodyA, bodyB, info.normal, info.distance);
+        getGVRContext().getEventManager().sendEvent(bodyA, eventsClass, eventName,
+                bodyA, bodyB, normal, distance);
 
-        getGVRContext().getEventManager().sendEvent(bodyB, ICollisionEvents.class, eventName,
-                bodyB, bodyA, info.normal, info.distance);
+        getGVRContext().getEventManager().sendEvent(bodyB, eventsClass, eventName,
+                bodyB, bodyA, normal, distance);
     }
 
     private void doPhysicsAttach(GVRSceneObject rootSceneObject) {
@@ -280,6 +566,54 @@ public class GVRWorld extends GVRComponent {
         NativePhysics3DWorld.getGravity(getNative(), gravity);
     }
 
+    /**
+     * Step the simulation at a fixed rate and interpolate the poses of the bodies.
+     * <p>
+     * Normally each simulation step writes the new poses of the bodies
+     * into their transforms from the physics thread, and the step size varies
+     * with the time between steps. When interpolation is enabled the world is
+     * always stepped by the same time step so the simulation only depends on
+     * its inputs. The poses after the last two steps are kept and, once per
+     * frame, the render thread writes poses interpolated between them into all
+     * the transforms at once. The bodies are displayed one time step behind
+     * the simulation.
+     *
+     * @param enable        true to enable interpolation, false to step the world directly
+     * @param fixedTimeStep time step in seconds (e.g. 1/60)
+     */
+    public void setInterpolation(final boolean enable, final float fixedTimeStep) {
+        if (enable == mInterpolated) {
+            return;
+        }
+        mInterpolated = enable;
+        mPhysicsContext.runOnPhysicsThread(new Runnable() {
+            @Override
+            public void run() {
+                NativePhysics3DWorld.setInterpolation(getNative(), enable, fixedTimeStep);
+            }
+        });
+        if (enable) {
+            getGVRContext().registerDrawFrameListener(mApplyPoses);
+        } else {
+            getGVRContext().unregisterDrawFrameListener(mApplyPoses);
+        }
+    }
+
+    /**
+     * Returns true if the world is stepped at a fixed rate with interpolated poses.
+     * @see #setInterpolation(boolean, float)
+     */
+    public boolean isInterpolated() {
+        return mInterpolated;
+    }
+
+    private final GVRDrawFrameListener mApplyPoses = new GVRDrawFrameListener() {
+        @Override
+        public void onDrawFrame(float frameTime) {
+            NativePhysics3DWorld.applyPoses(getNative());
+        }
+    };
+
     private class GVRWorldTask implements Runnable {
         private boolean running = false;
         private final long intervalMillis;
@@ -307,12 +641,18 @@ public class GVRWorld extends GVRComponent {
                 Log.v("GVRPhysicsWorld", "onStep " + timeStep + "ms" + ", subSteps " + maxSubSteps);
             }*/
 
-            timeStep  = simulationTime - lastSimulTime;
-            maxSubSteps = (int) (timeStep * 60) / 1000 + 1;
+            if (mInterpolated) {
+                if (NativePhysics3DWorld.stepFixed(getNative(), MAX_FIXED_STEPS) > 0) {
+                    generateCollisionEvents();
+                }
+            } else {
+                timeStep  = simulationTime - lastSimulTime;
+                maxSubSteps = (int) (timeStep * 60) / 1000 + 1;
 
-            NativePhysics3DWorld.step(getNative(), timeStep, maxSubSteps);
+                NativePhysics3DWorld.step(getNative(), timeStep, maxSubSteps);
 
-            generateCollisionEvents();
+                generateCollisionEvents();
+            }
 
             lastSimulTime = simulationTime;
 
@@ -417,9 +757,36 @@ class NativePhysics3DWorld {
 
     static native void step(long jphysics_world, float jtime_step, int maxSubSteps);
 
+    static native void setInterpolation(long jphysics_world, boolean enable, float fixedTimeStep);
+
+    static native int stepFixed(long jphysics_world, int maxSteps);
+
+    static native void applyPoses(long jphysics_world);
+
     static native void getGravity(long jworld, float[] array);
 
+    static native int queryScene(long jphysics_world, int type, ByteBuffer queries, int numQueries,
+                                 ByteBuffer hits);
+
+    static native int snapshot(long jphysics_world, ByteBuffer buffer);
+
+    static native boolean restore(long jphysics_world, ByteBuffer buffer, int size);
+
+    static native void setSnapshotHistory(long jphysics_world, int count);
+
+    static native boolean saveSnapshot(long jphysics_world, long frame);
+
+    static native boolean restoreSnapshot(long jphysics_world, long frame);
+
+    static native byte[] saveCollisionMesh(long jmesh);
+
+    static native boolean loadCollisionMesh(long jmesh, byte[] data);
+
+    static native void unloadCollisionMesh(long jmesh);
+
     static native void setGravity(long jworld, float x, float y, float z);
 
-    static native GVRCollisionInfo[] listCollisions(long jphysics_world);
+    static native int listContactEvents(long jphysics_world, ByteBuffer events, boolean update);
+
+    static native void setContactReporting(long jphysics_world, boolean reportStay, boolean reportAllPoints);
 }
@@ -29,7 +29,8 @@ public interface ICollisionEvents extends IEvents {
      *
      * @param sceneObj0 {@link GVRSceneObject} with a {@link GVRRigidBody} in collision with sceneObj1
      * @param sceneObj1 {@link GVRSceneObject} with a {@link GVRRigidBody} in collision with sceneObj0
-     * @param normal a float vector with the normal between the two colliding objects
+     * @param normal a float vector with the normal between the two colliding objects,
+     *               it is reused for the next event so copy it to keep it
      * @param distance distance between the objects (usually zero)
      */
     void onEnter(GVRSceneObject sceneObj0, GVRSceneObject sceneObj1, float normal[], float distance);
@@ -39,7 +40,8 @@ public interface ICollisionEvents extends IEvents {
      *
      * @param sceneObj0 {@link GVRSceneObject} with a {@link GVRRigidBody} in collision with sceneObj1
      * @param sceneObj1 {@link GVRSceneObject} with a {@link GVRRigidBody} in collision with sceneObj0
-     * @param normal a float vector with the normal between the two colliding objects
+     * @param normal a float vector with the normal between the two colliding objects,
+     *               it is reused for the next event so copy it to keep it
      * @param distance distance between the objects (usually zero)
      */
     void onExit(GVRSceneObject sceneObj0, GVRSceneObject sceneObj1, float normal[], float distance);
@@ -0,0 +1,244 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bullet_contact_tracker.h"
+#include "bullet_rigidbody.h"
+
+#include <BulletCollision/BroadphaseCollision/btDispatcher.h>
+#include <BulletCollision/NarrowPhaseCollision/btPersistentManifold.h>
+#include <stdint.h>
+
+namespace gvr {
+
+static const int INITIAL_TABLE_SIZE = 64;
+
+BulletContactTracker::BulletContactTracker()
+        : mTable(INITIAL_TABLE_SIZE, -1),
+          mMask(INITIAL_TABLE_SIZE - 1),
+          mFrame(0),
+          mReportStay(false),
+          mReportAllPoints(false)
+{
+}
+
+unsigned int BulletContactTracker::hash(const BulletRigidBody* body0, const BulletRigidBody* body1)
+{
+    uint64_t a = reinterpret_cast<uintptr_t>(body0);
+    uint64_t b = reinterpret_cast<uintptr_t>(body1);
+    uint64_t h = (a * 0x9E3779B97F4A7C15ULL) ^ (b + 0x7F4A7C159E3779B9ULL + (a << 6) + (a >> 2));
+
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return static_cast<unsigned int>(h);
+}
+
+/*
+ * Returns the slot holding a pair or the empty slot
+ * where it would be inserted.
+ */
+int BulletContactTracker::findSlot(const BulletRigidBody* body0, const BulletRigidBody* body1) const
+{
+    unsigned int slot = hash(body0, body1) & mMask;
+
+    while (mTable[slot] >= 0)
+    {
+        const Pair& p = mPairs[mTable[slot]];
+        if ((p.Body0 == body0) && (p.Body1 == body1))
+        {
+            break;
+        }
+        slot = (slot + 1) & mMask;
+    }
+    return slot;
+}
+
+int BulletContactTracker::insert(BulletRigidBody* body0, BulletRigidBody* body1)
+{
+    if ((mPairs.size() + 1) * 2 > mTable.size())
+    {
+        grow();
+    }
+    int slot = findSlot(body0, body1);
+    Pair p;
+
+    p.Body0 = body0;
+    p.Body1 = body1;
+    p.Frame = 0;
+    mTable[slot] = mPairs.size();
+    mPairs.push_back(p);
+    return mTable[slot];
+}
+
+void BulletContactTracker::grow()
+{
+    mTable.assign(mTable.size() * 2, -1);
+    mMask = mTable.size() - 1;
+    for (int i = 0; i < mPairs.size(); ++i)
+    {
+        mTable[findSlot(mPairs[i].Body0, mPairs[i].Body1)] = i;
+    }
+}
+
+/*
+ * Remove a pair from the hash table with backward shift deletion
+ * so no tombstones are needed, then move the last pair into its
+ * place in the dense array.
+ */
+void BulletContactTracker::erase(int pairIndex)
+{
+    const Pair& p = mPairs[pairIndex];
+    unsigned int hole = findSlot(p.Body0, p.Body1);
+    unsigned int slot = hole;
+
+    while (true)
+    {
+        slot = (slot + 1) & mMask;
+        if (mTable[slot] < 0)
+        {
+            break;
+        }
+        const Pair& q = mPairs[mTable[slot]];
+        unsigned int home = hash(q.Body0, q.Body1) & mMask;
+
+        // move the entry back unless its home lies cyclically in (hole, slot]
+        if (((slot - home) & mMask) >= ((slot - hole) & mMask))
+        {
+            mTable[hole] = mTable[slot];
+            hole = slot;
+        }
+    }
+    mTable[hole] = -1;
+
+    int last = mPairs.size() - 1;
+    if (pairIndex != last)
+    {
+        mPairs[pairIndex] = mPairs[last];
+        mTable[findSlot(mPairs[pairIndex].Body0, mPairs[pairIndex].Body1)] = pairIndex;
+    }
+    mPairs.pop_back();
+}
+
+void BulletContactTracker::addEvents(int type, const Pair& pair, const btPersistentManifold* manifold)
+{
+    int numPoints = 1;
+
+    if (manifold && mReportAllPoints)
+    {
+        numPoints = manifold->getNumContacts();
+    }
+    for (int i = 0; i < numPoints; ++i)
+    {
+        ContactEvent e;
+
+        e.body0 = reinterpret_cast<long long>(pair.Body0);
+        e.body1 = reinterpret_cast<long long>(pair.Body1);
+        e.type = type;
+        if (manifold)
+        {
+            const btManifoldPoint& pt = manifold->getContactPoint(i);
+            const btVector3& pos = pt.getPositionWorldOnB();
+
+            e.normal[0] = pt.m_normalWorldOnB.getX();
+            e.normal[1] = pt.m_normalWorldOnB.getY();
+            e.normal[2] = pt.m_normalWorldOnB.getZ();
+            e.distance = pt.getDistance();
+            e.position[0] = pos.getX();
+            e.position[1] = pos.getY();
+            e.position[2] = pos.getZ();
+        }
+        else
+        {
+            e.normal[0] = pair.Normal[0];
+            e.normal[1] = pair.Normal[1];
+            e.normal[2] = pair.Normal[2];
+            e.distance = pair.Distance;
+            e.position[0] = e.position[1] = e.position[2] = 0;
+        }
+        mEvents.push_back(e);
+    }
+}
+
+const std::vector<ContactEvent>& BulletContactTracker::update(btDispatcher* dispatcher)
+{
+    int numManifolds = dispatcher->getNumManifolds();
+
+    ++mFrame;
+    mEvents.clear();
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        BulletRigidBody* body0 = static_cast<BulletRigidBody*>(manifold->getBody0()->getUserPointer());
+        BulletRigidBody* body1 = static_cast<BulletRigidBody*>(manifold->getBody1()->getUserPointer());
+
+        if ((manifold->getNumContacts() == 0) || (body0 == nullptr) || (body1 == nullptr))
+        {
+            continue;
+        }
+        int slot = findSlot(body0, body1);
+        int index = mTable[slot];
+        int type = ContactEvent::STAY;
+
+        if (index < 0)
+        {
+            index = insert(body0, body1);
+            type = ContactEvent::ENTER;
+        }
+        else if (mPairs[index].Frame == mFrame)
+        {
+            continue;                   // two manifolds for the same pair
+        }
+        Pair& p = mPairs[index];
+        const btManifoldPoint& pt = manifold->getContactPoint(0);
+
+        p.Frame = mFrame;
+        p.Normal[0] = pt.m_normalWorldOnB.getX();
+        p.Normal[1] = pt.m_normalWorldOnB.getY();
+        p.Normal[2] = pt.m_normalWorldOnB.getZ();
+        p.Distance = pt.getDistance();
+        if ((type == ContactEvent::ENTER) || mReportStay)
+        {
+            addEvents(type, p, manifold);
+        }
+    }
+    for (int i = mPairs.size() - 1; i >= 0; --i)
+    {
+        if (mPairs[i].Frame != mFrame)
+        {
+            addEvents(ContactEvent::EXIT, mPairs[i], nullptr);
+            erase(i);
+        }
+    }
+    return mEvents;
+}
+
+void BulletContactTracker::sync(btDispatcher* dispatcher)
+{
+    update(dispatcher);
+    mEvents.clear();
+}
+
+void BulletContactTracker::removeBody(BulletRigidBody* body)
+{
+    for (int i = mPairs.size() - 1; i >= 0; --i)
+    {
+        if ((mPairs[i].Body0 == body) || (mPairs[i].Body1 == body))
+        {
+            erase(i);
+        }
+    }
+}
+
+}
@@ -0,0 +1,105 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Tracks which bodies are in contact between steps
+ ***************************************************************************/
+
+#ifndef BULLET_CONTACT_TRACKER_H_
+#define BULLET_CONTACT_TRACKER_H_
+
+#include "../physics_world.h"
+
+#include <vector>
+
+class btDispatcher;
+class btPersistentManifold;
+
+namespace gvr {
+
+class BulletRigidBody;
+
+/*
+ * Keeps the pairs of bodies which were touching after the last
+ * step in an open addressing hash set. Each update scans the
+ * contact manifolds of the dispatcher and produces ENTER events
+ * for new pairs, STAY events for pairs which are still touching
+ * and EXIT events for pairs which no longer are.
+ *
+ * The pairs are stored in a dense array, the hash table only
+ * holds indices into it. Removing a pair moves the last one
+ * into its place so exits are found by scanning the dense array.
+ * Nothing is allocated once the table and the event buffer have
+ * grown to the largest number of contacts seen.
+ */
+class BulletContactTracker {
+public:
+    BulletContactTracker();
+
+    /*
+     * Find the contact changes since the last update.
+     * @returns events in the order they were found
+     */
+    const std::vector<ContactEvent>& update(btDispatcher* dispatcher);
+
+    /*
+     * Events found by the last update.
+     */
+    const std::vector<ContactEvent>& getEvents() const { return mEvents; }
+
+    /*
+     * Make the pairs match the manifolds of the dispatcher without
+     * generating events, after the world was restored from a snapshot.
+     */
+    void sync(btDispatcher* dispatcher);
+
+    /*
+     * Forget all the pairs with a body, no events are generated for them.
+     */
+    void removeBody(BulletRigidBody* body);
+
+    void setReportStay(bool report) { mReportStay = report; }
+    void setReportAllPoints(bool report) { mReportAllPoints = report; }
+
+    int getPairCount() const { return mPairs.size(); }
+
+private:
+    struct Pair {
+        BulletRigidBody*    Body0;
+        BulletRigidBody*    Body1;
+        unsigned int        Frame;      // last update the pair was touching
+        float               Normal[3];  // reported with the exit event
+        float               Distance;
+    };
+
+    static unsigned int hash(const BulletRigidBody* body0, const BulletRigidBody* body1);
+    int  findSlot(const BulletRigidBody* body0, const BulletRigidBody* body1) const;
+    int  insert(BulletRigidBody* body0, BulletRigidBody* body1);
+    void erase(int pairIndex);
+    void grow();
+    void addEvents(int type, const Pair& pair, const btPersistentManifold* manifold);
+
+    std::vector<Pair>           mPairs;
+    std::vector<int>            mTable;     // index into mPairs, -1 for empty slots
+    unsigned int                mMask;
+    unsigned int                mFrame;
+    std::vector<ContactEvent>   mEvents;
+    bool                        mReportStay;
+    bool                        mReportAllPoints;
+};
+
+}
+
+#endif /* BULLET_CONTACT_TRACKER_H_ */
@@ -14,12 +14,14 @@
  */
 
 #include "bullet_gvr_utils.h"
+#include "bullet_shape_cache.h"
 
 #include <BulletCollision/CollisionShapes/btShapeHull.h>
 
 namespace gvr {
 
-btCollisionShape *convertCollider2CollisionShape(Collider *collider) {
+btCollisionShape *convertCollider2CollisionShape(Collider *collider, bool isDynamic,
+                                                 const btVector3 &scale) {
     btCollisionShape *shape = NULL;
 
     if (collider->shape_type() == COLLIDER_SHAPE_BOX) {
@@ -27,7 +29,8 @@ btCollisionShape *convertCollider2CollisionShape(Collider *collider) {
     } else if (collider->shape_type() == COLLIDER_SHAPE_SPHERE) {
         return convertSphereCollider2CollisionShape(static_cast<SphereCollider *>(collider));
     } else if (collider->shape_type() == COLLIDER_SHAPE_MESH) {
-        return convertMeshCollider2CollisionShape(static_cast<MeshCollider *>(collider));
+        return convertMeshCollider2CollisionShape(static_cast<MeshCollider *>(collider),
+                                                  isDynamic, scale);
     }
 
     return NULL;
@@ -55,7 +58,12 @@ btCollisionShape *convertBoxCollider2CollisionShape(BoxCollider *collider) {
     return shape;
 }
 
-btCollisionShape *convertMeshCollider2CollisionShape(MeshCollider *collider) {
+/*
+ * Mesh shapes come from the shape cache. Dynamic bodies get a convex hull,
+ * static and kinematic bodies collide with the triangles of the mesh.
+ */
+btCollisionShape *convertMeshCollider2CollisionShape(MeshCollider *collider, bool isDynamic,
+                                                     const btVector3 &scale) {
     btCollisionShape *shape = NULL;
 
     if (collider != NULL) {
@@ -74,7 +82,9 @@ btCollisionShape *convertMeshCollider2CollisionShape(MeshCollider *collider) {
                 return NULL;
             }
         }
-        shape = createConvexHullShapeFromMesh(mesh);
+        shape = BulletShapeCache::getInstance().acquire(mesh, scale, isDynamic ?
+                                                        BulletShapeCache::CONVEX_HULL :
+                                                        BulletShapeCache::TRIANGLE_MESH);
     }
 
     return shape;
@@ -102,6 +112,8 @@ btConvexHullShape *createConvexHullShapeFromMesh(Mesh *mesh) {
         hull_shape = new btConvexHullShape(
                 (btScalar *) hull_shape_optimizer->getVertexPointer(),
                 hull_shape_optimizer->numVertices());
+        delete hull_shape_optimizer;
+        delete initial_hull_shape;
     } else {
         LOGD("createConvexHullShapeFromMesh(): NULL mesh object");
     }
@@ -110,9 +122,14 @@ btConvexHullShape *createConvexHullShapeFromMesh(Mesh *mesh) {
 }
 
 btTransform convertTransform2btTransform(const Transform *t) {
-    btQuaternion rotation(t->rotation_x(), t->rotation_y(), t->rotation_z(), t->rotation_w());
+    glm::vec3 pos;
+    glm::quat rot;
+
+    t->getPose(pos, rot);
+
+    btQuaternion rotation(rot.x, rot.y, rot.z, rot.w);
 
-    btVector3 position(t->position_x(), t->position_y(), t->position_z());
+    btVector3 position(pos.x, pos.y, pos.z);
 
     btTransform transform(rotation, position);
 
@@ -123,8 +140,8 @@ void convertBtTransform2Transform(btTransform bulletTransform, Transform *transf
     btVector3 pos = bulletTransform.getOrigin();
     btQuaternion rot = bulletTransform.getRotation();
 
-    transform->set_position(pos.getX(), pos.getY(), pos.getZ());
-    transform->set_rotation(rot.getW(), rot.getX(), rot.getY(), rot.getZ());
+    transform->setPose(glm::vec3(pos.getX(), pos.getY(), pos.getZ()),
+                       glm::quat(rot.getW(), rot.getX(), rot.getY(), rot.getZ()));
 }
 
 }
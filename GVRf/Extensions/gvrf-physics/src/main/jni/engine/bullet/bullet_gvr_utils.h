@@ -28,13 +28,15 @@
 #include <BulletDynamics/Dynamics/btRigidBody.h>
 
 namespace gvr {
-    btCollisionShape *convertCollider2CollisionShape(Collider *collider);
+    btCollisionShape *convertCollider2CollisionShape(Collider *collider, bool isDynamic,
+                                                     const btVector3 &scale);
 
     btCollisionShape *convertSphereCollider2CollisionShape(SphereCollider *collider);
 
     btCollisionShape *convertBoxCollider2CollisionShape(BoxCollider *collider);
 
-    btCollisionShape *convertMeshCollider2CollisionShape(MeshCollider *collider);
+    btCollisionShape *convertMeshCollider2CollisionShape(MeshCollider *collider, bool isDynamic,
+                                                         const btVector3 &scale);
 
     btConvexHullShape *createConvexHullShapeFromMesh(Mesh *mesh);
 
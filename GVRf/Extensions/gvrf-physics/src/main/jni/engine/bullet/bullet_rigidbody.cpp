@@ -15,6 +15,7 @@
 #include "bullet_world.h"
 #include "bullet_rigidbody.h"
 #include "bullet_gvr_utils.h"
+#include "bullet_shape_cache.h"
 #include "objects/scene_object.h"
 #include "objects/components/sphere_collider.h"
 #include "util/gvr_log.h"
@@ -31,7 +32,14 @@ BulletRigidBody::BulletRigidBody()
         : mConstructionInfo(btScalar(0.0f), nullptr, new btEmptyShape()),
           m_centerOfMassOffset(btTransform::getIdentity()),
           mScale(1.0f, 1.0f, 1.0f),
-          mSimType(SimulationType::DYNAMIC)
+          mSimType(SimulationType::DYNAMIC),
+          mPoseBatch(nullptr),
+          mWorld(nullptr),
+          mFilterGroup(0),
+          mFilterMask(0),
+          mHasFilter(false),
+          mInterpolated(false),
+          mHasRenderPose(false)
 {
     initialize();
 }
@@ -42,6 +50,8 @@ BulletRigidBody::~BulletRigidBody() {
 
 void BulletRigidBody::setSimulationType(PhysicsRigidBody::SimulationType type)
 {
+    bool wasDynamic = (mSimType == SimulationType::DYNAMIC);
+
     mSimType = type;
     switch (type)
     {
@@ -66,6 +76,14 @@ void BulletRigidBody::setSimulationType(PhysicsRigidBody::SimulationType type)
         mRigidBody->setActivationState(ISLAND_SLEEPING);
         break;
     }
+    /*
+     * Mesh shapes and the inertia depend on whether the body is
+     * dynamic and Bullet keeps static bodies apart from dynamic ones,
+     * so a body in a world is rebuilt when it changes between them.
+     */
+    if (mWorld && (wasDynamic != (type == SimulationType::DYNAMIC))) {
+        mWorld->rebuildRigidBody(this);
+    }
 }
 
 BulletRigidBody::SimulationType BulletRigidBody::getSimulationType() const
@@ -74,20 +92,27 @@ BulletRigidBody::SimulationType BulletRigidBody::getSimulationType() const
 }
 
 void BulletRigidBody::updateConstructionInfo() {
-    bool isDynamic = (getMass() != 0.f);
+    bool isDynamic = (mSimType == SimulationType::DYNAMIC);
     Collider* collider = (Collider*)owner_object_->getComponent(COMPONENT_TYPE_COLLIDER);
     RenderData* rdata = owner_object_->render_data();
-    if (mConstructionInfo.m_collisionShape) {
-        delete mConstructionInfo.m_collisionShape;
-    }
+    // setMassProps clears the static flag of bodies with mass
+    int flags = mRigidBody->getCollisionFlags() &
+                (btCollisionObject::CollisionFlags::CF_STATIC_OBJECT |
+                 btCollisionObject::CollisionFlags::CF_KINEMATIC_OBJECT);
+
+    releaseCollisionShape();
     mRigidBody->setMotionState(this);
     mRigidBody->setMassProps(mConstructionInfo.m_mass, mConstructionInfo.m_localInertia);
     if (collider) {
-        mConstructionInfo.m_collisionShape = convertCollider2CollisionShape(collider);
-        if (isDynamic) {
+        mConstructionInfo.m_collisionShape = convertCollider2CollisionShape(collider, isDynamic,
+                                                                            getCollisionShapeScale());
+        if (isDynamic && mConstructionInfo.m_collisionShape) {
             mConstructionInfo.m_collisionShape->calculateLocalInertia(getMass(),
                                                                       mConstructionInfo.m_localInertia);
         }
+        else {
+            mConstructionInfo.m_localInertia.setZero();
+        }
         mRigidBody->setCollisionShape(mConstructionInfo.m_collisionShape);
         mRigidBody->setMassProps(getMass(), mConstructionInfo.m_localInertia);
         mRigidBody->updateInertiaTensor();
@@ -96,6 +121,9 @@ void BulletRigidBody::updateConstructionInfo() {
     else {
         LOGE("PHYSICS: Cannot attach rigid body without collider");
     }
+    if (!isDynamic) {
+        mRigidBody->setCollisionFlags(mRigidBody->getCollisionFlags() | flags);
+    }
 
     getWorldTransform(prevPos);
 
@@ -106,12 +134,25 @@ void BulletRigidBody::initialize() {
     mRigidBody->setUserPointer(this);
 }
 
-void BulletRigidBody::finalize() {
+/*
+ * Shapes from the shape cache may be shared with other bodies
+ * and are only deleted by the cache.
+ */
+void BulletRigidBody::releaseCollisionShape() {
+    btCollisionShape* shape = mRigidBody->getCollisionShape();
 
-    if (mRigidBody->getCollisionShape()) {
-        mConstructionInfo.m_collisionShape = 0;
-        delete mRigidBody->getCollisionShape();
+    if (shape) {
+        if (!BulletShapeCache::getInstance().release(shape)) {
+            delete shape;
+        }
+        mRigidBody->setCollisionShape(0);
     }
+    mConstructionInfo.m_collisionShape = 0;
+}
+
+void BulletRigidBody::finalize() {
+
+    releaseCollisionShape();
 
     if (mRigidBody) {
         delete mRigidBody;
@@ -163,6 +204,17 @@ void BulletRigidBody::getWorldTransform(btTransform &centerOfMassWorldTrans) con
 }
 
 void BulletRigidBody::setWorldTransform(const btTransform &centerOfMassWorldTrans) {
+    if (mInterpolated) {
+        return;
+    }
+    if (mPoseBatch) {
+        mPoseBatch->push_back(std::make_pair(this, centerOfMassWorldTrans));
+        return;
+    }
+    applyWorldTransform(centerOfMassWorldTrans);
+}
+
+void BulletRigidBody::applyWorldTransform(const btTransform &centerOfMassWorldTrans) {
     Transform* trans = owner_object()->transform();
     btTransform aux; getWorldTransform(aux);
 
@@ -183,6 +235,51 @@ void BulletRigidBody::setWorldTransform(const btTransform &centerOfMassWorldTran
     //convertBtTransform2Transform(centerOfMassWorldTrans * m_centerOfMassOffset, trans);
 }
 
+btTransform BulletRigidBody::getPhysicsPose() const {
+    return mRigidBody->getWorldTransform() * m_centerOfMassOffset;
+}
+
+void BulletRigidBody::setPhysicsPose(const btTransform &pose) {
+    mRigidBody->setWorldTransform(pose * m_centerOfMassOffset.inverse());
+    mRigidBody->activate();
+}
+
+void BulletRigidBody::resetOwnerPose() {
+    SceneObject* owner = owner_object();
+    btTransform pose = getPhysicsPose();
+
+    prevPos = pose;
+    mHasRenderPose = false;
+    if (owner) {
+        convertBtTransform2Transform(pose, owner->transform());
+    }
+}
+
+bool BulletRigidBody::applyRenderPose(const btTransform &pose, btTransform &moved) {
+    SceneObject* owner = owner_object();
+    if (owner == nullptr) {
+        return true;
+    }
+    Transform* trans = owner->transform();
+    if (mHasRenderPose) {
+        btVector3 pos(trans->position_x(), trans->position_y(), trans->position_z());
+        btVector3 diff = pos - mRenderPose.getOrigin();
+
+        if (std::abs(diff.getX()) >= 0.1f ||
+            std::abs(diff.getY()) >= 0.1f ||
+            std::abs(diff.getZ()) >= 0.1f)
+        {
+            moved = convertTransform2btTransform(trans);
+            mHasRenderPose = false;
+            return false;
+        }
+    }
+    convertBtTransform2Transform(pose, trans);
+    mRenderPose = pose;
+    mHasRenderPose = true;
+    return true;
+}
+
 void BulletRigidBody::applyCentralForce(float x, float y, float z) {
     mRigidBody->applyCentralForce(btVector3(x, y, z));
 }
@@ -246,7 +343,7 @@ void  BulletRigidBody::set_scale(float x, float y, float z) {
     updateColisionShapeLocalScaling();
 }
 
-void  BulletRigidBody::updateColisionShapeLocalScaling() {
+btVector3 BulletRigidBody::getCollisionShapeScale() {
     btVector3 ownerScale;
     SceneObject* owner = owner_object();
     if (owner) {
@@ -257,8 +354,21 @@ void  BulletRigidBody::updateColisionShapeLocalScaling() {
     } else {
         ownerScale.setValue(1.0f, 1.0f, 1.0f);
     }
+    return mScale * ownerScale;
+}
+
+void  BulletRigidBody::updateColisionShapeLocalScaling() {
+    btCollisionShape* shape = mRigidBody->getCollisionShape();
+
+    if (shape == 0) {
+        return;
+    }
+    btCollisionShape* scaled = BulletShapeCache::getInstance().rescale(shape, getCollisionShapeScale());
 
-    mRigidBody->getCollisionShape()->setLocalScaling(mScale * ownerScale);
+    if (scaled != shape) {
+        mConstructionInfo.m_collisionShape = scaled;
+        mRigidBody->setCollisionShape(scaled);
+    }
 }
 
 
@@ -21,9 +21,18 @@
 
 #include <BulletDynamics/Dynamics/btRigidBody.h>
 #include <LinearMath/btMotionState.h>
+#include <utility>
+#include <vector>
 
 namespace gvr {
 class SceneObject;
+class BulletRigidBody;
+class BulletWorld;
+
+/*
+ * Center of mass transforms of the bodies Bullet moved in a step.
+ */
+typedef std::vector<std::pair<BulletRigidBody*, btTransform>> BulletPoseBatch;
 
 class BulletRigidBody : public PhysicsRigidBody,
                                BulletObject,
@@ -58,6 +67,47 @@ class BulletRigidBody : public PhysicsRigidBody,
 
     void setWorldTransform(const btTransform &worldTrans);
 
+    /*
+     * Write a center of mass transform from the simulation into
+     * the owner transform.
+     */
+    void applyWorldTransform(const btTransform &worldTrans);
+
+    /*
+     * Collect the poses Bullet sets in a batch instead of writing
+     * them to the transform as soon as they are set.
+     */
+    void setPoseBatch(BulletPoseBatch* batch) {
+        mPoseBatch = batch;
+    }
+
+    /*
+     * The world the body is in and the collision filter it was
+     * added with, so it can be added again with the same filter.
+     */
+    void setWorld(BulletWorld* world, bool hasFilter = false, int group = 0, int mask = 0) {
+        mWorld = world;
+        mHasFilter = hasFilter;
+        mFilterGroup = group;
+        mFilterMask = mask;
+    }
+
+    BulletWorld* getWorld() const {
+        return mWorld;
+    }
+
+    bool hasCollisionFilter() const {
+        return mHasFilter;
+    }
+
+    int getFilterGroup() const {
+        return mFilterGroup;
+    }
+
+    int getFilterMask() const {
+        return mFilterMask;
+    }
+
     void applyCentralForce(float x, float y, float z);
 
     void applyTorque(float x, float y, float z);
@@ -138,6 +188,40 @@ class BulletRigidBody : public PhysicsRigidBody,
 
     void updateConstructionInfo();
 
+    /*
+     * When interpolated the body does not write its transform
+     * when Bullet moves it, the world applies the pose instead.
+     */
+    void setInterpolated(bool interpolated) {
+        mInterpolated = interpolated;
+        mHasRenderPose = false;
+    }
+
+    /*
+     * Pose of the owner object in the simulation.
+     */
+    btTransform getPhysicsPose() const;
+
+    /*
+     * Move the body to a new pose of its owner object.
+     */
+    void setPhysicsPose(const btTransform &pose);
+
+    /*
+     * Write an interpolated pose into the owner transform.
+     * If the transform has been moved since the last pose was
+     * written it is not changed. Its pose is returned instead
+     * so the body can be moved to it.
+     * @returns true if the pose was written, false if the transform moved
+     */
+    bool applyRenderPose(const btTransform &pose, btTransform &moved);
+
+    /*
+     * Write the pose of the body into the owner transform
+     * after the simulation state has been restored.
+     */
+    void resetOwnerPose();
+
 private:
     void initialize();
 
@@ -145,6 +229,9 @@ private:
 
     void updateColisionShapeLocalScaling();
 
+    btVector3 getCollisionShapeScale();
+
+    void releaseCollisionShape();
 
 private:
     btRigidBody *mRigidBody;
@@ -153,6 +240,14 @@ private:
     btTransform prevPos;
     btVector3 mScale;
     SimulationType mSimType;
+    btTransform mRenderPose;
+    BulletPoseBatch* mPoseBatch;
+    BulletWorld* mWorld;
+    int mFilterGroup;
+    int mFilterMask;
+    bool mHasFilter;
+    bool mInterpolated;
+    bool mHasRenderPose;
 };
 
 }
@@ -0,0 +1,374 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bullet_scene_query.h"
+
+#include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <BulletCollision/CollisionDispatch/btCollisionWorld.h>
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <BulletCollision/CollisionShapes/btConcaveShape.h>
+#include <BulletCollision/CollisionShapes/btSphereShape.h>
+#include <BulletCollision/CollisionShapes/btTriangleCallback.h>
+#include <BulletCollision/CollisionShapes/btTriangleShape.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
+#include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
+#include <BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h>
+
+namespace gvr {
+
+static btBroadphaseProxy* leafProxy(const btDbvtNode* leaf) {
+    return static_cast<btBroadphaseProxy*>(leaf->data);
+}
+
+static btCollisionObject* leafObject(const btDbvtNode* leaf) {
+    return static_cast<btCollisionObject*>(leafProxy(leaf)->m_clientObject);
+}
+
+static void setHit(SceneQueryHit& hit, const btCollisionObject* obj,
+                   const btVector3& point, const btVector3& normal, float fraction) {
+    hit.body = obj ? reinterpret_cast<long long>(obj->getUserPointer()) : 0;
+    hit.point[0] = point.getX();
+    hit.point[1] = point.getY();
+    hit.point[2] = point.getZ();
+    hit.normal[0] = normal.getX();
+    hit.normal[1] = normal.getY();
+    hit.normal[2] = normal.getZ();
+    hit.fraction = fraction;
+}
+
+/*
+ * The shape of a sweep or overlap query, built on the stack.
+ */
+class QueryShape {
+public:
+    QueryShape(int type, const SceneQuery& query)
+            : mSphere(query.size[0]),
+              mBox(btVector3(query.size[0], query.size[1], query.size[2])),
+              mIsSphere((type == PhysicsWorld::QUERY_SPHERE_SWEEP) ||
+                        (type == PhysicsWorld::QUERY_SPHERE_OVERLAP)),
+              mRotation(query.rotation[0], query.rotation[1], query.rotation[2], query.rotation[3])
+    {
+        if (mIsSphere || (mRotation.length2() < SIMD_EPSILON)) {
+            mRotation = btQuaternion::getIdentity();
+        }
+    }
+
+    const btConvexShape* get() const {
+        return mIsSphere ? static_cast<const btConvexShape*>(&mSphere) : &mBox;
+    }
+
+    btTransform transform(const float* pos) const {
+        return btTransform(mRotation, btVector3(pos[0], pos[1], pos[2]));
+    }
+
+private:
+    btSphereShape   mSphere;
+    btBoxShape      mBox;
+    bool            mIsSphere;
+    btQuaternion    mRotation;
+};
+
+/*
+ * Closest points between two convex shapes with GJK.
+ * @returns true if the shapes touch
+ */
+static bool convexOverlap(const btConvexShape* a, const btTransform& ta,
+                          const btConvexShape* b, const btTransform& tb,
+                          btVector3& point, btVector3& normal) {
+    btVoronoiSimplexSolver simplex;
+    btGjkEpaPenetrationDepthSolver epa;
+    btGjkPairDetector gjk(a, b, &simplex, &epa);
+    btGjkPairDetector::ClosestPointInput input;
+    btPointCollector result;
+
+    input.m_transformA = ta;
+    input.m_transformB = tb;
+    gjk.getClosestPoints(input, result, nullptr);
+    if (!result.m_hasResult || (result.m_distance > 0)) {
+        return false;
+    }
+    point = result.m_pointInWorld;
+    normal = result.m_normalOnBInWorld;
+    return true;
+}
+
+/*
+ * Tests the triangles of a concave shape in its own space.
+ */
+class TriangleOverlapCallback : public btTriangleCallback {
+public:
+    TriangleOverlapCallback(const btConvexShape* query, const btTransform& queryTrans)
+            : Found(false), mQuery(query), mQueryTrans(queryTrans) { }
+
+    void processTriangle(btVector3* triangle, int partId, int triangleIndex) {
+        if (Found) {
+            return;
+        }
+        btTriangleShape tri(triangle[0], triangle[1], triangle[2]);
+        Found = convexOverlap(mQuery, mQueryTrans, &tri, btTransform::getIdentity(), Point, Normal);
+    }
+
+    bool        Found;
+    btVector3   Point;
+    btVector3   Normal;
+
+private:
+    const btConvexShape*    mQuery;
+    btTransform             mQueryTrans;
+};
+
+static bool shapesOverlap(const btConvexShape* query, const btTransform& queryTrans,
+                          const btCollisionShape* shape, const btTransform& shapeTrans,
+                          btVector3& point, btVector3& normal) {
+    if (shape->isConvex()) {
+        return convexOverlap(query, queryTrans, static_cast<const btConvexShape*>(shape), shapeTrans,
+                             point, normal);
+    }
+    if (shape->isCompound()) {
+        const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+
+        for (int i = 0; i < compound->getNumChildShapes(); ++i) {
+            if (shapesOverlap(query, queryTrans, compound->getChildShape(i),
+                              shapeTrans * compound->getChildTransform(i), point, normal)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if (shape->isConcave()) {
+        btTransform local = shapeTrans.inverse() * queryTrans;
+        TriangleOverlapCallback callback(query, local);
+        btVector3 minAabb, maxAabb;
+
+        query->getAabb(local, minAabb, maxAabb);
+        static_cast<const btConcaveShape*>(shape)->processAllTriangles(&callback, minAabb, maxAabb);
+        if (callback.Found) {
+            point = shapeTrans(callback.Point);
+            normal = shapeTrans.getBasis() * callback.Normal;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Called for each leaf of the broadphase the ray passes through.
+ */
+struct RayLeafCallback : public btDbvt::ICollide {
+    RayLeafCallback(const btTransform& from, const btTransform& to,
+                    btCollisionWorld::ClosestRayResultCallback& result)
+            : From(from), To(to), Result(result) { }
+
+    void Process(const btDbvtNode* leaf) {
+        btCollisionObject* obj = leafObject(leaf);
+
+        if (Result.needsCollision(leafProxy(leaf))) {
+            btCollisionWorld::rayTestSingle(From, To, obj, obj->getCollisionShape(),
+                                            obj->getWorldTransform(), Result);
+        }
+    }
+
+    const btTransform& From;
+    const btTransform& To;
+    btCollisionWorld::ClosestRayResultCallback& Result;
+};
+
+struct SweepLeafCallback : public btDbvt::ICollide {
+    SweepLeafCallback(const btConvexShape* shape, const btTransform& from, const btTransform& to,
+                      btCollisionWorld::ClosestConvexResultCallback& result)
+            : Shape(shape), From(from), To(to), Result(result) { }
+
+    void Process(const btDbvtNode* leaf) {
+        btCollisionObject* obj = leafObject(leaf);
+
+        if (Result.needsCollision(leafProxy(leaf))) {
+            btCollisionWorld::objectQuerySingle(Shape, From, To, obj, obj->getCollisionShape(),
+                                                obj->getWorldTransform(), Result, 0);
+        }
+    }
+
+    const btConvexShape* Shape;
+    const btTransform& From;
+    const btTransform& To;
+    btCollisionWorld::ClosestConvexResultCallback& Result;
+};
+
+struct OverlapLeafCallback : public btDbvt::ICollide {
+    OverlapLeafCallback(const btConvexShape* shape, const btTransform& trans, int collidesWith,
+                        int query, std::vector<SceneQueryHit>& hits)
+            : Shape(shape), Trans(trans), CollidesWith(collidesWith), Query(query), Hits(hits) { }
+
+    void Process(const btDbvtNode* leaf) {
+        btBroadphaseProxy* proxy = leafProxy(leaf);
+        btCollisionObject* obj = leafObject(leaf);
+        btVector3 point, normal;
+
+        if (((proxy->m_collisionFilterGroup & CollidesWith) == 0) ||
+            !shapesOverlap(Shape, Trans, obj->getCollisionShape(), obj->getWorldTransform(),
+                           point, normal)) {
+            return;
+        }
+        SceneQueryHit hit;
+
+        setHit(hit, obj, point, normal, 0);
+        hit.query = Query;
+        Hits.push_back(hit);
+    }
+
+    const btConvexShape* Shape;
+    const btTransform& Trans;
+    int CollidesWith;
+    int Query;
+    std::vector<SceneQueryHit>& Hits;
+};
+
+BulletSceneQuery::BulletSceneQuery()
+        : mWorld(nullptr),
+          mBroadphase(nullptr),
+          mType(PhysicsWorld::QUERY_RAY),
+          mQueries(nullptr),
+          mHits(nullptr)
+{
+}
+
+void BulletSceneQuery::castRay(const SceneQuery& query, SceneQueryHit& hit) const {
+    btVector3 from(query.from[0], query.from[1], query.from[2]);
+    btVector3 to(query.to[0], query.to[1], query.to[2]);
+    btTransform fromTrans(btQuaternion::getIdentity(), from);
+    btTransform toTrans(btQuaternion::getIdentity(), to);
+    btCollisionWorld::ClosestRayResultCallback result(from, to);
+    RayLeafCallback callback(fromTrans, toTrans, result);
+
+    result.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+    result.m_collisionFilterMask = query.collidesWith;
+    btDbvt::rayTest(mBroadphase->m_sets[0].m_root, from, to, callback);
+    btDbvt::rayTest(mBroadphase->m_sets[1].m_root, from, to, callback);
+    if (result.hasHit()) {
+        setHit(hit, result.m_collisionObject, result.m_hitPointWorld,
+               result.m_hitNormalWorld, result.m_closestHitFraction);
+    } else {
+        setHit(hit, nullptr, to, btVector3(0, 0, 0), 1);
+    }
+}
+
+/*
+ * Bodies whose bounds touch the bounds of the shape swept
+ * from start to end are tested with a convex cast.
+ */
+void BulletSceneQuery::sweep(const SceneQuery& query, SceneQueryHit& hit) const {
+    QueryShape shape(mType, query);
+    btTransform fromTrans = shape.transform(query.from);
+    btTransform toTrans = shape.transform(query.to);
+    btCollisionWorld::ClosestConvexResultCallback result(fromTrans.getOrigin(), toTrans.getOrigin());
+    SweepLeafCallback callback(shape.get(), fromTrans, toTrans, result);
+    btVector3 minFrom, maxFrom, minTo, maxTo;
+
+    result.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+    result.m_collisionFilterMask = query.collidesWith;
+    shape.get()->getAabb(fromTrans, minFrom, maxFrom);
+    shape.get()->getAabb(toTrans, minTo, maxTo);
+    minFrom.setMin(minTo);
+    maxFrom.setMax(maxTo);
+
+    btDbvtVolume bounds = btDbvtVolume::FromMM(minFrom, maxFrom);
+    mBroadphase->m_sets[0].collideTV(mBroadphase->m_sets[0].m_root, bounds, callback);
+    mBroadphase->m_sets[1].collideTV(mBroadphase->m_sets[1].m_root, bounds, callback);
+    if (result.hasHit()) {
+        setHit(hit, result.m_hitCollisionObject, result.m_hitPointWorld,
+               result.m_hitNormalWorld, result.m_closestHitFraction);
+    } else {
+        setHit(hit, nullptr, toTrans.getOrigin(), btVector3(0, 0, 0), 1);
+    }
+}
+
+void BulletSceneQuery::overlap(const SceneQuery& query, int index,
+                               std::vector<SceneQueryHit>& hits) const {
+    QueryShape shape(mType, query);
+    btTransform trans = shape.transform(query.from);
+    OverlapLeafCallback callback(shape.get(), trans, query.collidesWith, index, hits);
+    btVector3 minAabb, maxAabb;
+
+    hits.clear();
+    shape.get()->getAabb(trans, minAabb, maxAabb);
+
+    btDbvtVolume bounds = btDbvtVolume::FromMM(minAabb, maxAabb);
+    mBroadphase->m_sets[0].collideTV(mBroadphase->m_sets[0].m_root, bounds, callback);
+    mBroadphase->m_sets[1].collideTV(mBroadphase->m_sets[1].m_root, bounds, callback);
+}
+
+void BulletSceneQuery::runRange(int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        switch (mType) {
+            case PhysicsWorld::QUERY_RAY:
+            castRay(mQueries[i], mHits[i]);
+            mHits[i].query = i;
+            break;
+
+            case PhysicsWorld::QUERY_SPHERE_SWEEP:
+            case PhysicsWorld::QUERY_BOX_SWEEP:
+            sweep(mQueries[i], mHits[i]);
+            mHits[i].query = i;
+            break;
+
+            default:
+            overlap(mQueries[i], i, mOverlaps[i]);
+            break;
+        }
+    }
+}
+
+int BulletSceneQuery::run(btCollisionWorld* world, int type, const SceneQuery* queries,
+                          int numQueries, SceneQueryHit* hits, int maxHits) {
+    bool isOverlap = (type == PhysicsWorld::QUERY_SPHERE_OVERLAP) ||
+                     (type == PhysicsWorld::QUERY_BOX_OVERLAP);
+
+    if ((type < PhysicsWorld::QUERY_RAY) || (type > PhysicsWorld::QUERY_BOX_OVERLAP)) {
+        return 0;
+    }
+    if (!isOverlap && (numQueries > maxHits)) {
+        numQueries = maxHits;
+    }
+    if (numQueries <= 0) {
+        return 0;
+    }
+    mWorld = world;
+    mBroadphase = static_cast<btDbvtBroadphase*>(world->getBroadphase());
+    mType = type;
+    mQueries = queries;
+    mHits = hits;
+    if (isOverlap && ((int) mOverlaps.size() < numQueries)) {
+        mOverlaps.resize(numQueries);
+    }
+    runRange(0, numQueries);
+    if (!isOverlap) {
+        return numQueries;
+    }
+    int numHits = 0;
+
+    for (int i = 0; i < numQueries; ++i) {
+        const std::vector<SceneQueryHit>& found = mOverlaps[i];
+
+        for (size_t j = 0; j < found.size(); ++j, ++numHits) {
+            if (numHits < maxHits) {
+                hits[numHits] = found[j];
+            }
+        }
+    }
+    return numHits;
+}
+
+}
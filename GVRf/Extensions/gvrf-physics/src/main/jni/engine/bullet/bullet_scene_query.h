@@ -0,0 +1,68 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Batched ray, sweep and overlap queries against a Bullet world
+ ***************************************************************************/
+
+#ifndef BULLET_SCENE_QUERY_H_
+#define BULLET_SCENE_QUERY_H_
+
+#include "../physics_world.h"
+
+#include <vector>
+
+class btCollisionWorld;
+struct btDbvtBroadphase;
+
+namespace gvr {
+
+/*
+ * Runs scene queries against the dynamic AABB trees of the broadphase.
+ * The queries do not use the broadphase ray test or the dispatcher,
+ * which keep shared state.
+ * The world must not be stepped while a batch runs.
+ */
+class BulletSceneQuery {
+public:
+    BulletSceneQuery();
+
+    /*
+     * Run a batch of queries, see PhysicsWorld::queryScene.
+     */
+    int run(btCollisionWorld* world, int type, const SceneQuery* queries, int numQueries,
+            SceneQueryHit* hits, int maxHits);
+
+private:
+    /*
+     * Run queries [begin, end) of the current batch.
+     */
+    void runRange(int begin, int end);
+
+    void castRay(const SceneQuery& query, SceneQueryHit& hit) const;
+    void sweep(const SceneQuery& query, SceneQueryHit& hit) const;
+    void overlap(const SceneQuery& query, int index, std::vector<SceneQueryHit>& hits) const;
+
+    btCollisionWorld*       mWorld;
+    btDbvtBroadphase*       mBroadphase;
+    int                     mType;
+    const SceneQuery*       mQueries;
+    SceneQueryHit*          mHits;
+    std::vector<std::vector<SceneQueryHit>> mOverlaps;  // hits of each overlap query
+};
+
+}
+
+#endif /* BULLET_SCENE_QUERY_H_ */
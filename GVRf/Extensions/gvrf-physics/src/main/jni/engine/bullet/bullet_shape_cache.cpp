@@ -0,0 +1,438 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bullet_shape_cache.h"
+#include "bullet_gvr_utils.h"
+#include "objects/mesh.h"
+#include "util/gvr_log.h"
+
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <LinearMath/btAlignedAllocator.h>
+#include <functional>
+#include <string.h>
+
+namespace gvr {
+
+static const unsigned int SAVED_BVH_MAGIC = 0x48564247;   // "GBVH"
+
+/*
+ * Precedes the hierarchy in saved data. The hierarchy only holds
+ * triangle indices so it is checked against the mesh it is loaded for.
+ */
+struct SavedBvhHeader {
+    unsigned int    Magic;
+    int             VertexCount;
+    int             IndexCount;
+    int             PointerSize;
+};
+
+BulletShapeCache& BulletShapeCache::getInstance()
+{
+    static BulletShapeCache cache;
+    return cache;
+}
+
+bool BulletShapeCache::Key::operator<(const Key& k) const
+{
+    if (MeshPtr != k.MeshPtr)
+    {
+        return std::less<const Mesh*>()(MeshPtr, k.MeshPtr);
+    }
+    if (Kind != k.Kind)
+    {
+        return Kind < k.Kind;
+    }
+    if (VertexCount != k.VertexCount)
+    {
+        return VertexCount < k.VertexCount;
+    }
+    if (IndexCount != k.IndexCount)
+    {
+        return IndexCount < k.IndexCount;
+    }
+    if (VertexChanges != k.VertexChanges)
+    {
+        return VertexChanges < k.VertexChanges;
+    }
+    if (IndexChanges != k.IndexChanges)
+    {
+        return IndexChanges < k.IndexChanges;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        if (Scale[i] != k.Scale[i])
+        {
+            return Scale[i] < k.Scale[i];
+        }
+    }
+    return false;
+}
+
+BulletShapeCache::Key BulletShapeCache::makeKey(const Mesh* mesh, const btVector3& scale, int kind)
+{
+    Key key;
+
+    key.MeshPtr = mesh;
+    key.VertexCount = mesh->getVertexCount();
+    key.IndexCount = mesh->getIndexCount();
+    key.VertexChanges = mesh->getVertexBuffer()->getChangeCount();
+    key.IndexChanges = mesh->getIndexBuffer() ? mesh->getIndexBuffer()->getChangeCount() : 0;
+    key.Scale[0] = scale.getX();
+    key.Scale[1] = scale.getY();
+    key.Scale[2] = scale.getZ();
+    key.Kind = kind;
+    return key;
+}
+
+/*
+ * Copy the positions and indices of a mesh so Bullet can
+ * use them after the mesh has changed or been destroyed.
+ * Meshes without indices are treated as a triangle list.
+ */
+bool BulletShapeCache::copyTriangles(Mesh* mesh, Entry& entry)
+{
+    int numVerts = mesh->getVertexCount();
+    int numIndices = mesh->getIndexCount();
+
+    if (numIndices == 0)
+    {
+        numIndices = numVerts;
+    }
+    if ((numVerts == 0) || (numIndices < 3))
+    {
+        return false;
+    }
+    entry.Vertices.resize(numVerts * 3);
+    entry.Indices.resize(numIndices);
+
+    float* verts = entry.Vertices.data();
+    int* indices = entry.Indices.data();
+
+    mesh->forAllVertices("a_position", [verts](int iter, const float* v)
+    {
+        verts[iter * 3] = v[0];
+        verts[iter * 3 + 1] = v[1];
+        verts[iter * 3 + 2] = v[2];
+    });
+    mesh->forAllIndices([indices](int iter, int index)
+    {
+        indices[iter] = index;
+    });
+    entry.MeshData = new btTriangleIndexVertexArray(numIndices / 3, indices, 3 * sizeof(int),
+                                                    numVerts, verts, 3 * sizeof(float));
+    return true;
+}
+
+void BulletShapeCache::freeEntry(Entry& entry)
+{
+    delete entry.Shape;
+    delete entry.MeshData;
+    if (entry.BvhData)
+    {
+        btAlignedFree(entry.BvhData);
+    }
+    entry.Shape = nullptr;
+    entry.MeshData = nullptr;
+    entry.BvhData = nullptr;
+}
+
+/*
+ * Find the unscaled shape for a mesh, building it if necessary.
+ * A new base shape is not referenced until a scaled shape uses it.
+ */
+BulletShapeCache::Entry* BulletShapeCache::findBase(Mesh* mesh, int kind, Key& baseKey)
+{
+    baseKey = makeKey(mesh, btVector3(1, 1, 1), kind);
+
+    std::map<Key, Entry>::iterator it = mEntries.find(baseKey);
+    if (it != mEntries.end())
+    {
+        return &(it->second);
+    }
+    Entry& e = mEntries[baseKey];
+
+    if (kind == TRIANGLE_BVH)
+    {
+        if (copyTriangles(mesh, e))
+        {
+            e.Shape = new btBvhTriangleMeshShape(e.MeshData, true);
+        }
+    }
+    else
+    {
+        e.Shape = createConvexHullShapeFromMesh(mesh);
+    }
+    if (e.Shape == nullptr)
+    {
+        LOGE("PHYSICS: cannot make collision shape from mesh with %d vertices", baseKey.VertexCount);
+        freeEntry(e);
+        mEntries.erase(baseKey);
+        return nullptr;
+    }
+    return &e;
+}
+
+btCollisionShape* BulletShapeCache::acquireScaled(const Key& key, const Key& baseKey, Entry& base)
+{
+    btVector3 scale(key.Scale[0], key.Scale[1], key.Scale[2]);
+    btCollisionShape* shape;
+
+    if (key.Kind == TRIANGLE_MESH)
+    {
+        shape = new btScaledBvhTriangleMeshShape(static_cast<btBvhTriangleMeshShape*>(base.Shape), scale);
+    }
+    else
+    {
+        btConvexHullShape* hull = static_cast<btConvexHullShape*>(base.Shape);
+        btConvexHullShape* scaled = new btConvexHullShape(
+                reinterpret_cast<const btScalar*>(hull->getUnscaledPoints()),
+                hull->getNumPoints(), sizeof(btVector3));
+
+        scaled->setLocalScaling(scale);
+        shape = scaled;
+    }
+    Entry& e = mEntries[key];
+
+    e.Shape = shape;
+    e.RefCount = 1;
+    e.Base = baseKey;
+    e.HasBase = true;
+    ++base.RefCount;
+    mKeys[shape] = key;
+    return shape;
+}
+
+btCollisionShape* BulletShapeCache::acquire(Mesh* mesh, const btVector3& scale, int kind)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    Key key = makeKey(mesh, scale, kind);
+
+    std::map<Key, Entry>::iterator it = mEntries.find(key);
+    if (it != mEntries.end())
+    {
+        ++(it->second.RefCount);
+        return it->second.Shape;
+    }
+    Key baseKey;
+    Entry* base = findBase(mesh, (kind == TRIANGLE_MESH) ? TRIANGLE_BVH : HULL_POINTS, baseKey);
+
+    if (base == nullptr)
+    {
+        return nullptr;
+    }
+    return acquireScaled(key, baseKey, *base);
+}
+
+/*
+ * Scaled shapes are deleted before the base shape they refer to.
+ */
+void BulletShapeCache::releaseKey(const Key& key)
+{
+    std::map<Key, Entry>::iterator it = mEntries.find(key);
+
+    if (it == mEntries.end())
+    {
+        return;
+    }
+    Entry& e = it->second;
+    if ((--e.RefCount > 0) || e.Pinned)
+    {
+        return;
+    }
+    Key baseKey = e.Base;
+    bool hasBase = e.HasBase;
+
+    mKeys.erase(e.Shape);
+    freeEntry(e);
+    mEntries.erase(it);
+    if (hasBase)
+    {
+        releaseKey(baseKey);
+    }
+}
+
+bool BulletShapeCache::release(btCollisionShape* shape)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    std::unordered_map<const btCollisionShape*, Key>::iterator it = mKeys.find(shape);
+
+    if (it == mKeys.end())
+    {
+        return false;
+    }
+    Key key = it->second;
+    releaseKey(key);
+    return true;
+}
+
+btCollisionShape* BulletShapeCache::rescale(btCollisionShape* shape, const btVector3& scale)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    std::unordered_map<const btCollisionShape*, Key>::iterator k = mKeys.find(shape);
+
+    if (k == mKeys.end())
+    {
+        shape->setLocalScaling(scale);
+        return shape;
+    }
+    Key oldKey = k->second;
+    Key newKey = oldKey;
+
+    newKey.Scale[0] = scale.getX();
+    newKey.Scale[1] = scale.getY();
+    newKey.Scale[2] = scale.getZ();
+    if (!(oldKey < newKey) && !(newKey < oldKey))
+    {
+        return shape;
+    }
+    btCollisionShape* newShape;
+    std::map<Key, Entry>::iterator it = mEntries.find(newKey);
+
+    if (it != mEntries.end())
+    {
+        ++(it->second.RefCount);
+        newShape = it->second.Shape;
+    }
+    else
+    {
+        Key baseKey = mEntries[oldKey].Base;
+        newShape = acquireScaled(newKey, baseKey, mEntries[baseKey]);
+    }
+    releaseKey(oldKey);
+    return newShape;
+}
+
+bool BulletShapeCache::saveTriangleMesh(Mesh* mesh, std::vector<char>& data)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    Key baseKey;
+    Entry* base = findBase(mesh, TRIANGLE_BVH, baseKey);
+
+    if (base == nullptr)
+    {
+        return false;
+    }
+    btOptimizedBvh* bvh = static_cast<btBvhTriangleMeshShape*>(base->Shape)->getOptimizedBvh();
+    unsigned int bvhSize = bvh->calculateSerializeBufferSize();
+    void* aligned = btAlignedAlloc(bvhSize, 16);
+    SavedBvhHeader header;
+
+    header.Magic = SAVED_BVH_MAGIC;
+    header.VertexCount = baseKey.VertexCount;
+    header.IndexCount = baseKey.IndexCount;
+    header.PointerSize = sizeof(void*);
+    bvh->serialize(aligned, bvhSize, false);
+    data.resize(sizeof(header) + bvhSize);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), aligned, bvhSize);
+    btAlignedFree(aligned);
+
+    // don't keep a hierarchy which was only built to be saved
+    if ((base->RefCount == 0) && !base->Pinned)
+    {
+        freeEntry(*base);
+        mEntries.erase(baseKey);
+    }
+    return true;
+}
+
+bool BulletShapeCache::loadTriangleMesh(Mesh* mesh, const void* data, int size)
+{
+    SavedBvhHeader header;
+
+    if (size <= (int) sizeof(header))
+    {
+        LOGE("PHYSICS: saved collision mesh is too small");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if ((header.Magic != SAVED_BVH_MAGIC) ||
+        (header.PointerSize != sizeof(void*)) ||
+        (header.VertexCount != mesh->getVertexCount()) ||
+        (header.IndexCount != mesh->getIndexCount()))
+    {
+        LOGE("PHYSICS: saved collision mesh does not match mesh");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+    Key baseKey = makeKey(mesh, btVector3(1, 1, 1), TRIANGLE_BVH);
+    std::map<Key, Entry>::iterator it = mEntries.find(baseKey);
+
+    if (it != mEntries.end())
+    {
+        it->second.Pinned = true;       // already built
+        return true;
+    }
+    Entry& e = mEntries[baseKey];
+    unsigned int bvhSize = size - sizeof(header);
+    btQuantizedBvh* bvh = nullptr;
+
+    if (copyTriangles(mesh, e))
+    {
+        e.BvhData = btAlignedAlloc(bvhSize, 16);
+        memcpy(e.BvhData, static_cast<const char*>(data) + sizeof(header), bvhSize);
+        bvh = btQuantizedBvh::deSerializeInPlace(e.BvhData, bvhSize, false);
+    }
+    if (bvh == nullptr)
+    {
+        LOGE("PHYSICS: cannot load saved collision mesh");
+        freeEntry(e);
+        mEntries.erase(baseKey);
+        return false;
+    }
+    btBvhTriangleMeshShape* shape = new btBvhTriangleMeshShape(e.MeshData, true, false);
+
+    shape->setOptimizedBvh(static_cast<btOptimizedBvh*>(bvh));
+    e.Shape = shape;
+    e.Pinned = true;
+    return true;
+}
+
+/*
+ * The mesh may have changed since its hierarchy was loaded,
+ * so the hierarchies are found by mesh rather than by key.
+ */
+void BulletShapeCache::unloadTriangleMesh(Mesh* mesh)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    std::map<Key, Entry>::iterator it = mEntries.begin();
+
+    while (it != mEntries.end())
+    {
+        Entry& e = it->second;
+
+        if ((it->first.MeshPtr != mesh) || (it->first.Kind != TRIANGLE_BVH) || !e.Pinned)
+        {
+            ++it;
+            continue;
+        }
+        e.Pinned = false;
+        if (e.RefCount <= 0)
+        {
+            freeEntry(e);
+            it = mEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+}
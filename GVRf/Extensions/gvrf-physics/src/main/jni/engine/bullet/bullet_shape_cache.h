@@ -0,0 +1,147 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Collision shapes shared by all the bodies using the same mesh
+ ***************************************************************************/
+
+#ifndef BULLET_SHAPE_CACHE_H_
+#define BULLET_SHAPE_CACHE_H_
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <LinearMath/btVector3.h>
+
+class btCollisionShape;
+class btTriangleIndexVertexArray;
+
+namespace gvr {
+
+class Mesh;
+
+/*
+ * Builds collision shapes from meshes once and shares them between
+ * rigid bodies. Shapes are keyed by the mesh, its size, the change
+ * counts of its vertices and indices, the scale and the kind of
+ * shape and are reference counted. A shape is deleted when the
+ * last body using it releases it. Editing a mesh, or making a new
+ * one where a deleted one was, does not find the old shapes since
+ * no two buffers have the same change count.
+ *
+ * Dynamic bodies use a convex hull of the mesh. Static and kinematic
+ * bodies use the triangles of the mesh in a bounding volume hierarchy.
+ * The hull or the hierarchy is built once per mesh and shared by the
+ * shapes for the different scales. The hierarchy can be saved and
+ * loaded again so it does not have to be rebuilt.
+ */
+class BulletShapeCache {
+public:
+    enum ShapeKind {
+        CONVEX_HULL = 0,
+        TRIANGLE_MESH = 1
+    };
+
+    static BulletShapeCache& getInstance();
+
+    /*
+     * Get a shape for a mesh, building it if it is not in the cache.
+     * The caller owns a reference and must call release.
+     */
+    btCollisionShape* acquire(Mesh* mesh, const btVector3& scale, int kind);
+
+    /*
+     * Get a shape like one from the cache with a different scale
+     * and release the original one. Shapes which are not from the
+     * cache are scaled in place.
+     * @returns the new shape, which may be the same as the input
+     */
+    btCollisionShape* rescale(btCollisionShape* shape, const btVector3& scale);
+
+    /*
+     * Release a reference to a shape.
+     * @returns false if the shape is not from the cache
+     */
+    bool release(btCollisionShape* shape);
+
+    /*
+     * Save the triangle hierarchy of a mesh.
+     * @returns false if the mesh has no triangles
+     */
+    bool saveTriangleMesh(Mesh* mesh, std::vector<char>& data);
+
+    /*
+     * Use a hierarchy saved by saveTriangleMesh for a mesh instead
+     * of building it. It is kept in the cache until unloadTriangleMesh
+     * is called for the mesh, which must be done before the mesh
+     * is destroyed.
+     * @returns true if the data was loaded, false if it does not match the mesh
+     */
+    bool loadTriangleMesh(Mesh* mesh, const void* data, int size);
+
+    void unloadTriangleMesh(Mesh* mesh);
+
+private:
+    // Unscaled shapes the scaled ones are made from, never given to bodies
+    enum BaseKind {
+        HULL_POINTS = 2,
+        TRIANGLE_BVH = 3
+    };
+
+    struct Key {
+        const Mesh* MeshPtr;
+        int         VertexCount;
+        int         IndexCount;
+        unsigned int VertexChanges;
+        unsigned int IndexChanges;
+        float       Scale[3];
+        int         Kind;
+
+        bool operator<(const Key& k) const;
+    };
+
+    struct Entry {
+        btCollisionShape*           Shape;
+        int                         RefCount;
+        Key                         Base;       // shape this one scales
+        bool                        HasBase;
+        std::vector<float>          Vertices;   // triangle data used by the hierarchy
+        std::vector<int>            Indices;
+        btTriangleIndexVertexArray* MeshData;
+        void*                       BvhData;    // hierarchy from loadTriangleMesh
+        bool                        Pinned;     // kept until unloadTriangleMesh
+    };
+
+    BulletShapeCache() { }
+    BulletShapeCache(const BulletShapeCache&);
+    BulletShapeCache& operator=(const BulletShapeCache&);
+
+    static Key makeKey(const Mesh* mesh, const btVector3& scale, int kind);
+    Entry* findBase(Mesh* mesh, int kind, Key& baseKey);
+    btCollisionShape* acquireScaled(const Key& key, const Key& baseKey, Entry& base);
+    void releaseKey(const Key& key);
+    static bool copyTriangles(Mesh* mesh, Entry& entry);
+    static void freeEntry(Entry& entry);
+
+    std::mutex                                          mLock;
+    std::map<Key, Entry>                                mEntries;
+    std::unordered_map<const btCollisionShape*, Key>    mKeys;
+};
+
+}
+
+#endif /* BULLET_SHAPE_CACHE_H_ */
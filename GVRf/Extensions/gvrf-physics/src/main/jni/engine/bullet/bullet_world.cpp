@@ -18,16 +18,26 @@
 
 #include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <BulletCollision/CollisionShapes/btCollisionShape.h>
 #include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
 
 #include <BulletDynamics/Dynamics/btDynamicsWorld.h>
 #include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 
 #include <android/log.h>
+#include <stddef.h>
+#include <string.h>
+#include "util/gvr_log.h"
 
 namespace gvr {
 
-BulletWorld::BulletWorld() {
+BulletWorld::BulletWorld()
+        : mInterpolated(false),
+          mFixedTimeStep(1.0f / 60.0f),
+          mSimTime(0),
+          mFrontPoses(0),
+          mFrontApplied(true)
+{
     initialize();
 }
 
@@ -91,86 +101,626 @@ void BulletWorld::removeConstraint(PhysicsConstraint *constraint) {
 void BulletWorld::addRigidBody(PhysicsRigidBody *body) {
     btRigidBody *b = (static_cast<BulletRigidBody *>(body))->getRigidBody();
     body->updateConstructionInfo();
+    (static_cast<BulletRigidBody *>(body))->setInterpolated(mInterpolated);
+    (static_cast<BulletRigidBody *>(body))->setPoseBatch(&mPoseBatch);
+    (static_cast<BulletRigidBody *>(body))->setWorld(this);
     mPhysicsWorld->addRigidBody(b);
 }
 
 void BulletWorld::addRigidBody(PhysicsRigidBody *body, int collisiontype, int collidesWith) {
     body->updateConstructionInfo();
+    (static_cast<BulletRigidBody *>(body))->setInterpolated(mInterpolated);
+    (static_cast<BulletRigidBody *>(body))->setPoseBatch(&mPoseBatch);
+    (static_cast<BulletRigidBody *>(body))->setWorld(this, true, collidesWith, collisiontype);
     mPhysicsWorld->addRigidBody((static_cast<BulletRigidBody *>(body))->getRigidBody(),
                                 collidesWith, collisiontype);
 }
 
+/*
+ * Bullet picks the collision filter of a body added without one
+ * from whether it is static, so it is picked again.
+ */
+void BulletWorld::rebuildRigidBody(BulletRigidBody *body) {
+    btRigidBody* rb = body->getRigidBody();
+
+    mPhysicsWorld->removeRigidBody(rb);
+    body->updateConstructionInfo();
+    if (body->hasCollisionFilter()) {
+        mPhysicsWorld->addRigidBody(rb, body->getFilterGroup(), body->getFilterMask());
+    }
+    else {
+        mPhysicsWorld->addRigidBody(rb);
+    }
+}
+
 void BulletWorld::removeRigidBody(PhysicsRigidBody *body) {
-    mPhysicsWorld->removeRigidBody((static_cast<BulletRigidBody *>(body))->getRigidBody());
+    BulletRigidBody* rb = static_cast<BulletRigidBody *>(body);
+
+    mPhysicsWorld->removeRigidBody(rb->getRigidBody());
+    rb->setInterpolated(false);
+    rb->setPoseBatch(nullptr);
+    rb->setWorld(nullptr);
+    mContactTracker.removeBody(rb);
+    if (mInterpolated) {
+        std::lock_guard<std::mutex> lock(mPoseLock);
+        std::vector<BodyPose>& front = mPoses[mFrontPoses];
+
+        front.erase(std::remove_if(front.begin(), front.end(),
+                                   [rb](const BodyPose& p) { return p.Body == rb; }),
+                    front.end());
+        mMovedBodies.erase(std::remove_if(mMovedBodies.begin(), mMovedBodies.end(),
+                                          [rb](const std::pair<BulletRigidBody*, btTransform>& m)
+                                          { return m.first == rb; }),
+                           mMovedBodies.end());
+    }
 }
 
+/*
+ * Bullet only sets the poses of the bodies which are awake.
+ * They are gathered while stepping and written to the transforms
+ * afterwards in one loop, sleeping bodies are not touched.
+ * Each body still sets its own transform, which marks the
+ * bounds of its owner and ancestors dirty.
+ */
 void BulletWorld::step(float timeStep, int maxSubSteps) {
+    mPoseBatch.clear();
     mPhysicsWorld->stepSimulation(timeStep, maxSubSteps);
+    for (auto it = mPoseBatch.begin(); it != mPoseBatch.end(); ++it) {
+        it->first->applyWorldTransform(it->second);
+    }
+    mPoseBatch.clear();
 }
 
-/**
- * Returns by reference the list of new and ceased collisions
- *  that will be the objects of ONENTER and ONEXIT events.
+void BulletWorld::setInterpolation(bool enable, float fixedTimeStep) {
+    std::lock_guard<std::mutex> lock(mPoseLock);
+    if (fixedTimeStep > 0) {
+        mFixedTimeStep = fixedTimeStep;
+    }
+    if (enable == mInterpolated) {
+        return;
+    }
+    mInterpolated = enable;
+    mPoses[0].clear();
+    mPoses[1].clear();
+    mMovedBodies.clear();
+    mFrontApplied = true;
+    mSimTime = 0;
+    mClockStart = std::chrono::steady_clock::now();
+    setBodiesInterpolated(enable);
+}
+
+void BulletWorld::setBodiesInterpolated(bool interpolated) {
+    btCollisionObjectArray& objects = mPhysicsWorld->getCollisionObjectArray();
+
+    for (int i = 0; i < objects.size(); ++i) {
+        btRigidBody* rb = btRigidBody::upcast(objects[i]);
+        if (rb && rb->getUserPointer()) {
+            static_cast<BulletRigidBody*>(rb->getUserPointer())->setInterpolated(interpolated);
+        }
+    }
+}
+
+double BulletWorld::elapsedSeconds() const {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - mClockStart;
+    return elapsed.count();
+}
+
+/*
+ * Steps the world by the fixed time step as many times as it
+ * takes to catch up with real time. The time step never varies,
+ * so the same inputs always produce the same simulation no
+ * matter how often this is called. If the simulation falls
+ * more than maxSteps behind, the extra time is dropped.
+ * The clock and the simulation time are read by applyPoses,
+ * they only change with the pose lock held, together with
+ * the poses they belong to.
  */
-void BulletWorld::listCollisions(std::list <ContactPoint> &contactPoints) {
+int BulletWorld::stepFixed(int maxSteps) {
+    if (!mInterpolated) {
+        return 0;
+    }
+    double dt;
+    double dropped = 0;
+    int steps;
+    {
+        std::lock_guard<std::mutex> lock(mPoseLock);
+        dt = mFixedTimeStep;
+        steps = static_cast<int>((elapsedSeconds() - mSimTime) / dt);
+        if (steps <= 0) {
+            return 0;
+        }
+        if (steps > maxSteps) {
+            dropped = (steps - maxSteps) * dt;
+            steps = maxSteps;
+        }
+        for (auto it = mMovedBodies.begin(); it != mMovedBodies.end(); ++it) {
+            it->first->setPhysicsPose(it->second);
+        }
+        mMovedBodies.clear();
+    }
+    for (int i = 0; i < steps - 1; ++i) {
+        mPhysicsWorld->stepSimulation(dt, 0);
+    }
+    std::vector<BodyPose>& back = mPoses[1 - mFrontPoses];
+
+    capturePrevPoses(back);
+    mPhysicsWorld->stepSimulation(dt, 0);
+    captureCurPoses(back);
+
+    std::lock_guard<std::mutex> lock(mPoseLock);
+    if (dropped > 0) {
+        mClockStart += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(dropped));
+    }
+    mSimTime += steps * dt;
+    mFrontPoses = 1 - mFrontPoses;
+    mFrontApplied = false;
+    return steps;
+}
+
+void BulletWorld::capturePrevPoses(std::vector<BodyPose>& poses) {
+    btCollisionObjectArray& objects = mPhysicsWorld->getCollisionObjectArray();
+
+    poses.clear();
+    for (int i = 0; i < objects.size(); ++i) {
+        btRigidBody* rb = btRigidBody::upcast(objects[i]);
+        if (rb == nullptr || rb->getUserPointer() == nullptr ||
+            rb->isStaticOrKinematicObject()) {
+            continue;
+        }
+        BodyPose pose;
+        pose.Body = static_cast<BulletRigidBody*>(rb->getUserPointer());
+        btTransform t = pose.Body->getPhysicsPose();
+        pose.PrevPos = t.getOrigin();
+        pose.PrevRot = t.getRotation();
+        poses.push_back(pose);
+    }
+}
+
+void BulletWorld::captureCurPoses(std::vector<BodyPose>& poses) {
+    for (auto it = poses.begin(); it != poses.end(); ++it) {
+        btTransform t = it->Body->getPhysicsPose();
+        it->CurPos = t.getOrigin();
+        it->CurRot = t.getRotation();
+        it->Moving = (it->CurPos != it->PrevPos) || (it->CurRot != it->PrevRot);
+    }
+}
 
 /*
- * Creates a list of all the current collisions on the World
- * */
-    std::map<std::pair<long,long>, ContactPoint> currCollisions;
-    int numManifolds = mPhysicsWorld->getDispatcher()->getNumManifolds();
-    btPersistentManifold *contactManifold;
-
-    for (int i = 0; i < numManifolds; i++) {
-        ContactPoint contactPt;
-
-        contactManifold = mPhysicsWorld->getDispatcher()->
-                getManifoldByIndexInternal(i);
-
-        contactPt.body0 = (BulletRigidBody *) (contactManifold->getBody0()->getUserPointer());
-        contactPt.body1 = (BulletRigidBody *) (contactManifold->getBody1()->getUserPointer());
-        contactPt.normal[0] = contactManifold->getContactPoint(0).m_normalWorldOnB.getX();
-        contactPt.normal[1] = contactManifold->getContactPoint(0).m_normalWorldOnB.getY();
-        contactPt.normal[2] = contactManifold->getContactPoint(0).m_normalWorldOnB.getZ();
-        contactPt.distance = contactManifold->getContactPoint(0).getDistance();
-        contactPt.isHit = true;
-
-        std::pair<long, long> collisionPair((long)contactPt.body0, (long)contactPt.body1);
-        std::pair<std::pair<long, long>, ContactPoint> newPair(collisionPair, contactPt);
-        currCollisions.insert(newPair);
-
-        /*
-         * If one of these current collisions is not on the list with all the previous
-         * collision, then it should be on the return list, because it is an onEnter event
-         * */
-        auto it = prevCollisions.find(collisionPair);
-        if ( it == prevCollisions.end()) {
-            contactPoints.push_front(contactPt);
-        } 
-        contactManifold = 0;
-    }
-
-    /*
-     * After going through all the current list, go through all the previous collisions list,
-     * if one of its collisions is not on the current collision list, then it should be
-     * on the return list, because it is an onExit event
-     * */
-    for (auto it = prevCollisions.begin(); it != prevCollisions.end(); ++it) {
-        if (currCollisions.find(it->first) == currCollisions.end()) {
-            ContactPoint cp = it->second;
-            cp.isHit = false;
-            contactPoints.push_front(cp);
+ * Renders the simulation one step behind real time so there
+ * are always two poses to interpolate between. Bodies which
+ * did not move are only written once after each step.
+ */
+void BulletWorld::applyPoses() {
+    if (!mInterpolated) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mPoseLock);
+    std::vector<BodyPose>& front = mPoses[mFrontPoses];
+    float alpha = static_cast<float>((elapsedSeconds() - mSimTime) / mFixedTimeStep);
+    btTransform moved;
+
+    alpha = std::max(0.0f, std::min(alpha, 1.0f));
+    for (auto it = front.begin(); it != front.end(); ++it) {
+        const BodyPose& p = *it;
+        if (!p.Moving && mFrontApplied) {
+            continue;
+        }
+        btTransform pose(p.PrevRot.slerp(p.CurRot, alpha), p.PrevPos.lerp(p.CurPos, alpha));
+        if (!p.Body->applyRenderPose(pose, moved)) {
+            mMovedBodies.push_back(std::make_pair(p.Body, moved));
         }
     }
+    mFrontApplied = true;
+}
+
+const std::vector<ContactEvent>& BulletWorld::updateContacts() {
+    return mContactTracker.update(mPhysicsWorld->getDispatcher());
+}
+
+void BulletWorld::setContactReporting(bool reportStay, bool reportAllPoints) {
+    mContactTracker.setReportStay(reportStay);
+    mContactTracker.setReportAllPoints(reportAllPoints);
+}
+
+int BulletWorld::queryScene(int type, const SceneQuery* queries, int numQueries,
+                            SceneQueryHit* hits, int maxHits) {
+    return mSceneQuery.run(mPhysicsWorld, type, queries, numQueries, hits, maxHits);
+}
 
 /*
- * Save all the current collisions on the previous collisions list for the next iteration
- * */
-    prevCollisions.clear();
-    prevCollisions.swap(currCollisions);
+ * Layout of a snapshot. The header is followed by a BodySnapshot for
+ * each collision object in the order of the collision object array,
+ * a ConstraintSnapshot for each constraint and the contact manifolds,
+ * each of them a ManifoldSnapshot followed by its contact points.
+ * Snapshots are only meant to be restored by the process which took
+ * them, the contact points are stored as Bullet keeps them.
+ */
+static const unsigned int SNAPSHOT_MAGIC = 0x534e5047;   // "GPNS"
+
+struct SnapshotHeader {
+    unsigned int    Magic;
+    int             Size;
+    int             NumBodies;
+    int             NumConstraints;
+    int             NumManifolds;
+    int             NumPoints;
+};
+
+struct BodySnapshot {
+    long long               Body;           // checked against the world on restore
+    btTransformFloatData    Transform;
+    btTransformFloatData    InterpolationTransform;
+    btVector3FloatData      LinearVelocity;
+    btVector3FloatData      AngularVelocity;
+    btVector3FloatData      InterpolationLinearVelocity;
+    btVector3FloatData      InterpolationAngularVelocity;
+    float                   DeactivationTime;
+    float                   HitFraction;
+    int                     ActivationState;
+    int                     Padding;
+};
+
+struct ConstraintSnapshot {
+    float   AppliedImpulse;
+    int     Enabled;
+};
+
+struct ManifoldSnapshot {
+    int     Body0;          // index of the body in the snapshot
+    int     Body1;
+    int     NumPoints;
+    int     Padding;
+};
+
+/*
+ * Number the collision objects by their place in the world so the
+ * manifolds of a snapshot can refer to them. The numbers are kept
+ * apart from the objects so their user index is left to the user.
+ */
+void BulletWorld::numberObjects() {
+    btCollisionObjectArray& objects = mPhysicsWorld->getCollisionObjectArray();
+
+    mObjectIndices.clear();
+    for (int i = 0; i < objects.size(); ++i) {
+        mObjectIndices.push_back(std::make_pair(static_cast<const btCollisionObject*>(objects[i]), i));
+    }
+    std::sort(mObjectIndices.begin(), mObjectIndices.end());
+}
+
+int BulletWorld::objectNumber(const btCollisionObject* obj) const {
+    auto it = std::lower_bound(mObjectIndices.begin(), mObjectIndices.end(),
+                               std::make_pair(obj, -1));
 
+    return ((it != mObjectIndices.end()) && (it->first == obj)) ? it->second : -1;
 }
 
+int BulletWorld::snapshot(void* buffer, int size) {
+    btCollisionObjectArray& objects = mPhysicsWorld->getCollisionObjectArray();
+    int numManifolds = mDispatcher->getNumManifolds();
+    SnapshotHeader header;
+
+    header.Magic = SNAPSHOT_MAGIC;
+    header.NumBodies = objects.size();
+    header.NumConstraints = mPhysicsWorld->getNumConstraints();
+    header.NumManifolds = 0;
+    header.NumPoints = 0;
+    for (int i = 0; i < numManifolds; ++i) {
+        int n = mDispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+        if (n > 0) {
+            ++header.NumManifolds;
+            header.NumPoints += n;
+        }
+    }
+    header.Size = sizeof(SnapshotHeader)
+                  + header.NumBodies * sizeof(BodySnapshot)
+                  + header.NumConstraints * sizeof(ConstraintSnapshot)
+                  + header.NumManifolds * sizeof(ManifoldSnapshot)
+                  + header.NumPoints * sizeof(btManifoldPoint);
+    if ((buffer == nullptr) || (size < header.Size)) {
+        return header.Size;
+    }
+    char* dst = static_cast<char*>(buffer);
+
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    numberObjects();
+    for (int i = 0; i < objects.size(); ++i) {
+        btRigidBody* rb = btRigidBody::upcast(objects[i]);
+        BodySnapshot b;
+
+        memset(&b, 0, sizeof(b));
+        b.Body = reinterpret_cast<long long>(objects[i]->getUserPointer());
+        objects[i]->getWorldTransform().serializeFloat(b.Transform);
+        objects[i]->getInterpolationWorldTransform().serializeFloat(b.InterpolationTransform);
+        objects[i]->getInterpolationLinearVelocity().serializeFloat(b.InterpolationLinearVelocity);
+        objects[i]->getInterpolationAngularVelocity().serializeFloat(b.InterpolationAngularVelocity);
+        if (rb) {
+            rb->getLinearVelocity().serializeFloat(b.LinearVelocity);
+            rb->getAngularVelocity().serializeFloat(b.AngularVelocity);
+        }
+        b.DeactivationTime = objects[i]->getDeactivationTime();
+        b.HitFraction = objects[i]->getHitFraction();
+        b.ActivationState = objects[i]->getActivationState();
+        memcpy(dst, &b, sizeof(b));
+        dst += sizeof(b);
+    }
+    for (int i = 0; i < header.NumConstraints; ++i) {
+        btTypedConstraint* constraint = mPhysicsWorld->getConstraint(i);
+        ConstraintSnapshot c;
+
+        c.AppliedImpulse = constraint->internalGetAppliedImpulse();
+        c.Enabled = constraint->isEnabled();
+        memcpy(dst, &c, sizeof(c));
+        dst += sizeof(c);
+    }
+    for (int i = 0; i < numManifolds; ++i) {
+        btPersistentManifold* manifold = mDispatcher->getManifoldByIndexInternal(i);
+        ManifoldSnapshot m;
+
+        m.NumPoints = manifold->getNumContacts();
+        if (m.NumPoints == 0) {
+            continue;
+        }
+        m.Body0 = objectNumber(manifold->getBody0());
+        m.Body1 = objectNumber(manifold->getBody1());
+        m.Padding = 0;
+        memcpy(dst, &m, sizeof(m));
+        dst += sizeof(m);
+        for (int j = 0; j < m.NumPoints; ++j) {
+            memcpy(dst, &manifold->getContactPoint(j), sizeof(btManifoldPoint));
+            dst += sizeof(btManifoldPoint);
+        }
+    }
+    return header.Size;
+}
+
+/*
+ * Recreate the broadphase proxies of all the bodies in the order
+ * of the collision object array. This drops all the overlapping
+ * pairs and contact manifolds so the pairs are found again in the
+ * same order every time a snapshot is restored.
+ */
+void BulletWorld::rebuildBroadphase() {
+    btCollisionObjectArray& objects = mPhysicsWorld->getCollisionObjectArray();
+    btBroadphaseInterface* broadphase = mPhysicsWorld->getBroadphase();
+
+    mProxyFilters.resize(objects.size());
+    for (int i = 0; i < objects.size(); ++i) {
+        btBroadphaseProxy* proxy = objects[i]->getBroadphaseHandle();
+
+        mProxyFilters[i].first = proxy->m_collisionFilterGroup;
+        mProxyFilters[i].second = proxy->m_collisionFilterMask;
+        broadphase->getOverlappingPairCache()->cleanProxyFromPairs(proxy, mDispatcher);
+        broadphase->destroyProxy(proxy, mDispatcher);
+        objects[i]->setBroadphaseHandle(nullptr);
+    }
+    broadphase->resetPool(mDispatcher);
+    for (int i = 0; i < objects.size(); ++i) {
+        btCollisionObject* obj = objects[i];
+        btVector3 minAabb, maxAabb;
+
+        obj->getCollisionShape()->getAabb(obj->getWorldTransform(), minAabb, maxAabb);
+        obj->setBroadphaseHandle(broadphase->createProxy(minAabb, maxAabb,
+                                                         obj->getCollisionShape()->getShapeType(),
+                                                         obj, mProxyFilters[i].first,
+                                                         mProxyFilters[i].second,
+                                                         mDispatcher, nullptr));
+    }
+}
+
+/*
+ * Key of the pair of bodies in a saved manifold which does not
+ * depend on the order of the bodies. Offsets of manifolds which
+ * have been restored are stored as -(offset + 1).
+ */
+static long long savedPairKey(const char* data, int offset) {
+    ManifoldSnapshot m;
+
+    if (offset < 0) {
+        offset = -offset - 1;
+    }
+    memcpy(&m, data + offset, sizeof(m));
+    return (static_cast<long long>(std::min(m.Body0, m.Body1)) << 32) | std::max(m.Body0, m.Body1);
+}
+
+/*
+ * Exchange the bodies of a contact point. The lateral impulses are
+ * along friction directions which the solver picks from the normal
+ * so they are no longer valid.
+ */
+static void swapPointBodies(btManifoldPoint& pt) {
+    std::swap(pt.m_localPointA, pt.m_localPointB);
+    std::swap(pt.m_positionWorldOnA, pt.m_positionWorldOnB);
+    std::swap(pt.m_partId0, pt.m_partId1);
+    std::swap(pt.m_index0, pt.m_index1);
+    pt.m_normalWorldOnB = -pt.m_normalWorldOnB;
+    pt.m_appliedImpulseLateral1 = 0;
+    pt.m_appliedImpulseLateral2 = 0;
+}
+
+/*
+ * Find the saved manifolds in the size bytes of data, checking each
+ * one and its points fit before it is read. The manifolds must use
+ * all of the data, have at most MANIFOLD_CACHE_SIZE points each and
+ * refer to bodies in the snapshot.
+ * @returns false if the data is truncated or corrupt
+ */
+bool BulletWorld::findSavedManifolds(const char* data, int size, int numManifolds, int numBodies) {
+    int offset = 0;
+
+    mSavedManifolds.clear();
+    for (int i = 0; i < numManifolds; ++i) {
+        ManifoldSnapshot m;
+
+        if (size - offset < (int) sizeof(m)) {
+            return false;
+        }
+        memcpy(&m, data + offset, sizeof(m));
+        if ((m.NumPoints <= 0) || (m.NumPoints > MANIFOLD_CACHE_SIZE) ||
+            (m.Body0 < 0) || (m.Body0 >= numBodies) ||
+            (m.Body1 < 0) || (m.Body1 >= numBodies) ||
+            ((size - offset - (int) sizeof(m)) / (int) sizeof(btManifoldPoint) < m.NumPoints)) {
+            return false;
+        }
+        mSavedManifolds.push_back(offset);
+        offset += sizeof(m) + m.NumPoints * sizeof(btManifoldPoint);
+    }
+    return offset == size;
+}
+
+/*
+ * Run the narrow phase to create the manifolds for the touching
+ * bodies, then replace their contact points with the saved ones
+ * found by findSavedManifolds.
+ * Manifolds which were not saved are emptied so they fill up in
+ * the next step like they would have done after the snapshot.
+ */
+void BulletWorld::restoreContacts(const char* data) {
+    mPhysicsWorld->performDiscreteCollisionDetection();
+    std::stable_sort(mSavedManifolds.begin(), mSavedManifolds.end(),
+                     [data](int a, int b) { return savedPairKey(data, a) < savedPairKey(data, b); });
+
+    int numNew = mDispatcher->getNumManifolds();
+    for (int i = 0; i < numNew; ++i) {
+        btPersistentManifold* manifold = mDispatcher->getManifoldByIndexInternal(i);
+        int body0 = objectNumber(manifold->getBody0());
+        int body1 = objectNumber(manifold->getBody1());
+        long long key = (static_cast<long long>(std::min(body0, body1)) << 32) | std::max(body0, body1);
+        auto it = std::lower_bound(mSavedManifolds.begin(), mSavedManifolds.end(), key,
+                                   [data](int a, long long k) { return savedPairKey(data, a) < k; });
+
+        manifold->clearManifold();
+        while ((it != mSavedManifolds.end()) && (*it < 0) && (savedPairKey(data, *it) == key)) {
+            ++it;                       // restored into another manifold of the pair
+        }
+        if ((it == mSavedManifolds.end()) || (*it < 0) || (savedPairKey(data, *it) != key)) {
+            continue;
+        }
+        ManifoldSnapshot m;
+        const char* src = data + *it;
+
+        memcpy(&m, src, sizeof(m));
+        src += sizeof(m);
+        for (int j = 0; j < m.NumPoints; ++j) {
+            btManifoldPoint pt;
+
+            memcpy(&pt, src + j * sizeof(btManifoldPoint), sizeof(btManifoldPoint));
+            pt.m_userPersistentData = nullptr;
+            if (m.Body0 != body0) {
+                swapPointBodies(pt);
+            }
+            manifold->addManifoldPoint(pt);
+        }
+        *it = -(*it + 1);
+    }
+}
+
+bool BulletWorld::restore(const void* buffer, int size) {
+    btCollisionObjectArray& objects = mPhysicsWorld->getCollisionObjectArray();
+    const char* src = static_cast<const char*>(buffer);
+    SnapshotHeader header;
+
+    if ((buffer == nullptr) || (size < (int) sizeof(header))) {
+        return false;
+    }
+    memcpy(&header, src, sizeof(header));
+    if ((header.Magic != SNAPSHOT_MAGIC) ||
+        (header.NumBodies != objects.size()) ||
+        (header.NumConstraints != mPhysicsWorld->getNumConstraints())) {
+        LOGE("PHYSICS: snapshot does not match the world");
+        return false;
+    }
+    long long expectedSize = sizeof(SnapshotHeader)
+                             + (long long) header.NumBodies * sizeof(BodySnapshot)
+                             + (long long) header.NumConstraints * sizeof(ConstraintSnapshot)
+                             + (long long) header.NumManifolds * sizeof(ManifoldSnapshot)
+                             + (long long) header.NumPoints * sizeof(btManifoldPoint);
+    if ((header.NumManifolds < 0) || (header.NumPoints < 0) ||
+        (header.Size != expectedSize) || (header.Size > size)) {
+        LOGE("PHYSICS: snapshot is truncated or corrupt");
+        return false;
+    }
+    src += sizeof(header);
+
+    const char* contacts = src + header.NumBodies * sizeof(BodySnapshot)
+                               + header.NumConstraints * sizeof(ConstraintSnapshot);
+    if (!findSavedManifolds(contacts, header.Size - (contacts - static_cast<const char*>(buffer)),
+                            header.NumManifolds, header.NumBodies)) {
+        LOGE("PHYSICS: snapshot contacts are truncated or corrupt");
+        return false;
+    }
+    for (int i = 0; i < header.NumBodies; ++i) {
+        long long body;
+
+        memcpy(&body, src + i * sizeof(BodySnapshot) + offsetof(BodySnapshot, Body), sizeof(body));
+        if (body != reinterpret_cast<long long>(objects[i]->getUserPointer())) {
+            LOGE("PHYSICS: snapshot was taken with different bodies");
+            return false;
+        }
+    }
+    for (int i = 0; i < header.NumBodies; ++i) {
+        btCollisionObject* obj = objects[i];
+        btRigidBody* rb = btRigidBody::upcast(obj);
+        BodySnapshot b;
+        btTransform t;
+        btVector3 v;
+
+        memcpy(&b, src, sizeof(b));
+        src += sizeof(b);
+        t.deSerializeFloat(b.Transform);
+        if (rb) {
+            rb->setCenterOfMassTransform(t);
+            v.deSerializeFloat(b.LinearVelocity);
+            rb->setLinearVelocity(v);
+            v.deSerializeFloat(b.AngularVelocity);
+            rb->setAngularVelocity(v);
+            rb->clearForces();
+        } else {
+            obj->setWorldTransform(t);
+        }
+        t.deSerializeFloat(b.InterpolationTransform);
+        obj->setInterpolationWorldTransform(t);
+        v.deSerializeFloat(b.InterpolationLinearVelocity);
+        obj->setInterpolationLinearVelocity(v);
+        v.deSerializeFloat(b.InterpolationAngularVelocity);
+        obj->setInterpolationAngularVelocity(v);
+        obj->setHitFraction(b.HitFraction);
+        obj->setDeactivationTime(b.DeactivationTime);
+        obj->forceActivationState(b.ActivationState);
+    }
+    for (int i = 0; i < header.NumConstraints; ++i) {
+        btTypedConstraint* constraint = mPhysicsWorld->getConstraint(i);
+        ConstraintSnapshot c;
+
+        memcpy(&c, src, sizeof(c));
+        src += sizeof(c);
+        constraint->internalSetAppliedImpulse(c.AppliedImpulse);
+        constraint->setEnabled(c.Enabled != 0);
+    }
+    rebuildBroadphase();
+    mSolver->reset();
+    numberObjects();
+    restoreContacts(src);
+
+    // the touching pairs are those of the snapshot now, not of the last step
+    mContactTracker.sync(mDispatcher);
+
+    for (int i = 0; i < objects.size(); ++i) {
+        BulletRigidBody* body = static_cast<BulletRigidBody*>(objects[i]->getUserPointer());
+        if (body) {
+            body->resetOwnerPose();
+        }
+    }
+    if (mInterpolated) {
+        std::lock_guard<std::mutex> lock(mPoseLock);
+        mPoses[0].clear();
+        mPoses[1].clear();
+        mMovedBodies.clear();
+        mFrontApplied = true;
+    }
+    return true;
+}
 
 void BulletWorld::setGravity(float x, float y, float z) {
     mPhysicsWorld->setGravity(btVector3(x, y, z));
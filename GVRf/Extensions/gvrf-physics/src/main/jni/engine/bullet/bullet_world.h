@@ -22,10 +22,21 @@
 
 #include "../physics_common.h"
 #include "../physics_world.h"
+#include "../physics_snapshot_ring.h"
+#include "bullet_rigidbody.h"
+#include "bullet_contact_tracker.h"
+#include "bullet_scene_query.h"
 
+#include <atomic>
+#include <chrono>
 #include <utility>
-#include <map>
+#include <mutex>
+#include <vector>
 
+#include <LinearMath/btQuaternion.h>
+#include <LinearMath/btTransform.h>
+
+class btCollisionObject;
 class btDynamicsWorld;
 class btCollisionConfiguration;
 class btCollisionDispatcher;
@@ -53,9 +64,50 @@ class BulletWorld : public PhysicsWorld {
 
     void removeRigidBody(PhysicsRigidBody *body);
 
+    /*
+     * Take a body out of the world, rebuild its collision shape
+     * and inertia and add it again with the same collision filter.
+     */
+    void rebuildRigidBody(BulletRigidBody *body);
+
     void step(float timeStep, int maxSubSteps);
 
-    void listCollisions(std::list <ContactPoint> &contactPoints);
+    void setInterpolation(bool enable, float fixedTimeStep);
+
+    bool isInterpolated() const {
+        return mInterpolated;
+    }
+
+    int stepFixed(int maxSteps);
+
+    void applyPoses();
+
+    const std::vector<ContactEvent>& updateContacts();
+
+    const std::vector<ContactEvent>& getContactEvents() const {
+        return mContactTracker.getEvents();
+    }
+
+    void setContactReporting(bool reportStay, bool reportAllPoints);
+
+    int queryScene(int type, const SceneQuery* queries, int numQueries,
+                   SceneQueryHit* hits, int maxHits);
+
+    int snapshot(void* buffer, int size);
+
+    bool restore(const void* buffer, int size);
+
+    void setSnapshotHistory(int count) {
+        mSnapshots.setCapacity(count);
+    }
+
+    bool saveSnapshot(long long frame) {
+        return mSnapshots.save(*this, frame);
+    }
+
+    bool restoreSnapshot(long long frame) {
+        return mSnapshots.restore(*this, frame);
+    }
 
     void setGravity(float x, float y, float z);
 
@@ -64,17 +116,64 @@ class BulletWorld : public PhysicsWorld {
     PhysicsVec3 getGravity() const;
 
  private:
+    /*
+     * Poses of a dynamic body before and after the last fixed step.
+     */
+    struct BodyPose {
+        BulletRigidBody*    Body;
+        btVector3           PrevPos;
+        btQuaternion        PrevRot;
+        btVector3           CurPos;
+        btQuaternion        CurRot;
+        bool                Moving;
+    };
+
     void initialize();
 
     void finalize();
 
+    double elapsedSeconds() const;
+
+    void capturePrevPoses(std::vector<BodyPose>& poses);
+
+    void captureCurPoses(std::vector<BodyPose>& poses);
+
+    void setBodiesInterpolated(bool interpolated);
+
+    void rebuildBroadphase();
+
+    bool findSavedManifolds(const char* data, int size, int numManifolds, int numBodies);
+    void restoreContacts(const char* data);
+    void numberObjects();
+    int objectNumber(const btCollisionObject* obj) const;
+
  private:
-    std::map<std::pair <long,long>, ContactPoint> prevCollisions;
+    BulletContactTracker mContactTracker;
+    BulletSceneQuery mSceneQuery;
+    BulletPoseBatch mPoseBatch;
     btDynamicsWorld *mPhysicsWorld;
     btCollisionConfiguration *mCollisionConfiguration;
     btCollisionDispatcher *mDispatcher;
     btSequentialImpulseConstraintSolver *mSolver;
     btBroadphaseInterface *mOverlappingPairCache;
+
+    // Fixed rate stepping. The physics thread fills the back buffer
+    // and swaps it with the front one, the render thread reads the front.
+    // The time step, clock and simulation time are guarded by mPoseLock.
+    std::atomic<bool> mInterpolated;
+    float mFixedTimeStep;
+    double mSimTime;
+    std::chrono::steady_clock::time_point mClockStart;
+    std::mutex mPoseLock;
+    std::vector<BodyPose> mPoses[2];
+    int mFrontPoses;
+    bool mFrontApplied;
+    std::vector<std::pair<BulletRigidBody*, btTransform>> mMovedBodies;
+
+    PhysicsSnapshotRing mSnapshots;
+    std::vector<std::pair<short, short>> mProxyFilters;
+    std::vector<int> mSavedManifolds;
+    std::vector<std::pair<const btCollisionObject*, int>> mObjectIndices;  // sorted by object
     //void (*gTmpFilter)(); // btNearCallback
     //int gNearCallbackCount = 0;
     //void *gUserData = 0;
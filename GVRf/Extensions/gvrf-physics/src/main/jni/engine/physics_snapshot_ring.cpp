@@ -0,0 +1,84 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "physics_snapshot_ring.h"
+#include "physics_world.h"
+
+namespace gvr {
+
+void PhysicsSnapshotRing::setCapacity(int count)
+{
+    mSlots.resize((count > 0) ? count : 0);
+    clear();
+}
+
+void PhysicsSnapshotRing::clear()
+{
+    for (auto it = mSlots.begin(); it != mSlots.end(); ++it)
+    {
+        it->Size = 0;
+    }
+    mNext = 0;
+}
+
+PhysicsSnapshotRing::Slot* PhysicsSnapshotRing::find(long long frame)
+{
+    for (auto it = mSlots.begin(); it != mSlots.end(); ++it)
+    {
+        if ((it->Size > 0) && (it->Frame == frame))
+        {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+bool PhysicsSnapshotRing::save(PhysicsWorld& world, long long frame)
+{
+    if (mSlots.empty())
+    {
+        return false;
+    }
+    Slot* slot = find(frame);
+
+    if (slot == nullptr)
+    {
+        slot = &mSlots[mNext];
+        mNext = (mNext + 1) % mSlots.size();
+    }
+    int size = world.snapshot(slot->Data.data(), slot->Data.size());
+
+    if (size > (int) slot->Data.size())
+    {
+        slot->Data.resize(size);
+        size = world.snapshot(slot->Data.data(), slot->Data.size());
+    }
+    slot->Frame = frame;
+    slot->Size = size;
+    return size > 0;
+}
+
+bool PhysicsSnapshotRing::restore(PhysicsWorld& world, long long frame)
+{
+    Slot* slot = find(frame);
+
+    if (slot == nullptr)
+    {
+        return false;
+    }
+    return world.restore(slot->Data.data(), slot->Size);
+}
+
+}
@@ -0,0 +1,67 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * History of physics world snapshots
+ ***************************************************************************/
+
+#ifndef PHYSICS_SNAPSHOT_RING_H_
+#define PHYSICS_SNAPSHOT_RING_H_
+
+#include <vector>
+
+namespace gvr {
+
+class PhysicsWorld;
+
+/*
+ * Keeps the last N snapshots of a world, each tagged with the
+ * frame it was taken for. The buffers are reused once the ring
+ * has wrapped around so saving does not allocate unless the
+ * world has grown.
+ */
+class PhysicsSnapshotRing {
+public:
+    PhysicsSnapshotRing() : mNext(0) { }
+
+    /*
+     * Change the number of snapshots kept, discarding all of them.
+     */
+    void setCapacity(int count);
+
+    int getCapacity() const { return mSlots.size(); }
+
+    bool save(PhysicsWorld& world, long long frame);
+
+    bool restore(PhysicsWorld& world, long long frame);
+
+    void clear();
+
+private:
+    struct Slot {
+        long long           Frame;
+        int                 Size;       // 0 if the slot is empty
+        std::vector<char>   Data;
+    };
+
+    Slot* find(long long frame);
+
+    std::vector<Slot>   mSlots;
+    int                 mNext;
+};
+
+}
+
+#endif /* PHYSICS_SNAPSHOT_RING_H_ */
@@ -24,20 +24,64 @@
 #include "physics_rigidbody.h"
 #include "physics_constraint.h"
 #include "../objects/scene_object.h"
-#include <list>
+#include <vector>
 
 namespace gvr {
 
-struct ContactPoint {
-	PhysicsRigidBody* body0 = 0;
-	PhysicsRigidBody* body1 = 0;
-	float normal[3] = {0.0f, 0.0f, 0.0f};
-	float distance = 0.0f;
-	bool isHit = true;
+/*
+ * A change in the contact between two bodies.
+ * This is the layout Java reads from a direct ByteBuffer,
+ * it must stay 48 bytes with no padding.
+ */
+struct ContactEvent {
+	enum Type {
+		ENTER = 0,
+		STAY = 1,
+		EXIT = 2
+	};
+
+	long long body0;
+	long long body1;
+	float normal[3];
+	float distance;
+	float position[3];
+	int type;
+};
+
+/*
+ * A ray, sweep or overlap query. This is the layout Java
+ * writes into a direct ByteBuffer, it must stay 56 bytes.
+ */
+struct SceneQuery {
+	float from[3];          // start of the ray or sweep, center of an overlap
+	float to[3];            // end of the ray or sweep
+	float size[3];          // sphere radius in size[0] or box half extents
+	float rotation[4];      // box orientation as x, y, z, w
+	int collidesWith;       // collision groups of the bodies to test
+};
+
+/*
+ * Result of a scene query. This is the layout Java reads
+ * from a direct ByteBuffer, it must stay 40 bytes.
+ */
+struct SceneQueryHit {
+	long long body;         // 0 if nothing was hit
+	float point[3];
+	float normal[3];        // on the body, pointing towards the query
+	float fraction;         // along the ray or sweep, 0 for overlaps
+	int query;              // index of the query in the batch
 };
 
 class PhysicsWorld : public Component {
  public:
+	enum SceneQueryType {
+		QUERY_RAY = 0,
+		QUERY_SPHERE_SWEEP = 1,
+		QUERY_BOX_SWEEP = 2,
+		QUERY_SPHERE_OVERLAP = 3,
+		QUERY_BOX_OVERLAP = 4
+	};
+
 	PhysicsWorld() : Component(PhysicsWorld::getComponentType()){}
 
 	static long long getComponentType() {
@@ -56,7 +100,94 @@ class PhysicsWorld : public Component {
 
 	virtual void step(float timeStep, int maxSubSteps) = 0;
 
-	virtual void listCollisions(std::list<ContactPoint>& contactPoints) = 0;
+	/*
+	 * Select whether the world is stepped at a fixed rate with
+	 * interpolated poses. When enabled, stepping does not write
+	 * the transforms of the bodies. Instead the poses after the
+	 * last two steps are published and applyPoses interpolates
+	 * between them on the render thread.
+	 */
+	virtual void setInterpolation(bool enable, float fixedTimeStep) = 0;
+
+	virtual bool isInterpolated() const = 0;
+
+	/*
+	 * Take as many fixed steps as have elapsed in real time
+	 * (at most maxSteps) and publish the resulting poses.
+	 * @returns number of steps taken
+	 */
+	virtual int stepFixed(int maxSteps) = 0;
+
+	/*
+	 * Write the interpolated poses into the transforms of
+	 * the bodies. Call once per frame from the render thread.
+	 */
+	virtual void applyPoses() = 0;
+
+	/*
+	 * Compare the contacts after the last step with the ones
+	 * before it and return the events for the differences.
+	 * The returned events are valid until the next call.
+	 */
+	virtual const std::vector<ContactEvent>& updateContacts() = 0;
+
+	/*
+	 * Return the events found by the last updateContacts.
+	 */
+	virtual const std::vector<ContactEvent>& getContactEvents() const = 0;
+
+	/*
+	 * Select whether STAY events are reported for bodies which
+	 * remain in contact and whether ENTER and STAY events are
+	 * reported for every contact point between two bodies
+	 * instead of only the first one.
+	 */
+	virtual void setContactReporting(bool reportStay, bool reportAllPoints) = 0;
+
+	/*
+	 * Run a batch of queries of the same type against the bodies.
+	 * Rays and sweeps give the closest hit for each query, with body 0
+	 * when nothing was hit, and stop after maxHits queries. Overlaps give
+	 * a hit for every body touching the query shape, up to maxHits.
+	 * @returns number of hits, may be more than maxHits for overlaps
+	 */
+	virtual int queryScene(int type, const SceneQuery* queries, int numQueries,
+						   SceneQueryHit* hits, int maxHits) = 0;
+
+	/*
+	 * Write the state of the simulation into a buffer: the poses,
+	 * velocities and activation of the bodies, the constraint impulses
+	 * and the cached contact points which warm start the solver.
+	 * Take snapshots between steps.
+	 * @returns number of bytes needed, nothing is written if size is smaller
+	 */
+	virtual int snapshot(void* buffer, int size) = 0;
+
+	/*
+	 * Restore a state saved by snapshot. The world must hold the same
+	 * bodies and constraints in the same order as when it was saved.
+	 * Stepping from a restored snapshot with the same inputs always
+	 * gives the same results.
+	 * @returns false if the snapshot does not match the world
+	 */
+	virtual bool restore(const void* buffer, int size) = 0;
+
+	/*
+	 * Keep the last count snapshots saved by saveSnapshot.
+	 */
+	virtual void setSnapshotHistory(int count) = 0;
+
+	/*
+	 * Save a snapshot in the history, replacing the oldest one
+	 * or the one already saved for the same frame.
+	 */
+	virtual bool saveSnapshot(long long frame) = 0;
+
+	/*
+	 * Restore the snapshot saved for a frame.
+	 * @returns false if it is no longer in the history
+	 */
+	virtual bool restoreSnapshot(long long frame) = 0;
 
     virtual void setGravity(float gx, float gy, float gz) = 0;
 
@@ -18,12 +18,17 @@
  ***************************************************************************/
 
 #include "bullet/bullet_world.h"
+#include "bullet/bullet_shape_cache.h"
 #include "physics_world.h"
 #include "physics_rigidbody.h"
 #include "physics_constraint.h"
 
+#include "objects/mesh.h"
 #include "util/gvr_jni.h"
 
+#include <algorithm>
+#include <string.h>
+
 namespace gvr {
 extern "C" {
 
@@ -57,9 +62,61 @@ extern "C" {
     Java_org_gearvrf_physics_NativePhysics3DWorld_step(JNIEnv * env, jobject obj,
             jlong jworld, jfloat jtime_step, int maxSubSteps);
 
-    JNIEXPORT jobjectArray JNICALL
-    Java_org_gearvrf_physics_NativePhysics3DWorld_listCollisions(JNIEnv * env, jobject obj,
-                                                                    jlong jworld);
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_setInterpolation(JNIEnv * env, jobject obj,
+            jlong jworld, jboolean enable, jfloat fixedTimeStep);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_stepFixed(JNIEnv * env, jobject obj,
+            jlong jworld, jint maxSteps);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_applyPoses(JNIEnv * env, jobject obj,
+            jlong jworld);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_listContactEvents(JNIEnv * env, jobject obj,
+            jlong jworld, jobject jbuffer, jboolean update);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_setContactReporting(JNIEnv * env, jobject obj,
+            jlong jworld, jboolean reportStay, jboolean reportAllPoints);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_queryScene(JNIEnv * env, jobject obj,
+            jlong jworld, jint type, jobject jqueries, jint numQueries, jobject jhits);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_snapshot(JNIEnv * env, jobject obj,
+            jlong jworld, jobject jbuffer);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_restore(JNIEnv * env, jobject obj,
+            jlong jworld, jobject jbuffer, jint size);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_setSnapshotHistory(JNIEnv * env, jobject obj,
+            jlong jworld, jint count);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_saveSnapshot(JNIEnv * env, jobject obj,
+            jlong jworld, jlong frame);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_restoreSnapshot(JNIEnv * env, jobject obj,
+            jlong jworld, jlong frame);
+
+    JNIEXPORT jbyteArray JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_saveCollisionMesh(JNIEnv * env, jobject obj,
+            jlong jmesh);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_loadCollisionMesh(JNIEnv * env, jobject obj,
+            jlong jmesh, jbyteArray jdata);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_physics_NativePhysics3DWorld_unloadCollisionMesh(JNIEnv * env, jobject obj,
+            jlong jmesh);
 
     JNIEXPORT void JNICALL
     Java_org_gearvrf_physics_NativePhysics3DWorld_setGravity(JNIEnv* env, jobject obj,
@@ -133,39 +190,169 @@ Java_org_gearvrf_physics_NativePhysics3DWorld_step(JNIEnv * env, jobject obj,
     world->step((float)jtime_step, maxSubSteps);
 }
 
-JNIEXPORT jobjectArray JNICALL
-Java_org_gearvrf_physics_NativePhysics3DWorld_listCollisions(JNIEnv * env, jobject obj, jlong jworld) {
+JNIEXPORT void JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_setInterpolation(JNIEnv * env, jobject obj,
+        jlong jworld, jboolean enable, jfloat fixedTimeStep) {
+    PhysicsWorld *world = reinterpret_cast<PhysicsWorld*>(jworld);
+
+    world->setInterpolation(enable, fixedTimeStep);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_stepFixed(JNIEnv * env, jobject obj,
+        jlong jworld, jint maxSteps) {
+    PhysicsWorld *world = reinterpret_cast<PhysicsWorld*>(jworld);
+
+    return world->stepFixed(maxSteps);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_applyPoses(JNIEnv * env, jobject obj,
+        jlong jworld) {
+    PhysicsWorld *world = reinterpret_cast<PhysicsWorld*>(jworld);
 
-    jclass collisionInfoClass = env->FindClass("org/gearvrf/physics/GVRCollisionInfo");
-    jmethodID collisionInfoConstructor = env->GetMethodID(collisionInfoClass, "<init>", "(JJ[FFZ)V");
+    world->applyPoses();
+}
 
+static_assert(sizeof(ContactEvent) == 48, "ContactEvent must match the layout GVRWorld reads");
+
+/*
+ * Copies the contact events into a direct ByteBuffer as an array
+ * of ContactEvent structures. If they do not all fit, only the
+ * ones which fit are copied. The same events can be read again
+ * into a larger buffer by calling with update false.
+ * Returns the total number of events.
+ */
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_listContactEvents(JNIEnv * env, jobject obj,
+        jlong jworld, jobject jbuffer, jboolean update) {
     PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
-    std::list <ContactPoint> contactPoints;
+    const std::vector<ContactEvent>& events = update ? world->updateContacts()
+                                                     : world->getContactEvents();
+    char* dst = static_cast<char*>(env->GetDirectBufferAddress(jbuffer));
+    long capacity = env->GetDirectBufferCapacity(jbuffer) / sizeof(ContactEvent);
+    int n = std::min<long>(events.size(), capacity);
+
+    if (dst && (n > 0)) {
+        memcpy(dst, events.data(), n * sizeof(ContactEvent));
+    }
+    return events.size();
+}
 
-    world->listCollisions(contactPoints);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_setContactReporting(JNIEnv * env, jobject obj,
+        jlong jworld, jboolean reportStay, jboolean reportAllPoints) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
 
-    int size = contactPoints.size();
-    jobjectArray jNewList = env->NewObjectArray(size, collisionInfoClass, NULL);
+    world->setContactReporting(reportStay, reportAllPoints);
+}
+
+static_assert(sizeof(SceneQuery) == 56, "SceneQuery must match the layout GVRWorld writes");
+static_assert(sizeof(SceneQueryHit) == 40, "SceneQueryHit must match the layout GVRWorld reads");
+
+/*
+ * Runs the queries in a direct ByteBuffer and writes as many hits
+ * as fit into another one. Returns the total number of hits.
+ */
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_queryScene(JNIEnv * env, jobject obj,
+        jlong jworld, jint type, jobject jqueries, jint numQueries, jobject jhits) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
+    const SceneQuery* queries = static_cast<const SceneQuery*>(env->GetDirectBufferAddress(jqueries));
+    SceneQueryHit* hits = static_cast<SceneQueryHit*>(env->GetDirectBufferAddress(jhits));
+
+    if ((queries == NULL) || (hits == NULL)) {
+        return 0;
+    }
+    numQueries = std::min<long>(numQueries, env->GetDirectBufferCapacity(jqueries) / sizeof(SceneQuery));
+    return world->queryScene(type, queries, numQueries, hits,
+                             env->GetDirectBufferCapacity(jhits) / sizeof(SceneQueryHit));
+}
+
+/*
+ * Writes a snapshot of the world into a direct ByteBuffer if it fits.
+ * Returns the size of the snapshot.
+ */
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_snapshot(JNIEnv * env, jobject obj,
+        jlong jworld, jobject jbuffer) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
+    void* dst = jbuffer ? env->GetDirectBufferAddress(jbuffer) : NULL;
+    int capacity = dst ? env->GetDirectBufferCapacity(jbuffer) : 0;
+
+    return world->snapshot(dst, capacity);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_restore(JNIEnv * env, jobject obj,
+        jlong jworld, jobject jbuffer, jint size) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
+    const void* src = env->GetDirectBufferAddress(jbuffer);
+
+    if ((src == NULL) || (size > env->GetDirectBufferCapacity(jbuffer))) {
+        return false;
+    }
+    return world->restore(src, size);
+}
 
-    int i = 0;
-    for (auto it = contactPoints.begin(); it != contactPoints.end(); ++it) {
-        const ContactPoint& data = *it;
+JNIEXPORT void JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_setSnapshotHistory(JNIEnv * env, jobject obj,
+        jlong jworld, jint count) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
+
+    world->setSnapshotHistory(count);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_saveSnapshot(JNIEnv * env, jobject obj,
+        jlong jworld, jlong frame) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
+
+    return world->saveSnapshot(frame);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_restoreSnapshot(JNIEnv * env, jobject obj,
+        jlong jworld, jlong frame) {
+    PhysicsWorld *world = reinterpret_cast <PhysicsWorld*> (jworld);
 
-        jfloatArray normal = env->NewFloatArray(3);
-        env->SetFloatArrayRegion(normal, 0, 3, data.normal);
+    return world->restoreSnapshot(frame);
+}
 
-        jobject contactObject = env->NewObject(collisionInfoClass, collisionInfoConstructor,
-                                               (jlong)data.body0, (jlong)data.body1,
-                                               (jfloatArray)normal, (jfloat)data.distance,
-                                               (jboolean)data.isHit);
+JNIEXPORT jbyteArray JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_saveCollisionMesh(JNIEnv * env, jobject obj,
+        jlong jmesh) {
+    Mesh *mesh = reinterpret_cast<Mesh*>(jmesh);
+    std::vector<char> data;
 
-        env->SetObjectArrayElement(jNewList, i++, contactObject);
-        env->DeleteLocalRef(contactObject);
-        env->DeleteLocalRef(normal);
+    if (!BulletShapeCache::getInstance().saveTriangleMesh(mesh, data)) {
+        return NULL;
+    }
+    jbyteArray jdata = env->NewByteArray(data.size());
+    if (jdata) {
+        env->SetByteArrayRegion(jdata, 0, data.size(), reinterpret_cast<const jbyte*>(data.data()));
     }
+    return jdata;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_loadCollisionMesh(JNIEnv * env, jobject obj,
+        jlong jmesh, jbyteArray jdata) {
+    Mesh *mesh = reinterpret_cast<Mesh*>(jmesh);
+    jsize size = env->GetArrayLength(jdata);
+    jbyte* data = env->GetByteArrayElements(jdata, NULL);
+    bool loaded = BulletShapeCache::getInstance().loadTriangleMesh(mesh, data, size);
+
+    env->ReleaseByteArrayElements(jdata, data, JNI_ABORT);
+    return loaded;
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_physics_NativePhysics3DWorld_unloadCollisionMesh(JNIEnv * env, jobject obj,
+        jlong jmesh) {
+    Mesh *mesh = reinterpret_cast<Mesh*>(jmesh);
 
-    env->DeleteLocalRef(collisionInfoClass);
-    return jNewList;
+    BulletShapeCache::getInstance().unloadTriangleMesh(mesh);
 }
 
 JNIEXPORT void JNICALL
@@ -0,0 +1,179 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Native copy of the key frames of a skeletal animation,
+ * sampled by {@link GVRSkeleton#animate}.
+ * <p>
+ * Each channel holds the keys for one joint. Keys are packed
+ * in float arrays with the time first:
+ * {@code (time, x, y, z)} for positions and scales and
+ * {@code (time, x, y, z, w)} for rotations.
+ * <p>
+ * Once all its channels are added a clip can be compressed.
+ * The compressed clip can be saved to a buffer and loaded
+ * back without decoding it, the keys are read straight
+ * from the buffer while sampling.
+ */
+public final class GVRAnimationClip extends GVRHybridObject {
+    public static final int POSITION_KEY_SIZE = 4;
+    public static final int ROTATION_KEY_SIZE = 5;
+    public static final int SCALE_KEY_SIZE = 4;
+
+    /** Default largest position and scale error when compressing, in scene units */
+    public static final float DEFAULT_POSITION_TOLERANCE = 0.001f;
+    /** Default largest rotation error when compressing, in radians */
+    public static final float DEFAULT_ROTATION_TOLERANCE = 0.001f;
+    public static final float DEFAULT_SCALE_TOLERANCE = 0.001f;
+
+    private ByteBuffer mCompressedData = null;
+
+    public GVRAnimationClip(GVRContext gvrContext) {
+        super(gvrContext, NativeAnimationClip.ctor());
+    }
+
+    /**
+     * Add the keys for a joint.
+     *
+     * @param name         name of the joint animated by the channel
+     * @param positionKeys packed position keys
+     * @param rotationKeys packed rotation keys
+     * @param scaleKeys    packed scale keys
+     * @return index of the channel
+     */
+    public int addChannel(String name, float[] positionKeys, float[] rotationKeys,
+                          float[] scaleKeys) {
+        return NativeAnimationClip.addChannel(getNative(), name, positionKeys,
+                rotationKeys, scaleKeys);
+    }
+
+    /**
+     * Match the channels with the joints of a skeleton by name.
+     * Must be called after all the joints and channels were added.
+     *
+     * @return the number of channels which found their joint
+     */
+    public int bind(GVRSkeleton skeleton) {
+        return NativeAnimationClip.bind(getNative(), skeleton.getNative());
+    }
+
+    /**
+     * Use different tolerances for one channel when compressing,
+     * for joints which need to be more precise like the root.
+     * Negative values use the tolerances given to {@link #compress}.
+     */
+    public void setTolerances(int channel, float positionTolerance,
+                              float rotationTolerance, float scaleTolerance) {
+        NativeAnimationClip.setTolerances(getNative(), channel, positionTolerance,
+                rotationTolerance, scaleTolerance);
+    }
+
+    /**
+     * Replace the keys with compressed ones. Keys which can be
+     * interpolated from their neighbors within the tolerance
+     * are dropped and the others are quantized. No channels
+     * can be added afterwards.
+     *
+     * @param positionTolerance largest position error in scene units
+     * @param rotationTolerance largest rotation error in radians
+     * @param scaleTolerance    largest scale error
+     * @return false if the clip was already compressed
+     */
+    public boolean compress(float positionTolerance, float rotationTolerance,
+                            float scaleTolerance) {
+        return NativeAnimationClip.compress(getNative(), positionTolerance,
+                rotationTolerance, scaleTolerance);
+    }
+
+    public boolean compress() {
+        return compress(DEFAULT_POSITION_TOLERANCE, DEFAULT_ROTATION_TOLERANCE,
+                DEFAULT_SCALE_TOLERANCE);
+    }
+
+    /**
+     * Sizes and errors of the last compression.
+     *
+     * @return {@code (raw size, compressed size, max position error,
+     *         max rotation error, max scale error)}, sizes in bytes
+     */
+    public float[] getCompressionStats() {
+        float[] stats = new float[5];
+        NativeAnimationClip.getCompressionStats(getNative(), stats);
+        return stats;
+    }
+
+    /**
+     * Copy the compressed clip to a new direct buffer,
+     * null if the clip is not compressed.
+     */
+    public ByteBuffer saveCompressed() {
+        int size = NativeAnimationClip.getCompressedSize(getNative());
+
+        if (size == 0) {
+            return null;
+        }
+        ByteBuffer buffer = ByteBuffer.allocateDirect(size);
+        if (!NativeAnimationClip.saveCompressed(getNative(), buffer)) {
+            return null;
+        }
+        return buffer;
+    }
+
+    /**
+     * Replace the channels with a clip from {@link #saveCompressed}.
+     * The buffer must be direct, a mapped file for instance.
+     * It is used in place and must not change afterwards.
+     * The clip must be bound again.
+     *
+     * @return false if the buffer is not a compressed clip
+     */
+    public boolean loadCompressed(ByteBuffer buffer) {
+        if (!buffer.isDirect()) {
+            throw new IllegalArgumentException("Compressed clips must be in a direct buffer");
+        }
+        if (!NativeAnimationClip.loadCompressed(getNative(), buffer, false)) {
+            return false;
+        }
+        mCompressedData = buffer;
+        return true;
+    }
+}
+
+class NativeAnimationClip {
+    static native long ctor();
+
+    static native int addChannel(long clip, String name, float[] positionKeys,
+            float[] rotationKeys, float[] scaleKeys);
+
+    static native int bind(long clip, long skeleton);
+
+    static native void setTolerances(long clip, int channel, float positionTolerance,
+            float rotationTolerance, float scaleTolerance);
+
+    static native boolean compress(long clip, float positionTolerance,
+            float rotationTolerance, float scaleTolerance);
+
+    static native void getCompressionStats(long clip, float[] stats);
+
+    static native int getCompressedSize(long clip);
+
+    static native boolean saveCompressed(long clip, ByteBuffer buffer);
+
+    static native boolean loadCompressed(long clip, ByteBuffer buffer, boolean copy);
+}
@@ -0,0 +1,167 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * Blends and layers {@link GVRAnimationClip}s into one pose
+ * for a {@link GVRSkeleton}, natively.
+ * <p>
+ * Nodes are added children first and the last node added is
+ * the root of the tree. Clip nodes sample a clip, blend nodes
+ * mix their children by one or two parameters, additive nodes
+ * add the difference between two poses to a base pose and
+ * override nodes replace a base pose on the joints of a mask.
+ * Parameters are changed by the application, every frame if
+ * needed, for instance to blend idle, walk and run by speed.
+ * <p>
+ * The whole tree is evaluated natively in reusable pose buffers
+ * and the result is written once to the skeleton.
+ */
+public final class GVRBlendTree extends GVRHybridObject {
+    private final List<GVRAnimationClip> mClips = new ArrayList<GVRAnimationClip>();
+
+    public GVRBlendTree(GVRContext gvrContext) {
+        super(gvrContext, NativeBlendTree.ctor());
+    }
+
+    /**
+     * Add a parameter used to weight blend, additive and override nodes.
+     *
+     * @return index of the parameter
+     */
+    public int addParameter(float value) {
+        return NativeBlendTree.addParameter(getNative(), value);
+    }
+
+    public void setParameter(int parameter, float value) {
+        NativeBlendTree.setParameter(getNative(), parameter, value);
+    }
+
+    /**
+     * Add a node which samples a clip.
+     *
+     * @param clip     clip to sample
+     * @param speed    clip ticks per second of tree time
+     * @param duration length of the clip in ticks, it loops if positive
+     * @return index of the node
+     */
+    public int addClip(GVRAnimationClip clip, float speed, float duration) {
+        mClips.add(clip);
+        return NativeBlendTree.addClip(getNative(), clip.getNative(), speed, duration);
+    }
+
+    /**
+     * Add a node which blends the two children whose thresholds
+     * surround the value of a parameter.
+     *
+     * @param parameter  parameter choosing the children
+     * @param children   nodes to blend
+     * @param thresholds value of the parameter for each child, increasing
+     * @param sync       true to play looping clips below this node at the
+     *                   same phase, so walk and run cycles stay in step
+     * @return index of the node or -1 if a child or the parameter is invalid
+     */
+    public int addBlend1D(int parameter, int[] children, float[] thresholds, boolean sync) {
+        return NativeBlendTree.addBlend1D(getNative(), parameter, children, thresholds, sync);
+    }
+
+    /**
+     * Add a node which blends its children by the distance
+     * of their position to the values of two parameters.
+     *
+     * @param positions x, y values of the parameters for each child
+     * @return index of the node or -1 if a child or a parameter is invalid
+     */
+    public int addBlend2D(int parameterX, int parameterY, int[] children, float[] positions,
+                          boolean sync) {
+        return NativeBlendTree.addBlend2D(getNative(), parameterX, parameterY, children,
+                positions, sync);
+    }
+
+    /**
+     * Add a node which adds the difference between the pose of
+     * {@code additive} and the pose of {@code reference} to
+     * the pose of {@code base}.
+     *
+     * @param reference node of the reference pose, -1 to use the rest pose
+     *                  of the skeleton
+     * @param weight    parameter scaling the difference
+     * @return index of the node or -1 if a child or the parameter is invalid
+     */
+    public int addAdditive(int base, int additive, int reference, int weight) {
+        return NativeBlendTree.addAdditive(getNative(), base, additive, reference, weight);
+    }
+
+    /**
+     * Add a node which replaces the pose of {@code base} with the
+     * pose of {@code override} on some joints, an upper body aim
+     * layer for instance.
+     *
+     * @param mask   weight of the override for each joint of the skeleton
+     * @param weight parameter scaling the mask
+     * @return index of the node or -1 if a child or the parameter is invalid
+     */
+    public int addOverride(int base, int override, float[] mask, int weight) {
+        return NativeBlendTree.addOverride(getNative(), base, override, mask, weight);
+    }
+
+    /**
+     * Bind the clips to a skeleton. Must be called after
+     * all the nodes were added and before animating.
+     */
+    public void bind(GVRSkeleton skeleton) {
+        NativeBlendTree.bind(getNative(), skeleton.getNative());
+    }
+
+    /**
+     * Evaluate the tree and pose the skeleton with the result.
+     *
+     * @param skeleton skeleton the tree is bound to
+     * @param time     time in seconds
+     */
+    public void animate(GVRSkeleton skeleton, float time) {
+        NativeBlendTree.animate(getNative(), skeleton.getNative(), time);
+    }
+}
+
+class NativeBlendTree {
+    static native long ctor();
+
+    static native int addParameter(long tree, float value);
+
+    static native void setParameter(long tree, int parameter, float value);
+
+    static native int addClip(long tree, long clip, float speed, float duration);
+
+    static native int addBlend1D(long tree, int parameter, int[] children,
+            float[] thresholds, boolean sync);
+
+    static native int addBlend2D(long tree, int parameterX, int parameterY, int[] children,
+            float[] positions, boolean sync);
+
+    static native int addAdditive(long tree, int base, int additive, int reference,
+            int weight);
+
+    static native int addOverride(long tree, int base, int override, float[] mask,
+            int weight);
+
+    static native void bind(long tree, long skeleton);
+
+    static native void animate(long tree, long skeleton, float time);
+}
@@ -66,6 +66,7 @@ public class GVRFrustumPicker extends GVRPicker {
     protected FrustumIntersection mCuller;
     protected float[] mProjMatrix = null;
     protected Matrix4f mProjection = null;
+    private GVRCollider[] mFound = new GVRCollider[16];
 
     /**
      * Construct a picker which picks from a given scene.
@@ -178,47 +179,40 @@ public class GVRFrustumPicker extends GVRPicker {
     public void doPick()
     {
         GVRSceneObject owner = getOwnerObject();
-        GVRPickedObject[] picked = pickVisible(mScene);
 
-        if (mProjection != null)
+        if (mProjection == null)
         {
-            Matrix4f view_matrix;
-            if (owner != null)
-            {
-                view_matrix = owner.getTransform().getModelMatrix4f();
-            }
-            else
-            {
-                view_matrix = mScene.getMainCameraRig().getHeadTransform().getModelMatrix4f();
-            }
-            view_matrix.invert();
-
-            for (int i = 0; i < picked.length; ++i)
+            generatePickEvents(pickVisible(mScene));
+            return;
+        }
+        GVRTransform viewTrans = (owner != null) ? owner.getTransform() :
+                                 mScene.getMainCameraRig().getHeadTransform();
+        Matrix4f view_matrix = viewTrans.getModelMatrix4f();
+        float ox = view_matrix.m30();
+        float oy = view_matrix.m31();
+        float oz = view_matrix.m32();
+        Matrix4f viewProj = new Matrix4f(mProjection);
+
+        view_matrix.invert();
+        viewProj.mul(view_matrix);
+        int n = pickObjectsInFrustum(mScene, viewProj, QUERY_RENDER_BOUNDS, mFound);
+        if (n > mFound.length)
+        {
+            mFound = new GVRCollider[n];
+            n = pickObjectsInFrustum(mScene, viewProj, QUERY_RENDER_BOUNDS, mFound);
+            n = Math.min(n, mFound.length);
+        }
+        GVRPickedObject[] picked = new GVRPickedObject[n];
+        int count = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (mFound[i] != null)
             {
-                GVRPickedObject hit = picked[i];
-
-                if (hit != null)
-                {
-                    GVRSceneObject sceneObj = hit.hitObject;
-                    GVRSceneObject.BoundingVolume bv = sceneObj.getBoundingVolume();
-                    Vector4f center = new Vector4f(bv.center.x, bv.center.y, bv.center.z, 1);
-                    Vector4f p = new Vector4f(bv.center.x, bv.center.y, bv.center.z + bv.radius, 1);
-                    float radius;
-
-                    center.mul(view_matrix);
-                    p.mul(view_matrix);
-                    p.sub(center, p);
-                    p.w = 0;
-                    radius = p.length();
-                    boolean pointIn = mCuller.testPoint(center.x, center.y, center.z);
-                    if (!mCuller.testSphere(center.x, center.y, center.z, radius))
-                    {
-                        picked[i] = null;
-                    }
-                }
+                picked[count++] = makeObjectHit(mFound[i], ox, oy, oz);
             }
+            mFound[i] = null;
         }
-        generatePickEvents(picked);
+        generatePickEvents((count == n) ? picked : Arrays.copyOf(picked, count));
     }
 
     /**
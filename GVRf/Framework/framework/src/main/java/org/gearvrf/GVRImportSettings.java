@@ -103,7 +103,20 @@ public enum GVRImportSettings {
     /**
      * Do not include textures and omit texture coordinates from meshes
      */
-    NO_TEXTURING(0x8000000);
+    NO_TEXTURING(0x8000000),
+
+    /**
+     * Reorder the triangles and vertices of imported meshes for the
+     * GPU vertex cache, reduced overdraw and vertex fetch locality.
+     * @see GVRMeshOptimizer
+     */
+    OPTIMIZE_MESH_ORDER(0x10000000),
+
+    /**
+     * Compress the key frames of imported animations with the
+     * default tolerances of {@link GVRAnimationClip}.
+     */
+    COMPRESS_ANIMATIONS(0x20000000);
 
     
     private int mValue;
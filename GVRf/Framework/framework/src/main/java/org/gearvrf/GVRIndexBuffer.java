@@ -244,7 +244,7 @@ public class GVRIndexBuffer extends GVRHybridObject implements PrettyPrint
     @Override
     public void prettyPrint(StringBuffer sb, int indent) {
         Integer n = getIndexCount();
-        sb.append(n.toString() + " indices");
+        sb.append(n.toString() + " indices " + (n * getIndexSize()) + " bytes");
         sb.append(System.lineSeparator());
     }
 }
@@ -19,12 +19,12 @@ import java.util.Map;
 import java.util.Set;
 import static java.lang.Math.max;
 
-import org.gearvrf.animation.GVRAnimation;
 import org.gearvrf.animation.GVRAnimator;
 import org.gearvrf.animation.keyframe.GVRAnimationBehavior;
 import org.gearvrf.animation.keyframe.GVRAnimationChannel;
 import org.gearvrf.animation.keyframe.GVRKeyFrameAnimation;
 import org.gearvrf.jassimp.AiAnimBehavior;
+import org.gearvrf.jassimp.AiAnimMesh;
 import org.gearvrf.jassimp.AiAnimation;
 import org.gearvrf.jassimp.AiBone;
 import org.gearvrf.jassimp.AiBoneWeight;
@@ -223,6 +223,41 @@ class GVRJassimpAdapter {
         {
             processBones(mesh, aiMesh.getBones());
         }
+        // Morph targets, half floats if animations are compressed
+        if (doAnimation && (verticesArray != null))
+        {
+            boolean halfFloats = settings.contains(GVRImportSettings.COMPRESS_ANIMATIONS);
+
+            for (AiAnimMesh animMesh : aiMesh.getAnimMeshes())
+            {
+                float[] positions = verticesArray;
+                float[] normals = null;
+                FloatBuffer fbuf = animMesh.getPositionBuffer();
+
+                if (fbuf != null)
+                {
+                    positions = new float[fbuf.capacity()];
+                    fbuf.get(positions, 0, fbuf.capacity());
+                }
+                fbuf = animMesh.getNormalBuffer();
+                if ((fbuf != null) && (normalsArray != null))
+                {
+                    normals = new float[fbuf.capacity()];
+                    fbuf.get(normals, 0, fbuf.capacity());
+                }
+                mesh.addMorphTarget(positions, normals, false, halfFloats);
+            }
+        }
+        if (settings.contains(GVRImportSettings.OPTIMIZE_MESH_ORDER))
+        {
+            float[] stats = new float[2 * GVRMeshOptimizer.STAT_COUNT];
+
+            if (GVRMeshOptimizer.optimize(mesh, GVRMeshOptimizer.DEFAULT_OVERDRAW_THRESHOLD, stats))
+            {
+                Log.d(TAG, "Optimized mesh %s ACMR %.3f -> %.3f ATVR %.3f -> %.3f overfetch %.3f -> %.3f",
+                      aiMesh.getName(), stats[0], stats[3], stats[1], stats[4], stats[2], stats[5]);
+            }
+        }
         return mesh;
     }
 
@@ -432,6 +467,8 @@ class GVRJassimpAdapter {
             case NO_ANIMATION:
             case NO_LIGHTING:
             case NO_TEXTURING:
+            case OPTIMIZE_MESH_ORDER:
+            case COMPRESS_ANIMATIONS:
                 return null;
             default:
                 // Unsupported setting
@@ -472,7 +509,7 @@ class GVRJassimpAdapter {
                 model.attachComponent(animator);
                 for (AiAnimation aiAnim : scene.getAnimations())
                 {
-                    GVRAnimation animation = createAnimation(aiAnim, model);
+                    GVRKeyFrameAnimation animation = createAnimation(aiAnim, model);
                     GVRModelSceneObject modelRoot = null;
                     if (GVRModelSceneObject.class.isAssignableFrom(model.getClass()))
                     {
@@ -480,6 +517,12 @@ class GVRJassimpAdapter {
                     }
                     if (animation != null)
                     {
+                        if (settings.contains(GVRImportSettings.COMPRESS_ANIMATIONS))
+                        {
+                            animation.compress(GVRAnimationClip.DEFAULT_POSITION_TOLERANCE,
+                                               GVRAnimationClip.DEFAULT_ROTATION_TOLERANCE,
+                                               GVRAnimationClip.DEFAULT_SCALE_TOLERANCE);
+                        }
                         animator.addAnimation(animation);
                         if (modelRoot != null)
                         {
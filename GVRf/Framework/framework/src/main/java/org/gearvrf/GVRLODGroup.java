@@ -15,13 +15,24 @@
 
 package org.gearvrf;
 
-import org.gearvrf.utility.Log;
-import org.joml.Vector4f;
-
-import java.util.LinkedList;
+import java.util.ArrayList;
+import java.util.List;
 
 
 /**
+ * Selects one of several levels of detail when the scene is culled.
+ * <p>
+ * Each level is either a child scene object or a mesh which replaces
+ * the mesh of the owner's {@link GVRRenderData}. The level is chosen
+ * natively, inside the renderer's culling pass, for the camera being
+ * rendered so it never lags behind the view and no work is done on
+ * the Java side each frame.
+ * <p>
+ * Levels can be selected by camera distance ({@link #addRange}) or by
+ * the fraction of the viewport height covered by the bounding sphere
+ * of the owner ({@link #addLevel}). A hysteresis band avoids popping
+ * when the camera hovers around a threshold and
+ * {@link GVRScene#setLODBias(float)} biases every group in the scene.
  * Example:
  * <pre>
  * root = new GVRSceneObject(..);
@@ -37,22 +48,34 @@ import java.util.LinkedList;
  * root.attachComponent(lodGroup);
  * </pre>
  */
-public final class GVRLODGroup extends GVRBehavior {
-    static private long TYPE_LODGROUP = newComponentType(GVRLODGroup.class);
+public final class GVRLODGroup extends GVRComponent {
+    /**
+     * Levels are selected by camera distance.
+     */
+    public static final int METRIC_DISTANCE = 0;
+
+    /**
+     * Levels are selected by projected size on the screen.
+     */
+    public static final int METRIC_SCREEN_SIZE = 1;
+
+    /**
+     * Maximum number of levels in a group.
+     */
+    public static final int MAX_LEVELS = 8;
+
+    private final List<GVRSceneObject> mLevelObjects = new ArrayList<GVRSceneObject>();
+    private final List<GVRMesh> mLevelMeshes = new ArrayList<GVRMesh>();
+    private int mMetric = METRIC_DISTANCE;
 
     public GVRLODGroup(GVRContext gvrContext) {
-        super(gvrContext, 0);
-        mType = getComponentType();
+        super(gvrContext, NativeLODGroup.ctor());
     }
 
     static public long getComponentType() {
-        return TYPE_LODGROUP;
+        return NativeLODGroup.getComponentType();
     }
 
-    private final Vector4f mCenter = new Vector4f();
-    private final Vector4f mVector = new Vector4f();
-    private final LinkedList<Object[]> mRanges = new LinkedList<>();
-
     /**
      * Add a range to this LOD group. Specify the scene object that should be displayed in this
      * range. Add the LOG group as a component to the parent scene object. The scene objects
@@ -63,74 +86,92 @@ public final class GVRLODGroup extends GVRBehavior {
      */
     public synchronized void addRange(final float range, final GVRSceneObject sceneObject)
     {
-        if (null == sceneObject) {
-            throw new IllegalArgumentException("sceneObject must be specified!");
-        }
         if (range < 0) {
             throw new IllegalArgumentException("range cannot be negative");
         }
+        useMetric(METRIC_DISTANCE);
+        addObjectLevel(range, sceneObject);
+    }
 
-        final int size = mRanges.size();
-        final float rangePow2 = range*range;
-        final Object[] newElement = new Object[] {rangePow2, sceneObject};
-
-        for (int i = 0; i < size; ++i) {
-            final Object[] el = mRanges.get(i);
-            final Float r = (Float)el[0];
-            if (r > rangePow2) {
-                mRanges.add(i, newElement);
-                break;
-            }
+    /**
+     * Add a level which displays a scene object when the owner covers
+     * at least the given fraction of the viewport height.
+     * The scene object will automatically be added as a child of the owner.
+     * @param screenSize minimum projected height (0 - 1) to show this level
+     * @param sceneObject scene object that should be rendered for this level
+     * @throws IllegalArgumentException if screenSize is negative or sceneObject null
+     */
+    public synchronized void addLevel(final float screenSize, final GVRSceneObject sceneObject)
+    {
+        if (screenSize < 0) {
+            throw new IllegalArgumentException("screen size cannot be negative");
         }
+        useMetric(METRIC_SCREEN_SIZE);
+        addObjectLevel(screenSize, sceneObject);
+    }
 
-        if (mRanges.size() == size) {
-            mRanges.add(newElement);
+    /**
+     * Add a level which replaces the mesh of the owner's render data
+     * when the owner covers at least the given fraction of the viewport height.
+     * @param screenSize minimum projected height (0 - 1) to show this level
+     * @param mesh mesh that should be rendered for this level
+     * @throws IllegalArgumentException if screenSize is negative or mesh null
+     */
+    public synchronized void addLevel(final float screenSize, final GVRMesh mesh)
+    {
+        if (null == mesh) {
+            throw new IllegalArgumentException("mesh must be specified!");
         }
-
-        final GVRSceneObject owner = getOwnerObject();
-        if (null != owner) {
-            owner.addChildObject(sceneObject);
+        if (screenSize < 0) {
+            throw new IllegalArgumentException("screen size cannot be negative");
+        }
+        useMetric(METRIC_SCREEN_SIZE);
+        if (NativeLODGroup.addMeshLevel(getNative(), screenSize, mesh.getNative()) >= 0) {
+            mLevelMeshes.add(mesh);
         }
     }
 
     /**
-     * Do not call directly.
-     * @deprecated
+     * Set the fraction by which the distance or screen size must pass
+     * a level boundary before the selected level changes.
+     * @param hysteresis fraction of the threshold, 0 disables hysteresis
      */
-    public void onDrawFrame(float frameTime) {
-        final GVRSceneObject owner = getOwnerObject();
-        if (owner == null) {
-            return;
-        }
+    public void setHysteresis(float hysteresis)
+    {
+        NativeLODGroup.setHysteresis(getNative(), hysteresis);
+    }
 
-        final int size = mRanges.size();
-        final GVRTransform t = getGVRContext().getMainScene().getMainCameraRig().getCenterCamera().getTransform();
+    /**
+     * Get the level selected during the last cull.
+     * @return 0 based level index or -1 if no level is displayed
+     */
+    public int getCurrentLevel()
+    {
+        return NativeLODGroup.getCurrentLevel(getNative());
+    }
 
-        for (final Object[] range : mRanges) {
-            ((GVRSceneObject)range[1]).setEnable(false);
+    private void useMetric(int metric)
+    {
+        if ((mMetric != metric) && !(mLevelObjects.isEmpty() && mLevelMeshes.isEmpty())) {
+            throw new IllegalArgumentException("cannot mix distance ranges and screen size levels");
         }
+        mMetric = metric;
+        NativeLODGroup.setMetric(getNative(), metric);
+    }
 
-        for (int i = size - 1; i >= 0; --i) {
-            final Object[] range = mRanges.get(i);
-            final GVRSceneObject child = (GVRSceneObject) range[1];
-            if (child.getParent() != owner) {
-                Log.w(TAG, "the scene object for distance greater than " + range[0] + " is not a child of the owner; skipping it");
-                continue;
-            }
-
-            final float[] values = child.getBoundingVolumeRawValues();
-            mCenter.set(values[0], values[1], values[2], 1.0f);
-            mVector.set(t.getPositionX(), t.getPositionY(), t.getPositionZ(), 1.0f);
-
-            mVector.sub(mCenter);
-            mVector.negate();
-
-            float distance = mVector.dot(mVector);
+    private void addObjectLevel(final float threshold, final GVRSceneObject sceneObject)
+    {
+        if (null == sceneObject) {
+            throw new IllegalArgumentException("sceneObject must be specified!");
+        }
+        if (NativeLODGroup.addObjectLevel(getNative(), threshold, sceneObject.getNative()) < 0) {
+            return;
+        }
+        mLevelObjects.add(sceneObject);
 
-            if (distance >= (Float) range[0]) {
-                child.setEnable(true);
-                break;
-            }
+        final GVRSceneObject owner = getOwnerObject();
+        if (null != owner) {
+            owner.addChildObject(sceneObject);
         }
     }
 
@@ -138,8 +179,8 @@ public final class GVRLODGroup extends GVRBehavior {
     public synchronized void onAttach(GVRSceneObject newOwner) {
         super.onAttach(newOwner);
 
-        for (final Object[] el : mRanges) {
-            newOwner.addChildObject((GVRSceneObject)el[1]);
+        for (final GVRSceneObject child : mLevelObjects) {
+            newOwner.addChildObject(child);
         }
     }
 
@@ -147,10 +188,25 @@ public final class GVRLODGroup extends GVRBehavior {
     public synchronized void onDetach(GVRSceneObject oldOwner) {
         super.onDetach(oldOwner);
 
-        for (final Object[] el : mRanges) {
-            oldOwner.removeChildObject((GVRSceneObject)el[1]);
+        for (final GVRSceneObject child : mLevelObjects) {
+            oldOwner.removeChildObject(child);
         }
     }
+}
+
+class NativeLODGroup
+{
+    static native long ctor();
+
+    static native long getComponentType();
+
+    static native void setMetric(long lod, int metric);
+
+    static native void setHysteresis(long lod, float hysteresis);
+
+    static native int addObjectLevel(long lod, float threshold, long sceneObject);
+
+    static native int addMeshLevel(long lod, float threshold, long mesh);
 
-    private static final String TAG = "GVRLODGroup";
-}
\ No newline at end of file
+    static native int getCurrentLevel(long lod);
+}
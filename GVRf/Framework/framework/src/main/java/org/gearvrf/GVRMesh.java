@@ -39,7 +39,7 @@ import org.gearvrf.utility.Log;
  * attributes in the OpenGL vertex shader.
  */
 public class GVRMesh extends GVRHybridObject implements PrettyPrint {
-    static public final int MAX_BONES = 60;
+    static public final int MAX_BONES = 256;
     static public final int BONES_PER_VERTEX = 4;
     private static final String TAG = GVRMesh.class.getSimpleName();
 
@@ -503,6 +503,59 @@ public class GVRMesh extends GVRHybridObject implements PrettyPrint {
         NativeMesh.setBones(getNative(), GVRHybridObject.getNativePtrArray(bones));
     }
 
+    /**
+     * Add a morph target (blend shape) to this mesh.
+     * <p>
+     * Only the vertices which the target moves are kept, with the
+     * difference of their position and normal to the base mesh.
+     * The vertices must be set before adding targets.
+     *
+     * @param positions  3 floats for each vertex of the mesh
+     * @param normals    3 floats for each vertex, may be null
+     * @param relative   true if the values are offsets from the base mesh,
+     *                   false if they replace the base values
+     * @param halfFloats true to store the offsets as half floats, which
+     *                   uses half the memory and is less precise
+     * @return index of the target or -1 if it could not be added
+     * @see #setMorphWeights(float[])
+     */
+    public int addMorphTarget(float[] positions, float[] normals, boolean relative,
+                              boolean halfFloats)
+    {
+        return NativeMesh.addMorphTarget(getNative(), positions, normals, relative, halfFloats);
+    }
+
+    /**
+     * Add a morph target given by the positions and normals which
+     * replace the ones of the base mesh, with offsets kept as floats.
+     * @see #addMorphTarget(float[], float[], boolean, boolean)
+     */
+    public int addMorphTarget(float[] positions, float[] normals)
+    {
+        return addMorphTarget(positions, normals, false, false);
+    }
+
+    public int getMorphTargetCount()
+    {
+        return NativeMesh.getMorphTargetCount(getNative());
+    }
+
+    /**
+     * Morph the mesh with one weight for each target.
+     * <p>
+     * The vertices are morphed from the base mesh, missing weights
+     * are zero. Only the vertices of the targets whose weight is not
+     * zero now or was not zero before are written and copied to the
+     * GPU, nothing is done if the weights did not change.
+     *
+     * @param weights weight of each target, usually between 0 and 1
+     * @return number of vertices written
+     */
+    public int setMorphWeights(float[] weights)
+    {
+        return NativeMesh.setMorphWeights(getNative(), weights);
+    }
+
 
     @Override
     public void prettyPrint(StringBuffer sb, int indent) {
@@ -640,4 +693,11 @@ class NativeMesh {
     static native void setIndexBuffer(long mesh, long ibuf);
 
     static native void setVertexBuffer(long mesh, long vbuf);
+
+    static native int addMorphTarget(long mesh, float[] positions, float[] normals,
+                                     boolean relative, boolean halfFloats);
+
+    static native int getMorphTargetCount(long mesh);
+
+    static native int setMorphWeights(long mesh, float[] weights);
 }
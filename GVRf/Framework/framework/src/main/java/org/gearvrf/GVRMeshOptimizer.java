@@ -0,0 +1,103 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+/**
+ * Reorders the triangles and vertices of a mesh for faster rendering
+ * without changing its appearance.
+ * <p>
+ * Triangles are ordered to reuse vertices in the GPU post-transform
+ * cache, then clusters of triangles are sorted so outward facing ones
+ * are drawn first to reduce overdraw, and vertices are stored in the
+ * order they are first used to improve vertex fetch locality.
+ * <p>
+ * The statistics reported are:
+ * <ul>
+ * <li>ACMR - transformed vertices per triangle (0.5 - 3, lower is better)</li>
+ * <li>ATVR - transformed vertices per vertex (1 is ideal)</li>
+ * <li>overfetch - bytes read from vertex memory relative to the size
+ *     of the vertices used (1 is ideal)</li>
+ * </ul>
+ * Meshes are optimized automatically during import with
+ * {@link GVRImportSettings#OPTIMIZE_MESH_ORDER}.
+ */
+public final class GVRMeshOptimizer {
+    /**
+     * Index of the average cache miss ratio in the statistics array.
+     */
+    public static final int STAT_ACMR = 0;
+
+    /**
+     * Index of the average transformed vertex ratio in the statistics array.
+     */
+    public static final int STAT_ATVR = 1;
+
+    /**
+     * Index of the vertex overfetch ratio in the statistics array.
+     */
+    public static final int STAT_OVERFETCH = 2;
+
+    /**
+     * Number of statistics for a mesh.
+     */
+    public static final int STAT_COUNT = 3;
+
+    /**
+     * Default amount the cache miss ratio may grow to reduce overdraw.
+     */
+    public static final float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+    private GVRMeshOptimizer() { }
+
+    /**
+     * Optimize a mesh in place. The number of vertices and indices does not change.
+     * @param mesh              indexed triangle mesh with "a_position"
+     * @param overdrawThreshold how much the cache miss ratio may grow to reduce
+     *                          overdraw (1.05 = 5%), 0 to skip overdraw optimization
+     * @param stats             if not null, receives the statistics before
+     *                          (first {@link #STAT_COUNT} entries) and after optimization
+     * @return true if the mesh was optimized, false on error
+     */
+    public static boolean optimize(GVRMesh mesh, float overdrawThreshold, float[] stats)
+    {
+        if ((stats != null) && (stats.length < 2 * STAT_COUNT))
+        {
+            throw new IllegalArgumentException("statistics array must have " + 2 * STAT_COUNT + " entries");
+        }
+        return NativeMeshOptimizer.optimize(mesh.getNative(), overdrawThreshold, stats);
+    }
+
+    /**
+     * Measure the cache and fetch efficiency of a mesh.
+     * @param mesh  mesh to analyze
+     * @param stats receives {@link #STAT_COUNT} statistics
+     * @return true if the mesh was analyzed, false on error
+     */
+    public static boolean analyze(GVRMesh mesh, float[] stats)
+    {
+        if (stats.length < STAT_COUNT)
+        {
+            throw new IllegalArgumentException("statistics array must have " + STAT_COUNT + " entries");
+        }
+        return NativeMeshOptimizer.analyze(mesh.getNative(), stats);
+    }
+}
+
+class NativeMeshOptimizer {
+    static native boolean optimize(long mesh, float overdrawThreshold, float[] stats);
+
+    static native boolean analyze(long mesh, float[] stats);
+}
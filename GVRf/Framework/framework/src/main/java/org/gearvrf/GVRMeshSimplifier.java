@@ -0,0 +1,141 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+import java.util.Arrays;
+
+/**
+ * Generates simplified versions of a mesh for levels of detail.
+ * <p>
+ * Simplification repeatedly collapses the edge with the smallest
+ * quadric error. Vertices are never moved, so every simplified
+ * mesh has the same vertex layout as its source and keeps its
+ * texture coordinates, normals and bone weights. UV and normal
+ * seams and open borders are preserved.
+ * <p>
+ * Errors are distances relative to the largest dimension of the
+ * mesh bounding box: 0.01 means 1% of the mesh size.
+ * The meshes produced can be given to {@link GVRLODGroup#addLevel(float, GVRMesh)}.
+ * <pre>
+ *     GVRMesh[] lods = GVRMeshSimplifier.generateLODs(mesh,
+ *              new float[] { 0.5f, 0.25f, 0.1f }, null, null);
+ *     GVRLODGroup lodGroup = new GVRLODGroup(gvrContext);
+ *     lodGroup.addLevel(0.5f, mesh);
+ *     lodGroup.addLevel(0.25f, lods[0]);
+ *     lodGroup.addLevel(0.1f, lods[1]);
+ *     lodGroup.addLevel(0.02f, lods[2]);
+ * </pre>
+ * Simplification takes time proportional to the number of triangles
+ * and should be done at import time or on a background thread.
+ * @see GVRLODGroup
+ */
+public final class GVRMeshSimplifier {
+    private GVRMeshSimplifier() { }
+
+    /**
+     * Simplify a mesh.
+     * @param mesh          mesh to simplify, must have "a_position"
+     * @param ratio         fraction of the triangles to keep (0 - 1)
+     * @param targetError   maximum error relative to the mesh size
+     *                      (use 1 to only limit by ratio)
+     * @return simplified mesh, null on error
+     */
+    public static GVRMesh simplify(GVRMesh mesh, float ratio, float targetError)
+    {
+        GVRVertexBuffer vbuf = createVertexBuffer(mesh);
+        GVRIndexBuffer ibuf = createIndexBuffer(mesh);
+
+        if (NativeMeshSimplifier.simplify(mesh.getNative(), vbuf.getNative(), ibuf.getNative(),
+                                          ratio, targetError) < 0)
+        {
+            return null;
+        }
+        return new GVRMesh(vbuf, ibuf);
+    }
+
+    /**
+     * Generate a chain of levels of detail from a mesh.
+     * Each level is simplified from the previous one and stops
+     * at whichever of its ratio or error limit is reached first.
+     * @param mesh          mesh to simplify, must have "a_position"
+     * @param ratios        fraction of the source triangles to keep for each level,
+     *                      use 0 for a purely error driven level
+     * @param targetErrors  maximum error relative to the mesh size for each level,
+     *                      null to only limit by ratio
+     * @param resultErrors  if not null, receives the error of each level
+     * @return array with the generated meshes, it may be shorter than
+     *         the input arrays if an error occurred
+     */
+    public static GVRMesh[] generateLODs(GVRMesh mesh, float[] ratios, float[] targetErrors,
+                                         float[] resultErrors)
+    {
+        int nlevels = ratios.length;
+        GVRVertexBuffer[] vbufs = new GVRVertexBuffer[nlevels];
+        GVRIndexBuffer[] ibufs = new GVRIndexBuffer[nlevels];
+        long[] vptrs = new long[nlevels];
+        long[] iptrs = new long[nlevels];
+
+        if (targetErrors == null)
+        {
+            targetErrors = new float[nlevels];
+            Arrays.fill(targetErrors, 1.0f);
+        }
+        else if (targetErrors.length != nlevels)
+        {
+            throw new IllegalArgumentException("must have an error limit for each level");
+        }
+        if ((resultErrors != null) && (resultErrors.length < nlevels))
+        {
+            throw new IllegalArgumentException("result error array is too small");
+        }
+        for (int i = 0; i < nlevels; ++i)
+        {
+            vbufs[i] = createVertexBuffer(mesh);
+            ibufs[i] = createIndexBuffer(mesh);
+            vptrs[i] = vbufs[i].getNative();
+            iptrs[i] = ibufs[i].getNative();
+        }
+        int n = NativeMeshSimplifier.generateLODs(mesh.getNative(), ratios, targetErrors,
+                                                  vptrs, iptrs, resultErrors);
+        GVRMesh[] lods = new GVRMesh[n];
+
+        for (int i = 0; i < n; ++i)
+        {
+            lods[i] = new GVRMesh(vbufs[i], ibufs[i]);
+        }
+        return lods;
+    }
+
+    private static GVRVertexBuffer createVertexBuffer(GVRMesh mesh)
+    {
+        GVRVertexBuffer src = mesh.getVertexBuffer();
+        return new GVRVertexBuffer(mesh.getGVRContext(), src.getDescriptor(), 0);
+    }
+
+    private static GVRIndexBuffer createIndexBuffer(GVRMesh mesh)
+    {
+        GVRIndexBuffer src = mesh.getIndexBuffer();
+        int indexSize = (src != null) ? src.getIndexSize() : 4;
+        return new GVRIndexBuffer(mesh.getGVRContext(), indexSize, 0);
+    }
+}
+
+class NativeMeshSimplifier {
+    static native float simplify(long mesh, long vertices, long indices, float ratio, float targetError);
+
+    static native int generateLODs(long mesh, float[] ratios, float[] targetErrors,
+                                   long[] vertices, long[] indices, float[] resultErrors);
+}
@@ -57,6 +57,7 @@ import org.joml.Vector4f;
  */
 public class GVRObjectPicker extends GVRPicker
 {
+    private GVRCollider[] mFound = new GVRCollider[16];
 
     /**
      * Construct a picker which picks from a given scene.
@@ -92,25 +93,35 @@ public class GVRObjectPicker extends GVRPicker
     public void doPick()
     {
         GVRSceneObject owner = getOwnerObject();
-        GVRPickedObject[] picked = GVRFrustumPicker.pickVisible(mScene);
 
-        if (owner != null)
+        if (owner == null)
         {
-            for (int i = 0; i < picked.length; ++i)
-            {
-                GVRPickedObject hit = picked[i];
+            generatePickEvents(GVRFrustumPicker.pickVisible(mScene));
+            return;
+        }
+        GVRSceneObject.BoundingVolume bv = owner.getBoundingVolume();
+        Vector3f mn = bv.minCorner;
+        Vector3f mx = bv.maxCorner;
+        int n = pickObjectsInBox(mScene, mn.x, mn.y, mn.z, mx.x, mx.y, mx.z, QUERY_RENDER_BOUNDS, mFound);
+        if (n > mFound.length)
+        {
+            mFound = new GVRCollider[n];
+            n = pickObjectsInBox(mScene, mn.x, mn.y, mn.z, mx.x, mx.y, mx.z, QUERY_RENDER_BOUNDS, mFound);
+            n = Math.min(n, mFound.length);
+        }
+        GVRPickedObject[] picked = new GVRPickedObject[n];
+        int count = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            GVRCollider collider = mFound[i];
 
-                if (hit != null)
-                {
-                    GVRSceneObject sceneObj = hit.hitObject;
-                    if (!owner.intersectsBoundingVolume(sceneObj))
-                    {
-                        picked[i] = null;
-                    }
-                }
+            mFound[i] = null;
+            if (collider != null)
+            {
+                picked[count++] = makeObjectHit(collider, bv.center.x, bv.center.y, bv.center.z);
             }
         }
-        generatePickEvents(picked);
+        generatePickEvents((count == n) ? picked : Arrays.copyOf(picked, count));
     }
 
     /**
@@ -0,0 +1,247 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+/**
+ * Simulates up to a fixed number of particles natively.
+ * <p>
+ * The particles are written every step to the vertices of a point
+ * mesh with the layout {@link #VERTEX_DESCRIPTOR}, one vertex per
+ * particle. Live particles are the first vertices, the others have
+ * a size of zero and should be clipped by the vertex shader.
+ * Particles move with their velocity, the acceleration and a random
+ * drift, and their color and size change linearly with their age.
+ * All particles live for the same time.
+ * <p>
+ * Stateless particles are not simulated at all. Each vertex of the
+ * mesh, with the layout {@link #STATELESS_VERTEX_DESCRIPTOR}, keeps
+ * the position, velocity, spawn time and a random seed of a particle
+ * when it was emitted, and the vertex shader computes the particle at
+ * {@link #getTime()}. Only emitted particles are copied to the GPU.
+ * <p>
+ * Nothing is allocated per particle or per frame: particles are
+ * emitted in batches with {@link #emit(int)} and the simulation is
+ * advanced once per frame with {@link #step(float)}. Attach the
+ * particle system to the scene object which renders its mesh to
+ * have the scene object culled with {@link #updateBounds()}.
+ */
+public class GVRParticleSystem extends GVRComponent {
+    public static final String VERTEX_DESCRIPTOR = "float3 a_position float4 a_color float a_size";
+    /** a_spawn is the spawn time and a random seed between 0 and 1 */
+    public static final String STATELESS_VERTEX_DESCRIPTOR = "float3 a_position float3 a_velocity float2 a_spawn";
+
+    /** Particles start at the origin */
+    public static final int POINT = 0;
+    /** Particles start on a rectangle in the X-Z plane */
+    public static final int PLANE = 1;
+    /** Particles start in a sphere and move away from its center */
+    public static final int SPHERE = 2;
+
+    private final GVRMesh mMesh;
+    private final int mCapacity;
+    private final boolean mStateless;
+
+    /**
+     * @param capacity maximum number of live particles
+     */
+    public GVRParticleSystem(GVRContext gvrContext, int capacity) {
+        this(gvrContext, capacity, false);
+    }
+
+    /**
+     * @param capacity  maximum number of live particles
+     * @param stateless true to compute the particles in the vertex shader
+     */
+    public GVRParticleSystem(GVRContext gvrContext, int capacity, boolean stateless) {
+        super(gvrContext, NativeParticleSystem.ctor(capacity, stateless));
+        mCapacity = capacity;
+        mStateless = stateless;
+        mMesh = new GVRMesh(gvrContext, stateless ? STATELESS_VERTEX_DESCRIPTOR : VERTEX_DESCRIPTOR);
+        if (!NativeParticleSystem.setMesh(getNative(), mMesh.getNative())) {
+            throw new IllegalArgumentException("Cannot make a particle mesh with " + capacity + " particles");
+        }
+    }
+
+    static public long getComponentType() {
+        return NativeParticleSystem.getComponentType();
+    }
+
+    /**
+     * Mesh the particles are written to, draw it as points.
+     */
+    public GVRMesh getMesh() {
+        return mMesh;
+    }
+
+    public int getCapacity() {
+        return mCapacity;
+    }
+
+    public boolean isStateless() {
+        return mStateless;
+    }
+
+    /**
+     * Seconds since the particle system was last empty. Stateless
+     * particles are drawn at this time, pass it to their shader
+     * after each step. A step moves the time back when it gets
+     * large, along with the spawn times of the live particles.
+     */
+    public float getTime() {
+        return NativeParticleSystem.getTime(getNative());
+    }
+
+    public int getParticleCount() {
+        return NativeParticleSystem.getParticleCount(getNative());
+    }
+
+    /**
+     * @param shape  {@link #POINT}, {@link #PLANE} or {@link #SPHERE}
+     * @param width  width of the plane along X or radius of the sphere
+     * @param height height of the plane along Z
+     */
+    public void setShape(int shape, float width, float height) {
+        NativeParticleSystem.setShape(getNative(), shape, width, height);
+    }
+
+    /**
+     * Range of the velocities of new particles. For spheres it is
+     * the range of speeds along the direction from the center.
+     */
+    public void setVelocityRange(float minX, float minY, float minZ,
+                                 float maxX, float maxY, float maxZ) {
+        NativeParticleSystem.setVelocityRange(getNative(), new float[] { minX, minY, minZ },
+                new float[] { maxX, maxY, maxZ });
+    }
+
+    public void setAcceleration(float x, float y, float z) {
+        NativeParticleSystem.setAcceleration(getNative(), x, y, z);
+    }
+
+    /**
+     * @param lifetime seconds a particle lives
+     */
+    public void setLifetime(float lifetime) {
+        NativeParticleSystem.setLifetime(getNative(), lifetime);
+    }
+
+    /**
+     * Each particle drifts in a random direction picked when it is
+     * emitted, at a constant speed of up to the noise.
+     * @param noise maximum speed of the random drift of each particle
+     */
+    public void setNoise(float noise) {
+        NativeParticleSystem.setNoise(getNative(), noise);
+    }
+
+    /**
+     * @param size     size of a new particle
+     * @param sizeRate change of the size per second
+     */
+    public void setSize(float size, float sizeRate) {
+        NativeParticleSystem.setSize(getNative(), size, sizeRate);
+    }
+
+    /**
+     * The color goes from the start color when a particle is emitted
+     * to the end color when it dies.
+     * @param start r, g, b, a
+     * @param end   r, g, b, a
+     */
+    public void setColors(float[] start, float[] end) {
+        NativeParticleSystem.setColors(getNative(), start, end);
+    }
+
+    /**
+     * Bounds of the particles relative to the mesh, used to cull it.
+     * @see #updateBounds()
+     */
+    public void setBounds(float minX, float minY, float minZ,
+                          float maxX, float maxY, float maxZ) {
+        NativeParticleSystem.setBounds(getNative(), new float[] { minX, minY, minZ },
+                new float[] { maxX, maxY, maxZ });
+    }
+
+    /**
+     * Set the bounds to contain every particle which can be emitted
+     * with the current shape, velocities, acceleration, noise and
+     * lifetime. Call it after changing them.
+     */
+    public void updateBounds() {
+        NativeParticleSystem.updateBounds(getNative());
+    }
+
+    /**
+     * Emit a batch of particles.
+     * @return number of particles emitted, less than {@code count}
+     *         if there is not room for them
+     */
+    public int emit(int count) {
+        return NativeParticleSystem.emit(getNative(), count);
+    }
+
+    /**
+     * Advance the particles and write them to the mesh.
+     * Call it from the GL thread once per frame.
+     * @return number of live particles
+     */
+    public int step(float frameTime) {
+        return NativeParticleSystem.step(getNative(), frameTime);
+    }
+
+    /**
+     * Remove all the particles.
+     */
+    public void clear() {
+        NativeParticleSystem.clear(getNative());
+    }
+}
+
+class NativeParticleSystem {
+    static native long ctor(int capacity, boolean stateless);
+
+    static native long getComponentType();
+
+    static native boolean setMesh(long system, long mesh);
+
+    static native void setShape(long system, int shape, float width, float height);
+
+    static native void setVelocityRange(long system, float[] min, float[] max);
+
+    static native void setAcceleration(long system, float x, float y, float z);
+
+    static native void setLifetime(long system, float lifetime);
+
+    static native void setNoise(long system, float noise);
+
+    static native void setSize(long system, float size, float sizeRate);
+
+    static native void setColors(long system, float[] start, float[] end);
+
+    static native void setBounds(long system, float[] min, float[] max);
+
+    static native void updateBounds(long system);
+
+    static native int emit(long system, int count);
+
+    static native int step(long system, float frameTime);
+
+    static native void clear(long system);
+
+    static native int getParticleCount(long system);
+
+    static native float getTime(long system);
+}
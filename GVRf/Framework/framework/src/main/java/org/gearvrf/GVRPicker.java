@@ -16,11 +16,13 @@
 package org.gearvrf;
 
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.Arrays;
 import java.util.List;
 import java.util.concurrent.locks.ReentrantLock;
 
 import org.gearvrf.utility.Log;
+import org.joml.Matrix4f;
 import org.joml.Vector3f;
 
 /**
@@ -64,10 +66,28 @@ import org.joml.Vector3f;
  */
 public class GVRPicker extends GVRBehavior {
     private static final String TAG = Log.tag(GVRPicker.class);
+
+    /**
+     * Volume queries test the world space bounds of the colliders.
+     * @see #pickObjectsInBox(GVRScene, float, float, float, float, float, float, int, GVRCollider[])
+     */
+    public static final int QUERY_COLLIDER_BOUNDS = 0;
+
+    /**
+     * Volume queries test the bounding volumes of the scene objects
+     * (including their children) which own the colliders.
+     * @see GVRSceneObject#getBoundingVolume()
+     */
+    public static final int QUERY_RENDER_BOUNDS = 1;
+
+    private static final int VOLUME_BOX = 1;
+    private static final int VOLUME_SPHERE = 2;
+    private static final int VOLUME_FRUSTUM = 3;
     static private long TYPE_PICKMANAGER = newComponentType(GVRPicker.class);
     private Vector3f mRayOrigin = new Vector3f(0, 0, 0);
     private Vector3f mRayDirection = new Vector3f(0, 0, -1);
     private float[] mPickRay = new float[6];
+    private boolean mPickClosest = false;
 
     protected GVRScene mScene;
     protected GVRPickedObject[] mPicked = null;
@@ -189,6 +209,31 @@ public class GVRPicker extends GVRBehavior {
         mRayDirection.z = dz;
     }
 
+    /**
+     * Enables or disables picking only the closest object.
+     * <p/>
+     * By default the picker finds all the objects the pick ray hits.
+     * When only the closest object is picked the search stops as soon
+     * as no other object can be closer which is much faster in scenes
+     * with many colliders. The pick list then contains at most one object.
+     *
+     * @param closest true to pick only the closest object, false to pick all objects hit
+     * @see #pickClosestObject(GVRScene, GVRTransform, float, float, float, float, float, float)
+     */
+    public void setPickClosest(boolean closest)
+    {
+        mPickClosest = closest;
+    }
+
+    /**
+     * Returns true if only the closest object is picked.
+     * @see #setPickClosest(boolean)
+     */
+    public boolean getPickClosest()
+    {
+        return mPickClosest;
+    }
+
     public void onDrawFrame(float frameTime)
     {
         if (isEnabled())
@@ -209,9 +254,21 @@ public class GVRPicker extends GVRBehavior {
     {
         GVRSceneObject owner = getOwnerObject();
         GVRTransform trans = (owner != null) ? owner.getTransform() : null;
-        GVRPickedObject[] picked = pickObjects(mScene, trans,
-                mRayOrigin.x, mRayOrigin.y, mRayOrigin.z,
-                mRayDirection.x, mRayDirection.y, mRayDirection.z);
+        GVRPickedObject[] picked;
+
+        if (mPickClosest)
+        {
+            GVRPickedObject closest = pickClosestObject(mScene, trans,
+                    mRayOrigin.x, mRayOrigin.y, mRayOrigin.z,
+                    mRayDirection.x, mRayDirection.y, mRayDirection.z);
+            picked = (closest != null) ? new GVRPickedObject[] { closest } : new GVRPickedObject[0];
+        }
+        else
+        {
+            picked = pickObjects(mScene, trans,
+                    mRayOrigin.x, mRayOrigin.y, mRayOrigin.z,
+                    mRayDirection.x, mRayDirection.y, mRayDirection.z);
+        }
         generatePickEvents(picked);
     }
 
@@ -530,6 +587,143 @@ public class GVRPicker extends GVRBehavior {
         }
     }
 
+    /**
+     * Casts a ray into the scene graph, and returns the closest object it intersects.
+     * <p/>
+     * The ray is defined by its origin {@code [ox, oy, oz]} and its direction
+     * {@code [dx, dy, dz]} in the coordinate system of the input transform.
+     * Colliders are tested in order of their distance along the ray and
+     * the search stops once no remaining collider can be closer,
+     * which is faster than finding all the objects hit.
+     * <p/>
+     * Objects are compared by the world space distance from the ray
+     * origin to where the ray hits their collision geometry.
+     *
+     * @param scene
+     *            The {@link GVRScene} with all the objects to be tested.
+     * @param trans
+     *            The {@link GVRTransform} establishing the coordinate system of the ray,
+     *            if null the ray is relative to the main camera.
+     * @param ox
+     *            The x coordinate of the ray origin.
+     * @param oy
+     *            The y coordinate of the ray origin.
+     * @param oz
+     *            The z coordinate of the ray origin.
+     * @param dx
+     *            The x vector of the ray direction.
+     * @param dy
+     *            The y vector of the ray direction.
+     * @param dz
+     *            The z vector of the ray direction.
+     * @return the {@link GVRPickedObject} closest to the ray origin or null if nothing is hit
+     * @see #setPickClosest(boolean)
+     */
+    public static final GVRPickedObject pickClosestObject(GVRScene scene, GVRTransform trans, float ox, float oy, float oz,
+                                                          float dx, float dy, float dz) {
+        sFindObjectsLock.lock();
+        try {
+            long nativeTrans = (trans != null) ? trans.getNative() : 0L;
+            return NativePicker.pickClosest(scene.getNative(), nativeTrans, ox, oy, oz, dx, dy, dz);
+        } finally {
+            sFindObjectsLock.unlock();
+        }
+    }
+
+    /**
+     * Finds the pickable objects inside or partially inside a view frustum.
+     * <p/>
+     * The query is done natively using the spatial index of the colliders
+     * (or the bounding volume hierarchy of the scene graph) instead of
+     * testing each scene object. Only enabled colliders are found and,
+     * if the scene only picks visible objects, only visible ones.
+     *
+     * @param scene             scene to query
+     * @param viewProjection    matrix which transforms world coordinates into clip coordinates
+     * @param boundsType        {@link #QUERY_COLLIDER_BOUNDS} or {@link #QUERY_RENDER_BOUNDS}
+     * @param results           array to get the colliders found
+     * @return number of colliders found, if it is larger than the
+     *         results array only the first ones are returned
+     */
+    public static final int pickObjectsInFrustum(GVRScene scene, Matrix4f viewProjection, int boundsType,
+                                                 GVRCollider[] results) {
+        float[] params = new float[16];
+        viewProjection.get(params, 0);
+        return pickVolume(scene, VOLUME_FRUSTUM, params, boundsType, results);
+    }
+
+    /**
+     * Finds the pickable objects inside or partially inside an axis aligned box.
+     * @param scene         scene to query
+     * @param minX          minimum X coordinate of the box in world coordinates
+     * @param minY          minimum Y coordinate of the box in world coordinates
+     * @param minZ          minimum Z coordinate of the box in world coordinates
+     * @param maxX          maximum X coordinate of the box in world coordinates
+     * @param maxY          maximum Y coordinate of the box in world coordinates
+     * @param maxZ          maximum Z coordinate of the box in world coordinates
+     * @param boundsType    {@link #QUERY_COLLIDER_BOUNDS} or {@link #QUERY_RENDER_BOUNDS}
+     * @param results       array to get the colliders found
+     * @return number of colliders found, if it is larger than the
+     *         results array only the first ones are returned
+     * @see #pickObjectsInFrustum(GVRScene, Matrix4f, int, GVRCollider[])
+     */
+    public static final int pickObjectsInBox(GVRScene scene, float minX, float minY, float minZ,
+                                             float maxX, float maxY, float maxZ, int boundsType,
+                                             GVRCollider[] results) {
+        float[] params = new float[] { minX, minY, minZ, maxX, maxY, maxZ };
+        return pickVolume(scene, VOLUME_BOX, params, boundsType, results);
+    }
+
+    /**
+     * Finds the pickable objects within a distance of a point.
+     * @param scene         scene to query
+     * @param x             X coordinate of the point in world coordinates
+     * @param y             Y coordinate of the point in world coordinates
+     * @param z             Z coordinate of the point in world coordinates
+     * @param distance      maximum distance from the point
+     * @param boundsType    {@link #QUERY_COLLIDER_BOUNDS} or {@link #QUERY_RENDER_BOUNDS}
+     * @param results       array to get the colliders found
+     * @return number of colliders found, if it is larger than the
+     *         results array only the first ones are returned
+     * @see #pickObjectsInFrustum(GVRScene, Matrix4f, int, GVRCollider[])
+     */
+    public static final int pickObjectsInSphere(GVRScene scene, float x, float y, float z, float distance,
+                                                int boundsType, GVRCollider[] results) {
+        float[] params = new float[] { x, y, z, distance };
+        return pickVolume(scene, VOLUME_SPHERE, params, boundsType, results);
+    }
+
+    private static int pickVolume(GVRScene scene, int volumeType, float[] params, int boundsType,
+                                  GVRCollider[] results) {
+        sFindObjectsLock.lock();
+        try {
+            if (sVolumeResults.length < results.length) {
+                sVolumeResults = new long[results.length];
+            }
+            int n = NativePicker.pickVolume(scene.getNative(), volumeType, params, boundsType, sVolumeResults);
+            int count = Math.min(n, results.length);
+            for (int i = 0; i < count; ++i) {
+                results[i] = GVRCollider.lookup(sVolumeResults[i]);
+            }
+            return n;
+        } finally {
+            sFindObjectsLock.unlock();
+        }
+    }
+
+    /**
+     * Internal utility to make a picked object for an object found by a volume query.
+     * The hit location is the world position of the object and the
+     * distance is measured from the given point.
+     */
+    static GVRPickedObject makeObjectHit(GVRCollider collider, float ox, float oy, float oz)
+    {
+        Matrix4f world = collider.getOwnerObject().getTransform().getModelMatrix4f();
+        Vector3f pos = world.getTranslation(new Vector3f());
+        float distance = pos.distance(ox, oy, oz);
+        return new GVRPickedObject(collider, new float[] { pos.x, pos.y, pos.z }, distance);
+    }
+
     /**
      * Casts a ray into the scene graph, and returns the objects it intersects.
      *
@@ -753,7 +947,214 @@ public class GVRPicker extends GVRBehavior {
         }
     }
 
+    /**
+     * Casts several rays into the scene in one pass.
+     * <p/>
+     * Several input devices (controllers, gaze, cursors) often pick
+     * the same scene every frame. A pick batch locks the colliders once,
+     * traces all its rays together and returns the hits in a direct
+     * ByteBuffer instead of creating a {@link GVRPickedObject} for each hit.
+     * <p/>
+     * Set the rays with {@link #setRay(int, float, float, float, float, float, float)},
+     * call {@link #pick(GVRScene, GVRTransform)} and then read the hits
+     * for each ray. The hits for a ray are sorted by increasing distance.
+     * The batch can be reused every frame without allocating.
+     */
+    public static final class GVRPickBatch
+    {
+        private static final int RECORD_SIZE = 64;
+        private static final int DISTANCE = 8;
+        private static final int HIT_POSITION = 12;
+        private static final int FACE_INDEX = 24;
+        private static final int BARYCENTRIC = 28;
+        private static final int TEXCOORD = 40;
+        private static final int NORMAL = 48;
+
+        private final float[] mRays;
+        private final int mRayCount;
+        private final int mHeaderSize;
+        private ByteBuffer mHits;
+        private int mHitCount = 0;
+
+        /**
+         * Construct a batch for a fixed number of rays.
+         * @param rayCount number of rays cast together
+         */
+        public GVRPickBatch(int rayCount)
+        {
+            mRayCount = rayCount;
+            mRays = new float[rayCount * 6];
+            mHeaderSize = ((rayCount + 1) * 4 + 7) & ~7;
+            allocate(rayCount * 8);
+        }
+
+        private void allocate(int numHits)
+        {
+            mHits = ByteBuffer.allocateDirect(mHeaderSize + numHits * RECORD_SIZE).order(ByteOrder.nativeOrder());
+        }
+
+        /**
+         * Set the origin and direction of a ray.
+         * The ray is in the coordinate system of the transform passed to pick.
+         * @param index index of the ray
+         */
+        public void setRay(int index, float ox, float oy, float oz, float dx, float dy, float dz)
+        {
+            int i = index * 6;
+            mRays[i] = ox;
+            mRays[i + 1] = oy;
+            mRays[i + 2] = oz;
+            mRays[i + 3] = dx;
+            mRays[i + 4] = dy;
+            mRays[i + 5] = dz;
+        }
+
+        /**
+         * Cast all the rays into the scene.
+         * @param scene scene to pick from
+         * @param trans transform establishing the coordinate system of the rays,
+         *              if null the rays are relative to the main camera
+         * @return total number of hits for all the rays
+         */
+        public int pick(GVRScene scene, GVRTransform trans)
+        {
+            long nativeTrans = (trans != null) ? trans.getNative() : 0L;
+
+            sFindObjectsLock.lock();
+            try
+            {
+                int numHits = NativePicker.pickSceneBatch(scene.getNative(), nativeTrans, mRays, mRayCount, mHits);
+                if (mHeaderSize + numHits * RECORD_SIZE > mHits.capacity())
+                {
+                    allocate(numHits * 2);
+                    numHits = NativePicker.pickSceneBatch(scene.getNative(), nativeTrans, mRays, mRayCount, mHits);
+                }
+                mHitCount = (mHeaderSize + numHits * RECORD_SIZE <= mHits.capacity()) ? numHits : 0;
+                return mHitCount;
+            }
+            finally
+            {
+                sFindObjectsLock.unlock();
+            }
+        }
+
+        /**
+         * Get the number of objects hit by a ray.
+         * @param ray index of the ray
+         */
+        public int getHitCount(int ray)
+        {
+            if (mHitCount == 0)
+            {
+                return 0;
+            }
+            return mHits.getInt((ray + 1) * 4) - mHits.getInt(ray * 4);
+        }
+
+        private int offset(int ray, int hit)
+        {
+            return mHeaderSize + (mHits.getInt(ray * 4) + hit) * RECORD_SIZE;
+        }
+
+        /**
+         * Get the collider hit.
+         * @param ray index of the ray
+         * @param hit index of the hit, 0 is the closest
+         */
+        public GVRCollider getCollider(int ray, int hit)
+        {
+            return GVRCollider.lookup(mHits.getLong(offset(ray, hit)));
+        }
+
+        /**
+         * Get the distance from the ray origin to the hit point.
+         * @param ray index of the ray
+         * @param hit index of the hit, 0 is the closest
+         */
+        public float getDistance(int ray, int hit)
+        {
+            return mHits.getFloat(offset(ray, hit) + DISTANCE);
+        }
+
+        /**
+         * Get the hit position in the coordinate system of the collider.
+         * @param ray index of the ray
+         * @param hit index of the hit, 0 is the closest
+         * @param pos array of 3 floats to get the position
+         */
+        public void getHitPosition(int ray, int hit, float[] pos)
+        {
+            getFloats(offset(ray, hit) + HIT_POSITION, pos, 3);
+        }
+
+        /**
+         * Get the index of the face hit, -1 if it is not a mesh collider
+         * with pick coordinates enabled.
+         */
+        public int getFaceIndex(int ray, int hit)
+        {
+            return mHits.getInt(offset(ray, hit) + FACE_INDEX);
+        }
+
+        /**
+         * Get the barycentric coordinates of the hit in the face hit.
+         */
+        public void getBarycentricCoords(int ray, int hit, float[] coords)
+        {
+            getFloats(offset(ray, hit) + BARYCENTRIC, coords, 3);
+        }
+
+        /**
+         * Get the texture coordinates of the hit point.
+         */
+        public void getTextureCoords(int ray, int hit, float[] coords)
+        {
+            getFloats(offset(ray, hit) + TEXCOORD, coords, 2);
+        }
+
+        /**
+         * Get the normal at the hit point.
+         */
+        public void getNormalCoords(int ray, int hit, float[] coords)
+        {
+            getFloats(offset(ray, hit) + NORMAL, coords, 3);
+        }
+
+        /**
+         * Make a picked object from a hit.
+         * This allocates, use the other accessors to avoid that.
+         */
+        public GVRPickedObject getPickedObject(int ray, int hit)
+        {
+            GVRCollider collider = getCollider(ray, hit);
+            if (collider == null)
+            {
+                return null;
+            }
+            float[] pos = new float[3];
+            float[] bary = new float[3];
+            float[] uv = new float[2];
+            float[] normal = new float[3];
+
+            getHitPosition(ray, hit, pos);
+            getBarycentricCoords(ray, hit, bary);
+            getTextureCoords(ray, hit, uv);
+            getNormalCoords(ray, hit, normal);
+            return new GVRPickedObject(collider, pos, getDistance(ray, hit), getFaceIndex(ray, hit),
+                                       bary, uv, normal);
+        }
+
+        private void getFloats(int offset, float[] dest, int count)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                dest[i] = mHits.getFloat(offset + i * 4);
+            }
+        }
+    }
+
     static final ReentrantLock sFindObjectsLock = new ReentrantLock();
+    private static long[] sVolumeResults = new long[64];
 }
 
 final class NativePicker {
@@ -763,11 +1164,18 @@ final class NativePicker {
     static native GVRPicker.GVRPickedObject[] pickObjects(long scene, long transform, float ox, float oy, float oz,
                                                           float dx, float dy, float dz);
 
+    static native int pickSceneBatch(long scene, long transform, float[] rays, int numRays, ByteBuffer hits);
+
+    static native GVRPicker.GVRPickedObject pickClosest(long scene, long transform, float ox, float oy, float oz,
+                                                        float dx, float dy, float dz);
+
     static native GVRPicker.GVRPickedObject pickSceneObject(long sceneObject, float ox, float oy, float oz,
                                                             float dx, float dy, float dz);
 
     static native GVRPicker.GVRPickedObject[] pickVisible(long scene);
 
+    static native int pickVolume(long scene, int volumeType, float[] params, int boundsType, long[] results);
+
     static native boolean pickSceneObjectAgainstBoundingBox(long sceneObject,
                                                             float ox, float oy, float oz, float dx, float dy, float dz, ByteBuffer readbackBuffer);
 }
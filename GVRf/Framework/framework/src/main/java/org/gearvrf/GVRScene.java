@@ -288,6 +288,18 @@ public class GVRScene extends GVRHybridObject implements PrettyPrint, IScriptabl
         NativeScene.setFrustumCulling(getNative(), flag);
     }
 
+    /**
+     * Sets the global level of detail bias for the {@link GVRScene}.
+     * The bias scales the metric used by every {@link GVRLODGroup}
+     * so values greater than 1 select coarser levels. It may be
+     * changed every frame to shed load when the frame rate drops.
+     * @param bias LOD bias, 1 is the default
+     * @see GVRLODGroup
+     */
+    public void setLODBias(float bias) {
+        NativeScene.setLODBias(getNative(), bias);
+    }
+
     /**
      * Sets the occlusion query for the {@link GVRScene}.
      */
@@ -353,6 +365,12 @@ public class GVRScene extends GVRHybridObject implements PrettyPrint, IScriptabl
 
             mStatsConsole.writeLine("Draw Calls: %d", numberDrawCalls);
             mStatsConsole.writeLine("Triangles: %d", numberTriangles);
+            for (int level = 0; level < GVRLODGroup.MAX_LEVELS; ++level) {
+                int lodTriangles = NativeScene.getNumberLODTriangles(getNative(), level);
+                if (lodTriangles > 0) {
+                    mStatsConsole.writeLine("  LOD %d: %d", level, lodTriangles);
+                }
+            }
 
             if (mStatMessage.length() > 0) {
                 String lines[] = mStatMessage.toString().split(System.lineSeparator());
@@ -698,6 +716,10 @@ class NativeScene {
 
     public static native int getNumberTriangles(long scene);
 
+    public static native int getNumberLODTriangles(long scene, int level);
+
+    public static native void setLODBias(long scene, float bias);
+
     public static native void exportToFile(long scene, String file_path);
 
     static native boolean addLight(long scene, long light);
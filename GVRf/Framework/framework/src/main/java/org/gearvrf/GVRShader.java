@@ -61,7 +61,7 @@ public class GVRShader
     protected String mVertexDescriptor;
     protected String mTextureDescriptor;
     protected Map<String, String> mShaderSegments;
-    protected static String sBonesDescriptor = "mat4 u_bone_matrix[" + GVRMesh.MAX_BONES + "]";
+    protected static String sBonesDescriptor = "float4 u_bone_matrix[" + 3 * GVRMesh.MAX_BONES + "]";
 
     protected static String sTransformUBOCode = "layout (std140) uniform Transform_ubo\n{\n"
             + " #ifdef HAS_MULTIVIEW\n"
@@ -0,0 +1,214 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * The joints of an animated hierarchy and the meshes skinned to them.
+ * <p>
+ * The skeleton is posed natively by a {@link GVRAnimationClip}: the
+ * keys are sampled, the joint matrices composed and the bone matrices
+ * of the skinned meshes written without any per-bone work in Java.
+ * <p>
+ * Joints are added parent first and usually correspond to scene objects.
+ * Joints which are not animated by the clip take their pose from their
+ * scene object. Joints added with {@code updateNode} set copy their
+ * animated pose to their scene object so the objects below them move too.
+ * The skeleton is usually attached to the root of the hierarchy it animates.
+ * <p>
+ * Skinned meshes drawn by several passes may be pre-skinned with
+ * {@link #setPreSkinned} so their vertices are skinned once per pose.
+ */
+public final class GVRSkeleton extends GVRComponent {
+    private final List<String> mJointNames = new ArrayList<String>();
+    private final List<GVRSceneObject> mJointObjects = new ArrayList<GVRSceneObject>();
+    private final List<GVRSceneObject> mSkins = new ArrayList<GVRSceneObject>();
+    private final Map<GVRSceneObject, GVRMesh> mPreSkinned = new HashMap<GVRSceneObject, GVRMesh>();
+    private final Map<GVRSceneObject, GVRMesh> mSkinnedMeshes = new HashMap<GVRSceneObject, GVRMesh>();
+
+    public GVRSkeleton(GVRContext gvrContext) {
+        super(gvrContext, NativeSkeleton.ctor());
+    }
+
+    static public long getComponentType() {
+        return NativeSkeleton.getComponentType();
+    }
+
+    /**
+     * Add a joint to the skeleton.
+     *
+     * @param name       name of the joint, matched with animation channels and bones
+     * @param parent     index of the parent joint, -1 for a root joint.
+     *                   The parent must be added before its children.
+     * @param node       scene object for the joint, may be null
+     * @param updateNode true to copy the animated pose of the joint to {@code node}
+     * @return index of the joint or -1 if the parent is not valid
+     */
+    public int addJoint(String name, int parent, GVRSceneObject node, boolean updateNode) {
+        int index = NativeSkeleton.addJoint(getNative(), name, parent,
+                (node != null) ? node.getNative() : 0, updateNode);
+        if (index >= 0) {
+            mJointNames.add(name);
+            mJointObjects.add(node);
+        }
+        return index;
+    }
+
+    /**
+     * Returns the index of the joint with the given name or -1 if there is none.
+     */
+    public int getJointIndex(String name) {
+        return mJointNames.indexOf(name);
+    }
+
+    public int getJointCount() {
+        return mJointNames.size();
+    }
+
+    public GVRSceneObject getJointObject(int joint) {
+        return mJointObjects.get(joint);
+    }
+
+    /**
+     * Skin the mesh of a scene object to this skeleton.
+     *
+     * @param owner      scene object with the skinned mesh
+     * @param boneJoints joint index for each {@link GVRBone} of the mesh, -1 for
+     *                   bones which are not animated
+     * @return false if the mesh does not have one bone for each entry of
+     * {@code boneJoints}
+     */
+    public boolean addSkin(GVRSceneObject owner, int[] boneJoints) {
+        if (NativeSkeleton.addSkin(getNative(), owner.getNative(), boneJoints)) {
+            mSkins.add(owner);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Skin the mesh of a scene object on the CPU instead of in the shaders.
+     * <p>
+     * A skinned mesh is skinned again by the vertex shader of every render
+     * pass, every shadow map and, without multiview, every eye. When it is
+     * pre-skinned its vertices are skinned once each time the skeleton is
+     * posed into a mesh without bones, which the render data of the scene
+     * object draws instead. All the passes then draw static geometry.
+     * The render data gets its original mesh back when pre-skinning is
+     * turned off. If the render data is given another mesh meanwhile,
+     * the skinned mesh is no longer updated and that mesh is kept.
+     *
+     * @param owner  scene object added with {@link #addSkin}
+     * @param enable true to skin on the CPU, false to skin in the shaders
+     * @return false if the mesh of {@code owner} cannot be pre-skinned
+     */
+    public boolean setPreSkinned(GVRSceneObject owner, boolean enable) {
+        GVRRenderData rdata = owner.getRenderData();
+        GVRMesh source = mPreSkinned.get(owner);
+
+        if (!enable) {
+            if (source != null) {
+                GVRMesh skinned = mSkinnedMeshes.remove(owner);
+
+                NativeSkeleton.setPreSkinned(getNative(), owner.getNative(), 0L);
+                mPreSkinned.remove(owner);
+                if ((rdata != null) && (rdata.getMesh() == skinned)) {
+                    rdata.setMesh(source);
+                }
+            }
+            return true;
+        }
+        if (source != null) {
+            return true;
+        }
+        if (!mSkins.contains(owner) || (rdata == null) || (rdata.getMesh() == null)) {
+            return false;
+        }
+        source = rdata.getMesh();
+        GVRVertexBuffer vbuf = source.getVertexBuffer();
+        GVRVertexBuffer skinnedVerts = new GVRVertexBuffer(getGVRContext(),
+                makeSkinnedDescriptor(vbuf.getDescriptor()), vbuf.getVertexCount());
+        GVRMesh skinned = new GVRMesh(skinnedVerts, source.getIndexBuffer());
+
+        if (!NativeSkeleton.setPreSkinned(getNative(), owner.getNative(), skinned.getNative())) {
+            return false;
+        }
+        mPreSkinned.put(owner, source);
+        mSkinnedMeshes.put(owner, skinned);
+        rdata.setMesh(skinned);
+        return true;
+    }
+
+    /**
+     * Returns true if the mesh of a scene object is skinned on the CPU.
+     */
+    public boolean isPreSkinned(GVRSceneObject owner) {
+        return mPreSkinned.containsKey(owner);
+    }
+
+    /*
+     * Layout of a skinned vertex buffer: the bone attributes are
+     * dropped and the skinned positions and normals are not packed.
+     */
+    private static String makeSkinnedDescriptor(String descriptor) {
+        String[] tokens = descriptor.trim().split("[\\s,;]+");
+        StringBuilder skinned = new StringBuilder();
+
+        for (int i = 0; i + 1 < tokens.length; i += 2) {
+            String type = tokens[i];
+            String name = tokens[i + 1];
+
+            if (name.equals("a_bone_weights") || name.equals("a_bone_indices")) {
+                continue;
+            }
+            if (name.equals("a_position") || name.equals("a_normal")) {
+                type = "float3";
+            }
+            skinned.append(type).append(' ').append(name).append(' ');
+        }
+        return skinned.toString();
+    }
+
+    /**
+     * Pose the skeleton with a clip and update the bone
+     * matrices of the skinned meshes.
+     *
+     * @param clip clip bound to this skeleton with {@link GVRAnimationClip#bind}
+     * @param time time in the clip in ticks
+     */
+    public void animate(GVRAnimationClip clip, float time) {
+        NativeSkeleton.animate(getNative(), clip.getNative(), time);
+    }
+}
+
+class NativeSkeleton {
+    static native long ctor();
+
+    static native long getComponentType();
+
+    static native int addJoint(long skeleton, String name, int parent, long sceneObject,
+            boolean updateNode);
+
+    static native boolean addSkin(long skeleton, long sceneObject, int[] boneJoints);
+
+    static native boolean setPreSkinned(long skeleton, long sceneObject, long mesh);
+
+    static native void animate(long skeleton, long clip, float time);
+}
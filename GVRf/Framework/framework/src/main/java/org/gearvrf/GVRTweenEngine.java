@@ -0,0 +1,274 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+import android.util.SparseArray;
+
+import org.gearvrf.animation.GVRAnimationEngine;
+import org.gearvrf.animation.GVRRepeatMode;
+
+/**
+ * Runs large numbers of simple property animations natively.
+ * <p>
+ * A tween animates the position, rotation or scale of a transform
+ * or a float uniform of a material from its current value to an
+ * end value. Unlike the animations run by {@link GVRAnimationEngine},
+ * tweens do not call into Java every frame: they are advanced in
+ * batches natively and each transform is updated once per frame
+ * however many of its properties are animated. Callbacks for tweens
+ * which finished or repeated are delivered together after the frame
+ * is done.
+ * <pre>
+ * GVRTweenEngine tweens = GVRTweenEngine.getInstance(gvrContext);
+ * tweens.position(sceneObject, 0.5f, 0, 1, -3, GVRTweenEngine.EASE_OUT);
+ * </pre>
+ */
+public final class GVRTweenEngine extends GVRHybridObject {
+    public static final int LINEAR = 0;
+    public static final int EASE_IN = 1;
+    public static final int EASE_OUT = 2;
+    /** Same curve as {@link org.gearvrf.animation.GVRAccelerateDecelerateInterpolator} */
+    public static final int EASE_IN_OUT = 3;
+
+    public static final int POSITION = 0;
+    public static final int ROTATION = 1;
+    public static final int SCALE = 2;
+
+    private static final int EVENT_FINISHED = 0;
+    private static final int EVENT_SIZE = 3;
+
+    private static GVRTweenEngine sInstance = null;
+
+    static {
+        GVRContext.addResetOnRestartHandler(new Runnable() {
+
+            @Override
+            public void run() {
+                sInstance = null;
+            }
+        });
+    }
+
+    /**
+     * Called when a tween stops by itself.
+     */
+    public interface OnFinish {
+        void finished(GVRTweenEngine engine, int tween);
+    }
+
+    /**
+     * Called at the end of each cycle of a repeating tween.
+     */
+    public interface OnRepeat extends OnFinish {
+        /**
+         * @param cycles number of cycles completed
+         * @return false to stop the tween where it is
+         */
+        boolean iteration(GVRTweenEngine engine, int tween, int cycles);
+    }
+
+    // Keeps the targets alive and holds the callbacks
+    private static final class Tween {
+        final GVRHybridObject target;
+        final OnFinish onFinish;
+
+        Tween(GVRHybridObject target, OnFinish onFinish) {
+            this.target = target;
+            this.onFinish = onFinish;
+        }
+    }
+
+    private final SparseArray<Tween> mTweens = new SparseArray<Tween>();
+    private int[] mEvents = new int[EVENT_SIZE * 64];
+    private Tween[] mEventTweens = new Tween[64];      // tweens of the events being delivered
+
+    private final GVRDrawFrameListener mOnDrawFrame = new GVRDrawFrameListener() {
+        @Override
+        public void onDrawFrame(float frameTime) {
+            step(frameTime);
+        }
+    };
+
+    private GVRTweenEngine(GVRContext gvrContext) {
+        super(gvrContext, NativeTweenEngine.ctor());
+        gvrContext.registerDrawFrameListener(mOnDrawFrame);
+    }
+
+    /**
+     * Returns the tween engine of the application, created the first time.
+     */
+    public static synchronized GVRTweenEngine getInstance(GVRContext gvrContext) {
+        if (sInstance == null) {
+            sInstance = new GVRTweenEngine(gvrContext);
+        }
+        return sInstance;
+    }
+
+    public int position(GVRSceneObject target, float duration, float x, float y, float z,
+                        int curve) {
+        return transform(POSITION, target.getTransform(), new float[] { x, y, z }, duration,
+                curve, GVRRepeatMode.ONCE, 0, null);
+    }
+
+    public int scale(GVRSceneObject target, float duration, float x, float y, float z,
+                     int curve) {
+        return transform(SCALE, target.getTransform(), new float[] { x, y, z }, duration,
+                curve, GVRRepeatMode.ONCE, 0, null);
+    }
+
+    /**
+     * Tween the rotation along the shortest arc to a quaternion.
+     */
+    public int rotation(GVRSceneObject target, float duration, float w, float x, float y,
+                        float z, int curve) {
+        return transform(ROTATION, target.getTransform(), new float[] { w, x, y, z }, duration,
+                curve, GVRRepeatMode.ONCE, 0, null);
+    }
+
+    public int opacity(GVRMaterial material, float duration, float opacity, int curve) {
+        return uniform(material, "u_opacity", new float[] { opacity }, duration, curve,
+                GVRRepeatMode.ONCE, 0, null);
+    }
+
+    public int color(GVRMaterial material, float duration, float r, float g, float b,
+                     int curve) {
+        return uniform(material, "u_color", new float[] { r, g, b }, duration, curve,
+                GVRRepeatMode.ONCE, 0, null);
+    }
+
+    /**
+     * Start a transform tween.
+     *
+     * @param property    {@link #POSITION}, {@link #ROTATION} or {@link #SCALE}
+     * @param end         end value, x, y, z or w, x, y, z for rotations
+     * @param curve       {@link #LINEAR}, {@link #EASE_IN}, {@link #EASE_OUT} or
+     *                    {@link #EASE_IN_OUT}
+     * @param repeatMode  a {@link GVRRepeatMode} value
+     * @param repeatCount number of cycles for repeating modes, negative to loop
+     * @param onFinish    callback, may be null
+     * @return id of the tween or -1 if the arguments are not valid
+     */
+    public int transform(int property, GVRTransform target, float[] end, float duration,
+                         int curve, int repeatMode, int repeatCount, OnFinish onFinish) {
+        synchronized (mTweens) {
+            int id = NativeTweenEngine.addTransformTween(getNative(), property,
+                    target.getNative(), end, duration, curve, repeatMode, repeatCount);
+            return addTween(id, target, onFinish);
+        }
+    }
+
+    /**
+     * Start a tween of a float uniform of a material.
+     *
+     * @param name uniform with as many floats as {@code end}, up to 4
+     * @return id of the tween or -1 if the material has no such uniform
+     * @see #transform
+     */
+    public int uniform(GVRShaderData material, String name, float[] end, float duration,
+                       int curve, int repeatMode, int repeatCount, OnFinish onFinish) {
+        synchronized (mTweens) {
+            int id = NativeTweenEngine.addUniformTween(getNative(), material.getNative(), name,
+                    end, duration, curve, repeatMode, repeatCount);
+            return addTween(id, material, onFinish);
+        }
+    }
+
+    /*
+     * Ids are reused by the native engine, so they are added
+     * and removed under the same lock as the events are read.
+     */
+    private int addTween(int id, GVRHybridObject target, OnFinish onFinish) {
+        if (id >= 0) {
+            mTweens.put(id, new Tween(target, onFinish));
+        }
+        return id;
+    }
+
+    /**
+     * Stop a tween, leaving the property at its current value.
+     * The callback of the tween is not called.
+     */
+    public void stop(int tween) {
+        synchronized (mTweens) {
+            if (NativeTweenEngine.stop(getNative(), tween)) {
+                mTweens.remove(tween);
+            }
+        }
+    }
+
+    public boolean isRunning(int tween) {
+        return NativeTweenEngine.isRunning(getNative(), tween);
+    }
+
+    private void step(float frameTime) {
+        int numEvents;
+
+        synchronized (mTweens) {
+            numEvents = NativeTweenEngine.step(getNative(), frameTime);
+            if (numEvents == 0) {
+                return;
+            }
+            if (mEvents.length < numEvents * EVENT_SIZE) {
+                mEvents = new int[numEvents * EVENT_SIZE];
+                mEventTweens = new Tween[numEvents];
+            }
+            NativeTweenEngine.getEvents(getNative(), mEvents);
+            for (int e = 0; e < numEvents; ++e) {
+                int id = mEvents[e * EVENT_SIZE];
+
+                mEventTweens[e] = mTweens.get(id);
+                if (mEvents[e * EVENT_SIZE + 1] == EVENT_FINISHED) {
+                    mTweens.remove(id);
+                }
+            }
+        }
+        for (int e = 0; e < numEvents; ++e) {
+            int i = e * EVENT_SIZE;
+            int id = mEvents[i];
+            Tween tween = mEventTweens[e];
+
+            mEventTweens[e] = null;
+            if ((tween == null) || (tween.onFinish == null)) {
+                continue;
+            }
+            if (mEvents[i + 1] == EVENT_FINISHED) {
+                tween.onFinish.finished(this, id);
+            } else if (tween.onFinish instanceof OnRepeat) {
+                if (!((OnRepeat) tween.onFinish).iteration(this, id, mEvents[i + 2])) {
+                    stop(id);
+                }
+            }
+        }
+    }
+}
+
+class NativeTweenEngine {
+    static native long ctor();
+
+    static native int addTransformTween(long engine, int property, long transform, float[] end,
+            float duration, int curve, int repeatMode, int repeatCount);
+
+    static native int addUniformTween(long engine, long material, String name, float[] end,
+            float duration, int curve, int repeatMode, int repeatCount);
+
+    static native boolean stop(long engine, int id);
+
+    static native boolean isRunning(long engine, int id);
+
+    static native int step(long engine, float frameTime);
+
+    static native void getEvents(long engine, int[] events);
+}
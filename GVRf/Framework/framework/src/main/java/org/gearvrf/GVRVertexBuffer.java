@@ -31,6 +31,32 @@ import java.nio.channels.IllegalBlockingModeException;
  * If the mesh uses a normal map for lighting, it will have tangents
  * and bitangents as well. These vertex components correspond to vertex
  * attributes in the OpenGL vertex shader.
+ * <p>
+ * Attributes are usually 32 bit floats or integers but they may be
+ * packed into smaller types to save memory and vertex fetch bandwidth.
+ * Packed attributes are still set and read as floats or integers,
+ * the conversion happens when the data is copied.
+ * <pre>
+ *     halfN        N 16 bit floats, good for positions and texture coordinates
+ *     snorm8xN     N signed bytes in [-1, 1], good for tangents
+ *     snorm16xN    N signed shorts in [-1, 1]
+ *     unorm8xN     N unsigned bytes in [0, 1], good for colors and bone weights
+ *     unorm16xN    N unsigned shorts in [0, 1]
+ *     int8xN       N signed byte integers
+ *     uint8xN      N unsigned byte integers, good for bone indices
+ *     int16xN      N signed short integers
+ *     uint16xN     N unsigned short integers
+ *     octnorm8     unit vector in 2 signed bytes (octahedral encoding), for normals
+ *     octnorm16    unit vector in 2 signed shorts (octahedral encoding), for normals
+ * </pre>
+ * For example, this layout takes 24 bytes per vertex instead of 64:
+ * <pre>
+ *     "half3 a_position half2 a_texcoord octnorm16 a_normal unorm8x4 a_bone_weights uint8x4 a_bone_indices"
+ * </pre>
+ * Each attribute is padded to 4 bytes. The octahedral types are only
+ * decoded by the built-in shaders for "a_normal".
+ * @see #getDataSize()
+ * @see #getUnpackedDataSize()
  */
 public class GVRVertexBuffer extends GVRHybridObject implements PrettyPrint
 {
@@ -380,6 +406,28 @@ public class GVRVertexBuffer extends GVRHybridObject implements PrettyPrint
         return mDescriptor;
     }
 
+    /**
+     * Gets the number of bytes used by the vertex data.
+     * @return vertex size in bytes times the number of vertices
+     * @see #getUnpackedDataSize()
+     */
+    public int getDataSize()
+    {
+        return NativeVertexBuffer.getDataSize(getNative());
+    }
+
+    /**
+     * Gets the number of bytes the vertex data would use if all
+     * attributes were stored as 32 bit floats or integers.
+     * This is the same as {@link #getDataSize()} if no
+     * attributes are packed.
+     * @return unpacked vertex size in bytes times the number of vertices
+     */
+    public int getUnpackedDataSize()
+    {
+        return NativeVertexBuffer.getUnpackedDataSize(getNative());
+    }
+
     /**
      * Gets the number of floats/ints occupied by a particular attribute.
      * For a uniform block, this is the data area size. For a vertex array,
@@ -432,7 +480,8 @@ public class GVRVertexBuffer extends GVRHybridObject implements PrettyPrint
     @Override
     public void prettyPrint(StringBuffer sb, int indent) {
         Integer n = getVertexCount();
-        sb.append(getDescriptor() + " " + n.toString() + " vertices");
+        sb.append(getDescriptor() + " " + n.toString() + " vertices ");
+        sb.append(getDataSize() + " bytes (" + getUnpackedDataSize() + " unpacked)");
         sb.append(System.lineSeparator());
     }
 
@@ -466,6 +515,10 @@ class NativeVertexBuffer {
 
     static native int  getAttributeSize(long vbuf, String name);
 
+    static native int getDataSize(long vbuf);
+
+    static native int getUnpackedDataSize(long vbuf);
+
     static native int getBoundingVolume(long vbuf, FloatBuffer bv);
 
     static native void dump(long vbuf, String attrName);
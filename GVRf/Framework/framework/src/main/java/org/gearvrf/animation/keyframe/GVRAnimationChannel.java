@@ -258,7 +258,7 @@ public final class GVRAnimationChannel implements PrettyPrint {
      * @return the time component
      */
     public double getScaleKeyTime(int keyIndex) {
-        return mRotationKeys[keyIndex].getTime();
+        return mScaleKeys[keyIndex].getTime();
     }
 
 
@@ -19,7 +19,6 @@ public class GVRKeyFrameAnimation extends GVRAnimation implements PrettyPrint {
     protected float mDurationTicks;
     protected List<GVRAnimationChannel> mChannels;
 
-    protected GVRNodeAnimationController mNodeAnimationController;
     protected GVRSkinningController mSkinningController;
 
     protected GVRSceneObject mTarget;
@@ -40,7 +39,6 @@ public class GVRKeyFrameAnimation extends GVRAnimation implements PrettyPrint {
         mTicksPerSecond = ticksPerSecond;
         mChannels = new ArrayList<GVRAnimationChannel>();
 
-        mNodeAnimationController = null;
         mSkinningController = null;
 
         mTarget = target;
@@ -56,10 +54,10 @@ public class GVRKeyFrameAnimation extends GVRAnimation implements PrettyPrint {
 
     /**
      * Must be called after adding all channels.
+     * The skinning controller poses the animated nodes
+     * as well as the bones, natively.
      */
     public void prepare() {
-        mNodeAnimationController = new GVRNodeAnimationController(mTarget, this);
-
         mSkinningController = new GVRSkinningController(mTarget, this);
         mTransforms = new Matrix4f[mChannels.size()];
         for (int i = 0; i < mTransforms.length; ++i) {
@@ -67,6 +65,28 @@ public class GVRKeyFrameAnimation extends GVRAnimation implements PrettyPrint {
         }
     }
 
+    /**
+     * Compress the keys of a prepared animation. Keys which are
+     * interpolated from their neighbors within the tolerances
+     * are dropped and the rest are quantized.
+     *
+     * @param positionTolerance largest position error in scene units
+     * @param rotationTolerance largest rotation error in radians
+     * @param scaleTolerance    largest scale error
+     * @return the compression statistics, see
+     *         {@link GVRAnimationClip#getCompressionStats()}
+     */
+    public float[] compress(float positionTolerance, float rotationTolerance,
+                            float scaleTolerance) {
+        GVRAnimationClip clip = (mSkinningController != null) ? mSkinningController.getClip() : null;
+
+        if (clip == null) {
+            throw new RuntimeException("Animation is not prepared. Call prepare() before compressing.");
+        }
+        clip.compress(positionTolerance, rotationTolerance, scaleTolerance);
+        return clip.getCompressionStats();
+    }
+
     @Override
     public void prettyPrint(StringBuffer sb, int indent) {
         sb.append(Log.getSpaces(indent));
@@ -114,12 +134,10 @@ public class GVRKeyFrameAnimation extends GVRAnimation implements PrettyPrint {
             return;
         }
 
-        if (mNodeAnimationController == null || mSkinningController == null) {
+        if (mSkinningController == null) {
             throw new RuntimeException("Animation is not prepared. Call prepare() before starting.");
         }
 
-        mNodeAnimationController.animate(getDuration() * ratio);
-
         mSkinningController.animate(getDuration() * ratio);
     }
 
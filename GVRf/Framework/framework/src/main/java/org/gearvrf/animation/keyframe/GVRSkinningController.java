@@ -1,50 +1,43 @@
 package org.gearvrf.animation.keyframe;
 
-import java.util.ArrayList;
 import java.util.HashMap;
-import java.util.Iterator;
+import java.util.HashSet;
 import java.util.List;
 import java.util.Map;
-import java.util.Map.Entry;
-import java.util.TreeMap;
+import java.util.Set;
 
+import org.gearvrf.GVRAnimationClip;
 import org.gearvrf.GVRBone;
 import org.gearvrf.GVRContext;
 import org.gearvrf.GVRMesh;
+import org.gearvrf.GVRRenderData;
 import org.gearvrf.GVRSceneObject;
+import org.gearvrf.GVRSkeleton;
 import org.gearvrf.utility.Log;
-import org.joml.Matrix4f;
+import org.joml.Quaternionf;
+import org.joml.Vector3f;
 
 /**
- * Controls skeletal animation (skinning). 
+ * Controls skeletal animation (skinning).
+ * <p>
+ * The hierarchy below the scene root is flattened into a native
+ * {@link GVRSkeleton}, shared by all the animations of the root, and
+ * the channels of the animation are copied into a native
+ * {@link GVRAnimationClip}. Each update is a single native call which
+ * samples the keys, poses the joints, moves the scene objects of all
+ * the animated joints and writes the bone matrices of the meshes.
  */
 public class GVRSkinningController extends GVRAnimationController {
     private static final String TAG = GVRSkinningController.class.getSimpleName();
 
-    protected GVRContext gvrContext;
-    protected GVRSceneObject sceneRoot;
+    /* What the subtree of a scene object contains */
+    private static final int HAS_BONE = 1;
+    private static final int HAS_RENDER_DATA = 2;
+    private static final int HAS_CHANNEL = 4;
 
-    protected SceneAnimNode animRoot;
-    protected Map<String, SceneAnimNode> nodeByName;
-    protected Map<GVRSceneObject, List<GVRBone>> boneMap;
-
-    protected class SceneAnimNode {
-        GVRSceneObject sceneObject;
-        SceneAnimNode parent;
-        List<SceneAnimNode> children;
-        Matrix4f localTransform;
-        Matrix4f globalTransform;
-        int channelId;
-
-        SceneAnimNode(GVRSceneObject sceneObject, SceneAnimNode parent) {
-            this.sceneObject = sceneObject;
-            this.parent = parent;
-            children = new ArrayList<SceneAnimNode>();
-            localTransform = new Matrix4f();
-            globalTransform = new Matrix4f();
-            channelId = -1;
-        }
-    }
+    protected GVRSceneObject sceneRoot;
+    protected GVRSkeleton skeleton;
+    protected GVRAnimationClip clip;
 
     /**
      * Constructs the skeleton for a list of {@link GVRSceneObject}.
@@ -56,127 +49,209 @@ public class GVRSkinningController extends GVRAnimationController {
         super(animation);
         this.sceneRoot = sceneRoot;
 
-        nodeByName = new TreeMap<String, SceneAnimNode>();
-        boneMap = new HashMap<GVRSceneObject, List<GVRBone>>();
+        GVRContext gvrContext = sceneRoot.getGVRContext();
+        skeleton = (GVRSkeleton) sceneRoot.getComponent(GVRSkeleton.getComponentType());
+        if (skeleton == null) {
+            skeleton = createSkeleton(gvrContext, sceneRoot, animation);
+            sceneRoot.attachComponent(skeleton);
+        } else if (animation != null) {
+            addChannelJoints(skeleton, sceneRoot, animation);
+        }
+        if (animation != null) {
+            clip = createClip(gvrContext, animation);
+            clip.bind(skeleton);
+        }
+    }
 
-        animRoot = createAnimationTree(sceneRoot, null);
-        pruneTree(animRoot);
+    /**
+     * Returns the skeleton posed by this controller.
+     */
+    public GVRSkeleton getSkeleton() {
+        return skeleton;
     }
 
-    protected SceneAnimNode createAnimationTree(GVRSceneObject node, SceneAnimNode parent) {
-        SceneAnimNode internalNode = new SceneAnimNode(node, parent);
-        nodeByName.put(node.getName(), internalNode);
+    /**
+     * Returns the native clip of the animation, null if there is none.
+     */
+    public GVRAnimationClip getClip() {
+        return clip;
+    }
 
-        // Bind-pose local transform
-        internalNode.localTransform.set(node.getTransform().getLocalModelMatrix4f());
-        internalNode.globalTransform.set(internalNode.localTransform);
+    /**
+     * Builds a skeleton from the scene objects which are bones, are
+     * animated or have meshes below them, parents first.
+     */
+    protected GVRSkeleton createSkeleton(GVRContext gvrContext, GVRSceneObject root,
+                                         GVRKeyFrameAnimation animation) {
+        GVRSkeleton skel = new GVRSkeleton(gvrContext);
+        Set<String> boneNames = new HashSet<String>();
+        Set<String> channelNames = new HashSet<String>();
+        Map<GVRSceneObject, Integer> contents = new HashMap<GVRSceneObject, Integer>();
+
+        collectBoneNames(root, boneNames);
+        collectChannelNames(animation, channelNames);
+        scanTree(root, boneNames, channelNames, contents);
+        addJoints(skel, root, -1, contents, new HashMap<GVRSceneObject, Integer>());
+        addSkins(skel, root);
+        return skel;
+    }
 
-        // Global transform
-        if (parent != null) {
-            parent.globalTransform.mul(internalNode.globalTransform, internalNode.globalTransform);
+    /**
+     * Adds the scene objects animated by another animation, and
+     * their parents, to a skeleton built for the same hierarchy.
+     */
+    protected void addChannelJoints(GVRSkeleton skel, GVRSceneObject root,
+                                    GVRKeyFrameAnimation animation) {
+        Set<String> channelNames = new HashSet<String>();
+        Map<GVRSceneObject, Integer> contents = new HashMap<GVRSceneObject, Integer>();
+        Map<GVRSceneObject, Integer> joints = new HashMap<GVRSceneObject, Integer>();
+
+        collectChannelNames(animation, channelNames);
+        scanTree(root, new HashSet<String>(), channelNames, contents);
+        for (int i = 0; i < skel.getJointCount(); ++i) {
+            GVRSceneObject node = skel.getJointObject(i);
+            if (node != null) {
+                joints.put(node, i);
+            }
         }
+        addJoints(skel, root, -1, contents, joints);
+    }
 
-        // Find channel Id
+    protected void collectChannelNames(GVRKeyFrameAnimation animation, Set<String> channelNames) {
         if (animation != null) {
-            internalNode.channelId = animation.findChannel(node.getName());
+            for (GVRAnimationChannel channel : animation.mChannels) {
+                channelNames.add(channel.getNodeName());
+            }
         }
+    }
 
-        setupBone(node, internalNode);
-
+    protected void collectBoneNames(GVRSceneObject node, Set<String> boneNames) {
+        GVRMesh mesh = getMesh(node);
+        if (mesh != null) {
+            for (GVRBone bone : mesh.getBones()) {
+                boneNames.add(bone.getName());
+            }
+        }
         for (GVRSceneObject child : node.getChildren()) {
-            SceneAnimNode animChild = createAnimationTree(child, internalNode);
-            internalNode.children.add(animChild);
+            collectBoneNames(child, boneNames);
         }
-
-        return internalNode;
     }
 
-    protected void setupBone(GVRSceneObject node, SceneAnimNode internalNode) {
-        GVRMesh mesh;
-        if (node.getRenderData() != null && (mesh = node.getRenderData().getMesh()) != null) {
-            Log.v(TAG, "setupBone checking mesh with %d vertices", mesh.getVertexBuffer().getVertexCount());
-            for (GVRBone bone : mesh.getBones()) {
-                bone.setSceneObject(node);
-
-                GVRSceneObject skeletalNode = sceneRoot.getSceneObjectByName(bone.getName());
-                if (skeletalNode == null) {
-                    Log.w(TAG, "what? cannot find the skeletal node for bone: %s", bone.toString());
-                    continue;
-                }
+    protected int scanTree(GVRSceneObject node, Set<String> boneNames, Set<String> channelNames,
+                           Map<GVRSceneObject, Integer> contents) {
+        int flags = 0;
 
-                // Create look-up table for bones
-                List<GVRBone> boneList = boneMap.get(skeletalNode);
-                if (boneList == null) {
-                    boneList = new ArrayList<GVRBone>();
-                    boneMap.put(skeletalNode, boneList);
-                }
-                boneList.add(bone);
-            }
+        if (boneNames.contains(node.getName())) {
+            flags |= HAS_BONE;
+        }
+        if (channelNames.contains(node.getName())) {
+            flags |= HAS_CHANNEL;
         }
+        if (node.getRenderData() != null) {
+            flags |= HAS_RENDER_DATA;
+        }
+        for (GVRSceneObject child : node.getChildren()) {
+            flags |= scanTree(child, boneNames, channelNames, contents);
+        }
+        contents.put(node, flags);
+        return flags;
     }
 
-    /**
-     * Update bone transforms for the specified tick.
+    /*
+     * Every joint moves its scene object when it is animated, so
+     * objects attached to bones or added below animated nodes later
+     * follow the animation. Scene objects in joints are not added again.
      */
-    @Override
-    protected void animateImpl(float animationTick) {
-        Matrix4f[] animationTransform = animation.getTransforms(animationTick);
-
-        updateTransforms(animRoot, new Matrix4f(), animationTransform);
+    protected void addJoints(GVRSkeleton skel, GVRSceneObject node, int parent,
+                             Map<GVRSceneObject, Integer> contents,
+                             Map<GVRSceneObject, Integer> joints) {
+        Integer flags = contents.get(node);
+        if ((flags == null) || (flags == 0)) {
+            return;
+        }
 
-        for (Entry<GVRSceneObject, List<GVRBone>> ent : boneMap.entrySet()) {
-            // Transform all bone splits (a bone can be split into multiple instances if they influence
-            // different meshes)
-            SceneAnimNode node = nodeByName.get(ent.getKey().getName());
-            for (GVRBone bone : ent.getValue()) {
-                updateBoneMatrices(bone, node);
-            }
+        Integer joint = joints.get(node);
+        if (joint == null) {
+            joint = skel.addJoint(node.getName(), parent, node, true);
+        }
+        for (GVRSceneObject child : node.getChildren()) {
+            addJoints(skel, child, joint, contents, joints);
         }
     }
 
-    protected void updateTransforms(SceneAnimNode node, Matrix4f parentTransform, Matrix4f[] animationTransform) {
-        if (node.channelId != -1) {
-            node.localTransform.set(animationTransform[node.channelId]);
-        } else {
-            // Default local transform
-            node.localTransform.set(node.sceneObject.getTransform().getLocalModelMatrix4f());
+    protected void addSkins(GVRSkeleton skel, GVRSceneObject node) {
+        GVRMesh mesh = getMesh(node);
+        if (mesh != null) {
+            List<GVRBone> bones = mesh.getBones();
+            if (!bones.isEmpty()) {
+                int[] boneJoints = new int[bones.size()];
+                for (int i = 0; i < boneJoints.length; ++i) {
+                    GVRBone bone = bones.get(i);
+
+                    bone.setSceneObject(node);
+                    boneJoints[i] = skel.getJointIndex(bone.getName());
+                    if (boneJoints[i] < 0) {
+                        Log.w(TAG, "what? cannot find the skeletal node for bone: %s", bone.toString());
+                    }
+                }
+                skel.addSkin(node, boneJoints);
+            }
         }
-
-        parentTransform.mul(node.localTransform, node.globalTransform);
-
-        for (SceneAnimNode child : node.children) {
-            updateTransforms(child, node.globalTransform, animationTransform);
+        for (GVRSceneObject child : node.getChildren()) {
+            addSkins(skel, child);
         }
     }
 
-    protected void updateBoneMatrices(GVRBone bone, SceneAnimNode node) {
-        Matrix4f finalMatrix = new Matrix4f().set(bone.getOffsetMatrix());
-
-        node.globalTransform.mul(finalMatrix, finalMatrix);
-
-        Matrix4f globalInverse = new Matrix4f().set(bone.getSceneObject().getTransform().getModelMatrix4f()).invert();
-        globalInverse.mul(finalMatrix, finalMatrix);
-
-        bone.setFinalTransformMatrix(finalMatrix);
+    protected GVRAnimationClip createClip(GVRContext gvrContext, GVRKeyFrameAnimation animation) {
+        GVRAnimationClip animClip = new GVRAnimationClip(gvrContext);
+
+        for (GVRAnimationChannel channel : animation.mChannels) {
+            float[] posKeys = new float[channel.getNumPosKeys() * GVRAnimationClip.POSITION_KEY_SIZE];
+            float[] rotKeys = new float[channel.getNumRotKeys() * GVRAnimationClip.ROTATION_KEY_SIZE];
+            float[] scaleKeys = new float[channel.getNumScaleKeys() * GVRAnimationClip.SCALE_KEY_SIZE];
+            int k = 0;
+
+            for (int i = 0; i < channel.getNumPosKeys(); ++i) {
+                Vector3f pos = channel.getPosKeyVector(i);
+                posKeys[k++] = (float) channel.getPosKeyTime(i);
+                posKeys[k++] = pos.x;
+                posKeys[k++] = pos.y;
+                posKeys[k++] = pos.z;
+            }
+            k = 0;
+            for (int i = 0; i < channel.getNumRotKeys(); ++i) {
+                Quaternionf rot = channel.getRotKeyQuaternion(i);
+                rotKeys[k++] = (float) channel.getRotKeyTime(i);
+                rotKeys[k++] = rot.x;
+                rotKeys[k++] = rot.y;
+                rotKeys[k++] = rot.z;
+                rotKeys[k++] = rot.w;
+            }
+            k = 0;
+            for (int i = 0; i < channel.getNumScaleKeys(); ++i) {
+                Vector3f scale = channel.getScaleKeyVector(i);
+                scaleKeys[k++] = (float) channel.getScaleKeyTime(i);
+                scaleKeys[k++] = scale.x;
+                scaleKeys[k++] = scale.y;
+                scaleKeys[k++] = scale.z;
+            }
+            animClip.addChannel(channel.getNodeName(), posKeys, rotKeys, scaleKeys);
+        }
+        return animClip;
     }
 
-    /* Returns true if the subtree should be kept */
-    protected boolean pruneTree(SceneAnimNode node) {
-        boolean keep = node.channelId != -1;
-        if (keep) {
-            return keep;
-        }
+    private static GVRMesh getMesh(GVRSceneObject node) {
+        GVRRenderData rdata = node.getRenderData();
+        return (rdata != null) ? rdata.getMesh() : null;
+    }
 
-        Iterator<SceneAnimNode> iter = node.children.iterator();
-        while (iter.hasNext()) {
-            SceneAnimNode child = iter.next();
-            boolean keepChild = pruneTree(child);
-            keep |= keepChild;
-            if (!keepChild) {
-                iter.remove();
-            }
+    /**
+     * Update bone transforms for the specified tick.
+     */
+    @Override
+    protected void animateImpl(float animationTick) {
+        if (clip != null) {
+            skeleton.animate(clip, animationTick);
         }
-
-        return keep;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,147 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library - Java Binding (jassimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2012, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms, 
+with or without modification, are permitted provided that the following 
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+package org.gearvrf.jassimp;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+
+
+/**
+ * A morph target of a mesh.<p>
+ * 
+ * The positions and normals of an animated mesh replace the ones
+ * of the mesh it belongs to. Either of them may be missing.
+ */
+public final class AiAnimMesh {
+    /**
+     * Constructor.
+     */
+    AiAnimMesh() {
+        /* nothing to do */
+    }
+    
+    
+    /**
+     * Returns the number of vertices, the same as the mesh.
+     * 
+     * @return the number of vertices
+     */
+    public int getNumVertices() {
+        return m_numVertices;
+    }
+    
+    
+    /**
+     * Returns a buffer containing the vertex positions, 
+     * <code>3 * getNumVertices()</code> floats.
+     * 
+     * @return a native-order direct buffer, or null if no data is available
+     */
+    public FloatBuffer getPositionBuffer() {
+        if (m_vertices == null) {
+            return null;
+        }
+        
+        return m_vertices.asFloatBuffer();
+    }
+    
+    
+    /**
+     * Returns a buffer containing the normals,
+     * <code>3 * getNumVertices()</code> floats.
+     * 
+     * @return a native-order direct buffer, or null if no data is available
+     */
+    public FloatBuffer getNormalBuffer() {
+        if (m_normals == null) {
+            return null;
+        }
+        
+        return m_normals.asFloatBuffer();
+    }
+    
+    
+    /**
+     * This method is used by JNI. Do not call or modify.<p>
+     * 
+     * Allocates the byte buffers of the animated mesh.
+     * 
+     * @param numVertices the number of vertices
+     * @param positions true to allocate positions
+     * @param normals true to allocate normals
+     */
+    @SuppressWarnings("unused")
+    private void allocateBuffers(int numVertices, boolean positions, 
+            boolean normals) {
+        m_numVertices = numVertices;
+        
+        if (positions) {
+            m_vertices = ByteBuffer.allocateDirect(numVertices * 3 * 
+                    Jassimp.NATIVE_FLOAT_SIZE);
+            m_vertices.order(ByteOrder.nativeOrder());
+        }
+        
+        if (normals) {
+            m_normals = ByteBuffer.allocateDirect(numVertices * 3 * 
+                    Jassimp.NATIVE_FLOAT_SIZE);
+            m_normals.order(ByteOrder.nativeOrder());
+        }
+    }
+    
+    
+    /**
+     * Number of vertices.
+     */
+    private int m_numVertices = 0;
+    
+    
+    /**
+     * Buffer for vertex position data.
+     */
+    private ByteBuffer m_vertices = null;
+    
+    
+    /**
+     * Buffer for normals.
+     */
+    private ByteBuffer m_normals = null;
+}
@@ -315,6 +315,16 @@ public final class AiMesh {
     }
     
     
+    /**
+     * Returns the morph targets of this mesh.
+     * 
+     * @return a list of animated meshes, empty if there are none
+     */
+    public List<AiAnimMesh> getAnimMeshes() {
+        return m_animMeshes;
+    }
+    
+    
     /**
      * Returns the number of vertices in this mesh.
      * 
@@ -1430,4 +1440,10 @@ public final class AiMesh {
      * Bones.
      */
     private final List<AiBone> m_bones = new ArrayList<AiBone>();
+    
+    
+    /**
+     * Morph targets.
+     */
+    private final List<AiAnimMesh> m_animMeshes = new ArrayList<AiAnimMesh>();
 }
@@ -883,6 +883,69 @@ static bool loadMeshes(JNIEnv *env, const aiScene* cScene, jobject& jScene)
 				}
 			}
 		}
+
+
+		/* push morph targets to java */
+		for (unsigned int a = 0; a < cMesh->mNumAnimMeshes; a++)
+		{
+			aiAnimMesh *cAnimMesh = cMesh->mAnimMeshes[a];
+
+			if ((cAnimMesh->mNumVertices != cMesh->mNumVertices) ||
+				(!cAnimMesh->HasPositions() && !cAnimMesh->HasNormals()))
+			{
+				continue;
+			}
+
+			jobject jAnimMesh;
+			SmartLocalRef refAnimMesh(env, jAnimMesh);
+			if (!createInstance(env, "org/gearvrf/jassimp/AiAnimMesh", jAnimMesh))
+			{
+				return false;
+			}
+
+			jvalue allocateParams[3];
+			allocateParams[0].i = cAnimMesh->mNumVertices;
+			allocateParams[1].z = cAnimMesh->HasPositions();
+			allocateParams[2].z = cAnimMesh->HasNormals();
+			if (!callv(env, jAnimMesh, "org/gearvrf/jassimp/AiAnimMesh", "allocateBuffers", "(IZZ)V", allocateParams))
+			{
+				return false;
+			}
+
+			if (cAnimMesh->HasPositions() &&
+				!copyBuffer(env, jAnimMesh, "m_vertices", cAnimMesh->mVertices, cAnimMesh->mNumVertices * sizeof(aiVector3D)))
+			{
+				lprintf("could not copy morph target vertex data\n");
+				return false;
+			}
+
+			if (cAnimMesh->HasNormals() &&
+				!copyBuffer(env, jAnimMesh, "m_normals", cAnimMesh->mNormals, cAnimMesh->mNumVertices * 3 * sizeof(float)))
+			{
+				lprintf("could not copy morph target normal data\n");
+				return false;
+			}
+
+			/* add morph target to list */
+			jobject jAnimMeshes = NULL;
+			SmartLocalRef refAnimMeshes(env, jAnimMeshes);
+			if (!getField(env, jMesh, "m_animMeshes", "Ljava/util/List;", jAnimMeshes))
+			{
+				return false;
+			}
+
+			jvalue addParams[1];
+			addParams[0].l = jAnimMesh;
+			if (!call(env, jAnimMeshes, "java/util/Collection", "add", "(Ljava/lang/Object;)Z", addParams))
+			{
+				return false;
+			}
+		}
+
+		if (cMesh->mNumAnimMeshes > 0)
+		{
+			lprintf("    with %u morph targets\n", cMesh->mNumAnimMeshes);
+		}
 	}
 
 	return true;
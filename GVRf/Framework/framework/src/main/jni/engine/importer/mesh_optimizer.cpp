@@ -0,0 +1,475 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Reorders mesh triangles and vertices for faster rendering.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "objects/mesh.h"
+#include "objects/vertex_buffer.h"
+#include "objects/index_buffer.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+namespace {
+
+const unsigned int INVALID = ~0u;
+
+/*
+ * Scoring parameters from Forsyth's reference implementation.
+ * The cache simulated while ordering is an LRU larger than the
+ * hardware FIFO so the ordering works for a range of cache sizes.
+ */
+const int SCORE_CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRI_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+/*
+ * Vertex fetch is simulated with a direct mapped cache.
+ */
+const int FETCH_LINE_SIZE = 64;
+const int FETCH_CACHE_LINES = 64;
+
+const int VALENCE_TABLE_SIZE = 32;
+
+/*
+ * Score of a vertex from its position in the simulated cache
+ * and the number of triangles still using it. Both terms are
+ * precomputed since they are evaluated for every cache entry
+ * after each triangle.
+ */
+struct VertexScorer {
+    float cache_scores[SCORE_CACHE_SIZE];
+    float valence_scores[VALENCE_TABLE_SIZE];
+
+    VertexScorer() {
+        float scale = 1.0f / (SCORE_CACHE_SIZE - 3);
+        for (int i = 0; i < SCORE_CACHE_SIZE; ++i) {
+            cache_scores[i] = (i < 3) ? LAST_TRI_SCORE :
+                              std::pow(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+        }
+        valence_scores[0] = 0;
+        for (int i = 1; i < VALENCE_TABLE_SIZE; ++i) {
+            valence_scores[i] = VALENCE_BOOST_SCALE * std::pow((float) i, -VALENCE_BOOST_POWER);
+        }
+    }
+
+    float score(int cache_pos, unsigned int remaining) const {
+        if (remaining == 0) {
+            return -1;
+        }
+        float s = (cache_pos >= 0) ? cache_scores[cache_pos] : 0;
+        if (remaining < VALENCE_TABLE_SIZE) {
+            return s + valence_scores[remaining];
+        }
+        return s + VALENCE_BOOST_SCALE * std::pow((float) remaining, -VALENCE_BOOST_POWER);
+    }
+};
+
+/*
+ * FIFO post-transform cache simulated with timestamps:
+ * a vertex is in the cache if fewer than CACHE_SIZE misses
+ * happened since it was loaded.
+ */
+struct FifoCache {
+    std::vector<unsigned int> timestamps;
+    unsigned int time;
+    unsigned int size;
+
+    FifoCache(int vertex_count, int cache_size)
+            : timestamps(vertex_count, 0), time(cache_size + 1), size(cache_size) {
+    }
+
+    void reset() {
+        time += size + 1;
+    }
+
+    int misses(const unsigned int* tri) {
+        int n = 0;
+        for (int j = 0; j < 3; ++j) {
+            unsigned int v = tri[j];
+            if (time - timestamps[v] > size) {
+                timestamps[v] = time++;
+                ++n;
+            }
+        }
+        return n;
+    }
+};
+
+struct Cluster {
+    int start;
+    int end;
+    float sort_key;
+};
+
+}
+
+void MeshOptimizer::optimizeVertexCache(unsigned int* dest, const unsigned int* indices,
+                                        int index_count, int vertex_count) {
+    int face_count = index_count / 3;
+    std::vector<unsigned int> live(vertex_count, 0);
+    std::vector<unsigned int> offsets(vertex_count + 1, 0);
+    std::vector<unsigned int> adjacency(face_count * 3);
+    std::vector<float> vertex_scores(vertex_count);
+    std::vector<float> tri_scores(face_count);
+    std::vector<unsigned char> emitted(face_count, 0);
+    unsigned int cache[SCORE_CACHE_SIZE + 3];
+    unsigned int new_cache[SCORE_CACHE_SIZE + 3];
+    int cache_count = 0;
+    const VertexScorer scorer;
+
+    if (face_count == 0) {
+        return;
+    }
+
+    /*
+     * Triangles around each vertex, the first live[v] entries
+     * of a vertex are the triangles not yet emitted.
+     */
+    for (int i = 0; i < face_count * 3; ++i) {
+        ++live[indices[i]];
+    }
+    for (int v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (int i = 0; i < face_count * 3; ++i) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+    for (int v = 0; v < vertex_count; ++v) {
+        vertex_scores[v] = scorer.score(-1, live[v]);
+    }
+    int best = 0;
+    for (int t = 0; t < face_count; ++t) {
+        const unsigned int* tri = indices + t * 3;
+        tri_scores[t] = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+        if (tri_scores[t] > tri_scores[best]) {
+            best = t;
+        }
+    }
+
+    int input_cursor = 0;
+    for (int out = 0; out < face_count; ++out) {
+        if (best < 0) {
+            /*
+             * Dead end, continue with the next triangle in input order.
+             */
+            while (emitted[input_cursor]) {
+                ++input_cursor;
+            }
+            best = input_cursor;
+        }
+        const unsigned int* tri = indices + best * 3;
+        int new_count = 0;
+
+        memcpy(dest + out * 3, tri, 3 * sizeof(unsigned int));
+        emitted[best] = 1;
+        for (int j = 0; j < 3; ++j) {
+            unsigned int v = tri[j];
+            unsigned int* begin = &adjacency[offsets[v]];
+            unsigned int* end = begin + live[v];
+            unsigned int* it = std::find(begin, end, (unsigned int) best);
+
+            if (it != end) {
+                *it = *(end - 1);
+                --live[v];
+            }
+            new_cache[new_count++] = v;
+        }
+        for (int i = 0; i < cache_count; ++i) {
+            unsigned int v = cache[i];
+            if ((v != tri[0]) && (v != tri[1]) && (v != tri[2])) {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        /*
+         * Update the scores of the vertices in the cache and of the
+         * triangles around them, vertices pushed out of the cache
+         * lose their cache score.
+         */
+        for (int i = 0; i < new_count; ++i) {
+            unsigned int v = new_cache[i];
+            float score = scorer.score((i < SCORE_CACHE_SIZE) ? i : -1, live[v]);
+            float delta = score - vertex_scores[v];
+
+            vertex_scores[v] = score;
+            for (unsigned int k = offsets[v]; k < offsets[v] + live[v]; ++k) {
+                tri_scores[adjacency[k]] += delta;
+            }
+        }
+
+        /*
+         * The next triangle is the best one using a cached vertex.
+         */
+        float best_score = -1;
+        best = -1;
+        for (int i = 0; (i < new_count) && (i < SCORE_CACHE_SIZE); ++i) {
+            unsigned int v = new_cache[i];
+            for (unsigned int k = offsets[v]; k < offsets[v] + live[v]; ++k) {
+                unsigned int t = adjacency[k];
+                if (tri_scores[t] > best_score) {
+                    best_score = tri_scores[t];
+                    best = t;
+                }
+            }
+        }
+        cache_count = std::min(new_count, SCORE_CACHE_SIZE);
+        memcpy(cache, new_cache, cache_count * sizeof(unsigned int));
+    }
+}
+
+void MeshOptimizer::optimizeOverdraw(unsigned int* dest, const unsigned int* indices, int index_count,
+                                     const float* positions, int vertex_count, int stride,
+                                     float threshold) {
+    int face_count = index_count / 3;
+    std::vector<int> hard;
+    std::vector<Cluster> clusters;
+    FifoCache cache(vertex_count, CACHE_SIZE);
+
+    if (face_count == 0) {
+        return;
+    }
+
+    /*
+     * Hard boundaries are where the cache was effectively flushed,
+     * reordering there cannot make cache reuse worse.
+     */
+    for (int t = 0; t < face_count; ++t) {
+        if ((cache.misses(indices + t * 3) == 3) || (t == 0)) {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(face_count);
+
+    /*
+     * Soft boundaries split hard clusters further as long as the
+     * cache miss ratio stays within the threshold of the cluster's.
+     */
+    for (int h = 0; h + 1 < hard.size(); ++h) {
+        int start = hard[h];
+        int end = hard[h + 1];
+        int misses = 0;
+
+        cache.reset();
+        for (int t = start; t < end; ++t) {
+            misses += cache.misses(indices + t * 3);
+        }
+        float cluster_threshold = threshold * misses / (end - start);
+
+        cache.reset();
+        misses = 0;
+        for (int t = start; t < end; ++t) {
+            misses += cache.misses(indices + t * 3);
+            if ((t + 1 < end) && ((float) misses / (t - start + 1) <= cluster_threshold)) {
+                clusters.push_back({ start, t + 1, 0 });
+                start = t + 1;
+                misses = 0;
+                cache.reset();
+            }
+        }
+        clusters.push_back({ start, end, 0 });
+    }
+
+    /*
+     * Sort clusters by how much they face away from the mesh center.
+     */
+    std::vector<glm::vec3> centroids(clusters.size());
+    std::vector<glm::vec3> normals(clusters.size());
+    glm::vec3 mesh_center(0);
+    float mesh_area = 0;
+
+    for (int c = 0; c < clusters.size(); ++c) {
+        glm::vec3 center(0);
+        glm::vec3 normal(0);
+        float area = 0;
+
+        for (int t = clusters[c].start; t < clusters[c].end; ++t) {
+            const unsigned int* tri = indices + t * 3;
+            glm::vec3 p0 = glm::make_vec3(positions + tri[0] * stride);
+            glm::vec3 p1 = glm::make_vec3(positions + tri[1] * stride);
+            glm::vec3 p2 = glm::make_vec3(positions + tri[2] * stride);
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+
+            center += (p0 + p1 + p2) * (a / 3);
+            normal += n;
+            area += a;
+        }
+        centroids[c] = (area > 0) ? center / area : center;
+        float len = glm::length(normal);
+        normals[c] = (len > 0) ? normal / len : normal;
+        mesh_center += center;
+        mesh_area += area;
+    }
+    if (mesh_area > 0) {
+        mesh_center /= mesh_area;
+    }
+    for (int c = 0; c < clusters.size(); ++c) {
+        clusters[c].sort_key = glm::dot(centroids[c] - mesh_center, normals[c]);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sort_key > b.sort_key;
+    });
+
+    int out = 0;
+    for (const Cluster& c : clusters) {
+        int n = (c.end - c.start) * 3;
+        memcpy(dest + out, indices + c.start * 3, n * sizeof(unsigned int));
+        out += n;
+    }
+}
+
+int MeshOptimizer::optimizeVertexFetch(unsigned int* order, unsigned int* indices,
+                                       int index_count, int vertex_count) {
+    std::vector<unsigned int> remap(vertex_count, INVALID);
+    int next = 0;
+
+    for (int i = 0; i < index_count; ++i) {
+        unsigned int v = indices[i];
+        if (remap[v] == INVALID) {
+            order[next] = v;
+            remap[v] = next++;
+        }
+        indices[i] = remap[v];
+    }
+    int used = next;
+    for (int v = 0; v < vertex_count; ++v) {
+        if (remap[v] == INVALID) {
+            order[next++] = v;
+        }
+    }
+    return used;
+}
+
+MeshOptimizer::Stats MeshOptimizer::analyze(const unsigned int* indices, int index_count,
+                                            int vertex_count, int vertex_size) {
+    Stats stats = { 0, 0, 0 };
+    FifoCache cache(vertex_count, CACHE_SIZE);
+    std::vector<unsigned char> used(vertex_count, 0);
+    int lines[FETCH_CACHE_LINES];
+    int face_count = index_count / 3;
+    int misses = 0;
+    int unique = 0;
+    long long fetched = 0;
+
+    if ((face_count == 0) || (vertex_size <= 0)) {
+        return stats;
+    }
+    for (int i = 0; i < FETCH_CACHE_LINES; ++i) {
+        lines[i] = -1;
+    }
+    for (int t = 0; t < face_count; ++t) {
+        misses += cache.misses(indices + t * 3);
+    }
+    for (int i = 0; i < face_count * 3; ++i) {
+        unsigned int v = indices[i];
+        long long first = (long long) v * vertex_size / FETCH_LINE_SIZE;
+        long long last = ((long long) (v + 1) * vertex_size - 1) / FETCH_LINE_SIZE;
+
+        if (!used[v]) {
+            used[v] = 1;
+            ++unique;
+        }
+        for (long long l = first; l <= last; ++l) {
+            int slot = (int) (l % FETCH_CACHE_LINES);
+            if (lines[slot] != (int) l) {
+                lines[slot] = (int) l;
+                fetched += FETCH_LINE_SIZE;
+            }
+        }
+    }
+    stats.acmr = (float) misses / face_count;
+    stats.atvr = (float) misses / unique;
+    stats.overfetch = (float) fetched / ((long long) unique * vertex_size);
+    return stats;
+}
+
+bool MeshOptimizer::optimize(Mesh& mesh, float overdraw_threshold, Stats* before, Stats* after) {
+    VertexBuffer* vbuf = mesh.getVertexBuffer();
+    IndexBuffer* ibuf = mesh.getIndexBuffer();
+    int index, offset, size;
+
+    if ((ibuf == nullptr) || (ibuf->getIndexCount() == 0)) {
+        LOGE("MeshOptimizer: mesh does not have indices");
+        return false;
+    }
+    if ((vbuf == nullptr) || !vbuf->getInfo("a_position", index, offset, size)) {
+        LOGE("MeshOptimizer: mesh does not have positions");
+        return false;
+    }
+    std::vector<unsigned int> indices;
+    int vertex_count = vbuf->getVertexCount();
+    int vertex_size = vbuf->getTotalSize();
+
+    MeshSimplifier::getIndices(mesh, indices);
+    int index_count = indices.size() - (indices.size() % 3);
+    Stats stats = analyze(indices.data(), index_count, vertex_count, vertex_size);
+    if (before) {
+        *before = stats;
+    }
+
+    std::vector<unsigned int> optimized(indices.size());
+    std::vector<unsigned int> order(vertex_count);
+
+    optimizeVertexCache(optimized.data(), indices.data(), index_count, vertex_count);
+    if (overdraw_threshold > 0) {
+        std::vector<float> unpacked;
+        int stride;
+        const float* positions = vbuf->getFloatData("a_position", unpacked, stride);
+        optimizeOverdraw(indices.data(), optimized.data(), index_count,
+                         positions, vertex_count, stride, overdraw_threshold);
+    } else {
+        std::copy(optimized.begin(), optimized.begin() + index_count, indices.begin());
+    }
+    optimizeVertexFetch(order.data(), indices.data(), indices.size(), vertex_count);
+
+    if (!vbuf->copyVertices(*vbuf, order.data(), vertex_count)) {
+        return false;
+    }
+    mesh.getMorphTargets().remapVertices(order.data(), vertex_count);
+    bool ok;
+    if (ibuf->getIndexSize() == sizeof(unsigned short)) {
+        std::vector<unsigned short> shortindices(indices.begin(), indices.end());
+        ok = ibuf->setShortVec(shortindices.data(), shortindices.size());
+    } else {
+        ok = ibuf->setIntVec(indices.data(), indices.size());
+    }
+    Stats result = analyze(indices.data(), index_count, vertex_count, vertex_size);
+    if (after) {
+        *after = result;
+    }
+    LOGD("MeshOptimizer: %d triangles ACMR %.3f -> %.3f ATVR %.3f -> %.3f overfetch %.3f -> %.3f",
+         index_count / 3, stats.acmr, result.acmr, stats.atvr, result.atvr,
+         stats.overfetch, result.overfetch);
+    return ok;
+}
+
+}
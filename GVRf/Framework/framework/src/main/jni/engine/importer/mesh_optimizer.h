@@ -0,0 +1,129 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Reorders mesh triangles and vertices for faster rendering.
+ ***************************************************************************/
+
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+
+namespace gvr {
+class Mesh;
+
+/*
+ * Reorders the triangles and vertices of a mesh without
+ * changing its appearance so the GPU does less work.
+ *
+ * Triangles are first reordered so vertices are reused while
+ * they are still in the post-transform cache, then clusters of
+ * triangles are sorted so outward facing ones come first which
+ * reduces overdraw, and finally vertices are stored in the order
+ * they are first used to improve vertex fetch locality.
+ *
+ * All the functions operate on 32 bit triangle lists so they
+ * can be used and measured without a renderer.
+ */
+class MeshOptimizer {
+public:
+    /*
+     * Cache and fetch statistics for a triangle list.
+     * acmr         average cache miss ratio: transformed vertices per triangle
+     *              (0.5 is ideal for large grids, 3 is the worst)
+     * atvr         average transformed vertex ratio: transformed vertices per
+     *              vertex (1 is ideal)
+     * overfetch    bytes read from vertex memory divided by the size of the
+     *              vertices referenced (1 is ideal)
+     */
+    struct Stats {
+        float acmr;
+        float atvr;
+        float overfetch;
+    };
+
+    /*
+     * Size of the FIFO post-transform cache simulated by analyze.
+     */
+    static const int CACHE_SIZE = 16;
+
+    /*
+     * Reorder triangles to maximize post-transform cache reuse
+     * (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+     * @param dest          receives index_count reordered indices
+     * @param indices       source triangle list
+     * @param index_count   number of indices
+     * @param vertex_count  number of vertices referenced by the indices
+     */
+    static void optimizeVertexCache(unsigned int* dest, const unsigned int* indices,
+                                    int index_count, int vertex_count);
+
+    /*
+     * Reorder clusters of a cache optimized triangle list so triangles
+     * facing away from the center of the mesh are drawn first
+     * (Sander et al., "Fast Triangle Reordering for Vertex Locality
+     * and Reduced Overdraw").
+     * @param dest          receives index_count reordered indices
+     * @param indices       cache optimized triangle list
+     * @param index_count   number of indices
+     * @param positions     pointer to the first vertex position (3 floats)
+     * @param vertex_count  number of vertices
+     * @param stride        number of floats from one position to the next
+     * @param threshold     how much the cache miss ratio may grow (1.05 = 5%)
+     */
+    static void optimizeOverdraw(unsigned int* dest, const unsigned int* indices, int index_count,
+                                 const float* positions, int vertex_count, int stride,
+                                 float threshold);
+
+    /*
+     * Renumber vertices in the order they are first referenced.
+     * Vertices which are not referenced are moved to the end.
+     * @param order         receives the old index of each new vertex
+     * @param indices       triangle list, updated with the new vertex numbers
+     * @param index_count   number of indices
+     * @param vertex_count  number of vertices
+     * @returns number of referenced vertices
+     */
+    static int optimizeVertexFetch(unsigned int* order, unsigned int* indices,
+                                   int index_count, int vertex_count);
+
+    /*
+     * Measure cache and fetch efficiency of a triangle list.
+     * @param indices       triangle list
+     * @param index_count   number of indices
+     * @param vertex_count  number of vertices
+     * @param vertex_size   number of bytes in a vertex
+     */
+    static Stats analyze(const unsigned int* indices, int index_count,
+                         int vertex_count, int vertex_size);
+
+    /*
+     * Apply all the optimizations to a mesh in place.
+     * The vertex and index counts do not change.
+     * @param mesh          indexed mesh with "a_position"
+     * @param overdraw_threshold  cache miss ratio growth allowed to reduce overdraw,
+     *                      0 skips the overdraw optimization
+     * @param before        if not null, receives the statistics before optimization
+     * @param after         if not null, receives the statistics after optimization
+     * @returns true if the mesh was optimized, false on error
+     */
+    static bool optimize(Mesh& mesh, float overdraw_threshold, Stats* before, Stats* after);
+
+private:
+    MeshOptimizer();
+};
+
+}
+#endif
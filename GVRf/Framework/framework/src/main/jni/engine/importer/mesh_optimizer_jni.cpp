@@ -0,0 +1,76 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include <vector>
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "objects/mesh.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C" {
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeMeshOptimizer_optimize(JNIEnv * env,
+            jobject obj, jlong jmesh, jfloat overdraw_threshold, jfloatArray jstats);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeMeshOptimizer_analyze(JNIEnv * env,
+            jobject obj, jlong jmesh, jfloatArray jstats);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeMeshOptimizer_optimize(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloat overdraw_threshold, jfloatArray jstats)
+{
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    MeshOptimizer::Stats stats[2];
+
+    if (!MeshOptimizer::optimize(*mesh, overdraw_threshold, &stats[0], &stats[1]))
+    {
+        return false;
+    }
+    if (jstats)
+    {
+        env->SetFloatArrayRegion(jstats, 0, 6, reinterpret_cast<const jfloat*>(stats));
+    }
+    return true;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeMeshOptimizer_analyze(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloatArray jstats)
+{
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    VertexBuffer* vbuf = mesh->getVertexBuffer();
+    std::vector<unsigned int> indices;
+
+    if (vbuf == nullptr)
+    {
+        return false;
+    }
+    MeshSimplifier::getIndices(*mesh, indices);
+    MeshOptimizer::Stats stats = MeshOptimizer::analyze(indices.data(), indices.size(),
+                                                        vbuf->getVertexCount(),
+                                                        vbuf->getTotalSize());
+    env->SetFloatArrayRegion(jstats, 0, 3, reinterpret_cast<const jfloat*>(&stats));
+    return true;
+}
+
+}
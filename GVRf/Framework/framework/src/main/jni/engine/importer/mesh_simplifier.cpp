@@ -0,0 +1,638 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Quadric error metric mesh simplification.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include "glm/glm.hpp"
+#include "mesh_simplifier.h"
+#include "objects/mesh.h"
+#include "objects/vertex_buffer.h"
+#include "objects/index_buffer.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+namespace {
+
+const unsigned int INVALID = ~0u;
+const float BORDER_WEIGHT = 10.0f;
+
+/*
+ * How a vertex may be collapsed.
+ * MANIFOLD vertices can move to any neighbor.
+ * BORDER vertices are on an open boundary and may only
+ * move along it. SEAM vertices have two wedges with different
+ * attributes which must move together along the seam.
+ * LOCKED vertices never move.
+ */
+enum VertexKind {
+    MANIFOLD = 0,
+    BORDER,
+    SEAM,
+    LOCKED
+};
+
+const bool CAN_COLLAPSE[4][4] = {
+    { true,  true,  true,  true  },     // MANIFOLD
+    { false, true,  false, true  },     // BORDER
+    { false, false, true,  true  },     // SEAM
+    { false, false, false, false },     // LOCKED
+};
+
+/*
+ * Symmetric quadric for the squared distance to a set of planes.
+ */
+struct Quadric {
+    float a00, a11, a22;
+    float a10, a20, a21;
+    float b0, b1, b2;
+    float c;
+    float w;
+
+    void addPlane(const glm::vec3& n, float d, float weight) {
+        a00 += weight * n.x * n.x;
+        a11 += weight * n.y * n.y;
+        a22 += weight * n.z * n.z;
+        a10 += weight * n.y * n.x;
+        a20 += weight * n.z * n.x;
+        a21 += weight * n.z * n.y;
+        b0 += weight * n.x * d;
+        b1 += weight * n.y * d;
+        b2 += weight * n.z * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a11 += q.a11; a22 += q.a22;
+        a10 += q.a10; a20 += q.a20; a21 += q.a21;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        w += q.w;
+    }
+
+    /*
+     * Weighted average of the squared plane distances at v.
+     */
+    float error(const glm::vec3& v) const {
+        float rx = b0 + a10 * v.y + a20 * v.z;
+        float ry = b1 + a21 * v.z;
+        float rz = b2;
+        float r;
+
+        rx = 2 * rx + a00 * v.x;
+        ry = 2 * ry + a11 * v.y;
+        rz = 2 * rz + a22 * v.z;
+        r = c + v.x * rx + v.y * ry + v.z * rz;
+        return (w > 0) ? (std::fabs(r) / w) : 0;
+    }
+};
+
+struct Collapse {
+    unsigned int v0;
+    unsigned int v1;
+    float error;
+};
+
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        unsigned int h[3];
+        memcpy(h, &p, sizeof(h));
+        return (h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u);
+    }
+};
+
+/*
+ * Simple compressed sparse row adjacency: for each
+ * vertex a contiguous range of entries in data.
+ */
+struct Adjacency {
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> data;
+
+    void build(int count, const unsigned int* keys, int nkeys, int per_key,
+               const std::function<unsigned int(int key, int j)>& value) {
+        offsets.assign(count + 1, 0);
+        for (int i = 0; i < nkeys; ++i) {
+            for (int j = 0; j < per_key; ++j) {
+                ++offsets[keys[i * per_key + j] + 1];
+            }
+        }
+        for (int v = 0; v < count; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        data.resize(offsets[count]);
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (int i = 0; i < nkeys; ++i) {
+            for (int j = 0; j < per_key; ++j) {
+                data[fill[keys[i * per_key + j]]++] = value(i, j);
+            }
+        }
+    }
+};
+
+bool hasEdge(const Adjacency& adj, unsigned int a, unsigned int b) {
+    for (unsigned int i = adj.offsets[a]; i < adj.offsets[a + 1]; ++i) {
+        if (adj.data[i] == b) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Open edges have no opposite half edge. loop[v] is the end of the
+ * single open edge leaving v and loopback[v] the start of the single
+ * open edge entering v. If there are several, the entry refers to v itself.
+ */
+void findOpenEdges(const Adjacency& edges, const unsigned int* indices, int index_count,
+                   std::vector<unsigned int>& loop, std::vector<unsigned int>& loopback) {
+    for (int i = 0; i < index_count; i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = indices[i + e];
+            unsigned int b = indices[i + (e + 1) % 3];
+
+            if (!hasEdge(edges, b, a)) {
+                loop[a] = (loop[a] == INVALID) ? b : a;
+                loopback[b] = (loopback[b] == INVALID) ? a : b;
+            }
+        }
+    }
+}
+
+void classifyVertices(std::vector<unsigned char>& kind, int vertex_count,
+                      const std::vector<unsigned int>& remap, const std::vector<unsigned int>& wedge,
+                      const std::vector<unsigned int>& loop, const std::vector<unsigned int>& loopback) {
+    for (int i = 0; i < vertex_count; ++i) {
+        if (remap[i] != (unsigned int) i) {
+            continue;
+        }
+        unsigned int w = wedge[i];
+        if (w == (unsigned int) i) {
+            unsigned int out = loop[i];
+            unsigned int in = loopback[i];
+
+            if ((out == INVALID) && (in == INVALID)) {
+                kind[i] = MANIFOLD;
+            } else if ((out != INVALID) && (in != INVALID) &&
+                       (out != (unsigned int) i) && (in != (unsigned int) i)) {
+                kind[i] = BORDER;
+            } else {
+                kind[i] = LOCKED;
+            }
+        } else if (wedge[w] == (unsigned int) i) {
+            unsigned int out0 = loop[i], in0 = loopback[i];
+            unsigned int out1 = loop[w], in1 = loopback[w];
+
+            /*
+             * A seam has one open edge in each direction on each wedge
+             * and the open edges of one wedge mirror those of the other.
+             */
+            if ((out0 != INVALID) && (in0 != INVALID) && (out1 != INVALID) && (in1 != INVALID) &&
+                (out0 != (unsigned int) i) && (in0 != (unsigned int) i) &&
+                (out1 != w) && (in1 != w) &&
+                (remap[out0] == remap[in1]) && (remap[in0] == remap[out1])) {
+                kind[i] = SEAM;
+            } else {
+                kind[i] = LOCKED;
+            }
+        } else {
+            kind[i] = LOCKED;
+        }
+    }
+    for (int i = 0; i < vertex_count; ++i) {
+        kind[i] = kind[remap[i]];
+    }
+}
+
+glm::vec3 triangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+/*
+ * Collapsing v0 onto v1 must not flip any of the triangles
+ * around v0 which survive the collapse.
+ */
+bool hasTriangleFlip(const Adjacency& triangles, const unsigned int* indices,
+                     const std::vector<unsigned int>& remap, const std::vector<glm::vec3>& pos,
+                     unsigned int v0, unsigned int v1) {
+    unsigned int r0 = remap[v0];
+    unsigned int r1 = remap[v1];
+    const glm::vec3& target = pos[r1];
+
+    for (unsigned int i = triangles.offsets[r0]; i < triangles.offsets[r0 + 1]; ++i) {
+        const unsigned int* tri = indices + triangles.data[i] * 3;
+        unsigned int a = remap[tri[0]], b = remap[tri[1]], c = remap[tri[2]];
+
+        if ((a == r1) || (b == r1) || (c == r1)) {
+            continue;
+        }
+        glm::vec3 before = triangleNormal(pos[a], pos[b], pos[c]);
+        glm::vec3 after = triangleNormal((a == r0) ? target : pos[a],
+                                         (b == r0) ? target : pos[b],
+                                         (c == r0) ? target : pos[c]);
+        if (glm::dot(before, after) <= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+int MeshSimplifier::simplify(unsigned int* dest, const unsigned int* indices, int index_count,
+                             const float* positions, int vertex_count, int stride,
+                             int target_index_count, float target_error, float* result_error) {
+    float max_error = 0;
+    int result_count = index_count - (index_count % 3);
+
+    if (result_error) {
+        *result_error = 0;
+    }
+    memmove(dest, indices, result_count * sizeof(unsigned int));
+    if ((result_count <= target_index_count) || (vertex_count <= 0)) {
+        return result_count;
+    }
+
+    /*
+     * Normalize the positions to the unit cube so error
+     * thresholds do not depend on the scale of the mesh.
+     */
+    glm::vec3 minv(positions[0], positions[1], positions[2]);
+    glm::vec3 maxv(minv);
+    for (int i = 1; i < vertex_count; ++i) {
+        glm::vec3 p(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]);
+        minv = glm::min(minv, p);
+        maxv = glm::max(maxv, p);
+    }
+    glm::vec3 extent = maxv - minv;
+    float size = std::max(extent.x, std::max(extent.y, extent.z));
+    float scale = (size > 0) ? (1.0f / size) : 1.0f;
+
+    /*
+     * remap[v] is the first vertex with the same position as v,
+     * wedge[v] is the next vertex with that position in a circular list.
+     */
+    std::vector<glm::vec3> pos(vertex_count);
+    std::vector<unsigned int> remap(vertex_count);
+    std::vector<unsigned int> wedge(vertex_count);
+    {
+        std::unordered_map<glm::vec3, unsigned int, PositionHash> unique;
+        unique.reserve(vertex_count);
+        for (int i = 0; i < vertex_count; ++i) {
+            const float* p = positions + i * stride;
+            glm::vec3 v(p[0], p[1], p[2]);
+            auto r = unique.insert(std::make_pair(v, (unsigned int) i));
+            unsigned int first = r.first->second;
+
+            pos[i] = (v - minv) * scale;
+            remap[i] = first;
+            wedge[i] = i;
+            if (first != (unsigned int) i) {
+                wedge[i] = wedge[first];
+                wedge[first] = i;
+            }
+        }
+    }
+
+    Adjacency edges;
+    std::vector<unsigned int> loop(vertex_count, INVALID);
+    std::vector<unsigned int> loopback(vertex_count, INVALID);
+    std::vector<unsigned char> kind(vertex_count, LOCKED);
+
+    edges.build(vertex_count, dest, result_count, 1, [dest](int i, int) {
+        return dest[(i % 3 == 2) ? (i - 2) : (i + 1)];
+    });
+    findOpenEdges(edges, dest, result_count, loop, loopback);
+    classifyVertices(kind, vertex_count, remap, wedge, loop, loopback);
+
+    /*
+     * Quadrics are kept per position so the wedges of a seam share them.
+     * Triangle planes are weighted by area, open boundaries add a plane
+     * perpendicular to the triangle through the border edge.
+     */
+    std::vector<Quadric> quadrics(vertex_count);
+    memset(quadrics.data(), 0, vertex_count * sizeof(Quadric));
+    for (int i = 0; i < result_count; i += 3) {
+        unsigned int v[3] = { remap[dest[i]], remap[dest[i + 1]], remap[dest[i + 2]] };
+        glm::vec3 n = triangleNormal(pos[v[0]], pos[v[1]], pos[v[2]]);
+        float area = glm::length(n);
+
+        if (area <= 0) {
+            continue;
+        }
+        n /= area;
+        for (int j = 0; j < 3; ++j) {
+            quadrics[v[j]].addPlane(n, -glm::dot(n, pos[v[0]]), area * 0.5f);
+        }
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = dest[i + e];
+            unsigned int b = dest[i + (e + 1) % 3];
+
+            if ((kind[a] == SEAM) || (kind[b] == SEAM) || hasEdge(edges, b, a)) {
+                continue;
+            }
+            glm::vec3 edge = pos[remap[b]] - pos[remap[a]];
+            float length = glm::length(edge);
+            glm::vec3 perp = glm::cross(edge, n);
+            float plen = glm::length(perp);
+
+            if (plen <= 0) {
+                continue;
+            }
+            perp /= plen;
+            float d = -glm::dot(perp, pos[remap[a]]);
+            quadrics[remap[a]].addPlane(perp, d, length * length * BORDER_WEIGHT);
+            quadrics[remap[b]].addPlane(perp, d, length * length * BORDER_WEIGHT);
+        }
+    }
+
+    std::vector<unsigned int> collapse_remap(vertex_count);
+    std::vector<unsigned char> locked(vertex_count);
+    std::vector<Collapse> collapses;
+    Adjacency triangles;
+    std::vector<unsigned int> tri_remap;
+    float error_limit = target_error * target_error;
+
+    for (int i = 0; i < vertex_count; ++i) {
+        collapse_remap[i] = i;
+    }
+    while (result_count > target_index_count) {
+        /*
+         * Gather the cheapest valid direction of every edge.
+         */
+        collapses.clear();
+        for (int i = 0; i < result_count; i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = dest[i + e];
+                unsigned int b = dest[i + (e + 1) % 3];
+                Collapse c = { INVALID, INVALID, 0 };
+                bool ab = CAN_COLLAPSE[kind[a]][kind[b]];
+                bool ba = CAN_COLLAPSE[kind[b]][kind[a]];
+
+                if ((kind[a] == BORDER) || (kind[a] == SEAM)) {
+                    ab = ab && ((loop[a] == b) || (loopback[a] == b));
+                }
+                if ((kind[b] == BORDER) || (kind[b] == SEAM)) {
+                    ba = ba && ((loop[b] == a) || (loopback[b] == a));
+                }
+                if (!ab && !ba) {
+                    continue;
+                }
+                Quadric q = quadrics[remap[a]];
+                q.add(quadrics[remap[b]]);
+                float eab = ab ? q.error(pos[remap[b]]) : 0;
+                float eba = ba ? q.error(pos[remap[a]]) : 0;
+
+                if (ab && (!ba || (eab <= eba))) {
+                    c.v0 = a; c.v1 = b; c.error = eab;
+                } else {
+                    c.v0 = b; c.v1 = a; c.error = eba;
+                }
+                collapses.push_back(c);
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.error < y.error;
+        });
+
+        /*
+         * Triangle adjacency per position for the flip test.
+         */
+        tri_remap.resize(result_count);
+        for (int i = 0; i < result_count; ++i) {
+            tri_remap[i] = remap[dest[i]];
+        }
+        triangles.build(vertex_count, tri_remap.data(), result_count, 1, [](int i, int) {
+            return (unsigned int) (i / 3);
+        });
+
+        /*
+         * Apply collapses in order of increasing error. Both ends of a
+         * collapse are locked for the rest of the pass so every quadric
+         * and triangle used for the tests is up to date.
+         */
+        int triangle_goal = (result_count - target_index_count) / 3;
+        int removed = 0;
+        int applied = 0;
+
+        std::fill(locked.begin(), locked.end(), 0);
+        for (const Collapse& c : collapses) {
+            if (c.error > error_limit) {
+                break;
+            }
+            unsigned int r0 = remap[c.v0];
+            unsigned int r1 = remap[c.v1];
+
+            if (locked[r0] || locked[r1]) {
+                continue;
+            }
+            if (hasTriangleFlip(triangles, dest, remap, pos, c.v0, c.v1)) {
+                continue;
+            }
+            if (kind[c.v0] == SEAM) {
+                /*
+                 * The other wedge moves to the vertex across the seam
+                 * from v1, found through the mirrored open edge.
+                 */
+                unsigned int w0 = wedge[c.v0];
+                unsigned int w1 = (loop[c.v0] == c.v1) ? loopback[w0] : loop[w0];
+
+                if ((w1 == INVALID) || (remap[w1] != r1)) {
+                    continue;
+                }
+                collapse_remap[c.v0] = c.v1;
+                collapse_remap[w0] = w1;
+            } else {
+                collapse_remap[c.v0] = c.v1;
+            }
+            quadrics[r1].add(quadrics[r0]);
+            locked[r0] = 1;
+            locked[r1] = 1;
+            max_error = std::max(max_error, c.error);
+            removed += (kind[c.v0] == MANIFOLD) ? 2 : 1;
+            ++applied;
+            if (removed >= triangle_goal) {
+                break;
+            }
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        /*
+         * Keep the open edge loops pointing at surviving vertices.
+         * When an open edge is collapsed against its direction the
+         * loop continues from the removed vertex.
+         */
+        for (int i = 0; i < vertex_count; ++i) {
+            if (loop[i] != INVALID) {
+                unsigned int l = loop[i];
+                unsigned int r = collapse_remap[l];
+                loop[i] = (r == (unsigned int) i) ? loop[l] : r;
+            }
+            if (loopback[i] != INVALID) {
+                unsigned int l = loopback[i];
+                unsigned int r = collapse_remap[l];
+                loopback[i] = (r == (unsigned int) i) ? loopback[l] : r;
+            }
+        }
+
+        /*
+         * Remap the triangles and drop the ones which became degenerate.
+         */
+        int write = 0;
+        for (int i = 0; i < result_count; i += 3) {
+            unsigned int a = collapse_remap[dest[i]];
+            unsigned int b = collapse_remap[dest[i + 1]];
+            unsigned int c = collapse_remap[dest[i + 2]];
+            unsigned int ra = remap[a], rb = remap[b], rc = remap[c];
+
+            if ((ra != rb) && (ra != rc) && (rb != rc)) {
+                dest[write++] = a;
+                dest[write++] = b;
+                dest[write++] = c;
+            }
+        }
+        if (write == result_count) {
+            break;
+        }
+        result_count = write;
+    }
+    if (result_error) {
+        *result_error = std::sqrt(max_error);
+    }
+    return result_count;
+}
+
+void MeshSimplifier::getIndices(const Mesh& mesh, std::vector<unsigned int>& indices) {
+    const IndexBuffer* ibuf = mesh.getIndexBuffer();
+
+    if ((ibuf == nullptr) || (ibuf->getIndexCount() == 0)) {
+        indices.resize(mesh.getVertexCount());
+        for (int i = 0; i < mesh.getVertexCount(); ++i) {
+            indices[i] = i;
+        }
+        return;
+    }
+    int n = ibuf->getIndexCount();
+    indices.resize(n);
+    if (ibuf->getIndexSize() == sizeof(unsigned short)) {
+        const unsigned short* src = reinterpret_cast<const unsigned short*>(ibuf->getIndexData());
+        for (int i = 0; i < n; ++i) {
+            indices[i] = src[i];
+        }
+    } else {
+        memcpy(indices.data(), ibuf->getIndexData(), n * sizeof(unsigned int));
+    }
+}
+
+bool MeshSimplifier::compact(const VertexBuffer& src_verts, const unsigned int* indices, int index_count,
+                             VertexBuffer& dst_verts, IndexBuffer& dst_indices) {
+    std::vector<unsigned int> vmap(src_verts.getVertexCount(), INVALID);
+    std::vector<unsigned int> newindices(index_count);
+    std::vector<unsigned int> vertices;
+
+    if (index_count == 0) {
+        LOGE("MeshSimplifier: nothing to copy");
+        return false;
+    }
+    for (int i = 0; i < index_count; ++i) {
+        unsigned int v = indices[i];
+        if (vmap[v] == INVALID) {
+            vmap[v] = vertices.size();
+            vertices.push_back(v);
+        }
+        newindices[i] = vmap[v];
+    }
+    if (!dst_verts.copyVertices(src_verts, vertices.data(), vertices.size())) {
+        return false;
+    }
+    if (dst_indices.getIndexSize() == sizeof(unsigned short)) {
+        if (vertices.size() > 65536) {
+            LOGE("MeshSimplifier: %d vertices cannot be addressed with 16 bit indices", (int) vertices.size());
+            return false;
+        }
+        std::vector<unsigned short> shortindices(newindices.begin(), newindices.end());
+        return dst_indices.setShortVec(shortindices.data(), index_count);
+    }
+    return dst_indices.setIntVec(newindices.data(), index_count);
+}
+
+bool MeshSimplifier::simplify(Mesh& src, VertexBuffer& dst_verts, IndexBuffer& dst_indices,
+                              float ratio, float target_error, float* result_error) {
+    VertexBuffer* vbuf = &dst_verts;
+    IndexBuffer* ibuf = &dst_indices;
+    return generateLODs(src, &ratio, &target_error, 1, &vbuf, &ibuf, result_error) == 1;
+}
+
+int MeshSimplifier::generateLODs(Mesh& src, const float* ratios, const float* errors, int nlevels,
+                                 VertexBuffer** dst_verts, IndexBuffer** dst_indices,
+                                 float* result_errors) {
+    const VertexBuffer* vbuf = src.getVertexBuffer();
+    int index, offset, size;
+
+    if ((vbuf == nullptr) || !vbuf->getInfo("a_position", index, offset, size)) {
+        LOGE("MeshSimplifier: mesh does not have positions");
+        return 0;
+    }
+    std::vector<unsigned int> source;
+    std::vector<unsigned int> result;
+    std::vector<float> unpacked;
+    int stride;
+    const float* positions = vbuf->getFloatData("a_position", unpacked, stride);
+    int vertex_count = vbuf->getVertexCount();
+    int total = 0;
+    float error = 0;
+
+    getIndices(src, source);
+    total = source.size() - (source.size() % 3);
+    result.resize(source.size());
+    for (int level = 0; level < nlevels; ++level) {
+        int target = (int) (total * ratios[level] / 3) * 3;
+        float level_error = 0;
+        int count = simplify(result.data(), source.data(), source.size(),
+                             positions, vertex_count, stride,
+                             target, errors[level], &level_error);
+
+        /*
+         * Errors add up along the chain since each level starts
+         * from the previous one rather than from the source.
+         */
+        error += level_error;
+        if (!compact(*vbuf, result.data(), count, *dst_verts[level], *dst_indices[level])) {
+            return level;
+        }
+        if (result_errors) {
+            result_errors[level] = error;
+        }
+        LOGD("MeshSimplifier: level %d has %d triangles, error %f", level, count / 3, error);
+        source.assign(result.begin(), result.begin() + count);
+    }
+    return nlevels;
+}
+
+}
@@ -0,0 +1,122 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Quadric error metric mesh simplification.
+ ***************************************************************************/
+
+#ifndef MESH_SIMPLIFIER_H_
+#define MESH_SIMPLIFIER_H_
+
+#include <vector>
+
+namespace gvr {
+class Mesh;
+class VertexBuffer;
+class IndexBuffer;
+
+/*
+ * Reduces the number of triangles in a mesh by repeatedly
+ * collapsing the edge with the smallest quadric error.
+ *
+ * Vertices are never moved or created, an edge collapse merges
+ * one vertex into its neighbor. This keeps every vertex attribute
+ * intact and lets all the levels generated from a mesh share its
+ * vertex layout.
+ *
+ * Vertices which share a position but have different attributes
+ * (UV or normal seams) are collapsed together along the seam so
+ * the seam is never torn open. Open boundary edges are constrained
+ * so the border only slides along itself and non-manifold vertices
+ * are left in place.
+ *
+ * Errors are expressed as a distance relative to the largest
+ * extent of the mesh bounding box so 0.01 means 1% of the mesh size.
+ */
+class MeshSimplifier {
+public:
+    /*
+     * Simplify an indexed triangle list.
+     * @param dest          destination index array, at least index_count entries
+     * @param indices       source triangle list
+     * @param index_count   number of indices in the source triangle list
+     * @param positions     pointer to the first vertex position (3 floats)
+     * @param vertex_count  number of vertices
+     * @param stride        number of floats from one position to the next
+     * @param target_index_count stop when the result has this many indices
+     * @param target_error  never make a collapse with a larger relative error
+     * @param result_error  if not null, receives the relative error of the result
+     * @returns number of indices written to dest
+     */
+    static int simplify(unsigned int* dest, const unsigned int* indices, int index_count,
+                        const float* positions, int vertex_count, int stride,
+                        int target_index_count, float target_error, float* result_error);
+
+    /*
+     * Simplify a mesh into new vertex and index buffers.
+     * Only the vertices referenced by the simplified triangles
+     * are copied. The destination vertex buffer must be empty
+     * and have the same layout as the source.
+     * @param src           mesh to simplify, must have "a_position"
+     * @param dst_verts     receives the vertices of the simplified mesh
+     * @param dst_indices   receives the triangles of the simplified mesh
+     * @param ratio         fraction of the source triangles to keep (0 - 1)
+     * @param target_error  maximum relative error allowed
+     * @param result_error  if not null, receives the relative error of the result
+     * @returns true if the buffers were filled, false on error
+     */
+    static bool simplify(Mesh& src, VertexBuffer& dst_verts, IndexBuffer& dst_indices,
+                         float ratio, float target_error, float* result_error);
+
+    /*
+     * Generate a chain of levels of detail from a mesh.
+     * Each level is simplified from the previous one so the
+     * chain costs about as much as simplifying the source once.
+     * A level stops at whichever of its ratio or error limit
+     * is reached first, use a ratio of 0 for a purely error
+     * driven level or an error of 1 for a purely ratio driven one.
+     * @param src           mesh to simplify, must have "a_position"
+     * @param ratios        fraction of the source triangles to keep for each level
+     * @param errors        maximum relative error for each level
+     * @param nlevels       number of levels to generate
+     * @param dst_verts     receives the vertices of each level
+     * @param dst_indices   receives the triangles of each level
+     * @param result_errors if not null, receives the relative error of each level
+     * @returns number of levels generated
+     */
+    static int generateLODs(Mesh& src, const float* ratios, const float* errors, int nlevels,
+                            VertexBuffer** dst_verts, IndexBuffer** dst_indices,
+                            float* result_errors);
+
+    /*
+     * Read the triangle list of a mesh as 32 bit indices.
+     * Meshes without an index buffer produce a sequential list.
+     */
+    static void getIndices(const Mesh& mesh, std::vector<unsigned int>& indices);
+
+    /*
+     * Copy the vertices referenced by a triangle list into a new
+     * vertex buffer and store the remapped triangles in an index buffer.
+     */
+    static bool compact(const VertexBuffer& src_verts, const unsigned int* indices, int index_count,
+                        VertexBuffer& dst_verts, IndexBuffer& dst_indices);
+
+private:
+    MeshSimplifier();
+};
+
+}
+#endif
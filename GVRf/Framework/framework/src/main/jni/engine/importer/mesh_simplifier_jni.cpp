@@ -0,0 +1,89 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include <vector>
+#include "mesh_simplifier.h"
+#include "objects/mesh.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C" {
+    JNIEXPORT jfloat JNICALL
+    Java_org_gearvrf_NativeMeshSimplifier_simplify(JNIEnv * env,
+            jobject obj, jlong jmesh, jlong jvertices, jlong jindices,
+            jfloat ratio, jfloat target_error);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMeshSimplifier_generateLODs(JNIEnv * env,
+            jobject obj, jlong jmesh, jfloatArray jratios, jfloatArray jerrors,
+            jlongArray jvertices, jlongArray jindices, jfloatArray jresult_errors);
+}
+
+JNIEXPORT jfloat JNICALL
+Java_org_gearvrf_NativeMeshSimplifier_simplify(JNIEnv * env,
+        jobject obj, jlong jmesh, jlong jvertices, jlong jindices,
+        jfloat ratio, jfloat target_error)
+{
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    VertexBuffer* vbuf = reinterpret_cast<VertexBuffer*>(jvertices);
+    IndexBuffer* ibuf = reinterpret_cast<IndexBuffer*>(jindices);
+    float error = 0;
+
+    if (!MeshSimplifier::simplify(*mesh, *vbuf, *ibuf, ratio, target_error, &error))
+    {
+        return -1;
+    }
+    return error;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeMeshSimplifier_generateLODs(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloatArray jratios, jfloatArray jerrors,
+        jlongArray jvertices, jlongArray jindices, jfloatArray jresult_errors)
+{
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    int nlevels = env->GetArrayLength(jratios);
+    jfloat* ratios = env->GetFloatArrayElements(jratios, 0);
+    jfloat* errors = env->GetFloatArrayElements(jerrors, 0);
+    jlong* vptrs = env->GetLongArrayElements(jvertices, 0);
+    jlong* iptrs = env->GetLongArrayElements(jindices, 0);
+    std::vector<VertexBuffer*> vbufs(nlevels);
+    std::vector<IndexBuffer*> ibufs(nlevels);
+    std::vector<float> result_errors(nlevels);
+
+    for (int i = 0; i < nlevels; ++i)
+    {
+        vbufs[i] = reinterpret_cast<VertexBuffer*>(vptrs[i]);
+        ibufs[i] = reinterpret_cast<IndexBuffer*>(iptrs[i]);
+    }
+    int n = MeshSimplifier::generateLODs(*mesh, ratios, errors, nlevels,
+                                         vbufs.data(), ibufs.data(), result_errors.data());
+    if (jresult_errors)
+    {
+        env->SetFloatArrayRegion(jresult_errors, 0, n, result_errors.data());
+    }
+    env->ReleaseLongArrayElements(jindices, iptrs, JNI_ABORT);
+    env->ReleaseLongArrayElements(jvertices, vptrs, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jerrors, errors, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jratios, ratios, JNI_ABORT);
+    return n;
+}
+
+}
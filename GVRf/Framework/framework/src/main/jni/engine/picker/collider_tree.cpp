@@ -0,0 +1,725 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Dynamic bounding volume tree over the colliders in a scene.
+ ***************************************************************************/
+
+#include "collider_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "objects/components/collider.h"
+#include "objects/components/collider_shape_types.h"
+
+namespace gvr {
+
+/*
+ * Leaf bounds are enlarged by this fraction of their
+ * largest dimension so small movements are absorbed.
+ */
+static const float FAT_MARGIN = 0.1f;
+
+static float surfaceArea(const glm::vec3& minCorner, const glm::vec3& maxCorner)
+{
+    glm::vec3 d = maxCorner - minCorner;
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+static float unionArea(const ColliderTree::Node& a, const ColliderTree::Node& b)
+{
+    return surfaceArea(glm::min(a.Min, b.Min), glm::max(a.Max, b.Max));
+}
+
+static bool heapCompare(const std::pair<float, int>& a, const std::pair<float, int>& b)
+{
+    return a.first > b.first;
+}
+
+ColliderTree::ColliderTree() :
+        mRoot(NULL_NODE), mFreeList(NULL_NODE), mNodeCount(0), mLeafCount(0)
+{
+}
+
+int ColliderTree::allocateNode()
+{
+    if (mFreeList == NULL_NODE)
+    {
+        Node node;
+        node.Height = -1;
+        node.Parent = NULL_NODE;
+        mNodes.push_back(node);
+        mLeafBounds.resize(2 * mNodes.size());
+        mFreeList = mNodes.size() - 1;
+    }
+    int nodeIndex = mFreeList;
+    Node& node = mNodes[nodeIndex];
+
+    mFreeList = node.Parent;
+    node.Parent = NULL_NODE;
+    node.Child1 = NULL_NODE;
+    node.Child2 = NULL_NODE;
+    node.Height = 0;
+    node.Owner = NULL;
+    ++mNodeCount;
+    return nodeIndex;
+}
+
+void ColliderTree::freeNode(int nodeIndex)
+{
+    Node& node = mNodes[nodeIndex];
+
+    node.Parent = mFreeList;
+    node.Height = -1;
+    node.Owner = NULL;
+    mFreeList = nodeIndex;
+    --mNodeCount;
+}
+
+void ColliderTree::addCollider(Collider* collider)
+{
+    collider->tree_node_ = NULL_NODE;
+    if ((collider->shape_type() == COLLIDER_SHAPE_MESH) ||
+        (collider->shape_type() == COLLIDER_SHAPE_SPHERE))
+    {
+        mWatched.push_back(collider);
+    }
+    markDirty(collider);
+}
+
+void ColliderTree::removeCollider(Collider* collider)
+{
+    {
+        std::lock_guard<std::mutex> lock(mDirtyLock);
+        if (collider->bounds_dirty_)
+        {
+            mDirty.erase(std::remove(mDirty.begin(), mDirty.end(), collider), mDirty.end());
+            collider->bounds_dirty_ = false;
+        }
+    }
+    mWatched.erase(std::remove(mWatched.begin(), mWatched.end(), collider), mWatched.end());
+    if (collider->tree_node_ >= 0)
+    {
+        removeLeaf(collider->tree_node_);
+        freeNode(collider->tree_node_);
+        --mLeafCount;
+    }
+    else if (collider->tree_node_ == UNBOUNDED_NODE)
+    {
+        mUnbounded.erase(std::remove(mUnbounded.begin(), mUnbounded.end(), collider), mUnbounded.end());
+    }
+    collider->tree_node_ = NULL_NODE;
+}
+
+void ColliderTree::clear()
+{
+    for (auto it = mNodes.begin(); it != mNodes.end(); ++it)
+    {
+        if ((it->Height == 0) && (it->Owner != NULL))
+        {
+            it->Owner->tree_node_ = NULL_NODE;
+        }
+    }
+    for (auto it = mUnbounded.begin(); it != mUnbounded.end(); ++it)
+    {
+        (*it)->tree_node_ = NULL_NODE;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mDirtyLock);
+        for (auto it = mDirty.begin(); it != mDirty.end(); ++it)
+        {
+            (*it)->bounds_dirty_ = false;
+        }
+        mDirty.clear();
+    }
+    mNodes.clear();
+    mLeafBounds.clear();
+    mUnbounded.clear();
+    mWatched.clear();
+    mRoot = NULL_NODE;
+    mFreeList = NULL_NODE;
+    mNodeCount = 0;
+    mLeafCount = 0;
+}
+
+void ColliderTree::markDirty(Collider* collider)
+{
+    std::lock_guard<std::mutex> lock(mDirtyLock);
+    if (!collider->bounds_dirty_)
+    {
+        collider->bounds_dirty_ = true;
+        mDirty.push_back(collider);
+    }
+}
+
+void ColliderTree::update()
+{
+    {
+        std::lock_guard<std::mutex> lock(mDirtyLock);
+        mUpdating.swap(mDirty);
+        for (auto it = mUpdating.begin(); it != mUpdating.end(); ++it)
+        {
+            (*it)->bounds_dirty_ = false;
+        }
+    }
+    /*
+     * Unbounded colliders are checked every time because
+     * their mesh may be attached after they are.
+     */
+    for (int i = mUnbounded.size() - 1; i >= 0; --i)
+    {
+        updateCollider(mUnbounded[i]);
+    }
+    for (auto it = mUpdating.begin(); it != mUpdating.end(); ++it)
+    {
+        updateCollider(*it);
+    }
+    mUpdating.clear();
+    for (auto it = mWatched.begin(); it != mWatched.end(); ++it)
+    {
+        if (((*it)->tree_node_ != UNBOUNDED_NODE) && (*it)->geometryChanged())
+        {
+            updateCollider(*it);
+        }
+    }
+}
+
+void ColliderTree::updateCollider(Collider* collider)
+{
+    glm::vec3 minCorner;
+    glm::vec3 maxCorner;
+    bool bounded = collider->getWorldBounds(minCorner, maxCorner) &&
+                   std::isfinite(minCorner.x) && std::isfinite(minCorner.y) && std::isfinite(minCorner.z) &&
+                   std::isfinite(maxCorner.x) && std::isfinite(maxCorner.y) && std::isfinite(maxCorner.z) &&
+                   (minCorner.x <= maxCorner.x) && (minCorner.y <= maxCorner.y) && (minCorner.z <= maxCorner.z);
+    int leaf = collider->tree_node_;
+
+    if (!bounded)
+    {
+        if (leaf >= 0)
+        {
+            removeLeaf(leaf);
+            freeNode(leaf);
+            --mLeafCount;
+        }
+        if (leaf != UNBOUNDED_NODE)
+        {
+            mUnbounded.push_back(collider);
+            collider->tree_node_ = UNBOUNDED_NODE;
+        }
+        return;
+    }
+    if (leaf == UNBOUNDED_NODE)
+    {
+        mUnbounded.erase(std::remove(mUnbounded.begin(), mUnbounded.end(), collider), mUnbounded.end());
+        leaf = NULL_NODE;
+    }
+    if (leaf >= 0)
+    {
+        const Node& node = mNodes[leaf];
+        mLeafBounds[2 * leaf] = minCorner;
+        mLeafBounds[2 * leaf + 1] = maxCorner;
+        if (glm::all(glm::lessThanEqual(node.Min, minCorner)) &&
+            glm::all(glm::greaterThanEqual(node.Max, maxCorner)))
+        {
+            return;
+        }
+        removeLeaf(leaf);
+    }
+    else
+    {
+        leaf = allocateNode();
+        mNodes[leaf].Owner = collider;
+        collider->tree_node_ = leaf;
+        ++mLeafCount;
+    }
+    glm::vec3 extent = maxCorner - minCorner;
+    float margin = FAT_MARGIN * std::max(extent.x, std::max(extent.y, extent.z));
+    Node& node = mNodes[leaf];
+
+    mLeafBounds[2 * leaf] = minCorner;
+    mLeafBounds[2 * leaf + 1] = maxCorner;
+    node.Min = minCorner - glm::vec3(margin);
+    node.Max = maxCorner + glm::vec3(margin);
+    insertLeaf(leaf);
+}
+
+/*
+ * Insert a leaf next to the node where it causes the smallest
+ * increase in surface area (Catto, Box2D b2DynamicTree).
+ */
+void ColliderTree::insertLeaf(int leaf)
+{
+    if (mRoot == NULL_NODE)
+    {
+        mRoot = leaf;
+        mNodes[leaf].Parent = NULL_NODE;
+        return;
+    }
+    int index = mRoot;
+    while (mNodes[index].Height > 0)
+    {
+        const Node& node = mNodes[index];
+        const Node& leafNode = mNodes[leaf];
+        const Node& child1 = mNodes[node.Child1];
+        const Node& child2 = mNodes[node.Child2];
+        float area = surfaceArea(node.Min, node.Max);
+        float combinedArea = unionArea(node, leafNode);
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+        float cost1 = unionArea(leafNode, child1) + inheritanceCost;
+        float cost2 = unionArea(leafNode, child2) + inheritanceCost;
+
+        if (child1.Height > 0)
+        {
+            cost1 -= surfaceArea(child1.Min, child1.Max);
+        }
+        if (child2.Height > 0)
+        {
+            cost2 -= surfaceArea(child2.Min, child2.Max);
+        }
+        if ((cost < cost1) && (cost < cost2))
+        {
+            break;
+        }
+        index = (cost1 < cost2) ? node.Child1 : node.Child2;
+    }
+    int sibling = index;
+    int oldParent = mNodes[sibling].Parent;
+    int newParent = allocateNode();
+    Node& parent = mNodes[newParent];
+
+    parent.Parent = oldParent;
+    parent.Min = glm::min(mNodes[leaf].Min, mNodes[sibling].Min);
+    parent.Max = glm::max(mNodes[leaf].Max, mNodes[sibling].Max);
+    parent.Height = mNodes[sibling].Height + 1;
+    parent.Child1 = sibling;
+    parent.Child2 = leaf;
+    mNodes[sibling].Parent = newParent;
+    mNodes[leaf].Parent = newParent;
+    if (oldParent != NULL_NODE)
+    {
+        if (mNodes[oldParent].Child1 == sibling)
+        {
+            mNodes[oldParent].Child1 = newParent;
+        }
+        else
+        {
+            mNodes[oldParent].Child2 = newParent;
+        }
+    }
+    else
+    {
+        mRoot = newParent;
+    }
+    refitNode(newParent);
+}
+
+void ColliderTree::removeLeaf(int leaf)
+{
+    if (leaf == mRoot)
+    {
+        mRoot = NULL_NODE;
+        return;
+    }
+    int parent = mNodes[leaf].Parent;
+    int grandParent = mNodes[parent].Parent;
+    int sibling = (mNodes[parent].Child1 == leaf) ? mNodes[parent].Child2 : mNodes[parent].Child1;
+
+    mNodes[leaf].Parent = NULL_NODE;
+    mNodes[sibling].Parent = grandParent;
+    freeNode(parent);
+    if (grandParent == NULL_NODE)
+    {
+        mRoot = sibling;
+        return;
+    }
+    if (mNodes[grandParent].Child1 == parent)
+    {
+        mNodes[grandParent].Child1 = sibling;
+    }
+    else
+    {
+        mNodes[grandParent].Child2 = sibling;
+    }
+    refitNode(grandParent);
+}
+
+/*
+ * Walk from a node to the root, rebalancing and
+ * recomputing the bounds and height of each node.
+ */
+void ColliderTree::refitNode(int nodeIndex)
+{
+    while (nodeIndex != NULL_NODE)
+    {
+        nodeIndex = balance(nodeIndex);
+        Node& node = mNodes[nodeIndex];
+        const Node& child1 = mNodes[node.Child1];
+        const Node& child2 = mNodes[node.Child2];
+
+        node.Height = 1 + std::max(child1.Height, child2.Height);
+        node.Min = glm::min(child1.Min, child2.Min);
+        node.Max = glm::max(child1.Max, child2.Max);
+        nodeIndex = node.Parent;
+    }
+}
+
+/*
+ * If one child of a node is more than one level taller than the
+ * other, rotate the taller child up to take the node's place.
+ * @returns index of the node which is now at this position
+ */
+int ColliderTree::balance(int iA)
+{
+    Node& A = mNodes[iA];
+
+    if (A.Height < 2)
+    {
+        return iA;
+    }
+    int iB = A.Child1;
+    int iC = A.Child2;
+    const Node& B = mNodes[iB];
+    const Node& C = mNodes[iC];
+    int diff = C.Height - B.Height;
+
+    if ((diff < -1) || (diff > 1))
+    {
+        /*
+         * Rotate the taller child (up) into A's place.
+         * A keeps the shorter child (side) and takes the
+         * shorter grandchild, up keeps the taller grandchild.
+         */
+        bool rightHeavy = diff > 1;
+        int iUp = rightHeavy ? iC : iB;
+        Node& up = mNodes[iUp];
+        const Node& side = rightHeavy ? B : C;
+        int iF = up.Child1;
+        int iG = up.Child2;
+        Node& F = mNodes[iF];
+        Node& G = mNodes[iG];
+        int iKeep = (F.Height > G.Height) ? iF : iG;
+        int iMove = (F.Height > G.Height) ? iG : iF;
+        Node& keep = mNodes[iKeep];
+        Node& move = mNodes[iMove];
+
+        up.Child1 = iA;
+        up.Child2 = iKeep;
+        up.Parent = A.Parent;
+        A.Parent = iUp;
+        if (up.Parent != NULL_NODE)
+        {
+            Node& parent = mNodes[up.Parent];
+            if (parent.Child1 == iA)
+            {
+                parent.Child1 = iUp;
+            }
+            else
+            {
+                parent.Child2 = iUp;
+            }
+        }
+        else
+        {
+            mRoot = iUp;
+        }
+        if (rightHeavy)
+        {
+            A.Child2 = iMove;
+        }
+        else
+        {
+            A.Child1 = iMove;
+        }
+        move.Parent = iA;
+        A.Min = glm::min(side.Min, move.Min);
+        A.Max = glm::max(side.Max, move.Max);
+        A.Height = 1 + std::max(side.Height, move.Height);
+        up.Min = glm::min(A.Min, keep.Min);
+        up.Max = glm::max(A.Max, keep.Max);
+        up.Height = 1 + std::max(A.Height, keep.Height);
+        return iUp;
+    }
+    return iA;
+}
+
+int ColliderTree::getHeight() const
+{
+    return (mRoot == NULL_NODE) ? 0 : mNodes[mRoot].Height;
+}
+
+/*
+ * Intersect a ray with an axis aligned box using slabs.
+ * @returns distance along the ray where it enters the box,
+ *          0 if it starts inside or -1 if it misses
+ */
+float ColliderTree::rayBox(const glm::vec3& rayStart, const glm::vec3& rayDir,
+                           const glm::vec3& minCorner, const glm::vec3& maxCorner)
+{
+    float tmin = 0;
+    float tmax = std::numeric_limits<float>::infinity();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (std::fabs(rayDir[i]) < std::numeric_limits<float>::epsilon())
+        {
+            if ((rayStart[i] < minCorner[i]) || (rayStart[i] > maxCorner[i]))
+            {
+                return -1;
+            }
+            continue;
+        }
+        float inv = 1.0f / rayDir[i];
+        float t1 = (minCorner[i] - rayStart[i]) * inv;
+        float t2 = (maxCorner[i] - rayStart[i]) * inv;
+
+        if (t1 > t2)
+        {
+            std::swap(t1, t2);
+        }
+        tmin = std::max(tmin, t1);
+        tmax = std::min(tmax, t2);
+        if (tmin > tmax)
+        {
+            return -1;
+        }
+    }
+    return tmin;
+}
+
+void ColliderTree::raycast(const glm::vec3& rayStart, const glm::vec3& rayDir,
+                           float maxDistance, const RayCallback& callback)
+{
+    for (auto it = mUnbounded.begin(); it != mUnbounded.end(); ++it)
+    {
+        maxDistance = std::min(maxDistance, callback(*it, 0));
+        if (maxDistance <= 0)
+        {
+            return;
+        }
+    }
+    if (mRoot == NULL_NODE)
+    {
+        return;
+    }
+    float t = rayBox(rayStart, rayDir, mNodes[mRoot].Min, mNodes[mRoot].Max);
+    if ((t < 0) || (t > maxDistance))
+    {
+        return;
+    }
+    /*
+     * Nodes are visited nearest first from a heap ordered by
+     * where the ray enters their bounds. Once the nearest node
+     * left is farther than the search distance nothing else
+     * can be closer.
+     */
+    mHeap.clear();
+    mHeap.push_back(std::make_pair(t, mRoot));
+    while (!mHeap.empty())
+    {
+        std::pop_heap(mHeap.begin(), mHeap.end(), heapCompare);
+        std::pair<float, int> entry = mHeap.back();
+        mHeap.pop_back();
+        if (entry.first > maxDistance)
+        {
+            break;
+        }
+        const Node& node = mNodes[entry.second];
+        if (node.Height == 0)
+        {
+            maxDistance = std::min(maxDistance, callback(node.Owner, entry.first));
+            if (maxDistance <= 0)
+            {
+                break;
+            }
+            continue;
+        }
+        int children[2] = { node.Child1, node.Child2 };
+        for (int i = 0; i < 2; ++i)
+        {
+            const Node& child = mNodes[children[i]];
+            t = rayBox(rayStart, rayDir, child.Min, child.Max);
+            if ((t >= 0) && (t <= maxDistance))
+            {
+                mHeap.push_back(std::make_pair(t, children[i]));
+                std::push_heap(mHeap.begin(), mHeap.end(), heapCompare);
+            }
+        }
+    }
+    mHeap.clear();
+}
+
+int ColliderTree::RayPacket::addRay(const glm::vec3& rayStart, const glm::vec3& rayDir)
+{
+    if (Count >= MAX_PACKET_SIZE)
+    {
+        return -1;
+    }
+    /*
+     * Tiny direction components are replaced so the inverse stays
+     * finite and the slab test never computes 0 * infinity.
+     */
+    const float tiny = 1e-20f;
+    glm::vec3 dir(rayDir);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (std::fabs(dir[i]) < tiny)
+        {
+            dir[i] = (dir[i] < 0) ? -tiny : tiny;
+        }
+    }
+    StartX[Count] = rayStart.x;
+    StartY[Count] = rayStart.y;
+    StartZ[Count] = rayStart.z;
+    InvDirX[Count] = 1.0f / dir.x;
+    InvDirY[Count] = 1.0f / dir.y;
+    InvDirZ[Count] = 1.0f / dir.z;
+    return Count++;
+}
+
+/*
+ * Intersect all the rays in a packet with an axis aligned box.
+ * @returns mask with a bit set for each ray that hits the box
+ */
+unsigned int ColliderTree::packetBox(const RayPacket& packet,
+                                     const glm::vec3& minCorner, const glm::vec3& maxCorner)
+{
+    unsigned int hits[MAX_PACKET_SIZE];
+    const int n = packet.Count;
+
+    for (int i = 0; i < n; ++i)
+    {
+        float tx1 = (minCorner.x - packet.StartX[i]) * packet.InvDirX[i];
+        float tx2 = (maxCorner.x - packet.StartX[i]) * packet.InvDirX[i];
+        float ty1 = (minCorner.y - packet.StartY[i]) * packet.InvDirY[i];
+        float ty2 = (maxCorner.y - packet.StartY[i]) * packet.InvDirY[i];
+        float tz1 = (minCorner.z - packet.StartZ[i]) * packet.InvDirZ[i];
+        float tz2 = (maxCorner.z - packet.StartZ[i]) * packet.InvDirZ[i];
+        float tmin = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)),
+                              std::max(std::min(tz1, tz2), 0.0f));
+        float tmax = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)),
+                              std::max(tz1, tz2));
+        hits[i] = (tmin <= tmax) ? 1 : 0;
+    }
+    unsigned int mask = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        mask |= hits[i] << i;
+    }
+    return mask;
+}
+
+void ColliderTree::raycast(const RayPacket& packet, const PacketCallback& callback)
+{
+    if (packet.Count <= 0)
+    {
+        return;
+    }
+    unsigned int allRays = (packet.Count >= 32) ? ~0u : ((1u << packet.Count) - 1);
+
+    for (auto it = mUnbounded.begin(); it != mUnbounded.end(); ++it)
+    {
+        callback(*it, allRays);
+    }
+    if (mRoot == NULL_NODE)
+    {
+        return;
+    }
+    mStack.clear();
+    mStack.push_back(std::make_pair(mRoot, allRays));
+    while (!mStack.empty())
+    {
+        std::pair<int, unsigned int> entry = mStack.back();
+        mStack.pop_back();
+        const Node& node = mNodes[entry.first];
+        unsigned int mask = entry.second & packetBox(packet, node.Min, node.Max);
+
+        if (mask == 0)
+        {
+            continue;
+        }
+        if (node.Height == 0)
+        {
+            callback(node.Owner, mask);
+            continue;
+        }
+        mStack.push_back(std::make_pair(node.Child2, mask));
+        mStack.push_back(std::make_pair(node.Child1, mask));
+    }
+}
+
+void ColliderTree::query(const PickVolume& volume, const VolumeCallback& callback)
+{
+    for (auto it = mUnbounded.begin(); it != mUnbounded.end(); ++it)
+    {
+        callback(*it);
+    }
+    if (mRoot == NULL_NODE)
+    {
+        return;
+    }
+    mStack.clear();
+    mStack.push_back(std::make_pair(mRoot, 0u));
+    while (!mStack.empty())
+    {
+        int nodeIndex = mStack.back().first;
+        mStack.pop_back();
+        const Node& node = mNodes[nodeIndex];
+        int result = volume.classify(node.Min, node.Max);
+
+        if (result == PickVolume::OUTSIDE)
+        {
+            continue;
+        }
+        if (result == PickVolume::INSIDE)
+        {
+            addSubtree(nodeIndex, callback);
+            continue;
+        }
+        if (node.Height == 0)
+        {
+            /*
+             * Leaf bounds are enlarged, test the actual bounds.
+             */
+            if (volume.classify(mLeafBounds[2 * nodeIndex], mLeafBounds[2 * nodeIndex + 1]) != PickVolume::OUTSIDE)
+            {
+                callback(node.Owner);
+            }
+            continue;
+        }
+        mStack.push_back(std::make_pair(node.Child2, 0u));
+        mStack.push_back(std::make_pair(node.Child1, 0u));
+    }
+}
+
+/*
+ * Visit all the colliders below a node without testing their bounds.
+ */
+void ColliderTree::addSubtree(int nodeIndex, const VolumeCallback& callback)
+{
+    const Node& node = mNodes[nodeIndex];
+
+    if (node.Height == 0)
+    {
+        callback(node.Owner);
+        return;
+    }
+    addSubtree(node.Child1, callback);
+    addSubtree(node.Child2, callback);
+}
+
+}
@@ -0,0 +1,218 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Dynamic bounding volume tree over the colliders in a scene.
+ ***************************************************************************/
+
+#ifndef COLLIDER_TREE_H_
+#define COLLIDER_TREE_H_
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+#include "pick_volume.h"
+
+namespace gvr {
+class Collider;
+
+/*
+ * Keeps the world space bounds of the colliders in a scene
+ * in a dynamic axis aligned bounding box tree so a ray only
+ * has to be tested against the colliders it might hit.
+ *
+ * Leaves store bounds which are slightly larger than the
+ * collider so small movements do not change the tree.
+ * When a collider moves out of its leaf bounds the leaf is
+ * removed and reinserted where it least increases the surface
+ * area of the tree. Tree rotations keep it balanced.
+ *
+ * Colliders are marked dirty when their transform changes.
+ * Only dirty colliders are refit when the tree is updated,
+ * and mesh colliders whose vertices were written.
+ * Colliders which cannot be bounded (a ColliderGroup or a
+ * mesh collider without a mesh) are kept in a separate list
+ * and tested against every ray.
+ *
+ * The tree itself is not thread safe, the scene guards it with
+ * its collider lock. Marking a collider dirty may be done from
+ * any thread.
+ */
+class ColliderTree {
+public:
+    /*
+     * Called for each collider whose bounds the ray enters,
+     * nearest first. It is passed the distance along the ray
+     * to the collider bounds and returns the new maximum
+     * distance to search. Return the input maximum to find
+     * every collider, the distance to a hit to find the closest
+     * one or 0 to stop.
+     */
+    typedef std::function<float (Collider* collider, float distance)> RayCallback;
+
+    /*
+     * Called for each collider whose bounds are entered by
+     * at least one ray of a packet. The bits of the mask
+     * are set for the rays which hit the bounds.
+     */
+    typedef std::function<void (Collider* collider, unsigned int rayMask)> PacketCallback;
+
+    /*
+     * Called for each collider whose bounds overlap a volume.
+     */
+    typedef std::function<void (Collider* collider)> VolumeCallback;
+
+    static const int MAX_PACKET_SIZE = 32;
+
+    /*
+     * A group of rays in world coordinates traced together.
+     * The rays are stored as separate arrays of components so the
+     * bounds of a node are tested against all of them in one loop
+     * the compiler can vectorize.
+     */
+    struct RayPacket {
+        float   StartX[MAX_PACKET_SIZE];
+        float   StartY[MAX_PACKET_SIZE];
+        float   StartZ[MAX_PACKET_SIZE];
+        float   InvDirX[MAX_PACKET_SIZE];
+        float   InvDirY[MAX_PACKET_SIZE];
+        float   InvDirZ[MAX_PACKET_SIZE];
+        int     Count;
+
+        RayPacket() : Count(0) { }
+
+        /*
+         * Add a ray to the packet.
+         * @returns index of the ray in the packet or -1 if it is full
+         */
+        int addRay(const glm::vec3& rayStart, const glm::vec3& rayDir);
+    };
+
+    /*
+     * A node in the tree. Leaves have Height 0 and reference
+     * a collider, interior nodes always have two children.
+     */
+    struct Node {
+        glm::vec3   Min;
+        int         Parent;     // next free node for nodes on the free list
+        glm::vec3   Max;
+        int         Height;     // -1 for free nodes
+        int         Child1;
+        int         Child2;
+        Collider*   Owner;
+    };
+
+    static const int NULL_NODE = -1;
+    static const int UNBOUNDED_NODE = -2;
+
+    ColliderTree();
+
+    /*
+     * Add a collider. Its bounds are computed on the next update.
+     */
+    void addCollider(Collider* collider);
+
+    /*
+     * Remove a collider from the tree.
+     */
+    void removeCollider(Collider* collider);
+
+    /*
+     * Remove all the colliders.
+     */
+    void clear();
+
+    /*
+     * Request the bounds of a collider be recomputed on the next update.
+     * This function may be called from any thread.
+     */
+    void markDirty(Collider* collider);
+
+    /*
+     * Recompute the bounds of the dirty colliders and update the tree.
+     */
+    void update();
+
+    /*
+     * Visit the colliders whose bounds are hit by a ray in order
+     * of increasing distance. Unbounded colliders are visited
+     * first with a distance of 0.
+     * @param rayStart      origin of the ray in world coordinates
+     * @param rayDir        normalized direction of the ray in world coordinates
+     * @param maxDistance   distance along the ray to stop searching
+     * @param callback      called for each collider, returns the new maximum distance
+     */
+    void raycast(const glm::vec3& rayStart, const glm::vec3& rayDir,
+                 float maxDistance, const RayCallback& callback);
+
+    /*
+     * Visit the colliders whose bounds are hit by any ray in a packet.
+     * Unbounded colliders are visited with all the rays.
+     * Colliders are not visited in any particular order.
+     * @param packet    rays to trace
+     * @param callback  called for each collider with the rays that hit it
+     */
+    void raycast(const RayPacket& packet, const PacketCallback& callback);
+
+    /*
+     * Visit the colliders whose world bounds overlap a volume.
+     * Unbounded colliders are always visited.
+     * Colliders are not visited in any particular order.
+     * @param volume    volume to test against
+     * @param callback  called for each collider found
+     */
+    void query(const PickVolume& volume, const VolumeCallback& callback);
+
+    int getHeight() const;
+    int getNodeCount() const { return mNodeCount; }
+    int getColliderCount() const { return mLeafCount + mUnbounded.size(); }
+
+private:
+    ColliderTree(const ColliderTree&);
+    ColliderTree& operator=(const ColliderTree&);
+
+    int  allocateNode();
+    void freeNode(int nodeIndex);
+    void updateCollider(Collider* collider);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int  balance(int nodeIndex);
+    void refitNode(int nodeIndex);
+    void addSubtree(int nodeIndex, const VolumeCallback& callback);
+    static float rayBox(const glm::vec3& rayStart, const glm::vec3& rayDir,
+                        const glm::vec3& minCorner, const glm::vec3& maxCorner);
+    static unsigned int packetBox(const RayPacket& packet,
+                                  const glm::vec3& minCorner, const glm::vec3& maxCorner);
+
+    std::vector<Node>       mNodes;
+    std::vector<glm::vec3>  mLeafBounds;    // actual minimum and maximum corners of each leaf
+    int                     mRoot;
+    int                     mFreeList;
+    int                     mNodeCount;
+    int                     mLeafCount;
+    std::vector<Collider*>  mUnbounded;
+    std::vector<Collider*>  mWatched;       // colliders whose geometry may change
+    std::vector<Collider*>  mDirty;
+    std::vector<Collider*>  mUpdating;
+    std::mutex              mDirtyLock;
+    std::vector<std::pair<float, int>> mHeap;   // scratch space for ray casting
+    std::vector<std::pair<int, unsigned int>> mStack; // scratch space for packet tracing
+};
+
+}
+#endif
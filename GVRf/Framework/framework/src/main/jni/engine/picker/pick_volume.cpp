@@ -0,0 +1,195 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Volumes used to query the objects in a region of a scene.
+ ***************************************************************************/
+
+#include "pick_volume.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "glm/gtc/type_ptr.hpp"
+
+namespace gvr {
+
+PickVolume::PickVolume() : mType(ALL), mMin(0), mMax(0), mRadius(0)
+{
+}
+
+bool PickVolume::set(int type, const float* params)
+{
+    switch (type)
+    {
+        case ALL:
+            mType = ALL;
+            return true;
+
+        case BOX:
+            setBox(glm::vec3(params[0], params[1], params[2]),
+                   glm::vec3(params[3], params[4], params[5]));
+            return true;
+
+        case SPHERE:
+            setSphere(glm::vec3(params[0], params[1], params[2]), params[3]);
+            return true;
+
+        case FRUSTUM:
+            setFrustum(glm::make_mat4(params));
+            return true;
+    }
+    return false;
+}
+
+void PickVolume::setBox(const glm::vec3& minCorner, const glm::vec3& maxCorner)
+{
+    mType = BOX;
+    mMin = minCorner;
+    mMax = maxCorner;
+}
+
+void PickVolume::setSphere(const glm::vec3& center, float radius)
+{
+    mType = SPHERE;
+    mMin = center;
+    mMax = center;
+    mRadius = radius;
+}
+
+/*
+ * Extract the six clip planes from a view projection matrix
+ * (Gribb and Hartmann). The planes point into the frustum.
+ */
+void PickVolume::setFrustum(const glm::mat4& m)
+{
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    mType = FRUSTUM;
+    mPlanes[0] = row3 + row0;
+    mPlanes[1] = row3 - row0;
+    mPlanes[2] = row3 + row1;
+    mPlanes[3] = row3 - row1;
+    mPlanes[4] = row3 + row2;
+    mPlanes[5] = row3 - row2;
+}
+
+int PickVolume::classify(const glm::vec3& minCorner, const glm::vec3& maxCorner) const
+{
+    if ((minCorner.x > maxCorner.x) || (minCorner.y > maxCorner.y) || (minCorner.z > maxCorner.z))
+    {
+        return OUTSIDE;
+    }
+    if (mType == BOX)
+    {
+        if (!boxesOverlap(mMin, mMax, minCorner, maxCorner))
+        {
+            return OUTSIDE;
+        }
+        if (glm::all(glm::lessThanEqual(mMin, minCorner)) &&
+            glm::all(glm::greaterThanEqual(mMax, maxCorner)))
+        {
+            return INSIDE;
+        }
+        return INTERSECTS;
+    }
+    if (mType == SPHERE)
+    {
+        glm::vec3 nearest = glm::clamp(mMin, minCorner, maxCorner);
+        glm::vec3 farthest = glm::max(glm::abs(minCorner - mMin), glm::abs(maxCorner - mMin));
+        float r2 = mRadius * mRadius;
+
+        if (glm::dot(nearest - mMin, nearest - mMin) > r2)
+        {
+            return OUTSIDE;
+        }
+        if (glm::dot(farthest, farthest) <= r2)
+        {
+            return INSIDE;
+        }
+        return INTERSECTS;
+    }
+    if (mType == FRUSTUM)
+    {
+        glm::vec3 center = (minCorner + maxCorner) * 0.5f;
+        glm::vec3 extent = (maxCorner - minCorner) * 0.5f;
+        int result = INSIDE;
+
+        for (int i = 0; i < 6; ++i)
+        {
+            const glm::vec4& plane = mPlanes[i];
+            glm::vec3 normal(plane);
+            float d = glm::dot(normal, center) + plane.w;
+            float r = glm::dot(glm::abs(normal), extent);
+
+            if (d + r < 0)
+            {
+                return OUTSIDE;
+            }
+            if (d - r < 0)
+            {
+                result = INTERSECTS;
+            }
+        }
+        return result;
+    }
+    return INSIDE;
+}
+
+bool PickVolume::boxesOverlap(const glm::vec3& min1, const glm::vec3& max1,
+                              const glm::vec3& min2, const glm::vec3& max2)
+{
+    return  (max1.x >= min2.x) &&
+            (max1.y >= min2.y) &&
+            (max1.z >= min2.z) &&
+            (min1.x <= max2.x) &&
+            (min1.y <= max2.y) &&
+            (min1.z <= max2.z);
+}
+
+/*
+ * Slab test (Williams et al., "An Efficient and Robust
+ * Ray-Box Intersection Algorithm").
+ */
+bool PickVolume::rayHitsBox(const glm::vec3& rayStart, const glm::vec3& rayDir,
+                            const glm::vec3& minCorner, const glm::vec3& maxCorner)
+{
+    float tmin = -std::numeric_limits<float>::infinity();
+    float tmax = std::numeric_limits<float>::infinity();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (rayDir[i] == 0)
+        {
+            if ((rayStart[i] < minCorner[i]) || (rayStart[i] > maxCorner[i]))
+            {
+                return false;
+            }
+            continue;
+        }
+        float inv = 1.0f / rayDir[i];
+        float t1 = (minCorner[i] - rayStart[i]) * inv;
+        float t2 = (maxCorner[i] - rayStart[i]) * inv;
+
+        tmin = std::max(tmin, std::min(t1, t2));
+        tmax = std::min(tmax, std::max(t1, t2));
+    }
+    return (tmin <= tmax) && (tmax >= 0);
+}
+
+}
@@ -0,0 +1,101 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Volumes used to query the objects in a region of a scene.
+ ***************************************************************************/
+
+#ifndef PICK_VOLUME_H_
+#define PICK_VOLUME_H_
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+
+/*
+ * A region of world space which scene objects are tested against.
+ * It can be everything, an axis aligned box, a sphere or a view
+ * frustum. Axis aligned boxes are classified as outside, inside
+ * or intersecting the volume so hierarchies can stop testing
+ * below a node which is entirely inside.
+ */
+class PickVolume {
+public:
+    enum Type {
+        ALL = 0,
+        BOX = 1,
+        SPHERE = 2,
+        FRUSTUM = 3
+    };
+
+    enum Result {
+        OUTSIDE = 0,
+        INTERSECTS = 1,
+        INSIDE = 2
+    };
+
+    /*
+     * Construct a volume which contains everything.
+     */
+    PickVolume();
+
+    /*
+     * Construct a volume from an array of floats:
+     * BOX      6 floats, minimum and maximum corners
+     * SPHERE   4 floats, center and radius
+     * FRUSTUM  16 floats, column major matrix which transforms
+     *          world coordinates into clip coordinates
+     * ALL      no floats
+     * @returns true if the type is valid, false if not
+     */
+    bool set(int type, const float* params);
+
+    void setBox(const glm::vec3& minCorner, const glm::vec3& maxCorner);
+    void setSphere(const glm::vec3& center, float radius);
+    void setFrustum(const glm::mat4& viewProjection);
+
+    int type() const { return mType; }
+
+    /*
+     * Classify an axis aligned box against the volume.
+     * An empty box (minimum greater than maximum) is outside.
+     * @returns OUTSIDE, INSIDE or INTERSECTS
+     */
+    int classify(const glm::vec3& minCorner, const glm::vec3& maxCorner) const;
+
+    /*
+     * Determine whether two axis aligned boxes overlap.
+     */
+    static bool boxesOverlap(const glm::vec3& min1, const glm::vec3& max1,
+                             const glm::vec3& min2, const glm::vec3& max2);
+
+    /*
+     * Determine whether a ray intersects an axis aligned box.
+     * Only the part of the ray in front of its origin is tested.
+     */
+    static bool rayHitsBox(const glm::vec3& rayStart, const glm::vec3& rayDir,
+                           const glm::vec3& minCorner, const glm::vec3& maxCorner);
+
+private:
+    int         mType;
+    glm::vec3   mMin;
+    glm::vec3   mMax;
+    float       mRadius;
+    glm::vec4   mPlanes[6];
+};
+
+}
+#endif
@@ -19,6 +19,7 @@
 
 #include "picker.h"
 
+#include <algorithm>
 #include <limits>
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_inverse.hpp"
@@ -38,36 +39,162 @@ Picker::Picker() {
 Picker::~Picker() {
 }
 
+/*
+ * Hit test a single collider against a ray in world coordinates.
+ * Disabled colliders and colliders which are not visible
+ * (when only visible objects are pickable) are skipped.
+ *
+ * @returns distance from the ray origin to the hit point in
+ *          world coordinates or infinity if not hit
+ */
+static float hitCollider(Scene* scene, Collider* collider,
+                         const glm::vec3& rayStart, const glm::vec3& rayDir,
+                         ColliderData& data)
+{
+    SceneObject* owner = collider->owner_object();
+
+    if (!collider->enabled() || (owner == NULL) || !owner->enabled() ||
+        !scene->isColliderPickable(collider))
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+    data = collider->isHit(rayStart, rayDir);
+    if ((collider->pick_distance() > 0) && (collider->pick_distance() < data.Distance)) {
+        data.IsHit = false;
+    }
+    if (!data.IsHit) {
+        return std::numeric_limits<float>::infinity();
+    }
+    /*
+     * The hit position is in the coordinate system of the
+     * collider owner, the distance is not always in world
+     * coordinates so compute the world distance from that.
+     */
+    Transform* t = owner->transform();
+    if (t == NULL) {
+        return data.Distance;
+    }
+    glm::vec4 p = t->getModelMatrix() * glm::vec4(data.HitPosition, 1);
+    return glm::distance(rayStart, glm::vec3(p));
+}
+
 /*
  * Intersects all the colliders in the scene with the input ray
  * and returns the list of collisions.
  *
- * This function is not thread-safe because it relies on a static
- * array of colliders which could be updated by a different thread.
+ * Only the colliders whose world bounds are hit by the
+ * ray are tested. The list is sorted by distance.
  */
 void Picker::pickScene(Scene* scene, std::vector<ColliderData>& picklist, Transform* t,
                        float ox, float oy, float oz, float dx, float dy, float dz) {
     glm::vec3 ray_start(ox, oy, oz);
     glm::vec3 ray_dir(dx, dy, dz);
-    const std::vector<Component*>& colliders = scene->lockColliders();
     const glm::mat4& model_matrix = t->getModelMatrix();
 
     Collider::transformRay(model_matrix, ray_start, ray_dir);
-    for (auto it = colliders.begin(); it != colliders.end(); ++it) {
-        Collider* collider = reinterpret_cast<Collider*>(*it);
-        SceneObject* owner = collider->owner_object();
-        if (collider->enabled() && (owner != NULL) && owner->enabled()) {
-            ColliderData data = collider->isHit(ray_start, ray_dir);
-            if ((collider->pick_distance() > 0) && (collider->pick_distance() < data.Distance)) {
-                data.IsHit = false;
-            }
-            if (data.IsHit) {
-                picklist.push_back(data);
-            }
+    ColliderTree& tree = scene->lockColliderTree();
+    tree.raycast(ray_start, ray_dir, std::numeric_limits<float>::infinity(),
+                 [&](Collider* collider, float distance) {
+        ColliderData data;
+        if (hitCollider(scene, collider, ray_start, ray_dir, data) < std::numeric_limits<float>::infinity()) {
+            picklist.push_back(data);
         }
-    }
+        return std::numeric_limits<float>::infinity();
+    });
+    scene->unlockColliders();
     std::sort(picklist.begin(), picklist.end(), compareColliderData);
+}
+
+/*
+ * Intersects the colliders in the scene with several rays at once.
+ *
+ * The colliders are locked and their bounds updated once for all
+ * the rays. Rays are traced through the collider bounds in packets
+ * so each node of the tree is visited once per packet.
+ *
+ * @param rays      6 floats per ray, origin then direction,
+ *                  in the coordinate system of the transform
+ * @param numRays   number of rays
+ * @param hits      gets the hits for all the rays, ordered by ray
+ *                  and sorted by distance for each ray
+ * @param firstHit  gets numRays + 1 indices, the hits for ray i are
+ *                  hits[firstHit[i]] up to hits[firstHit[i + 1]]
+ */
+void Picker::pickSceneBatch(Scene* scene, Transform* t, const float* rays, int numRays,
+                            std::vector<ColliderData>& hits, std::vector<int>& firstHit) {
+    const glm::mat4& model_matrix = t->getModelMatrix();
+    std::vector<glm::vec3> ray_starts(numRays);
+    std::vector<glm::vec3> ray_dirs(numRays);
+    std::vector<std::vector<ColliderData>> ray_hits(numRays);
+
+    for (int i = 0; i < numRays; ++i) {
+        const float* r = rays + 6 * i;
+        ray_starts[i] = glm::vec3(r[0], r[1], r[2]);
+        ray_dirs[i] = glm::vec3(r[3], r[4], r[5]);
+        Collider::transformRay(model_matrix, ray_starts[i], ray_dirs[i]);
+    }
+    ColliderTree& tree = scene->lockColliderTree();
+    for (int first = 0; first < numRays; first += ColliderTree::MAX_PACKET_SIZE) {
+        ColliderTree::RayPacket packet;
+        int count = std::min(numRays - first, (int) ColliderTree::MAX_PACKET_SIZE);
+
+        for (int i = 0; i < count; ++i) {
+            packet.addRay(ray_starts[first + i], ray_dirs[first + i]);
+        }
+        tree.raycast(packet, [&](Collider* collider, unsigned int mask) {
+            for (int i = 0; mask != 0; ++i, mask >>= 1) {
+                if (mask & 1) {
+                    int r = first + i;
+                    ColliderData data;
+                    if (hitCollider(scene, collider, ray_starts[r], ray_dirs[r], data) < std::numeric_limits<float>::infinity()) {
+                        ray_hits[r].push_back(data);
+                    }
+                }
+            }
+        });
+    }
     scene->unlockColliders();
+    firstHit.resize(numRays + 1);
+    for (int i = 0; i < numRays; ++i) {
+        std::vector<ColliderData>& list = ray_hits[i];
+
+        std::sort(list.begin(), list.end(), compareColliderData);
+        firstHit[i] = hits.size();
+        hits.insert(hits.end(), list.begin(), list.end());
+    }
+    firstHit[numRays] = hits.size();
+}
+
+/*
+ * Finds the collider closest to the origin of the input ray.
+ *
+ * Colliders are visited in order of where the ray enters their
+ * world bounds and the search stops as soon as the remaining
+ * bounds are all farther away than the closest hit.
+ *
+ * @returns true if a collider was hit, false if not
+ */
+bool Picker::pickClosest(Scene* scene, ColliderData& closest, Transform* t,
+                         float ox, float oy, float oz, float dx, float dy, float dz) {
+    glm::vec3 ray_start(ox, oy, oz);
+    glm::vec3 ray_dir(dx, dy, dz);
+    const glm::mat4& model_matrix = t->getModelMatrix();
+    float closest_distance = std::numeric_limits<float>::infinity();
+
+    Collider::transformRay(model_matrix, ray_start, ray_dir);
+    ColliderTree& tree = scene->lockColliderTree();
+    tree.raycast(ray_start, ray_dir, closest_distance,
+                 [&](Collider* collider, float distance) {
+        ColliderData data;
+        float hit_distance = hitCollider(scene, collider, ray_start, ray_dir, data);
+        if (hit_distance < closest_distance) {
+            closest_distance = hit_distance;
+            closest = data;
+        }
+        return closest_distance;
+    });
+    scene->unlockColliders();
+    return closest_distance < std::numeric_limits<float>::infinity();
 }
 
 void Picker::pickScene(Scene* scene, std::vector<ColliderData>& pickList) {
@@ -121,28 +248,60 @@ glm::vec3 Picker::pickSceneObjectAgainstBoundingBox(const SceneObject* scene_obj
 }
 
 /*
- * Returns the list of all visible colliders.
+ * Finds the pickable colliders whose bounds overlap a volume.
  *
- * This function is not thread-safe because it relies on a static
- * array of colliders which could be updated by a different thread.
+ * Collider bounds are found with the collider tree of the scene.
+ * Render bounds are found by descending the scene graph and
+ * skipping the objects whose hierarchical bounds are outside.
+ * Disabled colliders and colliders which are not visible
+ * (when only visible objects are pickable) are not returned.
+ * The colliders are not in any particular order.
  */
-void Picker::pickVisible(Scene* scene, Transform* t, std::vector<ColliderData>& picklist) {
-    const std::vector<Component*>& colliders = scene->lockColliders();
+void Picker::pickVolume(Scene* scene, const PickVolume& volume, int boundsType,
+                        std::vector<Collider*>& colliders) {
+    int first = colliders.size();
 
-    for (auto it = colliders.begin(); it != colliders.end(); ++it) {
-        Collider* collider = reinterpret_cast<Collider*>(*it);
+    if (boundsType == QUERY_RENDER_BOUNDS) {
+        scene->getRoot()->getCollidersInVolume(volume, colliders);
+    } else {
+        ColliderTree& tree = scene->lockColliderTree();
+        tree.query(volume, [&](Collider* collider) {
+            colliders.push_back(collider);
+        });
+        scene->unlockColliders();
+    }
+    auto dest = colliders.begin() + first;
+    for (auto it = dest; it != colliders.end(); ++it) {
+        Collider* collider = *it;
         SceneObject* owner = collider->owner_object();
-        if (collider->enabled() && (owner != NULL) && owner->enabled()) {
-            ColliderData data(collider);
-            Transform* trans = owner->transform();
-            glm::mat4 worldmtx = trans->getModelMatrix();
-            data.HitPosition = glm::vec3(worldmtx[3]);
-            data.Distance = data.HitPosition.length();
-            data.IsHit = true;
-            picklist.push_back(data);
+        if (collider->enabled() && (owner != NULL) && owner->enabled() &&
+            scene->isColliderPickable(collider)) {
+            *dest++ = collider;
         }
     }
+    colliders.erase(dest, colliders.end());
+}
+
+/*
+ * Returns the list of all visible colliders.
+ * The hit position is the world position of the collider owner
+ * and the distance is measured from the input transform.
+ */
+void Picker::pickVisible(Scene* scene, Transform* t, std::vector<ColliderData>& picklist) {
+    std::vector<Collider*> colliders;
+    glm::vec3 origin(t->getModelMatrix()[3]);
+
+    pickVolume(scene, PickVolume(), QUERY_COLLIDER_BOUNDS, colliders);
+    for (auto it = colliders.begin(); it != colliders.end(); ++it) {
+        Collider* collider = *it;
+        ColliderData data(collider);
+        Transform* trans = collider->owner_object()->transform();
+        glm::mat4 worldmtx = trans->getModelMatrix();
+        data.HitPosition = glm::vec3(worldmtx[3]);
+        data.Distance = glm::distance(origin, data.HitPosition);
+        data.IsHit = true;
+        picklist.push_back(data);
+    }
     std::sort(picklist.begin(), picklist.end(), compareColliderData);
-    scene->unlockColliders();
 }
 }
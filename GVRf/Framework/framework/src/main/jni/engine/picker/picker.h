@@ -24,6 +24,7 @@
 #include <vector>
 #include <memory>
 #include "objects/components/collider.h"
+#include "pick_volume.h"
 #include "glm/glm.hpp"
 
 namespace gvr {
@@ -39,6 +40,19 @@ private:
     ~Picker();
 
 public:
+    /*
+     * Bounds tested by pickVolume.
+     * QUERY_COLLIDER_BOUNDS uses the world bounds of the colliders,
+     * QUERY_RENDER_BOUNDS uses the hierarchical bounding volumes
+     * of the scene objects which own the colliders.
+     */
+    enum {
+        QUERY_COLLIDER_BOUNDS = 0,
+        QUERY_RENDER_BOUNDS = 1
+    };
+
+    static void pickVolume(Scene* scene, const PickVolume& volume, int boundsType,
+                           std::vector<Collider*>& colliders);
     static void pickVisible(Scene* scene, Transform* t, std::vector<ColliderData>& pickList);
     static void pickScene(Scene* scene, std::vector<ColliderData>& pickList);
     static void pickScene(
@@ -46,6 +60,16 @@ public:
             Transform* t,
             float ox, float oy, float oz,
             float dx, float dy, float dz);
+    static void pickSceneBatch(
+            Scene* scene, Transform* t,
+            const float* rays, int numRays,
+            std::vector<ColliderData>& hits,
+            std::vector<int>& firstHit);
+    static bool pickClosest(
+            Scene* scene, ColliderData& closest,
+            Transform* t,
+            float ox, float oy, float oz,
+            float dx, float dy, float dz);
     static void pickSceneObject(
             const SceneObject* scene_object,
             float ox, float oy, float oz,
@@ -18,6 +18,8 @@
  * JNI
  ***************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <objects/components/mesh_collider.h>
 #include "picker.h"
 #include "objects/scene.h"
@@ -26,6 +28,24 @@
 #include "glm/gtc/type_ptr.hpp"
 
 namespace gvr {
+
+/*
+ * Hit record written by pickSceneBatch, read by GVRPicker.GVRPickBatch.
+ * The buffer starts with numRays + 1 ints giving the index of the
+ * first hit of each ray, padded to a multiple of 8 bytes,
+ * followed by one record per hit.
+ */
+struct PickRecord {
+    jlong   Collider;
+    float   Distance;
+    float   HitPosition[3];
+    int     FaceIndex;
+    float   BarycentricCoordinates[3];
+    float   TextureCoordinates[2];
+    float   NormalCoordinates[3];
+    int     RayIndex;
+};
+
 extern "C" {
     JNIEXPORT jlongArray JNICALL
     Java_org_gearvrf_NativePicker_pickScene(JNIEnv * env,
@@ -35,6 +55,14 @@ extern "C" {
     Java_org_gearvrf_NativePicker_pickObjects(JNIEnv * env,
             jobject obj, jlong jscene, jlong jtransform, jfloat ox, jfloat oy, jfloat oz, jfloat dx,
             jfloat dy, jfloat dz);
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativePicker_pickSceneBatch(JNIEnv * env,
+            jobject obj, jlong jscene, jlong jtransform, jfloatArray jrays, jint numRays,
+            jobject jbuffer);
+    JNIEXPORT jobject JNICALL
+    Java_org_gearvrf_NativePicker_pickClosest(JNIEnv * env,
+            jobject obj, jlong jscene, jlong jtransform, jfloat ox, jfloat oy, jfloat oz, jfloat dx,
+            jfloat dy, jfloat dz);
     JNIEXPORT jobject JNICALL
     Java_org_gearvrf_NativePicker_pickSceneObject(JNIEnv * env,
             jobject obj, jlong jscene_object, jfloat ox, jfloat oy, jfloat oz,
@@ -46,6 +74,10 @@ extern "C" {
     JNIEXPORT jobjectArray JNICALL
     Java_org_gearvrf_NativePicker_pickVisible(JNIEnv * env,
             jobject obj, jlong jscene);
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativePicker_pickVolume(JNIEnv * env,
+            jobject obj, jlong jscene, jint volumeType, jfloatArray jparams,
+            jint boundsType, jlongArray jresults);
 }
 
 JNIEXPORT jlongArray JNICALL
@@ -122,6 +154,100 @@ Java_org_gearvrf_NativePicker_pickObjects(JNIEnv * env,
     return pickList;
 }
 
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativePicker_pickSceneBatch(JNIEnv * env,
+        jobject obj, jlong jscene, jlong jtransform, jfloatArray jrays, jint numRays,
+        jobject jbuffer)
+{
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    Transform* t = reinterpret_cast<Transform*>(jtransform);
+    std::vector<ColliderData> hits;
+    std::vector<int> firstHit;
+
+    if (t == NULL) {
+        t = scene->main_camera_rig()->getHeadTransform();
+    }
+    jfloat* rays = env->GetFloatArrayElements(jrays, 0);
+    Picker::pickSceneBatch(scene, t, rays, numRays, hits, firstHit);
+    env->ReleaseFloatArrayElements(jrays, rays, JNI_ABORT);
+
+    char* buffer = static_cast<char*>(env->GetDirectBufferAddress(jbuffer));
+    jlong capacity = env->GetDirectBufferCapacity(jbuffer);
+    int headerSize = ((numRays + 1) * sizeof(int) + 7) & ~7;
+    jlong size = headerSize + hits.size() * sizeof(PickRecord);
+
+    /*
+     * If the hits do not fit nothing is written,
+     * the caller enlarges the buffer and picks again.
+     */
+    if ((buffer == NULL) || (capacity < size)) {
+        return hits.size();
+    }
+    memcpy(buffer, firstHit.data(), (numRays + 1) * sizeof(int));
+    PickRecord* record = reinterpret_cast<PickRecord*>(buffer + headerSize);
+    for (int r = 0; r < numRays; ++r) {
+        for (int i = firstHit[r]; i < firstHit[r + 1]; ++i, ++record) {
+            const ColliderData& data = hits[i];
+            record->Collider = reinterpret_cast<jlong>(data.ColliderHit);
+            record->Distance = data.Distance;
+            record->HitPosition[0] = data.HitPosition.x;
+            record->HitPosition[1] = data.HitPosition.y;
+            record->HitPosition[2] = data.HitPosition.z;
+            record->FaceIndex = data.FaceIndex;
+            record->BarycentricCoordinates[0] = data.BarycentricCoordinates.x;
+            record->BarycentricCoordinates[1] = data.BarycentricCoordinates.y;
+            record->BarycentricCoordinates[2] = data.BarycentricCoordinates.z;
+            record->TextureCoordinates[0] = data.TextureCoordinates.x;
+            record->TextureCoordinates[1] = data.TextureCoordinates.y;
+            record->NormalCoordinates[0] = data.NormalCoordinates.x;
+            record->NormalCoordinates[1] = data.NormalCoordinates.y;
+            record->NormalCoordinates[2] = data.NormalCoordinates.z;
+            record->RayIndex = r;
+        }
+    }
+    return hits.size();
+}
+
+JNIEXPORT jobject JNICALL
+Java_org_gearvrf_NativePicker_pickClosest(JNIEnv * env,
+        jobject obj, jlong jscene, jlong jtransform, jfloat ox, jfloat oy, jfloat oz, jfloat dx,
+        jfloat dy, jfloat dz)
+{
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    Transform* t = reinterpret_cast<Transform*>(jtransform);
+    ColliderData data;
+
+    if (t == NULL) {
+        t = scene->main_camera_rig()->getHeadTransform();
+    }
+    if (!Picker::pickClosest(scene, data, t, ox, oy, oz, dx, dy, dz)) {
+        return NULL;
+    }
+    jclass pickerClass = env->FindClass("org/gearvrf/GVRPicker");
+    jlong pointerCollider = reinterpret_cast<jlong>(data.ColliderHit);
+    jobject hitObject;
+    MeshCollider* meshCollider = (MeshCollider *) data.ColliderHit;
+
+    if (meshCollider->shape_type() == COLLIDER_SHAPE_MESH && meshCollider->pickCoordinatesEnabled()) {
+        jmethodID makeHitMesh = env->GetStaticMethodID(pickerClass, "makeHitMesh", "(JFFFFIFFFFFFFF)Lorg/gearvrf/GVRPicker$GVRPickedObject;");
+        hitObject = env->CallStaticObjectMethod(pickerClass, makeHitMesh, pointerCollider,
+                                                data.Distance,
+                                                data.HitPosition.x, data.HitPosition.y, data.HitPosition.z,
+                                                data.FaceIndex,
+                                                data.BarycentricCoordinates.x, data.BarycentricCoordinates.y, data.BarycentricCoordinates.z,
+                                                data.TextureCoordinates.x, data.TextureCoordinates.y,
+                                                data.NormalCoordinates.x, data.NormalCoordinates.y, data.NormalCoordinates.z);
+    }
+    else {
+        jmethodID makeHit = env->GetStaticMethodID(pickerClass, "makeHit", "(JFFFF)Lorg/gearvrf/GVRPicker$GVRPickedObject;");
+        hitObject = env->CallStaticObjectMethod(pickerClass, makeHit, pointerCollider,
+                                                data.Distance,
+                                                data.HitPosition.x, data.HitPosition.y, data.HitPosition.z);
+    }
+    env->DeleteLocalRef(pickerClass);
+    return hitObject;
+}
+
 JNIEXPORT jobject JNICALL
 Java_org_gearvrf_NativePicker_pickSceneObject(JNIEnv * env,
                                               jobject obj, jlong jscene_object,
@@ -232,4 +358,33 @@ Java_org_gearvrf_NativePicker_pickVisible(JNIEnv * env,
     return pickList;
 }
 
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativePicker_pickVolume(JNIEnv * env,
+        jobject obj, jlong jscene, jint volumeType, jfloatArray jparams,
+        jint boundsType, jlongArray jresults)
+{
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    PickVolume volume;
+    std::vector<Collider*> colliders;
+    jfloat* params = (jparams != NULL) ? env->GetFloatArrayElements(jparams, 0) : NULL;
+    bool valid = volume.set(volumeType, params);
+
+    if (params != NULL) {
+        env->ReleaseFloatArrayElements(jparams, params, JNI_ABORT);
+    }
+    if (!valid) {
+        LOGE("Picker::pickVolume unknown volume type %d", volumeType);
+        return 0;
+    }
+    Picker::pickVolume(scene, volume, boundsType, colliders);
+
+    int n = std::min((int) colliders.size(), (int) env->GetArrayLength(jresults));
+    jlong* results = env->GetLongArrayElements(jresults, 0);
+    for (int i = 0; i < n; ++i) {
+        results[i] = reinterpret_cast<jlong>(colliders[i]);
+    }
+    env->ReleaseLongArrayElements(jresults, results, 0);
+    return colliders.size();
+}
+
 }
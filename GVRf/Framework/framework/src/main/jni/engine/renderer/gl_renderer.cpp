@@ -547,7 +547,7 @@ namespace gvr
             }
             if (curr_material->updateGPU(this,render_data) >= 0)
             {
-                numberTriangles += indexCount;
+                incrementTriangles(render_data, indexCount);
                 numberDrawCalls++;
                 set_face_culling(render_data->pass(0)->cull_face());
                 render_data->updateGPU(this, shader);
@@ -561,7 +561,7 @@ namespace gvr
          */
         for (int curr_pass = 0; curr_pass < render_data->pass_count(); ++curr_pass)
         {
-            numberTriangles += indexCount;
+            incrementTriangles(render_data, indexCount);
             numberDrawCalls++;
             set_face_culling(render_data->pass(curr_pass)->cull_face());
             curr_material = render_data->pass(curr_pass)->material();
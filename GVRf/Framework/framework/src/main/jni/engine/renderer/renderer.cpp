@@ -18,8 +18,10 @@
  ***************************************************************************/
 
 #include <contrib/glm/gtc/type_ptr.hpp>
+#include "glm/gtc/matrix_inverse.hpp"
 #include "renderer.h"
 #include "objects/scene.h"
+#include "objects/components/perspective_camera.h"
 
 #define MAX_INDICES 500
 #define BATCH_SIZE 60
@@ -39,13 +41,16 @@ Renderer::Renderer() : numberDrawCalls(0),
                        numLights(0),
                        batch_manager(nullptr),
                        post_effect_mesh_(nullptr){
+    for (int i = 0; i < MAX_LOD_LEVELS; ++i) {
+        numberLODTriangles[i] = 0;
+    }
     if(do_batching && !gRenderer->isVulkanInstance()) {
         batch_manager = new BatchManager(BATCH_SIZE, MAX_INDICES);
     }
 }
-void Renderer::frustum_cull(glm::vec3 camera_position, SceneObject *object,
+void Renderer::frustum_cull(glm::vec3 camera_position, const LODView& lod_view, SceneObject *object,
         float frustum[6][4], std::vector<SceneObject*>& scene_objects,
-        bool need_cull, int planeMask) {
+        bool need_cull, int planeMask, int lod_level) {
 
     // frustumCull() return 3 possible values:
     // 0 when the HBV of the object is completely outside the frustum: cull itself and all its children out
@@ -58,10 +63,23 @@ void Renderer::frustum_cull(glm::vec3 camera_position, SceneObject *object,
         return;
     }
 
+    // Choose the level of detail for this camera before culling so the
+    // bounding volume and mesh reflect the selected level.
+    LODGroup* lod = static_cast<LODGroup*>(object->getComponent(LODGroup::getComponentType()));
+    bool render_self = true;
+    if ((nullptr != lod) && lod->enabled()) {
+        int level = lod_view.select_levels ? lod->select(lod_view) : lod->getCurrentLevel();
+        if (level >= 0) {
+            lod_level = level;
+        }
+        render_self = !lod->isOwnerCulled();
+    }
+
     //allows for on demand calculation of the camera distance; usually matters
     //when transparent objects are in play
     RenderData* renderData = object->render_data();
     if (nullptr != renderData) {
+        renderData->set_lod_level(lod_level);
         renderData->setCameraDistanceLambda([object, camera_position]() {
             // Transform the bounding volume
             BoundingVolume bounding_volume_ = object->getBoundingVolume();
@@ -85,23 +103,40 @@ void Renderer::frustum_cull(glm::vec3 camera_position, SceneObject *object,
         }
 
         if (cullVal >= 2) {
-            object->setCullStatus(false);
-            scene_objects.push_back(object);
+            object->setCullStatus(!render_self);
+            if (render_self) {
+                scene_objects.push_back(object);
+            }
         }
 
         if (cullVal == 3) {
-            object->setCullStatus(false);
+            object->setCullStatus(!render_self);
             need_cull = false;
         }
     } else {
-        object->setCullStatus(false);
-        scene_objects.push_back(object);
+        object->setCullStatus(!render_self);
+        if (render_self) {
+            scene_objects.push_back(object);
+        }
     }
 
     const std::vector<SceneObject*> children = object->children();
     for (auto it = children.begin(); it != children.end(); ++it) {
-        frustum_cull(camera_position, *it, frustum, scene_objects, need_cull, planeMask);
+        if ((nullptr != lod) && lod->enabled() && !lod->isVisible(*it)) {
+            (*it)->setCullStatus(true);
+            continue;
+        }
+        frustum_cull(camera_position, lod_view, *it, frustum,
+                     scene_objects, need_cull, planeMask, lod_level);
+    }
+}
+
+int Renderer::incrementTriangles(RenderData* render_data, int number) {
+    int level = render_data->lod_level();
+    if ((level >= 0) && (level < MAX_LOD_LEVELS)) {
+        numberLODTriangles[level] += number;
     }
+    return numberTriangles += number;
 }
 
 void Renderer::state_sort(std::vector<RenderData*>* render_data_vector) {
@@ -148,6 +183,22 @@ bool isRenderPassEqual(RenderData* rdata1, RenderData* rdata2){
     return true;
 }
 
+/*
+ * Levels of detail are only selected for the cameras of the main
+ * camera rig, other cameras render the levels they selected.
+ */
+bool Renderer::isMainCamera(Scene* scene, Camera* camera)
+{
+    const CameraRig* rig = scene->main_camera_rig();
+
+    if (rig == nullptr)
+    {
+        return true;
+    }
+    return (camera == rig->center_camera()) || (camera == rig->left_camera()) ||
+           (camera == rig->right_camera());
+}
+
 /*
  * Perform view frustum culling from a specific camera viewpoint
  */
@@ -183,7 +234,12 @@ void Renderer::cullFromCamera(Scene *scene, Camera* camera,
         LOGD("FRUSTUM: start frustum culling for root %s\n", object->name().c_str());
     }
     //    frustum_cull(camera->owner_object()->transform()->position(), object, frustum, scene_objects, scene->get_frustum_culling(), 0);
-    frustum_cull(campos, object, frustum, scene_objects, scene->get_frustum_culling(), 0);
+    LODView lod_view;
+    lod_view.eye_position = glm::vec3(glm::affineInverse(rstate.uniforms.u_view)[3]);
+    lod_view.projection = rstate.uniforms.u_proj;
+    lod_view.bias = scene->get_lod_bias();
+    lod_view.select_levels = isMainCamera(scene, camera);
+    frustum_cull(campos, lod_view, object, frustum, scene_objects, scene->get_frustum_culling(), 0, -1);
     if (DEBUG_RENDERER) {
         LOGD("FRUSTUM: end frustum culling for root %s\n", object->name().c_str());
     }
@@ -29,6 +29,7 @@
 #include "objects/eye_type.h"
 #include "objects/mesh.h"
 #include "objects/bounding_volume.h"
+#include "objects/components/lod_group.h"
 #include "shaders/shader_manager.h"
 #include "batch_manager.h"
 
@@ -97,6 +98,9 @@ public:
     void resetStats() {
         numberDrawCalls = 0;
         numberTriangles = 0;
+        for (int i = 0; i < MAX_LOD_LEVELS; ++i) {
+            numberLODTriangles[i] = 0;
+        }
     }
     bool isVulkanInstance(){
         return isVulkan_;
@@ -114,6 +118,14 @@ public:
      int incrementTriangles(int number=1){
         return numberTriangles += number;
      }
+     /*
+      * Triangles drawn by meshes selected by a LODGroup
+      * are counted both in the total and per level.
+      */
+     int getNumberLODTriangles(int level) {
+        return ((level >= 0) && (level < MAX_LOD_LEVELS)) ? numberLODTriangles[level] : 0;
+     }
+     int incrementTriangles(RenderData* render_data, int number);
      int incrementDrawCalls(){
         return ++numberDrawCalls;
      }
@@ -164,9 +176,10 @@ public:
 private:
     static bool isVulkan_;
     virtual void build_frustum(float frustum[6][4], const float *vp_matrix);
-    virtual void frustum_cull(glm::vec3 camera_position, SceneObject *object,
+    virtual void frustum_cull(glm::vec3 camera_position, const LODView& lod_view, SceneObject *object,
             float frustum[6][4], std::vector<SceneObject*>& scene_objects,
-            bool continue_cull, int planeMask);
+            bool continue_cull, int planeMask, int lod_level);
+    bool isMainCamera(Scene* scene, Camera* camera);
 
     Renderer(const Renderer& render_engine);
     Renderer(Renderer&& render_engine);
@@ -192,6 +205,7 @@ protected:
 
     int numberDrawCalls;
     int numberTriangles;
+    int numberLODTriangles[MAX_LOD_LEVELS];
     bool useStencilBuffer_ = false;
     Mesh* post_effect_mesh_;
 public:
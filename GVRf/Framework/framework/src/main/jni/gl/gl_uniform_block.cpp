@@ -61,6 +61,36 @@ namespace gvr {
         return true;
     }
 
+    bool GLUniformBlock::updateGPU(Renderer* renderer, int firstElem, int numElems)
+    {
+        if (!mUseBuffer || (GLBuffer == 0))
+        {
+            return updateGPU(renderer);
+        }
+        if (mBindingPoint < 0)
+        {
+            return false;
+        }
+        if ((firstElem < 0) || (numElems <= 0) || (firstElem + numElems > mMaxElems))
+        {
+            LOGE("UniformBlock: ERROR: range %d, %d out of bounds for %s\n", firstElem, numElems, getBlockName());
+            return false;
+        }
+        if (mIsDirty)
+        {
+            int offset = firstElem * mElemSize;
+
+            glBindBuffer(GL_UNIFORM_BUFFER, GLBuffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, GLOffset + offset, numElems * mElemSize,
+                            static_cast<const char*>(getData()) + offset);
+            mIsDirty = false;
+            if (Shader::LOG_SHADER)
+                LOGV("UniformBlock::updateGPU %s elements %d to %d\n", getBlockName(), firstElem, firstElem + numElems - 1);
+        }
+        checkGLError("GLUniformBlock::updateGPU");
+        return true;
+    }
+
     bool GLUniformBlock::bindBuffer(Shader* shader, Renderer* unused)
     {
         GLShader* glshader = static_cast<GLShader*>(shader);
@@ -43,6 +43,11 @@ namespace gvr
          */
         virtual bool updateGPU(Renderer *);
 
+        /**
+         * Copy a range of elements into the OpenGL uniform buffer.
+         */
+        virtual bool updateGPU(Renderer *, int firstElem, int numElems);
+
         /*
          * Bind the uniform buffer to the OpenGL shader
          */
@@ -29,6 +29,29 @@ namespace gvr {
         }
     }
 
+    /***
+     * Get the GL component type for a vertex attribute.
+     * @param entry vertex attribute
+     * @return GL_HALF_FLOAT, GL_BYTE, GL_UNSIGNED_BYTE, GL_SHORT,
+     *         GL_UNSIGNED_SHORT, GL_INT or GL_FLOAT
+     */
+    GLenum GLVertexBuffer::getGLType(const DataEntry& entry)
+    {
+        if (entry.ComponentSize == 1)
+        {
+            return entry.IsUnsigned ? GL_UNSIGNED_BYTE : GL_BYTE;
+        }
+        if (entry.ComponentSize == 2)
+        {
+            if (!entry.IsInt && !entry.IsNormalized)
+            {
+                return GL_HALF_FLOAT;
+            }
+            return entry.IsUnsigned ? GL_UNSIGNED_SHORT : GL_SHORT;
+        }
+        return entry.IsInt ? GL_INT : GL_FLOAT;
+    }
+
     /***
      * Binds a VertexBuffer to a specific shader.
      * The binding occurs if the VertexBuffer was previously used
@@ -68,9 +91,23 @@ namespace gvr {
                     if (loc >= 0)                       // attribute found in shader?
                     {
                         glEnableVertexAttribArray(loc); // enable this attribute in GL
-                        glVertexAttribPointer(loc, entry->Size / sizeof(float),
-                                              entry->IsInt ? GL_INT : GL_FLOAT, GL_FALSE,
-                                              getTotalSize(), (GLvoid*) entry->Offset);
+                        if (entry->ComponentSize == sizeof(float))
+                        {
+                            glVertexAttribPointer(loc, entry->Size / sizeof(float),
+                                                  entry->IsInt ? GL_INT : GL_FLOAT, GL_FALSE,
+                                                  getTotalSize(), (GLvoid*) entry->Offset);
+                        }
+                        else if (entry->IsInt)          // packed integers stay integers
+                        {
+                            glVertexAttribIPointer(loc, entry->ComponentCount, getGLType(*entry),
+                                                   getTotalSize(), (GLvoid*) entry->Offset);
+                        }
+                        else                            // half floats or normalized integers
+                        {
+                            glVertexAttribPointer(loc, entry->ComponentCount, getGLType(*entry),
+                                                  entry->IsNormalized ? GL_TRUE : GL_FALSE,
+                                                  getTotalSize(), (GLvoid*) entry->Offset);
+                        }
                         LOGV("VertexBuffer: vertex attrib #%d %s loc %d ofs %d",
                              e.Index, e.Name, loc, entry->Offset);
                         checkGLError("VertexBuffer::bindToShader");
@@ -125,6 +162,17 @@ namespace gvr {
             mIsDirty = false;
             LOGV("VertexBuffer::updateGPU updated vertex buffer %d", mVBufferID);
         }
+        else if (mDirtyEnd > mDirtyBegin)   // only some vertices changed
+        {
+            int vsize = getTotalSize();
+
+            glBindBuffer(GL_ARRAY_BUFFER, mVBufferID);
+            glBufferSubData(GL_ARRAY_BUFFER, mDirtyBegin * vsize, (mDirtyEnd - mDirtyBegin) * vsize,
+                            mVertexData + mDirtyBegin * vsize);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            LOGV("VertexBuffer::updateGPU updated vertices %d to %d of %d", mDirtyBegin, mDirtyEnd - 1, mVBufferID);
+        }
+        clearDirtyRange();
         return true;
     }
 
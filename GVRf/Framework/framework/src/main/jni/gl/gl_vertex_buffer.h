@@ -33,6 +33,8 @@ namespace gvr {
         virtual void    bindToShader(Shader*, IndexBuffer*);
 
     protected:
+        static GLenum   getGLType(const DataEntry& entry);
+
         GLuint          mVBufferID;
         GLuint          mVArrayID;
         GLuint          mProgramID;
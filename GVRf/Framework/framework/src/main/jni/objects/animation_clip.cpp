@@ -0,0 +1,784 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Key frames of a skeletal animation.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <math.h>
+
+#include "objects/animation_clip.h"
+#include "objects/components/skeleton.h"
+#include "util/gvr_log.h"
+#include "util/gvr_simd.h"
+
+namespace gvr {
+
+static const int LANES = 4;                 // channels interpolated together
+static const int VECTOR_KEY_SIZE = 4;      // t, x, y, z
+static const int ROTATION_KEY_SIZE = 5;    // t, x, y, z, w
+static const int NUM_COMPONENTS[3] = { 3, 4, 3 };
+
+static const uint32_t CLIP_MAGIC = 0x50494C43;     // "CLIP"
+static const uint32_t CLIP_VERSION = 1;
+static const int MAX_SEGMENT_KEYS = 128;            // longest run of keys replaced by one segment
+static const float SMALLEST_THREE_RANGE = 0.70710678f;
+static const float SMALLEST_THREE_STEP = 2 * SMALLEST_THREE_RANGE / 32767;
+
+/*
+ * Compressed clip layout. All offsets are in bytes from
+ * the start of the header, arrays are 4 byte aligned.
+ */
+struct AnimationClip::ClipHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    size;               // of the whole clip
+    uint32_t    raw_size;           // of the keys before compression
+    float       max_error[3];       // per TrackKind
+    uint32_t    num_channels;
+    uint32_t    channels_offset;    // ClipChannel per channel
+    uint32_t    names_offset;       // null terminated channel names
+    uint32_t    num_keys[3];
+    uint32_t    times_offset[3];    // float per key
+    uint32_t    values_offset[3];   // three uint16_t per key
+    float       range_min[3][3];    // vector value = min + quantized * step
+    float       range_step[3][3];
+};
+
+struct ClipChannel {
+    uint32_t    name_offset;        // from names_offset
+    uint32_t    first[3];
+    uint32_t    count[3];
+};
+
+static inline uint32_t align4(uint32_t offset) {
+    return (offset + 3) & ~3;
+}
+
+/*
+ * Store the three smallest components of a unit quaternion
+ * in 15 bits each and the index of the largest in 2 bits.
+ * The largest is made positive and rebuilt from the others.
+ */
+static void encodeRotation(const float* q, uint16_t* out) {
+    int largest = 0;
+
+    for (int c = 1; c < 4; ++c) {
+        if (fabsf(q[c]) > fabsf(q[largest])) {
+            largest = c;
+        }
+    }
+    float sign = (q[largest] < 0) ? -1.0f : 1.0f;
+    uint64_t bits = (uint64_t) largest << 45;
+    int shift = 30;
+
+    for (int c = 0; c < 4; ++c) {
+        if (c == largest) {
+            continue;
+        }
+        float v = (sign * q[c] + SMALLEST_THREE_RANGE) / SMALLEST_THREE_STEP;
+        long quantized = lroundf(std::max(0.0f, std::min(v, 32767.0f)));
+        bits |= (uint64_t) quantized << shift;
+        shift -= 15;
+    }
+    out[0] = bits & 0xFFFF;
+    out[1] = (bits >> 16) & 0xFFFF;
+    out[2] = (bits >> 32) & 0xFFFF;
+}
+
+static void decodeRotation(const uint16_t* in, float* q) {
+    uint64_t bits = in[0] | ((uint64_t) in[1] << 16) | ((uint64_t) in[2] << 32);
+    int largest = (bits >> 45) & 3;
+    int shift = 30;
+    float sum = 0;
+
+    for (int c = 0; c < 4; ++c) {
+        if (c == largest) {
+            continue;
+        }
+        q[c] = ((bits >> shift) & 0x7FFF) * SMALLEST_THREE_STEP - SMALLEST_THREE_RANGE;
+        sum += q[c] * q[c];
+        shift -= 15;
+    }
+    q[largest] = sqrtf(std::max(0.0f, 1.0f - sum));
+}
+
+static float rotationDistance(const float* a, const float* b) {
+    float d = fabsf(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+    return 2 * acosf(std::min(d, 1.0f));
+}
+
+static float vectorDistance(const float* a, const float* b) {
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+static void interpolate(int kind, const float* a, const float* b, float factor, float* out) {
+    if (kind == AnimationClip::ROTATION) {
+        glm::quat q = glm::slerp(glm::quat(a[3], a[0], a[1], a[2]),
+                                 glm::quat(b[3], b[0], b[1], b[2]), factor);
+        out[0] = q.x; out[1] = q.y; out[2] = q.z; out[3] = q.w;
+    } else {
+        for (int c = 0; c < 3; ++c) {
+            out[c] = a[c] + (b[c] - a[c]) * factor;
+        }
+    }
+}
+
+static float keyDistance(int kind, const float* a, const float* b) {
+    return (kind == AnimationClip::ROTATION) ? rotationDistance(a, b) : vectorDistance(a, b);
+}
+
+void LocalPose::resize(int num_joints) {
+    positions.resize(num_joints, glm::vec3(0, 0, 0));
+    rotations.resize(num_joints, glm::quat());
+    scales.resize(num_joints, glm::vec3(1, 1, 1));
+    posed.resize(num_joints, false);
+}
+
+AnimationClip::Track AnimationClip::KeyArrays::add(const float* keys, int num_keys,
+                                                   int num_components) {
+    Track track = { (int) time.size(), num_keys, 0 };
+    int stride = num_components + 1;
+
+    for (int k = 0; k < num_keys; ++k) {
+        const float* key = keys + k * stride;
+
+        time.push_back(key[0]);
+        for (int c = 0; c < num_components; ++c) {
+            value[c].push_back(key[c + 1]);
+        }
+    }
+    return track;
+}
+
+AnimationClip::AnimationClip() :
+        HybridObject(), channels_(), compressed_(nullptr) {
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+int AnimationClip::addChannel(const char* name,
+                              const float* position_keys, int num_position_keys,
+                              const float* rotation_keys, int num_rotation_keys,
+                              const float* scale_keys, int num_scale_keys) {
+    Channel channel;
+
+    if (compressed_) {
+        return -1;
+    }
+    channel.name = name ? name : "";
+    channel.tracks[POSITION] = keys_[POSITION].add(position_keys, num_position_keys,
+                                                   VECTOR_KEY_SIZE - 1);
+    channel.tracks[ROTATION] = keys_[ROTATION].add(rotation_keys, num_rotation_keys,
+                                                   ROTATION_KEY_SIZE - 1);
+    channel.tracks[SCALE] = keys_[SCALE].add(scale_keys, num_scale_keys, VECTOR_KEY_SIZE - 1);
+    channel.tolerances[POSITION] = channel.tolerances[ROTATION] = channel.tolerances[SCALE] = -1;
+    channel.joint = -1;
+    channels_.push_back(std::move(channel));
+    return channels_.size() - 1;
+}
+
+int AnimationClip::bind(const Skeleton& skeleton) {
+    bound_channels_.clear();
+    for (int c = 0; c < (int) channels_.size(); ++c) {
+        channels_[c].joint = skeleton.findJoint(channels_[c].name);
+        if (channels_[c].joint >= 0) {
+            bound_channels_.push_back(c);
+        }
+    }
+    return bound_channels_.size();
+}
+
+/*
+ * Find the keys around the given time and the factor to interpolate
+ * them with. Both keys are the same outside of the track. The interval
+ * used last and the one after it are tried before searching.
+ */
+void AnimationClip::findKeys(const float* times, Track& track, float time,
+                             int& key0, int& key1, float& factor) {
+    const float* t = times + track.first;
+    int last = track.count - 1;
+    int i = track.cursor;
+
+    if ((last == 0) || (time <= t[0])) {
+        key0 = key1 = track.first;
+        factor = 0;
+        return;
+    }
+    if (time >= t[last]) {
+        key0 = key1 = track.first + last;
+        factor = 0;
+        return;
+    }
+    if ((time < t[i]) || (time >= t[i + 1])) {
+        if ((i + 2 <= last) && (time >= t[i + 1]) && (time < t[i + 2])) {
+            ++i;
+        } else {
+            int low = 0;
+            int high = last;
+
+            // invariant: t[low] <= time < t[high]
+            while (high - low > 1) {
+                int mid = (low + high) / 2;
+                if (time < t[mid]) {
+                    high = mid;
+                } else {
+                    low = mid;
+                }
+            }
+            i = low;
+        }
+        track.cursor = i;
+    }
+    key0 = track.first + i;
+    key1 = key0 + 1;
+    factor = (time - t[i]) / (t[i + 1] - t[i]);
+}
+
+const float* AnimationClip::getTimes(int kind) const {
+    return compressed_ ? compressed_times_[kind] : keys_[kind].time.data();
+}
+
+void AnimationClip::getVectorKey(int kind, int key, float* v) const {
+    if (compressed_) {
+        const uint16_t* quantized = compressed_values_[kind] + key * 3;
+        for (int c = 0; c < 3; ++c) {
+            v[c] = range_min_[kind][c] + quantized[c] * range_step_[kind][c];
+        }
+    } else {
+        for (int c = 0; c < 3; ++c) {
+            v[c] = keys_[kind].value[c][key];
+        }
+    }
+}
+
+void AnimationClip::getRotationKey(int key, float* q) const {
+    if (compressed_) {
+        decodeRotation(compressed_values_[ROTATION] + key * 3, q);
+    } else {
+        for (int c = 0; c < 4; ++c) {
+            q[c] = keys_[ROTATION].value[c][key];
+        }
+    }
+}
+
+/*
+ * Gather the keys of up to four channels into lanes,
+ * interpolate the lanes together and scatter the
+ * results to the joints.
+ */
+void AnimationClip::sampleVectors(int kind, const int* lanes, int num_lanes, float time,
+                                  float default_value, std::vector<glm::vec3>& out) {
+    alignas(16) float a[3][LANES];
+    alignas(16) float b[3][LANES];
+    alignas(16) float t[LANES];
+    const float* times = getTimes(kind);
+
+    for (int l = 0; l < LANES; ++l) {
+        Track* tr = (l < num_lanes) ? &channels_[lanes[l]].tracks[kind] : nullptr;
+        float v0[3], v1[3];
+        int k0, k1;
+
+        if ((tr == nullptr) || (tr->count == 0)) {
+            for (int c = 0; c < 3; ++c) {
+                a[c][l] = b[c][l] = default_value;
+            }
+            t[l] = 0;
+            continue;
+        }
+        findKeys(times, *tr, time, k0, k1, t[l]);
+        getVectorKey(kind, k0, v0);
+        getVectorKey(kind, k1, v1);
+        for (int c = 0; c < 3; ++c) {
+            a[c][l] = v0[c];
+            b[c][l] = v1[c];
+        }
+    }
+
+    float4 factor = load4(t);
+    for (int c = 0; c < 3; ++c) {
+        float4 a4 = load4(a[c]);
+        store4(a[c], madd4(sub4(load4(b[c]), a4), factor, a4));
+    }
+    for (int l = 0; l < num_lanes; ++l) {
+        int joint = channels_[lanes[l]].joint;
+        if (joint < (int) out.size()) {
+            out[joint] = glm::vec3(a[0][l], a[1][l], a[2][l]);
+        }
+    }
+}
+
+/*
+ * Rotations are interpolated linearly along the shorter arc and
+ * normalized. The factor is first adjusted with a polynomial fit
+ * in the factor and the cosine of the angle between the keys so
+ * the result stays within about 0.001 radians of slerp.
+ */
+void AnimationClip::sampleRotations(const int* lanes, int num_lanes, float time,
+                                    std::vector<glm::quat>& out) {
+    alignas(16) float a[4][LANES];
+    alignas(16) float b[4][LANES];
+    alignas(16) float t[LANES];
+    const float* times = getTimes(ROTATION);
+
+    for (int l = 0; l < LANES; ++l) {
+        Track* tr = (l < num_lanes) ? &channels_[lanes[l]].tracks[ROTATION] : nullptr;
+        float q0[4], q1[4];
+        int k0, k1;
+
+        if ((tr == nullptr) || (tr->count == 0)) {
+            for (int c = 0; c < 4; ++c) {
+                a[c][l] = b[c][l] = (c == 3) ? 1.0f : 0.0f;
+            }
+            t[l] = 0;
+            continue;
+        }
+        findKeys(times, *tr, time, k0, k1, t[l]);
+        getRotationKey(k0, q0);
+        getRotationKey(k1, q1);
+        for (int c = 0; c < 4; ++c) {
+            a[c][l] = q0[c];
+            b[c][l] = q1[c];
+        }
+    }
+
+    float4 ax = load4(a[0]), ay = load4(a[1]), az = load4(a[2]), aw = load4(a[3]);
+    float4 bx = load4(b[0]), by = load4(b[1]), bz = load4(b[2]), bw = load4(b[3]);
+    float4 ca = madd4(ax, bx, madd4(ay, by, madd4(az, bz, mul4(aw, bw))));
+    float4 d = abs4(ca);
+    float4 factor = load4(t);
+    float4 half = splat4(0.5f);
+    float4 tc = sub4(factor, half);
+
+    float4 ka = madd4(d, madd4(d, madd4(d, splat4(-1.43519f), splat4(3.55645f)),
+                               splat4(-3.2452f)), splat4(1.0904f));
+    float4 kb = madd4(d, madd4(d, splat4(0.215638f), splat4(-1.06021f)), splat4(0.848013f));
+    float4 k = madd4(mul4(ka, tc), tc, kb);
+    float4 ot = madd4(mul4(mul4(factor, tc), sub4(factor, splat4(1.0f))), k, factor);
+
+    // go the short way round
+    bx = flipsign4(bx, ca);
+    by = flipsign4(by, ca);
+    bz = flipsign4(bz, ca);
+    bw = flipsign4(bw, ca);
+
+    float4 rx = madd4(sub4(bx, ax), ot, ax);
+    float4 ry = madd4(sub4(by, ay), ot, ay);
+    float4 rz = madd4(sub4(bz, az), ot, az);
+    float4 rw = madd4(sub4(bw, aw), ot, aw);
+    float4 scale = rsqrt4(madd4(rx, rx, madd4(ry, ry, madd4(rz, rz, mul4(rw, rw)))));
+
+    store4(a[0], mul4(rx, scale));
+    store4(a[1], mul4(ry, scale));
+    store4(a[2], mul4(rz, scale));
+    store4(a[3], mul4(rw, scale));
+    for (int l = 0; l < num_lanes; ++l) {
+        int joint = channels_[lanes[l]].joint;
+        if (joint < (int) out.size()) {
+            out[joint] = glm::quat(a[3][l], a[0][l], a[1][l], a[2][l]);
+        }
+    }
+}
+
+void AnimationClip::sample(float time, LocalPose& pose) {
+    int num_bound = bound_channels_.size();
+
+    for (int first = 0; first < num_bound; first += LANES) {
+        const int* lanes = &bound_channels_[first];
+        int num_lanes = std::min(LANES, num_bound - first);
+
+        sampleVectors(POSITION, lanes, num_lanes, time, 0.0f, pose.positions);
+        sampleRotations(lanes, num_lanes, time, pose.rotations);
+        sampleVectors(SCALE, lanes, num_lanes, time, 1.0f, pose.scales);
+        for (int l = 0; l < num_lanes; ++l) {
+            int joint = channels_[lanes[l]].joint;
+            if (joint < pose.size()) {
+                pose.posed[joint] = true;
+            }
+        }
+    }
+}
+
+
+void AnimationClip::setTolerances(int channel, float position_tolerance,
+                                  float rotation_tolerance, float scale_tolerance) {
+    Channel& c = channels_[channel];
+
+    c.tolerances[POSITION] = position_tolerance;
+    c.tolerances[ROTATION] = rotation_tolerance;
+    c.tolerances[SCALE] = scale_tolerance;
+}
+
+/*
+ * Value of a track at the given time, interpolated the
+ * same way as the keys are reduced.
+ */
+void AnimationClip::sampleTrack(int kind, Track& track, float time, float* value) const {
+    float v0[4], v1[4];
+    float factor;
+    int k0, k1;
+
+    findKeys(getTimes(kind), track, time, k0, k1, factor);
+    if (kind == ROTATION) {
+        getRotationKey(k0, v0);
+        getRotationKey(k1, v1);
+    } else {
+        getVectorKey(kind, k0, v0);
+        getVectorKey(kind, k1, v1);
+    }
+    interpolate(kind, v0, v1, factor, value);
+}
+
+/*
+ * Choose the keys to keep from an uncompressed track. Starting
+ * from a kept key, the segment to the next kept key is made as
+ * long as all the keys it skips are within the tolerance of it.
+ * A track which stays within the tolerance of its first key
+ * is reduced to that key.
+ * @returns indices of the kept keys
+ */
+std::vector<int> AnimationClip::reduceKeys(int kind, const Track& track, float tolerance) const {
+    const KeyArrays& keys = keys_[kind];
+    int num_components = NUM_COMPONENTS[kind];
+    std::vector<int> kept;
+
+    auto getKey = [&](int key, float* v) {
+        for (int c = 0; c < num_components; ++c) {
+            v[c] = keys.value[c][track.first + key];
+        }
+    };
+    auto segmentFits = [&](int start, int end) {
+        float a[4], b[4], v[4], lerped[4];
+        float t0 = keys.time[track.first + start];
+        float duration = keys.time[track.first + end] - t0;
+
+        getKey(start, a);
+        getKey(end, b);
+        for (int m = start + 1; m < end; ++m) {
+            float factor = (duration > 0) ? (keys.time[track.first + m] - t0) / duration : 0;
+
+            getKey(m, v);
+            interpolate(kind, a, b, factor, lerped);
+            if (keyDistance(kind, v, lerped) > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (track.count == 0) {
+        return kept;
+    }
+    kept.push_back(track.first);
+
+    float first[4], v[4];
+    bool constant = true;
+
+    getKey(0, first);
+    for (int k = 1; (k < track.count) && constant; ++k) {
+        getKey(k, v);
+        constant = keyDistance(kind, first, v) <= tolerance;
+    }
+    if (constant) {
+        return kept;
+    }
+    for (int anchor = 0; anchor < track.count - 1;) {
+        int end = anchor + 1;
+
+        while ((end + 1 < track.count) && (end + 1 - anchor <= MAX_SEGMENT_KEYS) &&
+               segmentFits(anchor, end + 1)) {
+            ++end;
+        }
+        kept.push_back(track.first + end);
+        anchor = end;
+    }
+    return kept;
+}
+
+/*
+ * Largest difference between the uncompressed keys of a
+ * track and the compressed track at the times of those keys.
+ */
+float AnimationClip::measureError(int kind, const Track& raw_track, Track& track) const {
+    const KeyArrays& keys = keys_[kind];
+    float max_error = 0;
+
+    if (track.count == 0) {
+        return 0;
+    }
+    for (int k = 0; k < raw_track.count; ++k) {
+        int key = raw_track.first + k;
+        float raw[4], value[4];
+
+        for (int c = 0; c < NUM_COMPONENTS[kind]; ++c) {
+            raw[c] = keys.value[c][key];
+        }
+        sampleTrack(kind, track, keys.time[key], value);
+        max_error = std::max(max_error, keyDistance(kind, raw, value));
+    }
+    track.cursor = 0;
+    return max_error;
+}
+
+bool AnimationClip::compress(float position_tolerance, float rotation_tolerance,
+                             float scale_tolerance) {
+    const float defaults[3] = { position_tolerance, rotation_tolerance, scale_tolerance };
+    int num_channels = channels_.size();
+    std::vector<std::vector<int> > kept(num_channels * 3);
+    ClipHeader header;
+
+    if (compressed_) {
+        return false;
+    }
+    memset(&header, 0, sizeof(header));
+    header.magic = CLIP_MAGIC;
+    header.version = CLIP_VERSION;
+    header.num_channels = num_channels;
+    for (int k = 0; k < 3; ++k) {
+        header.raw_size += keys_[k].time.size() * (NUM_COMPONENTS[k] + 1) * sizeof(float);
+    }
+
+    // choose the keys and find the range of the vectors
+    for (int k = 0; k < 3; ++k) {
+        float range_max[3];
+
+        for (int c = 0; c < 3; ++c) {
+            header.range_min[k][c] = INFINITY;
+            range_max[c] = -INFINITY;
+        }
+        for (int i = 0; i < num_channels; ++i) {
+            const Channel& channel = channels_[i];
+            float tolerance = (channel.tolerances[k] >= 0) ? channel.tolerances[k] : defaults[k];
+            std::vector<int>& keys = kept[i * 3 + k];
+
+            keys = reduceKeys(k, channel.tracks[k], tolerance);
+            header.num_keys[k] += keys.size();
+            if (k == ROTATION) {
+                continue;
+            }
+            for (auto it = keys.begin(); it != keys.end(); ++it) {
+                for (int c = 0; c < 3; ++c) {
+                    float v = keys_[k].value[c][*it];
+                    header.range_min[k][c] = std::min(header.range_min[k][c], v);
+                    range_max[c] = std::max(range_max[c], v);
+                }
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            if (k == ROTATION || header.num_keys[k] == 0) {
+                header.range_min[k][c] = 0;
+                header.range_step[k][c] = 0;
+            } else {
+                header.range_step[k][c] = (range_max[c] - header.range_min[k][c]) / 65535;
+            }
+        }
+    }
+
+    // lay out the clip
+    uint32_t offset = sizeof(ClipHeader);
+    uint32_t names_size = 0;
+
+    header.channels_offset = offset;
+    offset += num_channels * sizeof(ClipChannel);
+    header.names_offset = offset;
+    for (auto it = channels_.begin(); it != channels_.end(); ++it) {
+        names_size += it->name.size() + 1;
+    }
+    offset = align4(offset + names_size);
+    for (int k = 0; k < 3; ++k) {
+        header.times_offset[k] = offset;
+        offset += header.num_keys[k] * sizeof(float);
+        header.values_offset[k] = offset;
+        offset = align4(offset + header.num_keys[k] * 3 * sizeof(uint16_t));
+    }
+    header.size = offset;
+
+    // fill it in
+    std::vector<char> data(header.size, 0);
+    char* base = data.data();
+
+    memcpy(base, &header, sizeof(header));
+    ClipChannel* clip_channels = reinterpret_cast<ClipChannel*>(base + header.channels_offset);
+    uint32_t name_offset = 0;
+    uint32_t next_key[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < num_channels; ++i) {
+        const std::string& name = channels_[i].name;
+
+        clip_channels[i].name_offset = name_offset;
+        memcpy(base + header.names_offset + name_offset, name.c_str(), name.size() + 1);
+        name_offset += name.size() + 1;
+        for (int k = 0; k < 3; ++k) {
+            const std::vector<int>& keys = kept[i * 3 + k];
+            float* times = reinterpret_cast<float*>(base + header.times_offset[k]);
+            uint16_t* values = reinterpret_cast<uint16_t*>(base + header.values_offset[k]);
+
+            clip_channels[i].first[k] = next_key[k];
+            clip_channels[i].count[k] = keys.size();
+            for (auto it = keys.begin(); it != keys.end(); ++it) {
+                uint32_t key = next_key[k]++;
+                float v[4];
+
+                times[key] = keys_[k].time[*it];
+                for (int c = 0; c < NUM_COMPONENTS[k]; ++c) {
+                    v[c] = keys_[k].value[c][*it];
+                }
+                if (k == ROTATION) {
+                    encodeRotation(v, values + key * 3);
+                    continue;
+                }
+                for (int c = 0; c < 3; ++c) {
+                    float step = header.range_step[k][c];
+                    float q = (step > 0) ? (v[c] - header.range_min[k][c]) / step : 0;
+                    values[key * 3 + c] = lroundf(std::max(0.0f, std::min(q, 65535.0f)));
+                }
+            }
+        }
+    }
+    compressed_data_.swap(data);
+    useCompressed(compressed_data_.data());
+
+    // measure against the original keys, then drop them
+    for (int i = 0; i < num_channels; ++i) {
+        Channel& channel = channels_[i];
+        const ClipChannel& clip_channel = clip_channels[i];
+
+        for (int k = 0; k < 3; ++k) {
+            Track raw_track = channel.tracks[k];
+
+            channel.tracks[k].first = clip_channel.first[k];
+            channel.tracks[k].count = clip_channel.count[k];
+            channel.tracks[k].cursor = 0;
+            header.max_error[k] = std::max(header.max_error[k],
+                                           measureError(k, raw_track, channel.tracks[k]));
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        keys_[k] = KeyArrays();
+    }
+    memcpy(compressed_data_.data(), &header, sizeof(header));
+    return useCompressed(compressed_data_.data());
+}
+
+/*
+ * Point the key accessors at compressed clip data
+ * which has already been checked.
+ */
+bool AnimationClip::useCompressed(const char* data) {
+    const ClipHeader* header = reinterpret_cast<const ClipHeader*>(data);
+
+    compressed_ = header;
+    for (int k = 0; k < 3; ++k) {
+        compressed_times_[k] = reinterpret_cast<const float*>(data + header->times_offset[k]);
+        compressed_values_[k] = reinterpret_cast<const uint16_t*>(data + header->values_offset[k]);
+        for (int c = 0; c < 3; ++c) {
+            range_min_[k][c] = header->range_min[k][c];
+            range_step_[k][c] = header->range_step[k][c];
+        }
+    }
+    stats_.raw_size = header->raw_size;
+    stats_.compressed_size = header->size;
+    stats_.max_position_error = header->max_error[POSITION];
+    stats_.max_rotation_error = header->max_error[ROTATION];
+    stats_.max_scale_error = header->max_error[SCALE];
+    return true;
+}
+
+int AnimationClip::getCompressedSize() const {
+    return compressed_ ? compressed_->size : 0;
+}
+
+bool AnimationClip::saveCompressed(void* data, int size) const {
+    if ((compressed_ == nullptr) || (size < (int) compressed_->size)) {
+        return false;
+    }
+    memcpy(data, compressed_, compressed_->size);
+    return true;
+}
+
+bool AnimationClip::loadCompressed(const void* data, int size, bool copy) {
+    const char* bytes = static_cast<const char*>(data);
+    ClipHeader header;
+
+    if ((bytes == nullptr) || (size < (int) sizeof(ClipHeader))) {
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if ((header.magic != CLIP_MAGIC) || (header.version != CLIP_VERSION) ||
+        (header.size > (uint32_t) size) ||
+        ((uint64_t) header.channels_offset + (uint64_t) header.num_channels * sizeof(ClipChannel) > header.size) ||
+        (header.names_offset > header.size) || (header.channels_offset & 3)) {
+        LOGE("AnimationClip::loadCompressed not a compressed clip");
+        return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+        if ((header.times_offset[k] & 3) || (header.values_offset[k] & 3) ||
+            ((uint64_t) header.times_offset[k] + (uint64_t) header.num_keys[k] * sizeof(float) > header.size) ||
+            ((uint64_t) header.values_offset[k] + (uint64_t) header.num_keys[k] * 6 > header.size)) {
+            LOGE("AnimationClip::loadCompressed keys out of range");
+            return false;
+        }
+    }
+
+    // key data has to be aligned to be used in place
+    if (reinterpret_cast<uintptr_t>(bytes) & 3) {
+        copy = true;
+    }
+    std::vector<char> copied;
+    const char* base = bytes;
+    if (copy) {
+        copied.assign(bytes, bytes + header.size);
+        base = copied.data();
+    }
+
+    const ClipChannel* clip_channels = reinterpret_cast<const ClipChannel*>(base + header.channels_offset);
+    const char* names = base + header.names_offset;
+    uint32_t names_size = header.size - header.names_offset;
+    std::vector<Channel> channels(header.num_channels);
+
+    for (uint32_t i = 0; i < header.num_channels; ++i) {
+        const ClipChannel& cc = clip_channels[i];
+        Channel& channel = channels[i];
+
+        if ((cc.name_offset >= names_size) ||
+            !memchr(names + cc.name_offset, 0, names_size - cc.name_offset)) {
+            LOGE("AnimationClip::loadCompressed bad name for channel %d", i);
+            return false;
+        }
+        channel.name = names + cc.name_offset;
+        channel.joint = -1;
+        for (int k = 0; k < 3; ++k) {
+            if ((uint64_t) cc.first[k] + cc.count[k] > header.num_keys[k]) {
+                LOGE("AnimationClip::loadCompressed bad keys for channel %d", i);
+                return false;
+            }
+            channel.tracks[k].first = cc.first[k];
+            channel.tracks[k].count = cc.count[k];
+            channel.tracks[k].cursor = 0;
+            channel.tolerances[k] = -1;
+        }
+    }
+    channels_.swap(channels);
+    bound_channels_.clear();
+    compressed_data_.swap(copied);
+    for (int k = 0; k < 3; ++k) {
+        keys_[k] = KeyArrays();
+    }
+    return useCompressed(base);
+}
+
+}
@@ -0,0 +1,228 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Key frames of a skeletal animation.
+ ***************************************************************************/
+
+#ifndef ANIMATION_CLIP_H_
+#define ANIMATION_CLIP_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "objects/hybrid_object.h"
+
+namespace gvr {
+class Skeleton;
+
+/*
+ * Local position, rotation and scale of each joint
+ * of a skeleton, indexed by joint.
+ */
+struct LocalPose {
+    std::vector<glm::vec3>  positions;
+    std::vector<glm::quat>  rotations;
+    std::vector<glm::vec3>  scales;
+    std::vector<char>       posed;      // joints written by the last sample
+
+    int size() const { return posed.size(); }
+
+    /*
+     * Change the number of joints, new joints get the identity pose.
+     */
+    void resize(int num_joints);
+};
+
+/*
+ * Holds the position, rotation and scale keys for the
+ * nodes affected by a key frame animation. Each channel
+ * animates one joint of a skeleton, the channels are
+ * matched to joints by name when the clip is bound.
+ *
+ * Keys are given as flat float arrays with the time
+ * first: (t, x, y, z) for positions and scales and
+ * (t, x, y, z, w) for rotations. Times are in ticks.
+ * They are stored with the times and each component
+ * in separate arrays so four channels are interpolated
+ * at once. Every track remembers the key it used last,
+ * with time moving forward the key is found without
+ * searching.
+ *
+ * A clip can be compressed once all its channels are
+ * added. The compressed keys are kept in one block of
+ * memory which can be saved and later used in place,
+ * from a mapped file for instance. The sampler decodes
+ * the keys it needs directly from that block.
+ */
+class AnimationClip: public HybridObject {
+public:
+    enum TrackKind {
+        POSITION = 0,
+        ROTATION = 1,
+        SCALE = 2
+    };
+
+    // Sizes of the keys before and after compression and the largest differences
+    struct CompressionStats {
+        int     raw_size;
+        int     compressed_size;
+        float   max_position_error;
+        float   max_rotation_error;     // radians
+        float   max_scale_error;
+    };
+
+    AnimationClip();
+    virtual ~AnimationClip() { }
+
+    /*
+     * Add a channel with the keys for one node.
+     * @returns index of the channel or -1 if the clip is compressed
+     */
+    int addChannel(const char* name,
+                   const float* position_keys, int num_position_keys,
+                   const float* rotation_keys, int num_rotation_keys,
+                   const float* scale_keys, int num_scale_keys);
+
+    int getChannelCount() const { return channels_.size(); }
+    const std::string& getChannelName(int channel) const { return channels_[channel].name; }
+
+    /*
+     * Match the channels with the joints of a skeleton.
+     * Channels without a joint are skipped when sampling.
+     * @returns number of channels which found a joint
+     */
+    int bind(const Skeleton& skeleton);
+
+    /*
+     * Joint animated by a channel after bind, -1 if there is none.
+     */
+    int getJoint(int channel) const { return channels_[channel].joint; }
+
+    /*
+     * Interpolate the bound channels at the given time and
+     * write them to the pose of their joints, marking them
+     * as posed. Times outside of the keys use the first
+     * or last key. Rotations use normalized linear
+     * interpolation corrected to follow slerp closely.
+     */
+    void sample(float time, LocalPose& pose);
+
+    /*
+     * Use different tolerances for one channel when compressing.
+     * Negative values use the tolerances given to compress.
+     */
+    void setTolerances(int channel, float position_tolerance,
+                       float rotation_tolerance, float scale_tolerance);
+
+    /*
+     * Replace the keys with a compressed copy. Keys which are
+     * interpolated from the keys around them within the tolerance
+     * are dropped. Rotations are stored in 48 bits as their three
+     * smallest components, positions and scales in 16 bits per
+     * component within the range they cover in the clip.
+     * Tolerances are in distance units for positions and scales
+     * and in radians for rotations.
+     * @returns false if the clip is already compressed
+     */
+    bool compress(float position_tolerance, float rotation_tolerance, float scale_tolerance);
+
+    bool isCompressed() const { return compressed_ != nullptr; }
+    const CompressionStats& getCompressionStats() const { return stats_; }
+
+    /*
+     * Size of the compressed clip, 0 if the clip is not compressed.
+     */
+    int getCompressedSize() const;
+
+    /*
+     * Copy the compressed clip to a buffer of getCompressedSize() bytes.
+     */
+    bool saveCompressed(void* data, int size) const;
+
+    /*
+     * Replace all the channels with a clip saved by saveCompressed.
+     * Unless copy is set, the data is used in place and must stay
+     * valid and unchanged as long as the clip uses it. The clip
+     * must be bound again afterwards.
+     * @returns false if the data is not a valid compressed clip
+     */
+    bool loadCompressed(const void* data, int size, bool copy);
+
+private:
+    // Keys of one position, rotation or scale track
+    struct Track {
+        int first;      // index of the first key in the key arrays
+        int count;
+        int cursor;     // interval used by the last sample
+    };
+
+    struct Channel {
+        std::string name;
+        Track       tracks[3];      // indexed by TrackKind
+        float       tolerances[3];  // negative for the clip defaults
+        int         joint;
+    };
+
+    // Keys of all the tracks of one kind, one array per component
+    struct KeyArrays {
+        std::vector<float>  time;
+        std::vector<float>  value[4];
+
+        Track add(const float* keys, int num_keys, int num_components);
+    };
+
+    struct ClipHeader;
+
+    AnimationClip(const AnimationClip& clip);
+    AnimationClip(AnimationClip&& clip);
+    AnimationClip& operator=(const AnimationClip& clip);
+    AnimationClip& operator=(AnimationClip&& clip);
+
+    const float* getTimes(int kind) const;
+    void getVectorKey(int kind, int key, float* v) const;
+    void getRotationKey(int key, float* q) const;
+    void sampleTrack(int kind, Track& track, float time, float* value) const;
+    std::vector<int> reduceKeys(int kind, const Track& track, float tolerance) const;
+    float measureError(int kind, const Track& raw_track, Track& track) const;
+    bool useCompressed(const char* data);
+
+    static void findKeys(const float* times, Track& track, float time,
+                         int& key0, int& key1, float& factor);
+    void sampleVectors(int kind, const int* lanes, int num_lanes, float time,
+                       float default_value, std::vector<glm::vec3>& out);
+    void sampleRotations(const int* lanes, int num_lanes, float time,
+                         std::vector<glm::quat>& out);
+
+    std::vector<Channel>    channels_;
+    std::vector<int>        bound_channels_;
+    KeyArrays               keys_[3];           // indexed by TrackKind
+
+    const ClipHeader*       compressed_;        // null until compressed
+    std::vector<char>       compressed_data_;   // empty if used in place
+    const float*            compressed_times_[3];
+    const uint16_t*         compressed_values_[3];
+    float                   range_min_[3][3];   // per kind and component
+    float                   range_step_[3][3];
+    CompressionStats        stats_;
+};
+
+}
+#endif
@@ -0,0 +1,172 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "objects/animation_clip.h"
+#include "objects/components/skeleton.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C"
+{
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeAnimationClip_ctor(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeAnimationClip_addChannel(JNIEnv * env,
+            jobject obj, jlong jclip, jstring jname, jfloatArray jposition_keys,
+            jfloatArray jrotation_keys, jfloatArray jscale_keys);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeAnimationClip_bind(JNIEnv * env,
+            jobject obj, jlong jclip, jlong jskeleton);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeAnimationClip_setTolerances(JNIEnv * env,
+            jobject obj, jlong jclip, jint channel, jfloat position_tolerance,
+            jfloat rotation_tolerance, jfloat scale_tolerance);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeAnimationClip_compress(JNIEnv * env,
+            jobject obj, jlong jclip, jfloat position_tolerance,
+            jfloat rotation_tolerance, jfloat scale_tolerance);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeAnimationClip_getCompressionStats(JNIEnv * env,
+            jobject obj, jlong jclip, jfloatArray jstats);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeAnimationClip_getCompressedSize(JNIEnv * env,
+            jobject obj, jlong jclip);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeAnimationClip_saveCompressed(JNIEnv * env,
+            jobject obj, jlong jclip, jobject jbuffer);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeAnimationClip_loadCompressed(JNIEnv * env,
+            jobject obj, jlong jclip, jobject jbuffer, jboolean copy);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeAnimationClip_ctor(JNIEnv * env, jobject obj)
+{
+    return reinterpret_cast<jlong>(new AnimationClip());
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeAnimationClip_addChannel(JNIEnv * env,
+        jobject obj, jlong jclip, jstring jname, jfloatArray jposition_keys,
+        jfloatArray jrotation_keys, jfloatArray jscale_keys)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    const char* name = env->GetStringUTFChars(jname, 0);
+    jfloat* position_keys = env->GetFloatArrayElements(jposition_keys, 0);
+    jfloat* rotation_keys = env->GetFloatArrayElements(jrotation_keys, 0);
+    jfloat* scale_keys = env->GetFloatArrayElements(jscale_keys, 0);
+
+    int channel = clip->addChannel(name,
+                                   position_keys, env->GetArrayLength(jposition_keys) / 4,
+                                   rotation_keys, env->GetArrayLength(jrotation_keys) / 5,
+                                   scale_keys, env->GetArrayLength(jscale_keys) / 4);
+
+    env->ReleaseFloatArrayElements(jscale_keys, scale_keys, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jrotation_keys, rotation_keys, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jposition_keys, position_keys, JNI_ABORT);
+    env->ReleaseStringUTFChars(jname, name);
+    return channel;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeAnimationClip_bind(JNIEnv * env,
+        jobject obj, jlong jclip, jlong jskeleton)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    return clip->bind(*skeleton);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeAnimationClip_setTolerances(JNIEnv * env,
+        jobject obj, jlong jclip, jint channel, jfloat position_tolerance,
+        jfloat rotation_tolerance, jfloat scale_tolerance)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    clip->setTolerances(channel, position_tolerance, rotation_tolerance, scale_tolerance);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeAnimationClip_compress(JNIEnv * env,
+        jobject obj, jlong jclip, jfloat position_tolerance,
+        jfloat rotation_tolerance, jfloat scale_tolerance)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    return clip->compress(position_tolerance, rotation_tolerance, scale_tolerance);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeAnimationClip_getCompressionStats(JNIEnv * env,
+        jobject obj, jlong jclip, jfloatArray jstats)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    const AnimationClip::CompressionStats& stats = clip->getCompressionStats();
+    jfloat values[5] = { (jfloat) stats.raw_size, (jfloat) stats.compressed_size,
+                         stats.max_position_error, stats.max_rotation_error,
+                         stats.max_scale_error };
+
+    env->SetFloatArrayRegion(jstats, 0, 5, values);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeAnimationClip_getCompressedSize(JNIEnv * env,
+        jobject obj, jlong jclip)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    return clip->getCompressedSize();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeAnimationClip_saveCompressed(JNIEnv * env,
+        jobject obj, jlong jclip, jobject jbuffer)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    void* data = env->GetDirectBufferAddress(jbuffer);
+
+    if (data == nullptr)
+    {
+        return false;
+    }
+    return clip->saveCompressed(data, env->GetDirectBufferCapacity(jbuffer));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeAnimationClip_loadCompressed(JNIEnv * env,
+        jobject obj, jlong jclip, jobject jbuffer, jboolean copy)
+{
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    const void* data = env->GetDirectBufferAddress(jbuffer);
+
+    if (data == nullptr)
+    {
+        return false;
+    }
+    return clip->loadCompressed(data, env->GetDirectBufferCapacity(jbuffer), copy);
+}
+
+}
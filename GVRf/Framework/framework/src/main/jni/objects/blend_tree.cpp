@@ -0,0 +1,431 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Blending and layering of skeletal animations.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <math.h>
+
+#include "objects/blend_tree.h"
+#include "objects/components/skeleton.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+static const float MIN_DISTANCE_SQUARED = 1e-8f;
+
+/*
+ * Normalized linear interpolation along the shortest arc.
+ */
+static inline glm::quat nlerp(const glm::quat& a, const glm::quat& b, float factor) {
+    glm::quat q = (glm::dot(a, b) < 0) ? -b : b;
+    return glm::normalize(a * (1 - factor) + q * factor);
+}
+
+BlendTree::BlendTree() : HybridObject() {
+}
+
+int BlendTree::addParameter(float value) {
+    parameters_.push_back(value);
+    return parameters_.size() - 1;
+}
+
+void BlendTree::setParameter(int parameter, float value) {
+    if (validParameter(parameter)) {
+        parameters_[parameter] = value;
+    }
+}
+
+bool BlendTree::validChild(int node) const {
+    return (node >= 0) && (node < (int) nodes_.size());
+}
+
+bool BlendTree::validParameter(int parameter) const {
+    return (parameter >= 0) && (parameter < (int) parameters_.size());
+}
+
+int BlendTree::addNode(Node& node) {
+    node.weights.assign(node.children.size(), 0.0f);
+    node.depth = 1;
+    switch (node.type) {
+    case BLEND_1D:
+    case BLEND_2D:
+        // the first weighted child uses the node buffer, the others the next one
+        for (auto it = node.children.begin(); it != node.children.end(); ++it) {
+            node.depth = std::max(node.depth, nodes_[*it].depth + 1);
+        }
+        break;
+
+    case ADDITIVE:
+    case OVERRIDE:
+        for (int i = 0; i < (int) node.children.size(); ++i) {
+            if (node.children[i] >= 0) {
+                node.depth = std::max(node.depth, nodes_[node.children[i]].depth + i);
+            }
+        }
+        break;
+    }
+    nodes_.push_back(std::move(node));
+    return nodes_.size() - 1;
+}
+
+int BlendTree::addClip(AnimationClip* clip, float speed, float duration) {
+    Node node;
+
+    node.type = CLIP;
+    node.clip = clip;
+    node.speed = speed;
+    node.duration = duration;
+    node.sync = false;
+    node.parameters[0] = node.parameters[1] = -1;
+    return addNode(node);
+}
+
+int BlendTree::addBlend1D(int parameter, const int* children, const float* thresholds,
+                          int num_children, bool sync) {
+    Node node;
+
+    if (!validParameter(parameter) || (num_children <= 0)) {
+        return -1;
+    }
+    for (int i = 0; i < num_children; ++i) {
+        if (!validChild(children[i]) || ((i > 0) && (thresholds[i] < thresholds[i - 1]))) {
+            LOGE("BlendTree::addBlend1D child %d is invalid or out of order", i);
+            return -1;
+        }
+    }
+    node.type = BLEND_1D;
+    node.clip = nullptr;
+    node.speed = 1;
+    node.duration = 0;
+    node.sync = sync;
+    node.parameters[0] = parameter;
+    node.parameters[1] = -1;
+    node.children.assign(children, children + num_children);
+    node.positions.assign(thresholds, thresholds + num_children);
+    return addNode(node);
+}
+
+int BlendTree::addBlend2D(int parameter_x, int parameter_y, const int* children,
+                          const float* positions, int num_children, bool sync) {
+    Node node;
+
+    if (!validParameter(parameter_x) || !validParameter(parameter_y) || (num_children <= 0)) {
+        return -1;
+    }
+    for (int i = 0; i < num_children; ++i) {
+        if (!validChild(children[i])) {
+            LOGE("BlendTree::addBlend2D child %d is invalid", i);
+            return -1;
+        }
+    }
+    node.type = BLEND_2D;
+    node.clip = nullptr;
+    node.speed = 1;
+    node.duration = 0;
+    node.sync = sync;
+    node.parameters[0] = parameter_x;
+    node.parameters[1] = parameter_y;
+    node.children.assign(children, children + num_children);
+    node.positions.assign(positions, positions + num_children * 2);
+    return addNode(node);
+}
+
+int BlendTree::addAdditive(int base, int additive, int reference, int weight_parameter) {
+    Node node;
+
+    if (!validChild(base) || !validChild(additive) ||
+        ((reference != -1) && !validChild(reference)) || !validParameter(weight_parameter)) {
+        return -1;
+    }
+    node.type = ADDITIVE;
+    node.clip = nullptr;
+    node.speed = 1;
+    node.duration = 0;
+    node.sync = false;
+    node.parameters[0] = weight_parameter;
+    node.parameters[1] = -1;
+    node.children.push_back(base);
+    node.children.push_back(additive);
+    node.children.push_back(reference);
+    return addNode(node);
+}
+
+int BlendTree::addOverride(int base, int override, const float* mask, int num_joints,
+                           int weight_parameter) {
+    Node node;
+
+    if (!validChild(base) || !validChild(override) || !validParameter(weight_parameter)) {
+        return -1;
+    }
+    node.type = OVERRIDE;
+    node.clip = nullptr;
+    node.speed = 1;
+    node.duration = 0;
+    node.sync = false;
+    node.parameters[0] = weight_parameter;
+    node.parameters[1] = -1;
+    node.children.push_back(base);
+    node.children.push_back(override);
+    node.mask.assign(mask, mask + num_joints);
+    return addNode(node);
+}
+
+void BlendTree::bind(const Skeleton& skeleton) {
+    for (auto it = nodes_.begin(); it != nodes_.end(); ++it) {
+        if (it->clip) {
+            it->clip->bind(skeleton);
+        }
+    }
+    rest_pose_ = skeleton.getRestPose();
+    std::fill(rest_pose_.posed.begin(), rest_pose_.posed.end(), false);
+    pool_.assign(nodes_.empty() ? 0 : nodes_.back().depth, rest_pose_);
+}
+
+const LocalPose& BlendTree::evaluate(float time) {
+    if (pool_.empty() || (pool_.size() < (size_t) nodes_.back().depth)) {
+        return rest_pose_;
+    }
+    evaluateNode(nodes_.size() - 1, 0, time, -1);
+    return pool_[0];
+}
+
+void BlendTree::computeWeights(Node& node) {
+    int num_children = node.children.size();
+    std::vector<float>& weights = node.weights;
+
+    std::fill(weights.begin(), weights.end(), 0.0f);
+    if (node.type == BLEND_1D) {
+        const std::vector<float>& thresholds = node.positions;
+        float value = parameters_[node.parameters[0]];
+
+        if (value <= thresholds[0]) {
+            weights[0] = 1;
+            return;
+        }
+        for (int i = 0; i < num_children - 1; ++i) {
+            if (value < thresholds[i + 1]) {
+                float factor = (value - thresholds[i]) / (thresholds[i + 1] - thresholds[i]);
+                weights[i] = 1 - factor;
+                weights[i + 1] = factor;
+                return;
+            }
+        }
+        weights[num_children - 1] = 1;
+        return;
+    }
+
+    // BLEND_2D, inverse distance squared, exact on the children
+    float x = parameters_[node.parameters[0]];
+    float y = parameters_[node.parameters[1]];
+    float total = 0;
+
+    for (int i = 0; i < num_children; ++i) {
+        float dx = x - node.positions[i * 2];
+        float dy = y - node.positions[i * 2 + 1];
+        float d2 = dx * dx + dy * dy;
+
+        if (d2 < MIN_DISTANCE_SQUARED) {
+            std::fill(weights.begin(), weights.end(), 0.0f);
+            weights[i] = 1;
+            return;
+        }
+        weights[i] = 1 / d2;
+        total += weights[i];
+    }
+    for (int i = 0; i < num_children; ++i) {
+        weights[i] /= total;
+    }
+}
+
+/*
+ * Length of the cycle of a node in seconds: the clip duration
+ * divided by its speed, or the weighted average of the cycles
+ * of the children of a blend.
+ */
+float BlendTree::getCycle(int index) {
+    Node& node = nodes_[index];
+    float cycle = 0;
+
+    switch (node.type) {
+    case CLIP:
+        return (node.speed > 0) ? node.duration / node.speed : 0;
+
+    case BLEND_1D:
+    case BLEND_2D:
+        computeWeights(node);
+        for (int i = 0; i < (int) node.children.size(); ++i) {
+            if (node.weights[i] > 0) {
+                cycle += node.weights[i] * getCycle(node.children[i]);
+            }
+        }
+        return cycle;
+
+    default:
+        return getCycle(node.children[0]);
+    }
+}
+
+/*
+ * Evaluate a node into the pose buffer at slot. Its children
+ * use the buffers after it, so nothing needs allocating.
+ * A phase between 0 and 1 replaces the time of the clips
+ * below a synchronized blend.
+ */
+void BlendTree::evaluateNode(int index, int slot, float time, float phase) {
+    Node& node = nodes_[index];
+    LocalPose& pose = pool_[slot];
+
+    switch (node.type) {
+    case CLIP: {
+        float clip_time = time * node.speed;
+
+        if (node.duration > 0) {
+            clip_time = (phase >= 0) ? phase * node.duration : fmodf(clip_time, node.duration);
+            if (clip_time < 0) {
+                clip_time += node.duration;
+            }
+        }
+        pose = rest_pose_;
+        if (node.clip) {
+            node.clip->sample(clip_time, pose);
+        }
+        break;
+    }
+
+    case BLEND_1D:
+    case BLEND_2D: {
+        float total = 0;
+
+        if (node.sync && (phase < 0)) {
+            float cycle = getCycle(index);
+            if (cycle > 0) {
+                phase = fmodf(time, cycle) / cycle;
+                if (phase < 0) {
+                    phase += 1;
+                }
+            }
+        }
+        computeWeights(node);
+        for (int i = 0; i < (int) node.children.size(); ++i) {
+            float weight = node.weights[i];
+
+            if (weight <= 0) {
+                continue;
+            }
+            if (total == 0) {
+                evaluateNode(node.children[i], slot, time, phase);
+                total = weight;
+                continue;
+            }
+            evaluateNode(node.children[i], slot + 1, time, phase);
+            total += weight;
+            blendPoses(pool_[slot], pool_[slot + 1], weight / total);
+        }
+        if (total == 0) {
+            pool_[slot] = rest_pose_;
+        }
+        break;
+    }
+
+    case ADDITIVE: {
+        float weight = parameters_[node.parameters[0]];
+        int reference = node.children[2];
+
+        evaluateNode(node.children[0], slot, time, phase);
+        if (weight == 0) {
+            break;
+        }
+        evaluateNode(node.children[1], slot + 1, time, phase);
+        if (reference >= 0) {
+            evaluateNode(reference, slot + 2, time, phase);
+        }
+        addPose(pool_[slot], pool_[slot + 1], (reference >= 0) ? pool_[slot + 2] : rest_pose_,
+                weight);
+        break;
+    }
+
+    case OVERRIDE: {
+        float weight = parameters_[node.parameters[0]];
+
+        evaluateNode(node.children[0], slot, time, phase);
+        if (weight == 0) {
+            break;
+        }
+        evaluateNode(node.children[1], slot + 1, time, phase);
+        overridePose(pool_[slot], pool_[slot + 1], node.mask, weight);
+        break;
+    }
+    }
+}
+
+void BlendTree::blendPoses(LocalPose& pose, const LocalPose& other, float factor) {
+    int num_joints = pose.size();
+
+    for (int j = 0; j < num_joints; ++j) {
+        if (!pose.posed[j] && !other.posed[j]) {
+            continue;
+        }
+        pose.positions[j] = glm::mix(pose.positions[j], other.positions[j], factor);
+        pose.rotations[j] = nlerp(pose.rotations[j], other.rotations[j], factor);
+        pose.scales[j] = glm::mix(pose.scales[j], other.scales[j], factor);
+        pose.posed[j] = true;
+    }
+}
+
+void BlendTree::addPose(LocalPose& pose, const LocalPose& additive,
+                        const LocalPose& reference, float weight) {
+    int num_joints = pose.size();
+
+    for (int j = 0; j < num_joints; ++j) {
+        if (!additive.posed[j]) {
+            continue;
+        }
+        glm::quat delta = glm::inverse(reference.rotations[j]) * additive.rotations[j];
+        glm::vec3 scale = additive.scales[j];
+
+        for (int c = 0; c < 3; ++c) {
+            if (reference.scales[j][c] != 0) {
+                scale[c] /= reference.scales[j][c];
+            }
+        }
+        pose.positions[j] += (additive.positions[j] - reference.positions[j]) * weight;
+        pose.rotations[j] = glm::normalize(pose.rotations[j] * nlerp(glm::quat(), delta, weight));
+        pose.scales[j] *= glm::mix(glm::vec3(1, 1, 1), scale, weight);
+        pose.posed[j] = true;
+    }
+}
+
+void BlendTree::overridePose(LocalPose& pose, const LocalPose& other,
+                             const std::vector<float>& mask, float weight) {
+    int num_joints = std::min(pose.size(), (int) mask.size());
+
+    for (int j = 0; j < num_joints; ++j) {
+        float factor = mask[j] * weight;
+
+        if ((factor <= 0) || !other.posed[j]) {
+            continue;
+        }
+        pose.positions[j] = glm::mix(pose.positions[j], other.positions[j], factor);
+        pose.rotations[j] = nlerp(pose.rotations[j], other.rotations[j], factor);
+        pose.scales[j] = glm::mix(pose.scales[j], other.scales[j], factor);
+        pose.posed[j] = true;
+    }
+}
+
+}
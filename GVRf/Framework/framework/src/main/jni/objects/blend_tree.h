@@ -0,0 +1,177 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Blending and layering of skeletal animations.
+ ***************************************************************************/
+
+#ifndef BLEND_TREE_H_
+#define BLEND_TREE_H_
+
+#include <vector>
+
+#include "objects/animation_clip.h"
+#include "objects/hybrid_object.h"
+
+namespace gvr {
+class Skeleton;
+
+/*
+ * Combines animation clips into one pose for a skeleton.
+ *
+ * The tree is made of nodes added children first, the
+ * last node added is the root. The nodes are:
+ * - clip: samples an animation clip
+ * - 1D blend: blends the two children whose thresholds
+ *   surround a parameter
+ * - 2D blend: blends all its children weighted by the
+ *   inverse square distance of their position to a
+ *   pair of parameters
+ * - additive: adds the difference between a pose and a
+ *   reference pose to a base pose
+ * - override: replaces a base pose by another on the
+ *   joints of a mask, an upper body layer for instance
+ *
+ * Blends, additive and override nodes are weighted by
+ * parameters which the application changes every frame.
+ *
+ * Poses are evaluated depth first into a pool of pose
+ * buffers sized once for the tree and the skeleton, so
+ * evaluating does not allocate. The result is given to
+ * the skeleton which writes it to its nodes and skins.
+ * Joints not animated by any clip keep their rest pose
+ * in the blends and are posed from their node.
+ */
+class BlendTree: public HybridObject {
+public:
+    enum NodeType {
+        CLIP = 0,
+        BLEND_1D = 1,
+        BLEND_2D = 2,
+        ADDITIVE = 3,
+        OVERRIDE = 4
+    };
+
+    BlendTree();
+    virtual ~BlendTree() { }
+
+    /*
+     * Add a parameter for the weights of the nodes.
+     * @returns index of the parameter
+     */
+    int addParameter(float value);
+    void setParameter(int parameter, float value);
+    float getParameter(int parameter) const { return parameters_[parameter]; }
+
+    /*
+     * Add a node which samples a clip. The clip time is the
+     * tree time multiplied by the speed, wrapped to the
+     * duration if it is positive. A clip may be used by
+     * several nodes.
+     * @returns index of the node
+     */
+    int addClip(AnimationClip* clip, float speed, float duration);
+
+    /*
+     * Add a node which blends its children by one parameter.
+     * @param thresholds    value of the parameter for each child, increasing
+     * @param sync          true to play clip children at the same phase
+     * @returns index of the node or -1 if a child or parameter is invalid
+     */
+    int addBlend1D(int parameter, const int* children, const float* thresholds,
+                   int num_children, bool sync);
+
+    /*
+     * Add a node which blends its children by two parameters.
+     * @param positions     x, y values of the parameters for each child
+     * @returns index of the node or -1 if a child or parameter is invalid
+     */
+    int addBlend2D(int parameter_x, int parameter_y, const int* children,
+                   const float* positions, int num_children, bool sync);
+
+    /*
+     * Add the difference between an additive pose and a reference
+     * pose to a base pose, scaled by a weight parameter.
+     * @param reference     node for the reference pose, -1 for the rest pose
+     * @returns index of the node or -1 if a child or parameter is invalid
+     */
+    int addAdditive(int base, int additive, int reference, int weight_parameter);
+
+    /*
+     * Replace a base pose with another one for the joints
+     * in a mask, scaled by a weight parameter.
+     * @param mask          weight of the override for each joint,
+     *                      joints past the end are not overridden
+     * @returns index of the node or -1 if a child or parameter is invalid
+     */
+    int addOverride(int base, int override, const float* mask, int num_joints,
+                    int weight_parameter);
+
+    int getNodeCount() const { return nodes_.size(); }
+
+    /*
+     * Bind the clips of the tree to a skeleton and size the
+     * pose buffers for it. Must be called again if nodes
+     * or joints are added.
+     */
+    void bind(const Skeleton& skeleton);
+
+    /*
+     * Evaluate the tree at the given time in seconds.
+     * @returns the pose of the root, valid until the next evaluation
+     */
+    const LocalPose& evaluate(float time);
+
+private:
+    struct Node {
+        int                 type;
+        AnimationClip*      clip;
+        float               speed;
+        float               duration;
+        bool                sync;
+        int                 parameters[2];
+        std::vector<int>    children;
+        std::vector<float>  positions;      // thresholds or x, y per child
+        std::vector<float>  weights;        // of the children, per evaluation
+        std::vector<float>  mask;
+        int                 depth;          // number of pose buffers used
+    };
+
+    BlendTree(const BlendTree& tree);
+    BlendTree(BlendTree&& tree);
+    BlendTree& operator=(const BlendTree& tree);
+    BlendTree& operator=(BlendTree&& tree);
+
+    bool validChild(int node) const;
+    bool validParameter(int parameter) const;
+    int addNode(Node& node);
+    float getCycle(int node);
+    void computeWeights(Node& node);
+    void evaluateNode(int node, int slot, float time, float phase);
+    static void blendPoses(LocalPose& pose, const LocalPose& other, float factor);
+    static void addPose(LocalPose& pose, const LocalPose& additive,
+                        const LocalPose& reference, float weight);
+    static void overridePose(LocalPose& pose, const LocalPose& other,
+                             const std::vector<float>& mask, float weight);
+
+    std::vector<Node>       nodes_;
+    std::vector<float>      parameters_;
+    std::vector<LocalPose>  pool_;
+    LocalPose               rest_pose_;
+};
+
+}
+#endif
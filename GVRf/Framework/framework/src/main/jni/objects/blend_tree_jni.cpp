@@ -0,0 +1,187 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "objects/blend_tree.h"
+#include "objects/components/skeleton.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C"
+{
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeBlendTree_ctor(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeBlendTree_addParameter(JNIEnv * env,
+            jobject obj, jlong jtree, jfloat value);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeBlendTree_setParameter(JNIEnv * env,
+            jobject obj, jlong jtree, jint parameter, jfloat value);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeBlendTree_addClip(JNIEnv * env,
+            jobject obj, jlong jtree, jlong jclip, jfloat speed, jfloat duration);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeBlendTree_addBlend1D(JNIEnv * env,
+            jobject obj, jlong jtree, jint parameter, jintArray jchildren,
+            jfloatArray jthresholds, jboolean sync);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeBlendTree_addBlend2D(JNIEnv * env,
+            jobject obj, jlong jtree, jint parameter_x, jint parameter_y,
+            jintArray jchildren, jfloatArray jpositions, jboolean sync);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeBlendTree_addAdditive(JNIEnv * env,
+            jobject obj, jlong jtree, jint base, jint additive, jint reference,
+            jint weight_parameter);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeBlendTree_addOverride(JNIEnv * env,
+            jobject obj, jlong jtree, jint base, jint override, jfloatArray jmask,
+            jint weight_parameter);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeBlendTree_bind(JNIEnv * env,
+            jobject obj, jlong jtree, jlong jskeleton);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeBlendTree_animate(JNIEnv * env,
+            jobject obj, jlong jtree, jlong jskeleton, jfloat time);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeBlendTree_ctor(JNIEnv * env, jobject obj)
+{
+    return reinterpret_cast<jlong>(new BlendTree());
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeBlendTree_addParameter(JNIEnv * env,
+        jobject obj, jlong jtree, jfloat value)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    return tree->addParameter(value);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeBlendTree_setParameter(JNIEnv * env,
+        jobject obj, jlong jtree, jint parameter, jfloat value)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    tree->setParameter(parameter, value);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeBlendTree_addClip(JNIEnv * env,
+        jobject obj, jlong jtree, jlong jclip, jfloat speed, jfloat duration)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    return tree->addClip(clip, speed, duration);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeBlendTree_addBlend1D(JNIEnv * env,
+        jobject obj, jlong jtree, jint parameter, jintArray jchildren,
+        jfloatArray jthresholds, jboolean sync)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    int num_children = env->GetArrayLength(jchildren);
+
+    if (env->GetArrayLength(jthresholds) < num_children)
+    {
+        return -1;
+    }
+    jint* children = env->GetIntArrayElements(jchildren, 0);
+    jfloat* thresholds = env->GetFloatArrayElements(jthresholds, 0);
+    int node = tree->addBlend1D(parameter, children, thresholds, num_children, sync);
+
+    env->ReleaseFloatArrayElements(jthresholds, thresholds, JNI_ABORT);
+    env->ReleaseIntArrayElements(jchildren, children, JNI_ABORT);
+    return node;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeBlendTree_addBlend2D(JNIEnv * env,
+        jobject obj, jlong jtree, jint parameter_x, jint parameter_y,
+        jintArray jchildren, jfloatArray jpositions, jboolean sync)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    int num_children = env->GetArrayLength(jchildren);
+
+    if (env->GetArrayLength(jpositions) < num_children * 2)
+    {
+        return -1;
+    }
+    jint* children = env->GetIntArrayElements(jchildren, 0);
+    jfloat* positions = env->GetFloatArrayElements(jpositions, 0);
+    int node = tree->addBlend2D(parameter_x, parameter_y, children, positions,
+                                num_children, sync);
+
+    env->ReleaseFloatArrayElements(jpositions, positions, JNI_ABORT);
+    env->ReleaseIntArrayElements(jchildren, children, JNI_ABORT);
+    return node;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeBlendTree_addAdditive(JNIEnv * env,
+        jobject obj, jlong jtree, jint base, jint additive, jint reference,
+        jint weight_parameter)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    return tree->addAdditive(base, additive, reference, weight_parameter);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeBlendTree_addOverride(JNIEnv * env,
+        jobject obj, jlong jtree, jint base, jint override, jfloatArray jmask,
+        jint weight_parameter)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    jfloat* mask = env->GetFloatArrayElements(jmask, 0);
+    int node = tree->addOverride(base, override, mask, env->GetArrayLength(jmask),
+                                 weight_parameter);
+
+    env->ReleaseFloatArrayElements(jmask, mask, JNI_ABORT);
+    return node;
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeBlendTree_bind(JNIEnv * env,
+        jobject obj, jlong jtree, jlong jskeleton)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    tree->bind(*skeleton);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeBlendTree_animate(JNIEnv * env,
+        jobject obj, jlong jtree, jlong jskeleton, jfloat time)
+{
+    BlendTree* tree = reinterpret_cast<BlendTree*>(jtree);
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    skeleton->setPose(tree->evaluate(time));
+}
+
+}
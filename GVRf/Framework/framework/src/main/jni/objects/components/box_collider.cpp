@@ -41,6 +41,19 @@ namespace gvr {
         return data;
     }
 
+    bool BoxCollider::getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner)
+    {
+        SceneObject* owner = owner_object();
+
+        if ((owner == NULL) || (owner->transform() == NULL))
+        {
+            return false;
+        }
+        transformBounds(owner->transform()->getModelMatrix(),
+                        -half_extents_, half_extents_, minCorner, maxCorner);
+        return true;
+    }
+
 /*
  * Determine if the ray hits the collider.
  * @param model_matrix  matrix to transform model to world coordinates
@@ -39,6 +39,7 @@ public:
 
     void set_half_extents(float x, float y, float z) {
         half_extents_ = glm::vec3(x, y, z);
+        markBoundsDirty();
     }
 
     glm::vec3 get_half_extents() {
@@ -46,6 +47,7 @@ public:
     }
 
     ColliderData isHit(const glm::vec3& rayStart, const glm::vec3& rayDir);
+    bool getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner);
     ColliderData isHit(const glm::mat4& model_matrix, const glm::vec3& half_extends, const glm::vec3& rayStart, const glm::vec3& rayDir);
 
 private:
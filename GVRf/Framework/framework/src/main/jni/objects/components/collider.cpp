@@ -43,14 +43,48 @@ void Collider::transformRay(const glm::mat4& model_matrix, glm::vec3& rayStart,
     rayStart = glm::vec3(start);
 }
 
+/*
+ * Compute the axis aligned bounds of a box after it is transformed.
+ * @param matrix    4x4 affine matrix to apply to the box
+ * @param minIn     minimum corner of the input box
+ * @param maxIn     maximum corner of the input box
+ * @param minOut    gets the minimum corner of the transformed box
+ * @param maxOut    gets the maximum corner of the transformed box
+ */
+void Collider::transformBounds(const glm::mat4& matrix,
+                               const glm::vec3& minIn, const glm::vec3& maxIn,
+                               glm::vec3& minOut, glm::vec3& maxOut)
+{
+    glm::vec3 center = (minIn + maxIn) * 0.5f;
+    glm::vec3 extent = (maxIn - minIn) * 0.5f;
+    glm::vec3 newCenter(matrix * glm::vec4(center, 1));
+    glm::vec3 newExtent = glm::abs(glm::vec3(matrix[0])) * extent.x +
+                          glm::abs(glm::vec3(matrix[1])) * extent.y +
+                          glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+    minOut = newCenter - newExtent;
+    maxOut = newCenter + newExtent;
+}
+
+void Collider::markBoundsDirty()
+{
+    Scene* scene = scene_;
+    if (scene != NULL)
+    {
+        scene->markColliderDirty(this);
+    }
+}
+
 void Collider::onAddedToScene(Scene* scene)
 {
+    scene_ = scene;
     scene->addCollider(this);
 }
 
 void Collider::onRemovedFromScene(Scene* scene)
 {
     scene->removeCollider(this);
+    scene_ = NULL;
 }
 
 }
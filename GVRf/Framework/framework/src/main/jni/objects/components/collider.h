@@ -30,6 +30,7 @@
 
 namespace gvr {
 class Collider;
+class ColliderTree;
 
 /*
  * Information from a collision when a collider is picked.
@@ -58,8 +59,10 @@ public:
  */
 class Collider: public Component {
 public:
-    Collider() : Component(Collider::getComponentType()), pick_distance_(0) {}
-    Collider(long long type) : Component(type), pick_distance_(0) {}
+    Collider() : Component(Collider::getComponentType()), pick_distance_(0),
+                 scene_(NULL), tree_node_(-1), bounds_dirty_(false), visible_stamp_(0) {}
+    Collider(long long type) : Component(type), pick_distance_(0),
+                 scene_(NULL), tree_node_(-1), bounds_dirty_(false), visible_stamp_(0) {}
 
     virtual ~Collider() {}
 
@@ -76,6 +79,46 @@ public:
      */
     virtual ColliderData isHit(const glm::vec3& rayStart, const glm::vec3& rayDir) = 0;
 
+    /*
+     * Compute the axis aligned bounds of the collider in world space.
+     * The scene keeps these bounds in a tree so rays are only tested
+     * against colliders they might hit.
+     *
+     * @param minCorner     gets the minimum corner in world coordinates
+     * @param maxCorner     gets the maximum corner in world coordinates
+     *
+     * @returns false if the collider cannot be bounded,
+     *          it is then tested against every ray
+     */
+    virtual bool getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner) {
+        return false;
+    }
+
+    /*
+     * Tell the scene the world bounds of this collider have changed.
+     * Called when the transform of the owner changes or the
+     * collision geometry is modified.
+     */
+    void markBoundsDirty();
+
+    /*
+     * Returns true if the collision geometry changed since the
+     * last call without the collider being told, such as the
+     * vertices of a mesh being written. The collider tree calls
+     * it on each update, under the scene collider lock.
+     */
+    virtual bool geometryChanged() {
+        return false;
+    }
+
+    void set_visible_stamp(unsigned int stamp) {
+        visible_stamp_ = stamp;
+    }
+
+    unsigned int visible_stamp() const {
+        return visible_stamp_;
+    }
+
     virtual long shape_type() {
         return COLLIDER_SHAPE_UNKNOWN;
     }
@@ -92,11 +135,20 @@ public:
         return pick_distance_;
     }
     static void transformRay(const glm::mat4& matrix, glm::vec3& rayStart, glm::vec3& rayDir);
+    static void transformBounds(const glm::mat4& matrix,
+                                const glm::vec3& minIn, const glm::vec3& maxIn,
+                                glm::vec3& minOut, glm::vec3& maxOut);
     virtual void onAddedToScene(Scene* scene);
     virtual void onRemovedFromScene(Scene* scene);
 
 protected:
+    friend class ColliderTree;
+
     float pick_distance_;
+    Scene* scene_;
+    int tree_node_;
+    bool bounds_dirty_;
+    unsigned int visible_stamp_;
 
     Collider(const Collider& collider);
     Collider(Collider&& collider);
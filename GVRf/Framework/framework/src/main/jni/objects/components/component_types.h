@@ -29,6 +29,9 @@ namespace gvr {
     static const long long COMPONENT_TYPE_PHYSICS_WORLD      = 10011;
     static const long long COMPONENT_TYPE_RENDER_TARGET      = 10012;
     static const long long COMPONENT_TYPE_PHYSICS_CONSTRAINT = 10013;
+    static const long long COMPONENT_TYPE_LOD_GROUP          = 10014;
+    static const long long COMPONENT_TYPE_SKELETON           = 10015;
+    static const long long COMPONENT_TYPE_PARTICLE_SYSTEM    = 10016;
 
 }
 
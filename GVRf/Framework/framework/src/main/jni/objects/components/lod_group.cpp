@@ -0,0 +1,211 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Selects one of several levels of detail during culling.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include "lod_group.h"
+#include "objects/scene_object.h"
+#include "objects/mesh.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+LODGroup::LODGroup() :
+        Component(LODGroup::getComponentType()),
+        metric_(Distance),
+        hysteresis_(0),
+        current_level_(-1),
+        base_mesh_(nullptr) {
+}
+
+void LODGroup::set_metric(Metric m) {
+    std::lock_guard<std::mutex> lock(lock_);
+    metric_ = m;
+    std::stable_sort(levels_.begin(), levels_.end(), [m](const Level& a, const Level& b) {
+        return (m == Distance) ? (a.threshold < b.threshold) : (a.threshold > b.threshold);
+    });
+    updateRanges();
+    current_level_ = -1;
+}
+
+int LODGroup::addLevel(float threshold, SceneObject* object) {
+    Level level = { threshold, 0, 0, object, nullptr };
+    return insertLevel(level);
+}
+
+int LODGroup::addLevel(float threshold, Mesh* mesh) {
+    Level level = { threshold, 0, 0, nullptr, mesh };
+    return insertLevel(level);
+}
+
+/*
+ * Levels are kept sorted from the most to the least detailed.
+ * For distance that means ascending distance, for screen
+ * size it means descending projected size.
+ */
+int LODGroup::insertLevel(const Level& level) {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (levels_.size() >= MAX_LOD_LEVELS) {
+        LOGE("LODGroup: cannot have more than %d levels", MAX_LOD_LEVELS);
+        return -1;
+    }
+    auto it = levels_.begin();
+    for (; it != levels_.end(); ++it) {
+        if ((metric_ == Distance) ? (level.threshold < it->threshold)
+                                  : (level.threshold > it->threshold)) {
+            break;
+        }
+    }
+    int index = it - levels_.begin();
+    levels_.insert(it, level);
+    updateRanges();
+    current_level_ = -1;
+    return index;
+}
+
+void LODGroup::onDetach(SceneObject* owner) {
+    std::lock_guard<std::mutex> lock(lock_);
+    RenderData* rdata = owner->render_data();
+    if (rdata && base_mesh_) {
+        rdata->set_mesh(base_mesh_);
+    }
+    base_mesh_ = nullptr;
+    current_level_ = -1;
+}
+
+/*
+ * Convert the user thresholds into metric ranges [start, end).
+ * In screen size mode the metric is the reciprocal of the
+ * projected size so both modes grow as the object recedes.
+ * Past the smallest screen size nothing is rendered, past the
+ * largest distance the coarsest level stays selected.
+ */
+void LODGroup::updateRanges() {
+    const float inf = std::numeric_limits<float>::infinity();
+    int n = levels_.size();
+
+    for (int i = 0; i < n; ++i) {
+        Level& l = levels_[i];
+        if (metric_ == Distance) {
+            l.start = l.threshold;
+            l.end = (i < n - 1) ? levels_[i + 1].threshold : inf;
+        } else {
+            l.start = (i > 0) ? 1.0f / levels_[i - 1].threshold : 0.0f;
+            l.end = (l.threshold > 0) ? 1.0f / l.threshold : inf;
+        }
+    }
+}
+
+float LODGroup::computeMetric(const LODView& view) {
+    const BoundingVolume& bv = owner_object_->getBoundingVolume();
+    const glm::mat4& proj = view.projection;
+    float distance = glm::length(bv.center() - view.eye_position);
+
+    if (metric_ == Distance) {
+        return distance * view.bias;
+    }
+    /*
+     * Projected height of the bounding sphere as a fraction of
+     * the viewport is radius * proj[1][1] / distance for perspective
+     * projections and radius * proj[1][1] for orthographic ones.
+     */
+    float size = bv.radius() * proj[1][1];
+    if (proj[3][3] == 0) {
+        if (distance <= bv.radius()) {
+            return 0;
+        }
+        size /= distance;
+    }
+    return (size > 0) ? (view.bias / size) : std::numeric_limits<float>::infinity();
+}
+
+int LODGroup::select(const LODView& view) {
+    std::lock_guard<std::mutex> lock(lock_);
+    if ((owner_object_ == nullptr) || levels_.empty()) {
+        return -1;
+    }
+    float metric = computeMetric(view);
+    int level = current_level_;
+
+    if ((level >= 0) && (level < levels_.size())) {
+        const Level& cur = levels_[level];
+        if ((metric >= cur.start * (1 - hysteresis_)) &&
+            (metric < cur.end * (1 + hysteresis_))) {
+            return level;
+        }
+    }
+    level = -1;
+    for (int i = 0; i < levels_.size(); ++i) {
+        if ((metric >= levels_[i].start) && (metric < levels_[i].end)) {
+            level = i;
+            break;
+        }
+    }
+    if (level != current_level_) {
+        applyLevel(level);
+        current_level_ = level;
+    }
+    return level;
+}
+
+/*
+ * Mesh levels replace the mesh of the owner's RenderData.
+ * The original mesh is remembered so it can be restored
+ * when the group is detached.
+ */
+void LODGroup::applyLevel(int level) {
+    RenderData* rdata = owner_object_ ? owner_object_->render_data() : nullptr;
+    if (rdata == nullptr) {
+        return;
+    }
+    if (base_mesh_ == nullptr) {
+        base_mesh_ = rdata->mesh();
+    }
+    if ((level >= 0) && levels_[level].mesh) {
+        rdata->set_mesh(levels_[level].mesh);
+    } else if (level < 0) {
+        rdata->set_mesh(base_mesh_);
+    }
+}
+
+bool LODGroup::isVisible(const SceneObject* child) const {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (int i = 0; i < levels_.size(); ++i) {
+        if (levels_[i].object == child) {
+            return i == current_level_;
+        }
+    }
+    return true;
+}
+
+bool LODGroup::isOwnerCulled() const {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (current_level_ >= 0) {
+        return false;
+    }
+    for (auto it = levels_.begin(); it != levels_.end(); ++it) {
+        if (it->mesh) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,142 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Selects one of several levels of detail during culling.
+ ***************************************************************************/
+
+#ifndef LOD_GROUP_H_
+#define LOD_GROUP_H_
+
+#include <vector>
+#include <mutex>
+#include "glm/glm.hpp"
+
+#include "component.h"
+
+namespace gvr {
+class Mesh;
+class SceneObject;
+
+#define MAX_LOD_LEVELS 8
+
+/*
+ * Camera information used to select levels of detail.
+ */
+struct LODView {
+    glm::vec3   eye_position;   // camera position in world coordinates
+    glm::mat4   projection;     // camera projection matrix
+    float       bias;           // global LOD bias, > 1 selects coarser levels
+    bool        select_levels;  // false to keep the levels selected for the main view
+};
+
+/*
+ * Component attached to a SceneObject which chooses
+ * a level of detail each time the scene is culled.
+ *
+ * Each level is either a child scene object (only the
+ * selected child is traversed by the renderer) or a mesh
+ * which replaces the mesh of the owner's RenderData.
+ *
+ * Levels are selected by camera distance or by the fraction
+ * of the viewport height covered by the owner's bounding sphere.
+ * The selection is made inside Renderer::frustum_cull for the
+ * main camera being culled so it never lags behind the view.
+ * Other cameras, such as shadow map cameras, use the levels
+ * selected for the main view.
+ */
+class LODGroup: public Component {
+public:
+    enum Metric {
+        Distance = 0,   // thresholds are minimum camera distances
+        ScreenSize = 1  // thresholds are minimum projected heights (0 - 1)
+    };
+
+    LODGroup();
+    virtual ~LODGroup() { }
+
+    static long long getComponentType() {
+        return COMPONENT_TYPE_LOD_GROUP;
+    }
+
+    Metric metric() const { return metric_; }
+    void set_metric(Metric m);
+
+    /*
+     * Fraction by which the metric must pass a level boundary
+     * before the selection changes. Prevents popping when the
+     * camera hovers around a threshold.
+     */
+    float hysteresis() const { return hysteresis_; }
+    void set_hysteresis(float h) { hysteresis_ = (h < 0) ? 0 : h; }
+
+    int addLevel(float threshold, SceneObject* object);
+    int addLevel(float threshold, Mesh* mesh);
+
+    int getLevelCount() const { return levels_.size(); }
+    int getCurrentLevel() const { return current_level_; }
+
+    /*
+     * Select the level for the given view and apply it.
+     * @param view  camera position, projection and LOD bias
+     * @returns index of the selected level or -1 if nothing should render
+     */
+    int select(const LODView& view);
+
+    /*
+     * Returns true if the given child of the owner should be
+     * traversed with the current selection. Children which are
+     * not levels of this group are always visible.
+     */
+    bool isVisible(const SceneObject* child) const;
+
+    /*
+     * Returns true if the owner itself should not be rendered
+     * because it displays mesh levels and none is selected.
+     */
+    bool isOwnerCulled() const;
+
+    virtual void onDetach(SceneObject* owner);
+
+private:
+    struct Level {
+        float           threshold;  // value given by the user
+        float           start;      // metric at which this level begins
+        float           end;        // metric at which this level ends
+        SceneObject*    object;
+        Mesh*           mesh;
+    };
+
+    LODGroup(const LODGroup& lod_group);
+    LODGroup(LODGroup&& lod_group);
+    LODGroup& operator=(const LODGroup& lod_group);
+    LODGroup& operator=(LODGroup&& lod_group);
+
+    int     insertLevel(const Level& level);
+    void    updateRanges();
+    float   computeMetric(const LODView& view);
+    void    applyLevel(int level);
+
+    mutable std::mutex  lock_;
+    std::vector<Level>  levels_;
+    Metric              metric_;
+    float               hysteresis_;
+    int                 current_level_;
+    Mesh*               base_mesh_;
+};
+
+}
+#endif
@@ -0,0 +1,110 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "lod_group.h"
+#include "objects/mesh.h"
+#include "objects/scene_object.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C"
+{
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeLODGroup_ctor(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeLODGroup_getComponentType(JNIEnv * env, jobject obj);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeLODGroup_setMetric(JNIEnv * env,
+            jobject obj, jlong jlod, jint metric);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeLODGroup_setHysteresis(JNIEnv * env,
+            jobject obj, jlong jlod, jfloat hysteresis);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeLODGroup_addObjectLevel(JNIEnv * env,
+            jobject obj, jlong jlod, jfloat threshold, jlong jscene_object);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeLODGroup_addMeshLevel(JNIEnv * env,
+            jobject obj, jlong jlod, jfloat threshold, jlong jmesh);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeLODGroup_getCurrentLevel(JNIEnv * env,
+            jobject obj, jlong jlod);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeLODGroup_ctor(JNIEnv * env, jobject obj)
+{
+    return reinterpret_cast<jlong>(new LODGroup());
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeLODGroup_getComponentType(JNIEnv * env, jobject obj)
+{
+    return LODGroup::getComponentType();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeLODGroup_setMetric(JNIEnv * env,
+        jobject obj, jlong jlod, jint metric)
+{
+    LODGroup* lod = reinterpret_cast<LODGroup*>(jlod);
+    lod->set_metric(static_cast<LODGroup::Metric>(metric));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeLODGroup_setHysteresis(JNIEnv * env,
+        jobject obj, jlong jlod, jfloat hysteresis)
+{
+    LODGroup* lod = reinterpret_cast<LODGroup*>(jlod);
+    lod->set_hysteresis(hysteresis);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeLODGroup_addObjectLevel(JNIEnv * env,
+        jobject obj, jlong jlod, jfloat threshold, jlong jscene_object)
+{
+    LODGroup* lod = reinterpret_cast<LODGroup*>(jlod);
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    return lod->addLevel(threshold, scene_object);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeLODGroup_addMeshLevel(JNIEnv * env,
+        jobject obj, jlong jlod, jfloat threshold, jlong jmesh)
+{
+    LODGroup* lod = reinterpret_cast<LODGroup*>(jlod);
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    return lod->addLevel(threshold, mesh);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeLODGroup_getCurrentLevel(JNIEnv * env,
+        jobject obj, jlong jlod)
+{
+    LODGroup* lod = reinterpret_cast<LODGroup*>(jlod);
+    return lod->getCurrentLevel();
+}
+
+}
@@ -30,17 +30,20 @@
 
 namespace gvr {
 MeshCollider::MeshCollider(Mesh* mesh) :
-        Collider(getComponentType()), mesh_(mesh), pickCoordinates_(false), useMeshBounds_(false)
+        Collider(getComponentType()), mesh_(mesh), pickCoordinates_(false), useMeshBounds_(false),
+        bounds_mesh_(NULL), bounds_change_count_(0)
 {
 }
 
 MeshCollider::MeshCollider(Mesh* mesh, bool pickCoordinates) :
-        Collider(getComponentType()), mesh_(mesh), pickCoordinates_(pickCoordinates), useMeshBounds_(false)
+        Collider(getComponentType()), mesh_(mesh), pickCoordinates_(pickCoordinates), useMeshBounds_(false),
+        bounds_mesh_(NULL), bounds_change_count_(0)
 {
 }
 
 MeshCollider::MeshCollider(bool useMeshBounds) :
-        Collider(getComponentType()), mesh_(NULL), pickCoordinates_(false), useMeshBounds_(useMeshBounds)
+        Collider(getComponentType()), mesh_(NULL), pickCoordinates_(false), useMeshBounds_(useMeshBounds),
+        bounds_mesh_(NULL), bounds_change_count_(0)
 {
 }
 
@@ -115,6 +118,74 @@ ColliderData MeshCollider::isHit(const glm::vec3& rayStart, const glm::vec3& ray
     return data;
 }
 
+/*
+ * Compute the world bounds of the mesh collider from the
+ * bounds of its mesh or the mesh of the owner's render data.
+ * If there is no mesh yet the collider cannot be bounded.
+ */
+bool MeshCollider::getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner)
+{
+    SceneObject* owner = owner_object();
+    Mesh* mesh = boundsMesh();
+
+    if ((owner == NULL) || (owner->transform() == NULL))
+    {
+        return false;
+    }
+    if ((mesh == NULL) || (mesh->getVertexBuffer() == NULL))
+    {
+        return false;
+    }
+    const BoundingVolume& bounds = mesh->getBoundingVolume();
+    if (glm::any(glm::greaterThan(bounds.min_corner(), bounds.max_corner())))
+    {
+        return false;
+    }
+    transformBounds(owner->transform()->getModelMatrix(),
+                    bounds.min_corner(), bounds.max_corner(), minCorner, maxCorner);
+    return true;
+}
+
+/*
+ * The world bounds depend on the vertices of the mesh, which
+ * may be written without the collider knowing.
+ */
+bool MeshCollider::geometryChanged()
+{
+    Mesh* mesh = boundsMesh();
+    unsigned int count = 0;
+
+    if ((mesh != NULL) && (mesh->getVertexBuffer() != NULL))
+    {
+        count = mesh->getVertexBuffer()->getChangeCount();
+    }
+    if ((mesh == bounds_mesh_) && (count == bounds_change_count_))
+    {
+        return false;
+    }
+    bounds_mesh_ = mesh;
+    bounds_change_count_ = count;
+    return true;
+}
+
+/*
+ * The mesh of the collider or of the owner's render data.
+ */
+Mesh* MeshCollider::boundsMesh()
+{
+    SceneObject* owner = owner_object();
+
+    if ((mesh_ == NULL) && (owner != NULL))
+    {
+        RenderData* rd = owner->render_data();
+        if (rd != NULL)
+        {
+            return rd->mesh();
+        }
+    }
+    return mesh_;
+}
+
 /**
  * Efficient means of solving Barycentric coordinates by Christer Ericson/John Calsbeek found at
  * https://gamedev.stackexchange.com/questions/23743/whats-the-most-efficient-way-to-find-barycentric-coordinates
@@ -164,39 +235,28 @@ static void populateSurfaceCoords(const Mesh& mesh, ColliderData& colliderData)
         I3 = *(intData+2);
     }
 
-    const float* vertData = vBuffer->getVertexData();
-    const float *V1;
-    const float *V2;
-    const float *V3;
-    int stride = vBuffer->getVertexSize();
-    V1 = vertData + (stride * I1);
-    V2 = vertData + (stride * I2);
-    V3 = vertData + (stride * I3);
-    int index, offset, size;
-    vBuffer->getInfo("a_position", index, offset, size);
-    offset /= sizeof(float);
-    glm::vec3 v1(V1[offset], V1[offset+1], V1[offset+2]);
-    glm::vec3 v2(V2[offset], V2[offset+1], V2[offset+2]);
-    glm::vec3 v3(V3[offset], V3[offset+1], V3[offset+2]);
+    glm::vec4 V1, V2, V3;
+    vBuffer->getFloatVertex("a_position", I1, &V1.x);
+    vBuffer->getFloatVertex("a_position", I2, &V2.x);
+    vBuffer->getFloatVertex("a_position", I3, &V3.x);
+    glm::vec3 v1(V1), v2(V2), v3(V3);
 
     calcBarycentric(colliderData.HitPosition, v1, v2, v3, colliderData.BarycentricCoordinates);
-    bool hasTexCoords = vBuffer->getInfo("a_texcoord", index, offset, size);
+    bool hasTexCoords = vBuffer->getFloatVertex("a_texcoord", I1, &V1.x);
     if(hasTexCoords){
-        offset /= sizeof(float);
-        glm::vec2 u1(V1[offset], V1[offset+1]);
-        glm::vec2 u2(V2[offset], V2[offset+1]);
-        glm::vec2 u3(V3[offset], V3[offset+1]);
+        vBuffer->getFloatVertex("a_texcoord", I2, &V2.x);
+        vBuffer->getFloatVertex("a_texcoord", I3, &V3.x);
+        glm::vec2 u1(V1), u2(V2), u3(V3);
 
         colliderData.TextureCoordinates =   u1 * colliderData.BarycentricCoordinates.x
                                             + u2 * colliderData.BarycentricCoordinates.y
                                             + u3 * colliderData.BarycentricCoordinates.z;
     }
-    bool hasNormals = vBuffer->getInfo("a_normal", index, offset, size);
+    bool hasNormals = vBuffer->getFloatVertex("a_normal", I1, &V1.x);
     if(hasNormals){
-        offset /= sizeof(float);
-        glm::vec3 n1(V1[offset], V1[offset+1], V1[offset+2]);
-        glm::vec3 n2(V2[offset], V2[offset+1], V2[offset+2]);
-        glm::vec3 n3(V3[offset], V3[offset+1], V3[offset+2]);
+        vBuffer->getFloatVertex("a_normal", I2, &V2.x);
+        vBuffer->getFloatVertex("a_normal", I3, &V3.x);
+        glm::vec3 n1(V1), n2(V2), n3(V3);
 
         colliderData.NormalCoordinates =   n1 * colliderData.BarycentricCoordinates.x
                                             + n2 * colliderData.BarycentricCoordinates.y
@@ -217,26 +277,21 @@ ColliderData MeshCollider::isHit(const Mesh& mesh, const glm::vec3& rayStart, co
     ColliderData data;
     if (mesh.getVertexCount() > 0)
     {
-        mesh.forAllTriangles([&data, rayStart, rayDir](int iter, const float* v1, const float* v2, const float* v3) mutable
+        /*
+         * Compute the point where the ray penetrates the mesh in
+         * the coordinate space of the mesh. The hit point will
+         * be in mesh coordinates as will the distance.
+         */
+        glm::vec3 hitPos;
+        float distance;
+        int faceIndex;
+        if (mesh.getBVH().raycast(mesh, rayStart, rayDir, hitPos, distance, faceIndex))
         {
-            /*
-             * Compute the point where the ray penetrates the mesh in
-             * the coordinate space of the mesh. The hit point will
-             * be in mesh coordinates as will the distance.
-             */
-            glm::vec3 hitPos;
-            glm::vec3 A(v1[0], v1[1], v1[2]);
-            glm::vec3 B(v2[0], v2[1], v2[2]);
-            glm::vec3 C(v3[0], v3[1], v3[2]);
-            float distance = rayTriangleIntersect(hitPos, rayStart, rayDir, A, B, C);
-            if ((distance > 0) && (distance < data.Distance))
-            {
-                data.IsHit = true;
-                data.HitPosition = hitPos;
-                data.Distance = distance;
-                data.FaceIndex = iter;
-            }
-        });
+            data.IsHit = true;
+            data.HitPosition = hitPos;
+            data.Distance = distance;
+            data.FaceIndex = faceIndex;
+        }
         if(pickCoordinates && data.IsHit){
             populateSurfaceCoords(mesh, data);
         }
@@ -261,41 +316,4 @@ ColliderData MeshCollider::isHit(const Mesh& mesh, const glm::vec3& rayStart, co
          }
          return data;
     }
-
-    float MeshCollider::rayTriangleIntersect(glm::vec3& hitPos, const glm::vec3& rayStart, const glm::vec3& rayDir,
-                                       const glm::vec3& V1, const glm::vec3& V2, const glm::vec3& V3)
-    {
-        glm::vec3 e1(V2 - V1);
-        glm::vec3 e2(V3 - V1);
-        glm::vec3 P = glm::cross(rayDir, e2);
-        glm::vec3 T(glm::vec3(rayStart) - V1);
-        float det = glm::dot(e1, P);
-        const float EPSILON = 0.00001f;
-
-        if (det > -EPSILON && det < EPSILON) {
-            return -1;
-        }
-
-        float inv_det = 1.0f / det;
-        float u = glm::dot(T, P) * inv_det;
-
-        if (u < 0.0f || u > 1.0f) {
-            return -1;
-        }
-
-        glm::vec3 Q = glm::cross(T, e1);
-        float v = glm::dot(glm::vec3(rayDir), Q) * inv_det;
-
-        if (v < 0.0f || (u + v) > 1.0f) {
-            return -1;
-        }
-
-        float t = glm::dot(e2, Q) * inv_det;
-
-        if (t > EPSILON) {
-            hitPos = (1.0f - u - v) * V1 + u * V2 + v * V3;
-            return t;
-        }
-        return -1;
-    }
 }
@@ -46,6 +46,7 @@ public:
 
     void set_mesh(Mesh* mesh) {
         mesh_ = mesh;
+        markBoundsDirty();
     }
 
     bool pickCoordinatesEnabled(){
@@ -53,6 +54,8 @@ public:
     }
 
     ColliderData isHit(const glm::vec3& rayStart, const glm::vec3& rayDir);
+    bool getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner);
+    bool geometryChanged();
     static ColliderData isHit(const BoundingVolume& bounds, const glm::vec3& rayStart, const glm::vec3& rayDir);
 
 private:
@@ -61,12 +64,13 @@ private:
     MeshCollider& operator=(const MeshCollider& mesh_collider);
     MeshCollider& operator=(MeshCollider&& mesh_collider);
     static ColliderData isHit(const Mesh& mesh, const glm::vec3& rayStart, const glm::vec3& rayDir, bool pickCoordinates);
-    static float rayTriangleIntersect(glm::vec3& hitPos, const glm::vec3& rayStart, const glm::vec3& rayDir,
-                               const glm::vec3& V1, const glm::vec3& V2, const glm::vec3& V3);
+    Mesh* boundsMesh();
 private:
     bool useMeshBounds_;
     bool pickCoordinates_;
     Mesh* mesh_;
+    Mesh* bounds_mesh_;                 // mesh when geometryChanged was last called
+    unsigned int bounds_change_count_;  // and the change count of its vertices
 };
 }
 #endif
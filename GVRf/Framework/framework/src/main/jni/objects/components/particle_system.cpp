@@ -0,0 +1,558 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Particles simulated natively and streamed to a point mesh.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <math.h>
+
+#include "particle_system.h"
+#include "objects/mesh.h"
+#include "objects/scene_object.h"
+#include "objects/vertex_buffer.h"
+#include "util/gvr_log.h"
+#include "util/gvr_simd.h"
+
+namespace gvr {
+
+// Floats per vertex of each attribute
+static const int POSITION_SIZE = 3;
+static const int COLOR_SIZE = 4;
+static const int SIZE_SIZE = 1;
+static const int VELOCITY_SIZE = 3;
+static const int SPAWN_SIZE = 2;
+
+// Spawn time of vertices which do not hold a stateless particle
+static const float NEVER = -1e30f;
+
+// Seconds past the lifetime after which stateless spawn times
+// are moved back towards zero
+static const float REBASE_TIME = 256.0f;
+
+ParticleSystem::ParticleSystem(int capacity, bool stateless)
+: Component(ParticleSystem::getComponentType()),
+  capacity_(std::max(capacity, 1)),
+  stateless_(stateless),
+  head_(0),
+  count_(0),
+  written_(0),
+  time_(0.0f),
+  mesh_(nullptr),
+  position_offset_(0),
+  color_offset_(0),
+  size_offset_(0),
+  shape_(POINT),
+  width_(1.0f),
+  height_(1.0f),
+  lifetime_(1.0f),
+  noise_(0.0f),
+  size_(1.0f),
+  size_rate_(0.0f),
+  seed_(0x9E3779B9)
+{
+    for (int k = 0; k < 3; ++k) {
+        if (!stateless_) {
+            positions_[k].resize(capacity_ + 3, 0.0f);
+            velocities_[k].resize(capacity_ + 3, 0.0f);
+            drifts_[k].resize(capacity_ + 3, 0.0f);
+        }
+        min_velocity_[k] = 0.0f;
+        max_velocity_[k] = 0.0f;
+        acceleration_[k] = 0.0f;
+    }
+    if (stateless_) {
+        spawn_times_.resize(capacity_, 0.0f);
+    } else {
+        ages_.resize(capacity_ + 3, 0.0f);
+    }
+    for (int k = 0; k < 4; ++k) {
+        start_color_[k] = 1.0f;
+        end_color_[k] = 1.0f;
+    }
+}
+
+bool ParticleSystem::setMesh(Mesh* mesh) {
+    std::lock_guard<std::mutex> lock(lock_);
+    VertexBuffer* vbuf = mesh->getVertexBuffer();
+    const char* color_name = stateless_ ? "a_velocity" : "a_color";
+    const char* size_name = stateless_ ? "a_spawn" : "a_size";
+    int color_size = stateless_ ? VELOCITY_SIZE : COLOR_SIZE;
+    int size_size = stateless_ ? SPAWN_SIZE : SIZE_SIZE;
+    std::vector<float> zeros(capacity_ * COLOR_SIZE, 0.0f);
+    int index, offset, size;
+
+    if ((vbuf->getAttributeSize("a_position") != POSITION_SIZE) ||
+        (vbuf->getAttributeSize(color_name) != color_size) ||
+        (vbuf->getAttributeSize(size_name) != size_size)) {
+        LOGE("ParticleSystem: mesh layout %s does not have the particle attributes",
+             vbuf->getDescriptor());
+        return false;
+    }
+    if (stateless_) {
+        for (int i = 0; i < capacity_; ++i) {
+            zeros[i * SPAWN_SIZE] = NEVER;
+        }
+    }
+    if (!vbuf->setFloatVec("a_position", zeros.data(), capacity_ * POSITION_SIZE, POSITION_SIZE) ||
+        !vbuf->setFloatVec(color_name, zeros.data(), capacity_ * color_size, color_size) ||
+        !vbuf->setFloatVec(size_name, zeros.data(), capacity_ * size_size, size_size)) {
+        return false;
+    }
+    vbuf->getInfo("a_position", index, offset, size);
+    if (size != POSITION_SIZE * sizeof(float)) {
+        LOGE("ParticleSystem: particle attributes cannot be packed");
+        return false;
+    }
+    position_offset_ = offset / sizeof(float);
+    vbuf->getInfo(color_name, index, offset, size);
+    color_offset_ = offset / sizeof(float);
+    vbuf->getInfo(size_name, index, offset, size);
+    size_offset_ = offset / sizeof(float);
+    mesh_ = mesh;
+    written_ = 0;
+    return true;
+}
+
+void ParticleSystem::setShape(int shape, float width, float height) {
+    std::lock_guard<std::mutex> lock(lock_);
+    shape_ = shape;
+    width_ = width;
+    height_ = height;
+}
+
+void ParticleSystem::setVelocityRange(const float* min_velocity, const float* max_velocity) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (int k = 0; k < 3; ++k) {
+        min_velocity_[k] = min_velocity[k];
+        max_velocity_[k] = max_velocity[k];
+    }
+}
+
+void ParticleSystem::setAcceleration(const float* acceleration) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (int k = 0; k < 3; ++k) {
+        acceleration_[k] = acceleration[k];
+    }
+}
+
+void ParticleSystem::setLifetime(float lifetime) {
+    std::lock_guard<std::mutex> lock(lock_);
+    lifetime_ = std::max(lifetime, 0.0f);
+}
+
+void ParticleSystem::setNoise(float noise) {
+    std::lock_guard<std::mutex> lock(lock_);
+    noise_ = noise;
+}
+
+void ParticleSystem::setSize(float size, float size_rate) {
+    std::lock_guard<std::mutex> lock(lock_);
+    size_ = size;
+    size_rate_ = size_rate;
+}
+
+void ParticleSystem::setColors(const float* start_color, const float* end_color) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (int k = 0; k < 4; ++k) {
+        start_color_[k] = start_color[k];
+        end_color_[k] = end_color[k];
+    }
+}
+
+void ParticleSystem::setBounds(const float* min_corner, const float* max_corner) {
+    std::lock_guard<std::mutex> lock(lock_);
+    applyBounds(min_corner, max_corner);
+}
+
+/*
+ * Lowest or highest offset along one axis over the life of a particle,
+ * starting with a speed v under an acceleration a, at the ends of
+ * the life or where the particle turns back.
+ */
+static float extremeOffset(float v, float a, float lifetime, bool highest) {
+    float end = (v + 0.5f * a * lifetime) * lifetime;
+    float offset = highest ? std::max(0.0f, end) : std::min(0.0f, end);
+
+    if (a != 0.0f) {
+        float t = -v / a;
+
+        if ((t > 0.0f) && (t < lifetime)) {
+            float turn = -0.5f * v * v / a;
+            offset = highest ? std::max(offset, turn) : std::min(offset, turn);
+        }
+    }
+    return offset;
+}
+
+void ParticleSystem::updateBounds() {
+    std::lock_guard<std::mutex> lock(lock_);
+    float min_corner[3];
+    float max_corner[3];
+
+    for (int k = 0; k < 3; ++k) {
+        float lo = std::min(min_velocity_[k], max_velocity_[k]);
+        float hi = std::max(min_velocity_[k], max_velocity_[k]);
+        float extent = 0.0f;
+
+        if (shape_ == PLANE) {
+            extent = 0.5f * ((k == 0) ? width_ : ((k == 2) ? height_ : 0.0f));
+        } else if (shape_ == SPHERE) {
+            // the speed is scaled by a direction between -1 and 1
+            hi = std::max(fabsf(lo), fabsf(hi));
+            lo = -hi;
+            extent = width_;
+        }
+        // the drift adds up to the noise to the speed
+        min_corner[k] = -extent + extremeOffset(lo - noise_, acceleration_[k], lifetime_, false);
+        max_corner[k] = extent + extremeOffset(hi + noise_, acceleration_[k], lifetime_, true);
+    }
+    applyBounds(min_corner, max_corner);
+}
+
+/*
+ * Cull the mesh with the bounds and have the scene object
+ * it is attached to take them into its bounding volume.
+ */
+void ParticleSystem::applyBounds(const float* min_corner, const float* max_corner) {
+    BoundingVolume bv;
+
+    if (mesh_ == nullptr) {
+        LOGE("ParticleSystem: set the mesh before the bounds");
+        return;
+    }
+    bv.expand(glm::vec3(min_corner[0], min_corner[1], min_corner[2]));
+    bv.expand(glm::vec3(max_corner[0], max_corner[1], max_corner[2]));
+    mesh_->setBoundingVolume(bv);
+    if (owner_object()) {
+        owner_object()->dirtyHierarchicalBoundingVolume();
+    }
+}
+
+void ParticleSystem::clear() {
+    std::lock_guard<std::mutex> lock(lock_);
+    head_ = 0;
+    count_ = 0;
+    if (stateless_) {
+        hideStateless();
+    }
+}
+
+// xorshift, uniform in [0, 1)
+float ParticleSystem::random() {
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return (seed_ >> 8) * (1.0f / 16777216.0f);
+}
+
+int ParticleSystem::emit(int count) {
+    std::lock_guard<std::mutex> lock(lock_);
+    int n = std::max(std::min(count, capacity_ - count_), 0);
+    int slot = head_ + count_;
+
+    if (slot >= capacity_) {
+        slot -= capacity_;
+    }
+    if (stateless_) {
+        int run = std::min(n, capacity_ - slot);
+
+        emitStateless(slot, run);
+        emitStateless(0, n - run);
+        count_ += n;
+        return n;
+    }
+    for (int i = 0; i < n; ++i) {
+        emitParticle(slot);
+        if (++slot == capacity_) {
+            slot = 0;
+        }
+    }
+    count_ += n;
+    return n;
+}
+
+/*
+ * Position and velocity of a new particle from the shape.
+ */
+void ParticleSystem::newParticle(float* p, float* v) {
+    p[0] = p[1] = p[2] = 0.0f;
+
+    for (int k = 0; k < 3; ++k) {
+        v[k] = min_velocity_[k] + random() * (max_velocity_[k] - min_velocity_[k]);
+    }
+    if (shape_ == PLANE) {
+        p[0] = (random() - 0.5f) * width_;
+        p[2] = (random() - 0.5f) * height_;
+    } else if (shape_ == SPHERE) {
+        float r2 = width_ * width_;
+        float len2;
+
+        // a point in the cube of the sphere until it is in the sphere
+        do {
+            for (int k = 0; k < 3; ++k) {
+                p[k] = (random() * 2.0f - 1.0f) * width_;
+            }
+            len2 = p[0] * p[0] + p[1] * p[1] + p[2] * p[2];
+        } while (len2 > r2);
+
+        // the speed is along the direction from the center
+        float scale = (len2 > 0.0f) ? (1.0f / sqrtf(len2)) : 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            v[k] *= (len2 > 0.0f) ? p[k] * scale : ((k == 1) ? 1.0f : 0.0f);
+        }
+    }
+}
+
+void ParticleSystem::emitParticle(int slot) {
+    float p[3];
+    float v[3];
+
+    newParticle(p, v);
+    for (int k = 0; k < 3; ++k) {
+        positions_[k][slot] = p[k];
+        velocities_[k][slot] = v[k];
+        drifts_[k][slot] = random() * 2.0f - 1.0f;
+    }
+    ages_[slot] = 0.0f;
+}
+
+/*
+ * Write count stateless particles emitted now to the vertices
+ * from first on. These are the only vertices copied to the GPU.
+ */
+void ParticleSystem::emitStateless(int first, int count) {
+    if ((count <= 0) || (mesh_ == nullptr)) {
+        return;
+    }
+    mesh_->getVertexBuffer()->writeVertices(first, count, [this, first, count](float* vertices, int stride) {
+        for (int i = 0; i < count; ++i, vertices += stride) {
+            float* spawn = vertices + size_offset_;
+
+            newParticle(vertices + position_offset_, vertices + color_offset_);
+            spawn[0] = time_;
+            spawn[1] = random();
+            spawn_times_[first + i] = time_;
+        }
+    });
+    written_ = std::max(written_, first + count);
+}
+
+/*
+ * Give every vertex written so far the spawn time of no particle,
+ * so the time can start again from zero.
+ */
+void ParticleSystem::hideStateless() {
+    if ((mesh_ != nullptr) && (written_ > 0)) {
+        mesh_->getVertexBuffer()->writeVertices(0, written_, [this](float* vertices, int stride) {
+            for (int i = 0; i < written_; ++i) {
+                vertices[i * stride + size_offset_] = NEVER;
+            }
+        });
+    }
+    written_ = 0;
+    time_ = 0.0f;
+}
+
+int ParticleSystem::step(float frame_time) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (stateless_) {
+        return stepStateless(frame_time);
+    }
+    if (frame_time > 0.0f) {
+        time_ += frame_time;
+        // the oldest particles are at the head
+        while ((count_ > 0) && (ages_[head_] + frame_time >= lifetime_)) {
+            if (++head_ == capacity_) {
+                head_ = 0;
+            }
+            --count_;
+        }
+        int end = std::min(head_ + count_, capacity_);
+        integrate(head_, end, frame_time);
+        integrate(0, count_ - (end - head_), frame_time);
+    }
+    writeMesh();
+    return count_;
+}
+
+/*
+ * Move the time and the spawn times of the live stateless
+ * particles back so the oldest one was emitted at time zero.
+ * The vertices of dead particles are hidden, with the earlier
+ * time they would come back to life.
+ */
+void ParticleSystem::rebaseStateless() {
+    float offset = spawn_times_[head_];
+    int end = std::min(head_ + count_, capacity_);
+    int wrapped = count_ - (end - head_);
+
+    for (int i = head_; i < end; ++i) {
+        spawn_times_[i] -= offset;
+    }
+    for (int i = 0; i < wrapped; ++i) {
+        spawn_times_[i] -= offset;
+    }
+    time_ -= offset;
+    if ((mesh_ == nullptr) || (written_ == 0)) {
+        return;
+    }
+    mesh_->getVertexBuffer()->writeVertices(0, written_, [this, end, wrapped](float* vertices, int stride) {
+        for (int i = 0; i < written_; ++i) {
+            bool live = ((i >= head_) && (i < end)) || (i < wrapped);
+
+            vertices[i * stride + size_offset_] = live ? spawn_times_[i] : NEVER;
+        }
+    });
+}
+
+/*
+ * Stateless particles only need the dead ones dropped.
+ * Spawn times are relative to the time the system was
+ * last empty or last rebased, which keeps them precise
+ * even if the system never empties.
+ */
+int ParticleSystem::stepStateless(float frame_time) {
+    if (frame_time > 0.0f) {
+        time_ += frame_time;
+        while ((count_ > 0) && (spawn_times_[head_] + lifetime_ <= time_)) {
+            if (++head_ == capacity_) {
+                head_ = 0;
+            }
+            --count_;
+        }
+    }
+    if (count_ == 0) {
+        head_ = 0;
+        hideStateless();
+    } else if (time_ >= REBASE_TIME + lifetime_) {
+        rebaseStateless();
+    }
+    return count_;
+}
+
+/*
+ * Move and age the particles in [begin, end) of the ring,
+ * four at a time and the rest one by one. The acceleration
+ * is constant so the motion is exact, the same stateless
+ * particles follow.
+ */
+void ParticleSystem::integrate(int begin, int end, float frame_time) {
+    float4 dt = splat4(frame_time);
+    float4 drift = splat4(noise_ * frame_time);
+    float4 dv[3];
+    float4 half_dv[3];
+    int i = begin;
+
+    for (int k = 0; k < 3; ++k) {
+        dv[k] = splat4(acceleration_[k] * frame_time);
+        half_dv[k] = splat4(0.5f * acceleration_[k] * frame_time);
+    }
+    for (; i + 4 <= end; i += 4) {
+        for (int k = 0; k < 3; ++k) {
+            float* v = &velocities_[k][i];
+            float* p = &positions_[k][i];
+            float4 vel = load4(v);
+
+            store4(p, madd4(load4(&drifts_[k][i]), drift, madd4(add4(vel, half_dv[k]), dt, load4(p))));
+            store4(v, add4(vel, dv[k]));
+        }
+        store4(&ages_[i], add4(load4(&ages_[i]), dt));
+    }
+    for (; i < end; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            float& v = velocities_[k][i];
+            float a = acceleration_[k];
+
+            positions_[k][i] += (v + 0.5f * a * frame_time + drifts_[k][i] * noise_) * frame_time;
+            v += a * frame_time;
+        }
+        ages_[i] += frame_time;
+    }
+}
+
+/*
+ * Write the particles in [begin, end) of the ring to consecutive
+ * vertices. Size and color are computed four at a time, the arrays
+ * are padded so reading past the end is safe.
+ */
+void ParticleSystem::writeParticles(float* vertices, int stride, int begin, int end) {
+    float4 size = splat4(size_);
+    float4 size_rate = splat4(size_rate_);
+    float4 zero = splat4(0.0f);
+    float4 one = splat4(1.0f);
+    float4 inv_lifetime = splat4((lifetime_ > 0.0f) ? (1.0f / lifetime_) : 0.0f);
+    float4 start[4];
+    float4 delta[4];
+
+    for (int k = 0; k < 4; ++k) {
+        start[k] = splat4(start_color_[k]);
+        delta[k] = splat4(end_color_[k] - start_color_[k]);
+    }
+    for (int i = begin; i < end; i += 4) {
+        float4 age = load4(&ages_[i]);
+        float4 t = min4(mul4(age, inv_lifetime), one);
+        float sizes[4];
+        float colors[4][4];
+        int n = std::min(end - i, 4);
+
+        store4(sizes, max4(madd4(age, size_rate, size), zero));
+        for (int k = 0; k < 4; ++k) {
+            store4(colors[k], madd4(delta[k], t, start[k]));
+        }
+        for (int j = 0; j < n; ++j, vertices += stride) {
+            float* p = vertices + position_offset_;
+            float* c = vertices + color_offset_;
+
+            p[0] = positions_[0][i + j];
+            p[1] = positions_[1][i + j];
+            p[2] = positions_[2][i + j];
+            c[0] = colors[0][j];
+            c[1] = colors[1][j];
+            c[2] = colors[2][j];
+            c[3] = colors[3][j];
+            vertices[size_offset_] = sizes[j];
+        }
+    }
+}
+
+/*
+ * Write the live particles to the first vertices of the mesh
+ * and hide the vertices of particles which died since the
+ * last step. Only those vertices are copied to the GPU.
+ */
+void ParticleSystem::writeMesh() {
+    int num_verts = std::max(count_, written_);
+
+    if ((mesh_ == nullptr) || (num_verts == 0)) {
+        return;
+    }
+    mesh_->getVertexBuffer()->writeVertices(0, num_verts, [this](float* vertices, int stride) {
+        int end = std::min(head_ + count_, capacity_);
+        int n = end - head_;
+
+        writeParticles(vertices, stride, head_, end);
+        writeParticles(vertices + n * stride, stride, 0, count_ - n);
+        for (int i = count_; i < written_; ++i) {
+            vertices[i * stride + size_offset_] = 0.0f;
+        }
+    });
+    written_ = count_;
+}
+
+}
@@ -0,0 +1,189 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Particles simulated natively and streamed to a point mesh.
+ ***************************************************************************/
+
+#ifndef PARTICLE_SYSTEM_H_
+#define PARTICLE_SYSTEM_H_
+
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+#include "component.h"
+
+namespace gvr {
+class Mesh;
+
+/*
+ * Emits, moves and ages a fixed number of particles and
+ * writes them to the vertices of a point mesh.
+ *
+ * Particles are kept in a ring. All particles live for
+ * the same time, so they die in the order they were
+ * emitted, from the head of the ring, and the live
+ * particles are always one or two runs of the ring.
+ * Nothing is allocated after the mesh is set.
+ *
+ * Simulated particles have one array per field. A step
+ * drops the dead ones at the head, moves the others four
+ * at a time and writes them to the first vertices of the
+ * mesh. Vertices which held particles in the previous
+ * step get a size of zero. The mesh has the layout
+ * "float3 a_position float4 a_color float a_size",
+ * the color and size of a particle change linearly
+ * with its age.
+ *
+ * Stateless particles are not simulated: each vertex of
+ * the ring keeps where, when and how a particle was
+ * emitted and the vertex shader computes the particle
+ * from the time. Only emitted particles are written and
+ * a step only drops the dead ones. The mesh has the layout
+ * "float3 a_position float3 a_velocity float2 a_spawn"
+ * with the spawn time and a random seed in a_spawn.
+ *
+ * The mesh is culled with bounds which either are set
+ * or contain every particle the settings can emit.
+ */
+class ParticleSystem: public Component {
+public:
+    enum Shape {
+        POINT = 0,
+        PLANE = 1,          // width along x, height along z
+        SPHERE = 2          // radius is the width
+    };
+
+    ParticleSystem(int capacity, bool stateless);
+    virtual ~ParticleSystem() { }
+
+    static long long getComponentType() {
+        return COMPONENT_TYPE_PARTICLE_SYSTEM;
+    }
+
+    /*
+     * Set the mesh the particles are written to. Its vertex buffer
+     * gets one vertex per particle.
+     * @returns false if the mesh does not have the particle layout
+     */
+    bool setMesh(Mesh* mesh);
+
+    void setShape(int shape, float width, float height);
+    void setVelocityRange(const float* min_velocity, const float* max_velocity);
+    void setAcceleration(const float* acceleration);
+    void setLifetime(float lifetime);
+
+    /*
+     * Each particle drifts in a random direction at up to this speed.
+     */
+    void setNoise(float noise);
+    void setSize(float size, float size_rate);
+    void setColors(const float* start_color, const float* end_color);
+
+    /*
+     * Bounds of the particles in the coordinates of the mesh,
+     * used to cull the mesh instead of its vertices.
+     */
+    void setBounds(const float* min_corner, const float* max_corner);
+
+    /*
+     * Set the bounds to contain every particle which can be emitted
+     * with the current shape, velocities, acceleration, noise and
+     * lifetime, wherever it is in its life.
+     */
+    void updateBounds();
+
+    /*
+     * Emit a batch of particles from the shape.
+     * @returns number of particles emitted, less than count if the ring is full
+     */
+    int emit(int count);
+
+    /*
+     * Advance the particles by the frame time and write them to the mesh.
+     * @returns number of live particles
+     */
+    int step(float frame_time);
+
+    void clear();
+    int getCapacity() const { return capacity_; }
+    int getParticleCount() const { return count_; }
+    bool isStateless() const { return stateless_; }
+
+    /*
+     * Seconds since the particle system was last empty or rebased,
+     * the time stateless particles are computed at. It is moved
+     * back whenever it gets large, so it is only valid until the
+     * next step.
+     */
+    float getTime() const { return time_; }
+
+private:
+    ParticleSystem(const ParticleSystem& system);
+    ParticleSystem(ParticleSystem&& system);
+    ParticleSystem& operator=(const ParticleSystem& system);
+    ParticleSystem& operator=(ParticleSystem&& system);
+
+    float random();
+    void newParticle(float* position, float* velocity);
+    void emitParticle(int slot);
+    void emitStateless(int first, int count);
+    void hideStateless();
+    void rebaseStateless();
+    int stepStateless(float frame_time);
+    void integrate(int begin, int end, float frame_time);
+    void writeParticles(float* vertices, int stride, int begin, int end);
+    void writeMesh();
+    void applyBounds(const float* min_corner, const float* max_corner);
+
+    std::mutex              lock_;
+    int                     capacity_;
+    bool                    stateless_;
+    int                     head_;              // oldest particle
+    int                     count_;
+    int                     written_;           // vertices written last step
+    float                   time_;
+    Mesh*                   mesh_;
+    int                     position_offset_;   // in floats
+    int                     color_offset_;      // or velocity if stateless
+    int                     size_offset_;       // or spawn time and seed if stateless
+
+    // One array per field, padded to be read four at a time,
+    // only the spawn times if stateless
+    std::vector<float>      positions_[3];
+    std::vector<float>      velocities_[3];
+    std::vector<float>      drifts_[3];
+    std::vector<float>      ages_;
+    std::vector<float>      spawn_times_;
+
+    int                     shape_;
+    float                   width_;
+    float                   height_;
+    float                   min_velocity_[3];
+    float                   max_velocity_[3];
+    float                   acceleration_[3];
+    float                   lifetime_;
+    float                   noise_;
+    float                   size_;
+    float                   size_rate_;
+    float                   start_color_[4];
+    float                   end_color_[4];
+    uint32_t                seed_;
+};
+
+}
+#endif
@@ -0,0 +1,249 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "particle_system.h"
+#include "objects/mesh.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C"
+{
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeParticleSystem_ctor(JNIEnv * env,
+            jobject obj, jint capacity, jboolean stateless);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeParticleSystem_getComponentType(JNIEnv * env,
+            jobject obj);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setMesh(JNIEnv * env,
+            jobject obj, jlong jsystem, jlong jmesh);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setShape(JNIEnv * env,
+            jobject obj, jlong jsystem, jint shape, jfloat width, jfloat height);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setVelocityRange(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloatArray jmin, jfloatArray jmax);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setAcceleration(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloat x, jfloat y, jfloat z);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setLifetime(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloat lifetime);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setNoise(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloat noise);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setSize(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloat size, jfloat size_rate);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setColors(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloatArray jstart, jfloatArray jend);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_setBounds(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloatArray jmin, jfloatArray jmax);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_updateBounds(JNIEnv * env,
+            jobject obj, jlong jsystem);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeParticleSystem_emit(JNIEnv * env,
+            jobject obj, jlong jsystem, jint count);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeParticleSystem_step(JNIEnv * env,
+            jobject obj, jlong jsystem, jfloat frame_time);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeParticleSystem_clear(JNIEnv * env,
+            jobject obj, jlong jsystem);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeParticleSystem_getParticleCount(JNIEnv * env,
+            jobject obj, jlong jsystem);
+
+    JNIEXPORT jfloat JNICALL
+    Java_org_gearvrf_NativeParticleSystem_getTime(JNIEnv * env,
+            jobject obj, jlong jsystem);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeParticleSystem_ctor(JNIEnv * env,
+        jobject obj, jint capacity, jboolean stateless)
+{
+    return reinterpret_cast<jlong>(new ParticleSystem(capacity, stateless));
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeParticleSystem_getComponentType(JNIEnv * env,
+        jobject obj)
+{
+    return ParticleSystem::getComponentType();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeParticleSystem_setMesh(JNIEnv * env,
+        jobject obj, jlong jsystem, jlong jmesh)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    return system->setMesh(mesh);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setShape(JNIEnv * env,
+        jobject obj, jlong jsystem, jint shape, jfloat width, jfloat height)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    system->setShape(shape, width, height);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setVelocityRange(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloatArray jmin, jfloatArray jmax)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    jfloat* min = env->GetFloatArrayElements(jmin, 0);
+    jfloat* max = env->GetFloatArrayElements(jmax, 0);
+
+    system->setVelocityRange(min, max);
+    env->ReleaseFloatArrayElements(jmax, max, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jmin, min, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setAcceleration(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloat x, jfloat y, jfloat z)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    float acceleration[3] = { x, y, z };
+
+    system->setAcceleration(acceleration);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setLifetime(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloat lifetime)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    system->setLifetime(lifetime);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setNoise(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloat noise)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    system->setNoise(noise);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setSize(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloat size, jfloat size_rate)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    system->setSize(size, size_rate);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setColors(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloatArray jstart, jfloatArray jend)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    jfloat* start = env->GetFloatArrayElements(jstart, 0);
+    jfloat* end = env->GetFloatArrayElements(jend, 0);
+
+    system->setColors(start, end);
+    env->ReleaseFloatArrayElements(jend, end, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jstart, start, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_setBounds(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloatArray jmin, jfloatArray jmax)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    jfloat* min = env->GetFloatArrayElements(jmin, 0);
+    jfloat* max = env->GetFloatArrayElements(jmax, 0);
+
+    system->setBounds(min, max);
+    env->ReleaseFloatArrayElements(jmax, max, JNI_ABORT);
+    env->ReleaseFloatArrayElements(jmin, min, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_updateBounds(JNIEnv * env,
+        jobject obj, jlong jsystem)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    system->updateBounds();
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeParticleSystem_emit(JNIEnv * env,
+        jobject obj, jlong jsystem, jint count)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    return system->emit(count);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeParticleSystem_step(JNIEnv * env,
+        jobject obj, jlong jsystem, jfloat frame_time)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    return system->step(frame_time);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeParticleSystem_clear(JNIEnv * env,
+        jobject obj, jlong jsystem)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    system->clear();
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeParticleSystem_getParticleCount(JNIEnv * env,
+        jobject obj, jlong jsystem)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    return system->getParticleCount();
+}
+
+JNIEXPORT jfloat JNICALL
+Java_org_gearvrf_NativeParticleSystem_getTime(JNIEnv * env,
+        jobject obj, jlong jsystem)
+{
+    ParticleSystem* system = reinterpret_cast<ParticleSystem*>(jsystem);
+    return system->getTime();
+}
+
+}
@@ -18,6 +18,7 @@
 
 #include "util/jni_utils.h"
 #include "objects/scene.h"
+#include "objects/components/collider.h"
 #include "shaders/shader.h"
 
 namespace gvr {
@@ -54,6 +55,15 @@ void RenderData::set_mesh(Mesh* mesh)
     {
         mesh_ = mesh;
         markDirty();
+        if (owner_object())
+        {
+            Collider* collider = static_cast<Collider*>(owner_object()->getComponent(Collider::getComponentType()));
+            if (collider)
+            {
+                collider->markBoundsDirty();
+            }
+            owner_object()->dirtyHierarchicalBoundingVolume();
+        }
     }
 }
 
@@ -308,19 +318,10 @@ bool RenderData::updateGPU(Renderer* renderer, Shader* shader)
     if (mesh_->hasBones() && shader->hasBones())
     {
         VertexBoneData& vbd = mesh_->getVertexBoneData();
-        std::vector<glm::mat4>& bone_matrices = vbd.getBoneMatrices();
-        int numBones = bone_matrices.size();
 
-        if (numBones > 0)
+        if (vbd.getNumBones() > 0)
         {
-            if (bones_ubo_ == NULL)
-            {
-                bones_ubo_ = renderer->createUniformBlock("mat4 u_bone_matrix", BONES_UBO_INDEX,
-                                                          "Bones_ubo", MAX_BONES);
-                bones_ubo_->setNumElems(numBones);
-            }
-            bones_ubo_->setRange(0, bone_matrices.data(), numBones);
-            bones_ubo_->updateGPU(renderer);
+            bones_ubo_ = vbd.updatePalette(renderer);
         }
     }
     vbuf->updateGPU(renderer, mesh_->getIndexBuffer(), shader);
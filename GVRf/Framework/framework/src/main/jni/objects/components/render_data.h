@@ -79,7 +79,7 @@ public:
             sample_coverage_(1.0f), invert_coverage_mask_(GL_FALSE),
             source_alpha_blend_func_(GL_ONE), dest_alpha_blend_func_(GL_ONE_MINUS_SRC_ALPHA),
             draw_mode_(GL_TRIANGLES), texture_capturer(0), cast_shadows_(true),
-            bones_ubo_(nullptr),dirty_(false)
+            bones_ubo_(nullptr),dirty_(false), lod_level_(-1)
     {
     }
 
@@ -143,6 +143,18 @@ public:
     virtual bool updateGPU(Renderer*,Shader*);
     void set_mesh(Mesh* mesh);
 
+    /*
+     * Level of detail selected for this render data by the
+     * nearest LODGroup during culling, -1 if there is none.
+     */
+    int lod_level() const {
+        return lod_level_;
+    }
+
+    void set_lod_level(int level) {
+        lod_level_ = level;
+    }
+
     void add_pass(RenderPass* render_pass);
     void remove_pass(int pass);
     RenderPass* pass(int pass);
@@ -428,6 +440,7 @@ protected:
     GLboolean invert_coverage_mask_;
     GLenum draw_mode_;
     float camera_distance_;
+    int lod_level_;
     TextureCapturer *texture_capturer;
     std::function<float()> cameraDistanceLambda_ = nullptr;
 
@@ -0,0 +1,392 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Joint hierarchy for skeletal animation.
+ ***************************************************************************/
+
+#include <algorithm>
+
+#include "glm/gtc/type_ptr.hpp"
+
+#include "skeleton.h"
+#include "objects/mesh.h"
+#include "objects/scene_object.h"
+#include "objects/vertex_buffer.h"
+#include "util/gvr_log.h"
+#include "util/gvr_simd.h"
+
+namespace gvr {
+
+/*
+ * Same as translate * rotate * scale without the matrix products.
+ */
+static inline glm::mat4 composeMatrix(const glm::vec3& position, const glm::quat& rotation,
+                                      const glm::vec3& scale) {
+    glm::mat4 m = glm::mat4_cast(rotation);
+
+    m[0] *= scale.x;
+    m[1] *= scale.y;
+    m[2] *= scale.z;
+    m[3] = glm::vec4(position, 1);
+    return m;
+}
+
+Skeleton::Skeleton() :
+        Component(Skeleton::getComponentType()) {
+}
+
+int Skeleton::addJoint(const char* name, int parent, SceneObject* node, bool update_node) {
+    std::lock_guard<std::mutex> lock(lock_);
+    int index = parents_.size();
+    glm::vec3 position(0, 0, 0);
+    glm::quat rotation;
+    glm::vec3 scale(1, 1, 1);
+
+    if ((parent < -1) || (parent >= index)) {
+        LOGE("Skeleton::addJoint joint %s must come after its parent %d", name, parent);
+        return -1;
+    }
+    if (node && node->transform()) {
+        node->transform()->getPose(position, rotation, scale);
+    }
+    names_.push_back(name ? name : "");
+    parents_.push_back(parent);
+    nodes_.push_back(node);
+    update_nodes_.push_back(update_node && node);
+    pose_.resize(index + 1);
+    pose_.positions[index] = position;
+    pose_.rotations[index] = rotation;
+    pose_.scales[index] = scale;
+    rest_pose_.resize(index + 1);
+    rest_pose_.positions[index] = position;
+    rest_pose_.rotations[index] = rotation;
+    rest_pose_.scales[index] = scale;
+    global_matrices_.push_back(glm::mat4());
+    return index;
+}
+
+int Skeleton::findJoint(const std::string& name) const {
+    auto it = std::find(names_.begin(), names_.end(), name);
+    return (it == names_.end()) ? -1 : (it - names_.begin());
+}
+
+bool Skeleton::readOffsets(Mesh* mesh, Skin& skin) {
+    VertexBoneData& bone_data = mesh->getVertexBoneData();
+    int num_bones = skin.joints.size();
+
+    if (bone_data.getNumBones() != num_bones) {
+        return false;
+    }
+    skin.offsets.resize(num_bones);
+    for (int i = 0; i < num_bones; ++i) {
+        skin.offsets[i] = bone_data.getBone(i)->getOffsetMatrix();
+    }
+    skin.mesh = mesh;
+    return true;
+}
+
+bool Skeleton::addSkin(SceneObject* owner, const int* bone_joints, int num_bones) {
+    std::lock_guard<std::mutex> lock(lock_);
+    RenderData* rdata = owner->render_data();
+    Mesh* mesh = rdata ? rdata->mesh() : nullptr;
+    Skin skin;
+
+    if (mesh == nullptr) {
+        return false;
+    }
+    skin.owner = owner;
+    skin.mesh = nullptr;
+    skin.skinned = nullptr;
+    skin.joints.assign(bone_joints, bone_joints + num_bones);
+    for (auto it = skin.joints.begin(); it != skin.joints.end(); ++it) {
+        if (*it >= (int) parents_.size()) {
+            *it = -1;
+        }
+    }
+    if (!readOffsets(mesh, skin)) {
+        LOGE("Skeleton::addSkin mesh of %s does not have %d bones",
+             owner->name().c_str(), num_bones);
+        return false;
+    }
+    skins_.push_back(std::move(skin));
+    return true;
+}
+
+bool Skeleton::setPreSkinned(SceneObject* owner, Mesh* skinned) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = std::find_if(skins_.begin(), skins_.end(),
+                           [owner](const Skin& skin) { return skin.owner == owner; });
+
+    if (it == skins_.end()) {
+        LOGE("Skeleton::setPreSkinned %s is not skinned", owner->name().c_str());
+        return false;
+    }
+    Skin& skin = *it;
+    if (skinned == nullptr) {
+        skin.skinned = nullptr;
+        std::vector<float>().swap(skin.positions);
+        std::vector<float>().swap(skin.normals);
+        std::vector<float>().swap(skin.weights);
+        std::vector<int>().swap(skin.indices);
+        std::vector<float>().swap(skin.skinned_positions);
+        std::vector<float>().swap(skin.skinned_normals);
+        return true;
+    }
+    RenderData* rdata = owner->render_data();
+    Mesh* mesh = rdata ? rdata->mesh() : nullptr;
+
+    if ((skin.skinned == nullptr) && (mesh != nullptr) && (mesh != skin.mesh) &&
+        !readOffsets(mesh, skin)) {
+        return false;
+    }
+    if ((skinned->getVertexCount() != skin.mesh->getVertexCount()) || !readVertices(skin)) {
+        LOGE("Skeleton::setPreSkinned mesh of %s cannot be skinned into a mesh of %d vertices",
+             owner->name().c_str(), skinned->getVertexCount());
+        return false;
+    }
+    copyAttributes(*skin.mesh->getVertexBuffer(), *skinned->getVertexBuffer());
+    skin.skinned = skinned;
+    skinVertices(skin, skin.mesh->getVertexBoneData().getBoneMatrices());
+    return true;
+}
+
+void Skeleton::animate(AnimationClip& clip, float time) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    std::fill(pose_.posed.begin(), pose_.posed.end(), false);
+    clip.sample(time, pose_);
+    updatePose();
+}
+
+void Skeleton::setPose(const LocalPose& pose) {
+    std::lock_guard<std::mutex> lock(lock_);
+    int num_joints = std::min(pose.size(), pose_.size());
+
+    std::fill(pose_.posed.begin(), pose_.posed.end(), false);
+    for (int j = 0; j < num_joints; ++j) {
+        if (pose.posed[j]) {
+            pose_.positions[j] = pose.positions[j];
+            pose_.rotations[j] = pose.rotations[j];
+            pose_.scales[j] = pose.scales[j];
+            pose_.posed[j] = true;
+        }
+    }
+    updatePose();
+}
+
+/*
+ * Fill in the joints which are not posed from their nodes,
+ * write the posed ones back and update the skins.
+ */
+void Skeleton::updatePose() {
+    int num_joints = parents_.size();
+
+    for (int j = 0; j < num_joints; ++j) {
+        if (!pose_.posed[j] && nodes_[j] && nodes_[j]->transform()) {
+            nodes_[j]->transform()->getPose(pose_.positions[j], pose_.rotations[j],
+                                            pose_.scales[j]);
+        }
+    }
+    updateGlobalMatrices();
+    for (int j = 0; j < num_joints; ++j) {
+        if (pose_.posed[j] && update_nodes_[j] && nodes_[j]->transform()) {
+            nodes_[j]->transform()->setPose(pose_.positions[j], pose_.rotations[j],
+                                            pose_.scales[j]);
+        }
+    }
+    for (auto it = skins_.begin(); it != skins_.end(); ++it) {
+        updateSkin(*it);
+    }
+}
+
+/*
+ * Parents come before their children so a single pass
+ * over the joints computes all the global matrices.
+ * Roots are placed under the parent of their node so
+ * they are in the same space as the skinned meshes.
+ */
+void Skeleton::updateGlobalMatrices() {
+    int num_joints = parents_.size();
+
+    for (int j = 0; j < num_joints; ++j) {
+        glm::mat4 local = composeMatrix(pose_.positions[j], pose_.rotations[j], pose_.scales[j]);
+        int parent = parents_[j];
+
+        if (parent >= 0) {
+            global_matrices_[j] = global_matrices_[parent] * local;
+            continue;
+        }
+        SceneObject* parent_node = nodes_[j] ? nodes_[j]->parent() : nullptr;
+        if (parent_node && parent_node->transform()) {
+            global_matrices_[j] = parent_node->transform()->getModelMatrix() * local;
+        } else {
+            global_matrices_[j] = local;
+        }
+    }
+}
+
+void Skeleton::updateSkin(Skin& skin) {
+    RenderData* rdata = skin.owner->render_data();
+    Mesh* mesh = skin.skinned ? skin.mesh : (rdata ? rdata->mesh() : nullptr);
+
+    if ((mesh == nullptr) || (skin.owner->transform() == nullptr)) {
+        return;
+    }
+    if ((mesh != skin.mesh) && !readOffsets(mesh, skin)) {
+        return;
+    }
+    std::vector<glm::mat4>& bone_matrices = mesh->getVertexBoneData().getBoneMatrices();
+    glm::mat4 mesh_inverse = glm::inverse(skin.owner->transform()->getModelMatrix());
+    int num_bones = skin.joints.size();
+
+    for (int b = 0; b < num_bones; ++b) {
+        int j = skin.joints[b];
+
+        if (j >= 0) {
+            bone_matrices[b] = mesh_inverse * global_matrices_[j] * skin.offsets[b];
+        }
+    }
+    // the app may have given the render data another mesh
+    if (skin.skinned && rdata && (rdata->mesh() == skin.skinned)) {
+        skinVertices(skin, bone_matrices);
+    }
+}
+
+/*
+ * Read the vertices of the skinned mesh once as floats
+ * so packed attributes are not expanded every frame.
+ */
+bool Skeleton::readVertices(Skin& skin) {
+    const VertexBuffer* vbuf = skin.mesh->getVertexBuffer();
+    int num_verts = vbuf->getVertexCount();
+
+    if (!vbuf->isSet("a_position") || !vbuf->isSet("a_bone_weights") ||
+        !vbuf->isSet("a_bone_indices")) {
+        return false;
+    }
+    skin.positions.assign(num_verts * 3, 0.0f);
+    skin.weights.assign(num_verts * BONES_PER_VERTEX, 0.0f);
+    skin.indices.assign(num_verts * BONES_PER_VERTEX, -1);
+    if (!vbuf->getFloatVec("a_position", skin.positions.data(), skin.positions.size(), 3) ||
+        !vbuf->getFloatVec("a_bone_weights", skin.weights.data(), skin.weights.size(),
+                           BONES_PER_VERTEX) ||
+        !vbuf->getIntVec("a_bone_indices", skin.indices.data(), skin.indices.size(),
+                         BONES_PER_VERTEX)) {
+        return false;
+    }
+    skin.normals.clear();
+    if (vbuf->isSet("a_normal")) {
+        skin.normals.assign(num_verts * 3, 0.0f);
+        if (!vbuf->getFloatVec("a_normal", skin.normals.data(), skin.normals.size(), 3)) {
+            skin.normals.clear();
+        }
+    }
+    skin.skinned_positions.resize(skin.positions.size());
+    skin.skinned_normals.resize(skin.normals.size());
+    return true;
+}
+
+/*
+ * Copy the attributes the two vertex buffers have in common.
+ */
+void Skeleton::copyAttributes(const VertexBuffer& src, VertexBuffer& dst) {
+    int num_verts = src.getVertexCount();
+    std::vector<float> floats;
+    std::vector<int> ints;
+
+    dst.forEachEntry([&](const DataDescriptor::DataEntry& e) {
+        int size = src.getAttributeSize(e.Name);
+
+        if (!src.isSet(e.Name) || (size != dst.getAttributeSize(e.Name))) {
+            return;
+        }
+        if (e.IsInt) {
+            ints.resize(num_verts * size);
+            if (src.getIntVec(e.Name, ints.data(), ints.size(), size)) {
+                dst.setIntVec(e.Name, ints.data(), ints.size(), size);
+            }
+        } else {
+            floats.resize(num_verts * size);
+            if (src.getFloatVec(e.Name, floats.data(), floats.size(), size)) {
+                dst.setFloatVec(e.Name, floats.data(), floats.size(), size);
+            }
+        }
+    });
+}
+
+/*
+ * Blend the columns of the bone matrices of each vertex,
+ * four floats at a time, and transform its position and
+ * normal with the blended matrix like the skinning shader.
+ */
+void Skeleton::skinVertices(Skin& skin, const std::vector<glm::mat4>& bone_matrices) {
+    VertexBuffer* vbuf = skin.skinned->getVertexBuffer();
+    int num_verts = skin.positions.size() / 3;
+    int num_bones = bone_matrices.size();
+    bool has_normals = !skin.normals.empty();
+    float out[4];
+
+    for (int v = 0; v < num_verts; ++v) {
+        const float* weights = &skin.weights[v * BONES_PER_VERTEX];
+        const int* indices = &skin.indices[v * BONES_PER_VERTEX];
+        float4 c0 = splat4(0.0f);
+        float4 c1 = c0;
+        float4 c2 = c0;
+        float4 c3 = c0;
+
+        for (int i = 0; i < BONES_PER_VERTEX; ++i) {
+            int b = indices[i];
+
+            if ((weights[i] == 0.0f) || (b < 0) || (b >= num_bones)) {
+                continue;
+            }
+            const float* m = glm::value_ptr(bone_matrices[b]);
+            float4 w = splat4(weights[i]);
+
+            c0 = madd4(load4(m), w, c0);
+            c1 = madd4(load4(m + 4), w, c1);
+            c2 = madd4(load4(m + 8), w, c2);
+            c3 = madd4(load4(m + 12), w, c3);
+        }
+
+        const float* p = &skin.positions[v * 3];
+        float* dst = &skin.skinned_positions[v * 3];
+
+        store4(out, madd4(c0, splat4(p[0]), madd4(c1, splat4(p[1]), madd4(c2, splat4(p[2]), c3))));
+        dst[0] = out[0];
+        dst[1] = out[1];
+        dst[2] = out[2];
+        if (!has_normals) {
+            continue;
+        }
+        const float* n = &skin.normals[v * 3];
+        float* ndst = &skin.skinned_normals[v * 3];
+
+        store4(out, madd4(c0, splat4(n[0]), madd4(c1, splat4(n[1]), mul4(c2, splat4(n[2])))));
+        float len = sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+        float scale = (len > 0.0f) ? (1.0f / len) : 0.0f;
+        ndst[0] = out[0] * scale;
+        ndst[1] = out[1] * scale;
+        ndst[2] = out[2] * scale;
+    }
+    vbuf->setFloatVec("a_position", skin.skinned_positions.data(), skin.skinned_positions.size(), 3);
+    if (has_normals && (vbuf->getAttributeSize("a_normal") > 0)) {
+        vbuf->setFloatVec("a_normal", skin.skinned_normals.data(), skin.skinned_normals.size(), 3);
+    }
+}
+
+}
@@ -0,0 +1,163 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Joint hierarchy for skeletal animation.
+ ***************************************************************************/
+
+#ifndef SKELETON_H_
+#define SKELETON_H_
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "component.h"
+#include "objects/animation_clip.h"
+
+namespace gvr {
+class Mesh;
+class SceneObject;
+class VertexBuffer;
+
+/*
+ * Poses the joints of an animated hierarchy and computes
+ * the bone matrices of the meshes skinned to it.
+ *
+ * The joints are kept in a flat array where each parent
+ * comes before its children, so the global matrices are
+ * computed in one pass over the array. Each joint may
+ * refer to the scene object it was built from. Joints
+ * which are not animated take their pose from it and
+ * animated joints can write their pose back to it.
+ *
+ * A skin maps the bones of a mesh to joints. The bone
+ * matrices are written straight into the VertexBoneData
+ * of the mesh which the renderer uploads.
+ *
+ * A skin may instead be pre-skinned: its vertices are
+ * skinned on the CPU once per pose into a mesh without
+ * bones which the render data draws. Every render pass,
+ * shadow map and eye then draws static geometry instead
+ * of skinning the vertices again in its shader.
+ */
+class Skeleton: public Component {
+public:
+    Skeleton();
+    virtual ~Skeleton() { }
+
+    static long long getComponentType() {
+        return COMPONENT_TYPE_SKELETON;
+    }
+
+    /*
+     * Add a joint after its parent.
+     * @param name          name used to match animation channels and bones
+     * @param parent        index of the parent joint, -1 for a root
+     * @param node          scene object for the joint, may be null
+     * @param update_node   true to copy the animated pose to the node
+     * @returns index of the joint or -1 if the parent is invalid
+     */
+    int addJoint(const char* name, int parent, SceneObject* node, bool update_node);
+
+    /*
+     * Skin the mesh of a scene object.
+     * @param owner         scene object with the skinned mesh
+     * @param bone_joints   joint for each bone of the mesh, -1 if none
+     * @param num_bones     must be the number of bones in the mesh
+     * @returns false if the mesh has a different number of bones
+     */
+    bool addSkin(SceneObject* owner, const int* bone_joints, int num_bones);
+
+    /*
+     * Skin the mesh of a skin on the CPU into another mesh.
+     * The skinned mesh has the attributes of the skinned one
+     * without the bone weights and indices. Its positions and
+     * normals are written every time the skeleton is posed,
+     * the other attributes are copied once.
+     * @param owner         scene object of a skin of this skeleton
+     * @param skinned       mesh to skin into, null to skin in the shaders again
+     * @returns false if owner is not skinned or the meshes do not match
+     */
+    bool setPreSkinned(SceneObject* owner, Mesh* skinned);
+
+    int getJointCount() const { return parents_.size(); }
+    int findJoint(const std::string& name) const;
+
+    /*
+     * Pose the skeleton with a clip bound to it and
+     * update the bone matrices of all the skins.
+     */
+    void animate(AnimationClip& clip, float time);
+
+    /*
+     * Pose the skeleton with the posed joints of a pose computed
+     * elsewhere, by a blend tree for instance, and update the
+     * bone matrices of all the skins.
+     */
+    void setPose(const LocalPose& pose);
+
+    /*
+     * Pose of the joints taken from their nodes when they were added.
+     */
+    const LocalPose& getRestPose() const { return rest_pose_; }
+
+    const glm::mat4& getGlobalMatrix(int joint) const { return global_matrices_[joint]; }
+
+private:
+    struct Skin {
+        SceneObject*            owner;
+        Mesh*                   mesh;       // mesh the offsets were read from
+        std::vector<int>        joints;
+        std::vector<glm::mat4>  offsets;
+        Mesh*                   skinned;    // mesh skinned on the CPU or null
+        std::vector<float>      positions;  // vertices of the mesh as floats
+        std::vector<float>      normals;
+        std::vector<float>      weights;
+        std::vector<int>        indices;
+        std::vector<float>      skinned_positions;
+        std::vector<float>      skinned_normals;
+    };
+
+    Skeleton(const Skeleton& skeleton);
+    Skeleton(Skeleton&& skeleton);
+    Skeleton& operator=(const Skeleton& skeleton);
+    Skeleton& operator=(Skeleton&& skeleton);
+
+    static bool readOffsets(Mesh* mesh, Skin& skin);
+    static bool readVertices(Skin& skin);
+    static void copyAttributes(const VertexBuffer& src, VertexBuffer& dst);
+    static void skinVertices(Skin& skin, const std::vector<glm::mat4>& bone_matrices);
+    void updatePose();
+    void updateGlobalMatrices();
+    void updateSkin(Skin& skin);
+
+    std::mutex                  lock_;
+    std::vector<std::string>    names_;
+    std::vector<int>            parents_;
+    std::vector<SceneObject*>   nodes_;
+    std::vector<char>           update_nodes_;
+    LocalPose                   pose_;
+    LocalPose                   rest_pose_;
+    std::vector<glm::mat4>      global_matrices_;
+    std::vector<Skin>           skins_;
+};
+
+}
+#endif
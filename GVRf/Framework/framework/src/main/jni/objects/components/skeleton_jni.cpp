@@ -0,0 +1,115 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "skeleton.h"
+#include "objects/animation_clip.h"
+#include "objects/mesh.h"
+#include "objects/scene_object.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C"
+{
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeSkeleton_ctor(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeSkeleton_getComponentType(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeSkeleton_addJoint(JNIEnv * env,
+            jobject obj, jlong jskeleton, jstring jname, jint parent,
+            jlong jscene_object, jboolean update_node);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeSkeleton_addSkin(JNIEnv * env,
+            jobject obj, jlong jskeleton, jlong jscene_object, jintArray jbone_joints);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeSkeleton_setPreSkinned(JNIEnv * env,
+            jobject obj, jlong jskeleton, jlong jscene_object, jlong jmesh);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeSkeleton_animate(JNIEnv * env,
+            jobject obj, jlong jskeleton, jlong jclip, jfloat time);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeSkeleton_ctor(JNIEnv * env, jobject obj)
+{
+    return reinterpret_cast<jlong>(new Skeleton());
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeSkeleton_getComponentType(JNIEnv * env, jobject obj)
+{
+    return Skeleton::getComponentType();
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeSkeleton_addJoint(JNIEnv * env,
+        jobject obj, jlong jskeleton, jstring jname, jint parent,
+        jlong jscene_object, jboolean update_node)
+{
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    const char* name = jname ? env->GetStringUTFChars(jname, 0) : nullptr;
+    int joint = skeleton->addJoint(name, parent, scene_object, update_node);
+
+    if (name)
+    {
+        env->ReleaseStringUTFChars(jname, name);
+    }
+    return joint;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeSkeleton_addSkin(JNIEnv * env,
+        jobject obj, jlong jskeleton, jlong jscene_object, jintArray jbone_joints)
+{
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    jint* bone_joints = env->GetIntArrayElements(jbone_joints, 0);
+    bool added = skeleton->addSkin(scene_object, bone_joints, env->GetArrayLength(jbone_joints));
+
+    env->ReleaseIntArrayElements(jbone_joints, bone_joints, JNI_ABORT);
+    return added;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeSkeleton_setPreSkinned(JNIEnv * env,
+        jobject obj, jlong jskeleton, jlong jscene_object, jlong jmesh)
+{
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    return skeleton->setPreSkinned(scene_object, mesh);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSkeleton_animate(JNIEnv * env,
+        jobject obj, jlong jskeleton, jlong jclip, jfloat time)
+{
+    Skeleton* skeleton = reinterpret_cast<Skeleton*>(jskeleton);
+    AnimationClip* clip = reinterpret_cast<AnimationClip*>(jclip);
+    skeleton->animate(*clip, time);
+}
+
+}
@@ -83,6 +83,66 @@ ColliderData SphereCollider::isHit(const glm::vec3& rayStart, const glm::vec3& r
     return data;
 }
 
+/*
+ * Compute the world bounds of the sphere.
+ * The center and radius are determined the same way as
+ * when the sphere is hit tested.
+ */
+bool SphereCollider::getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner)
+{
+    glm::vec3    sphCenter(0, 0, 0);
+    float        radius = radius_;
+    SceneObject* owner = owner_object();
+
+    if ((owner == NULL) || (owner->transform() == NULL))
+    {
+        return false;
+    }
+    RenderData* rd = owner->render_data();
+    if ((rd != NULL) && (rd->mesh() != NULL))
+    {
+        const BoundingVolume& meshbv = rd->mesh()->getBoundingVolume();
+        sphCenter = meshbv.center();
+        if (radius <= 0)
+        {
+            radius = meshbv.radius();
+        }
+    }
+    if (radius <= 0)
+    {
+        radius = 1;
+    }
+    transformBounds(owner->transform()->getModelMatrix(),
+                    sphCenter - glm::vec3(radius), sphCenter + glm::vec3(radius),
+                    minCorner, maxCorner);
+    return true;
+}
+
+/*
+ * The center, and the radius if it is not set, come from the
+ * bounds of the owner's mesh, whose vertices may be written
+ * without the collider knowing.
+ */
+bool SphereCollider::geometryChanged()
+{
+    SceneObject* owner = owner_object();
+    RenderData* rd = (owner != NULL) ? owner->render_data() : NULL;
+    Mesh* mesh = (rd != NULL) ? rd->mesh() : NULL;
+    unsigned int count = 0;
+
+    if ((mesh != NULL) && (mesh->getVertexBuffer() != NULL))
+    {
+        count = mesh->getVertexBuffer()->getChangeCount();
+    }
+    if ((mesh == bounds_mesh_) && (count == bounds_change_count_))
+    {
+        return false;
+    }
+    bounds_mesh_ = mesh;
+    bounds_change_count_ = count;
+    return true;
+}
+
 /*
  * Determine if the ray hits the collider.
  * @param model_matrix  matrix to transform model to world coordinates
@@ -32,7 +32,9 @@ public:
     SphereCollider() :
         Collider(),
         center_(0, 0, 0),
-        radius_(0) { }
+        radius_(0),
+        bounds_mesh_(NULL),
+        bounds_change_count_(0) { }
 
     ~SphereCollider() { }
 
@@ -43,6 +45,7 @@ public:
     void set_radius(float r)
     {
         radius_ = r;
+        markBoundsDirty();
     }
 
     float get_radius()
@@ -51,6 +54,8 @@ public:
     }
 
     ColliderData isHit(const glm::vec3& rayStart, const glm::vec3& rayDir);
+    bool getWorldBounds(glm::vec3& minCorner, glm::vec3& maxCorner);
+    bool geometryChanged();
     static ColliderData isHit(Mesh& mesh, const glm::mat4& model_matrix, const glm::vec3& rayStart, const glm::vec3& rayDir);
     static ColliderData isHit(const glm::mat4& model_matrix, const glm::vec3& center, float radius, const glm::vec3& rayStart, const glm::vec3& rayDir);
 
@@ -63,6 +68,8 @@ private:
 private:
     glm::vec3   center_;
     float       radius_;
+    Mesh*       bounds_mesh_;           // mesh when geometryChanged was last called
+    unsigned int bounds_change_count_;  // and the change count of its vertices
 };
 }
 #endif
@@ -71,6 +71,40 @@ void Transform::invalidate(bool rotationUpdated)
     }
 }
 
+void Transform::setPose(const glm::vec3& position, const glm::quat& rotation)
+{
+    SceneObject* owner = owner_object();
+
+    mutex_.lock();
+    position_ = position;
+    rotation_ = rotation;
+    model_matrix_.invalidate();
+    mutex_.unlock();
+    if (owner)
+    {
+        owner->onTransformChanged();
+        owner->dirtyHierarchicalBoundingVolume();
+    }
+}
+
+void Transform::setPose(const glm::vec3& position, const glm::quat& rotation,
+                        const glm::vec3& scale)
+{
+    SceneObject* owner = owner_object();
+
+    mutex_.lock();
+    position_ = position;
+    rotation_ = rotation;
+    scale_ = scale;
+    model_matrix_.invalidate();
+    mutex_.unlock();
+    if (owner)
+    {
+        owner->onTransformChanged();
+        owner->dirtyHierarchicalBoundingVolume();
+    }
+}
+
 glm::mat4 Transform::getModelMatrix(bool forceRecalculate) {
     if (!isModelMatrixValid() || forceRecalculate) {
         mutex_.lock();
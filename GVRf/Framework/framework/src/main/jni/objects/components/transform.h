@@ -164,6 +164,31 @@ public:
         invalidate(true);
     }
 
+    void getPose(glm::vec3& position, glm::quat& rotation) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        position = position_;
+        rotation = rotation_;
+    }
+
+    /*
+     * Set the position and a normalized rotation together.
+     * The owner is only notified of the change once.
+     */
+    void setPose(const glm::vec3& position, const glm::quat& rotation);
+
+    void getPose(glm::vec3& position, glm::quat& rotation, glm::vec3& scale) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        position = position_;
+        rotation = rotation_;
+        scale = scale_;
+    }
+
+    /*
+     * Set the position, rotation and scale together.
+     * The owner is only notified of the change once.
+     */
+    void setPose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
     const glm::vec3& scale() const {
         return scale_;
     }
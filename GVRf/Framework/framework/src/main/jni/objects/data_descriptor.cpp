@@ -12,6 +12,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
 #include <istream>
@@ -22,6 +24,69 @@
 
 namespace gvr
 {
+    /*
+     * Packed vertex types, each is followed by the number of
+     * components except for octahedral unit vectors.
+     */
+    struct PackedType
+    {
+        const char* Prefix;
+        char        ComponentSize;
+        bool        IsInt;
+        bool        IsNormalized;
+        bool        IsUnsigned;
+        bool        IsOctahedral;
+    };
+
+    static const PackedType sPackedTypes[] =
+    {
+        { "half",       2, false, false, false, false },
+        { "snorm8x",    1, false, true,  false, false },
+        { "snorm16x",   2, false, true,  false, false },
+        { "unorm8x",    1, false, true,  true,  false },
+        { "unorm16x",   2, false, true,  true,  false },
+        { "int8x",      1, true,  false, false, false },
+        { "uint8x",     1, true,  false, true,  false },
+        { "int16x",     2, true,  false, false, false },
+        { "uint16x",    2, true,  false, true,  false },
+        { "octnorm8",   1, false, true,  false, true },
+        { "octnorm16",  2, false, true,  false, true },
+    };
+
+    /*
+     * Find the packed type which matches the type name.
+     * @param type  type name from the descriptor
+     * @param count gets the number of components stored
+     * @return packed type or null if not a packed type
+     */
+    static const PackedType* findPackedType(const char* type, int& count)
+    {
+        for (const PackedType& p : sPackedTypes)
+        {
+            size_t n = strlen(p.Prefix);
+
+            if (strncmp(type, p.Prefix, n) != 0)
+            {
+                continue;
+            }
+            if (p.IsOctahedral)
+            {
+                if (type[n] != 0)
+                {
+                    continue;
+                }
+                count = 2;
+                return &p;
+            }
+            if (!std::isdigit(type[n]))
+            {
+                continue;
+            }
+            count = atoi(type + n);
+            return &p;
+        }
+        return nullptr;
+    }
 
     DataDescriptor::DataDescriptor(const char* descriptor) :
             mTotalSize(0),
@@ -175,6 +240,23 @@ namespace gvr
                     entry.NotUsed = false;
                     entry.IsInt =  strstr(type,"int") != nullptr;
                     entry.IsMatrix = type[0] == 'm';
+                    entry.IsNormalized = false;
+                    entry.IsUnsigned = false;
+                    entry.IsOctahedral = false;
+                    entry.ComponentSize = sizeof(float);
+                    entry.ComponentCount = byteSize / (array_size * sizeof(float));
+
+                    int ncomps;
+                    const PackedType* packed = findPackedType(type, ncomps);
+                    if (packed)
+                    {
+                        entry.IsInt = packed->IsInt;
+                        entry.IsNormalized = packed->IsNormalized;
+                        entry.IsUnsigned = packed->IsUnsigned;
+                        entry.IsOctahedral = packed->IsOctahedral;
+                        entry.ComponentSize = packed->ComponentSize;
+                        entry.ComponentCount = ncomps;
+                    }
                     entry.Index = index++;
                     entry.Offset = mTotalSize;
                     entry.Size = byteSize;
@@ -193,8 +275,21 @@ namespace gvr
     std::string DataDescriptor::makeShaderType(const char* type, int byteSize)
     {
         std::ostringstream stream;
+        int ncomps;
+        const PackedType* packed = findPackedType(type, ncomps);
 
-        if ((byteSize > 4) && (byteSize <= 16))
+        if (packed)
+        {
+            if (ncomps > 1)
+            {
+                stream << (packed->IsInt ? "ivec" : "vec") << ncomps;
+            }
+            else
+            {
+                stream << (packed->IsInt ? "int" : "float");
+            }
+        }
+        else if ((byteSize > 4) && (byteSize <= 16))
         {
             if (type[0] == 'f')
             {
@@ -220,8 +315,14 @@ namespace gvr
     {
         int size = 1;
         int n = strlen(type);
+        const PackedType* packed = findPackedType(type, size);
 
-        if (strncmp(type, "float", 5) == 0)
+        if (packed)
+        {
+            size *= packed->ComponentSize;
+            return (size + 3) & ~3;
+        }
+        else if (strncmp(type, "float", 5) == 0)
         {
             std::istringstream is(type + 5);
             is >> size;
@@ -293,4 +394,25 @@ namespace gvr
         return (e && e->IsSet) ? e->Size : 0;
     }
 
+    int DataDescriptor::getUnpackedSize() const
+    {
+        int size = 0;
+
+        for (auto it = mLayout.begin(); it != mLayout.end(); ++it)
+        {
+            const DataEntry& e = *it;
+            int ncomps = e.IsOctahedral ? 3 : e.ComponentCount;
+
+            if (e.ComponentSize < 4)
+            {
+                size += ncomps * sizeof(float) * e.Count;
+            }
+            else
+            {
+                size += e.Size;
+            }
+        }
+        return size;
+    }
+
 }
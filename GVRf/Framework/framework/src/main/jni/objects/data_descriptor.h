@@ -46,6 +46,11 @@ namespace gvr {
             unsigned int IsInt : 1;     // true if the entry represents an integer, false for float
             unsigned int IsMatrix : 1;  // true if the entry represents a matrix
             unsigned int NotUsed : 1;   // true if the shader does not use this entry
+            unsigned int IsNormalized : 1;  // true if integer components map to [-1, 1] or [0, 1]
+            unsigned int IsUnsigned : 1;    // true if integer components are unsigned
+            unsigned int IsOctahedral : 1;  // true if a unit vector is packed into 2 components
+            char ComponentSize;         // number of bytes in a single component (1, 2 or 4)
+            char ComponentCount;        // number of components stored in each element
             char NameLength;            // length of the name
             char Name[64];              // name of the entry
             std::string Type;           // type of the entry
@@ -94,6 +99,21 @@ namespace gvr {
          *  "float3 color, float opacity"
          *  "float factor float power int2 offset"
          * }
+         * Vertex descriptors may also use packed types which are
+         * converted from and to floats when the data is accessed:
+         * {@code
+         *  halfN       N 16 bit floats
+         *  snorm8xN    N signed bytes normalized to [-1, 1]
+         *  snorm16xN   N signed shorts normalized to [-1, 1]
+         *  unorm8xN    N unsigned bytes normalized to [0, 1]
+         *  unorm16xN   N unsigned shorts normalized to [0, 1]
+         *  int8xN      N signed byte integers
+         *  uint8xN     N unsigned byte integers
+         *  int16xN     N signed short integers
+         *  uint16xN    N unsigned short integers
+         *  octnorm8    unit vector, octahedral encoded in 2 snorm bytes
+         *  octnorm16   unit vector, octahedral encoded in 2 snorm shorts
+         * }
          * @return layout descriptor string
          * @see setDescriptor
          */
@@ -144,9 +164,21 @@ namespace gvr {
 
         /**
          * Calculate the byte size of the given type.
+         * Packed vertex types are padded to a multiple of 4 bytes
+         * so every attribute in a vertex stays 32 bit aligned.
          */
         static short calcSize(const char* type);
 
+        /**
+         * Get the number of bytes the data would occupy if every
+         * packed entry was stored as 32 bit floats or integers.
+         * For descriptors without packed types this is the same
+         * as getTotalSize().
+         * @return number of bytes
+         * @see calcSize
+         */
+        int getUnpackedSize() const;
+
     protected:
 
         /**
@@ -4,6 +4,7 @@
  * colors and texcoords.
  *
  ****/
+#include <atomic>
 #include <string>
 #include <sstream>
 #include "index_buffer.h"
@@ -11,11 +12,22 @@
 
 namespace gvr {
 
+    /*
+     * Change counts come from one counter shared by all the
+     * index buffers so they are never the same for two buffers.
+     */
+    unsigned int IndexBuffer::newChangeCount()
+    {
+        static std::atomic<unsigned int> counter(0);
+        return ++counter;
+    }
+
     IndexBuffer::IndexBuffer(int bytesPerIndex, int count)
     : mIndexCount(0),
       mIndexData(NULL),
       mIndexByteSize(0),
       mIsDirty(false),
+      mChangeCount(newChangeCount()),
       mUpdateLock()
     {
         if (bytesPerIndex > 0)
@@ -73,6 +85,7 @@ namespace gvr {
         dest = reinterpret_cast<unsigned short*>(mIndexData);
         memcpy(dest, src, srcSize * sizeof(short));
         mIsDirty = true;
+        mChangeCount = newChangeCount();
         return true;
     }
 
@@ -98,6 +111,7 @@ namespace gvr {
         dest = reinterpret_cast<unsigned int*>(mIndexData);
         memcpy(dest, src, srcSize * sizeof(int));
         mIsDirty = true;
+        mChangeCount = newChangeCount();
         return true;
     }
 
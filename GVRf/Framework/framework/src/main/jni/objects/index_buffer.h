@@ -87,6 +87,14 @@ namespace gvr {
         bool    getShortVec(unsigned short* dest, int destSize) const;
 
         bool            isDirty() const { return mIsDirty; }
+
+        /**
+         * Get a counter which changes every time the indices change.
+         * Unlike isDirty() it is not reset when the GPU copy is updated,
+         * so CPU side caches can use it to tell if they are stale.
+         * No two index buffers have the same count.
+         */
+        unsigned int    getChangeCount() const { return mChangeCount; }
         virtual bool    bindBuffer(Shader*) = 0;
         virtual bool    updateGPU(Renderer*) = 0;
         void            dump() const;
@@ -94,9 +102,11 @@ namespace gvr {
     protected:
         bool            setIndexCount(int count);
         bool            setIndexSize(int v);
+        static unsigned int newChangeCount();
 
         mutable std::mutex mUpdateLock;
         mutable bool    mIsDirty;
+        unsigned int    mChangeCount;
         int     mIndexByteSize;     // index size in bytes (either 2 or 4)
         int     mIndexCount;        // current number of vertices
         char*   mIndexData;         // index data buffer
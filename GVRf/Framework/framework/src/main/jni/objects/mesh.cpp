@@ -24,6 +24,8 @@ namespace gvr
     : mVertices(nullptr),
       mIndices(nullptr),
       have_bounding_volume_(false),
+      fixed_bounding_volume_(false),
+      bounding_volume_count_(0),
       vertexBoneData_()
     {
         mVertices = Renderer::getInstance()->createVertexBuffer(descriptor, 0);
@@ -32,6 +34,8 @@ namespace gvr
     Mesh::Mesh(VertexBuffer& vbuf)
     : mVertices(&vbuf), mIndices(nullptr),
       have_bounding_volume_(false),
+      fixed_bounding_volume_(false),
+      bounding_volume_count_(0),
       vertexBoneData_()
     {
     }
@@ -64,21 +68,20 @@ namespace gvr
 // an array of size:6 with Xmin, Ymin, Zmin and Xmax, Ymax, Zmax values
     const BoundingVolume &Mesh::getBoundingVolume()
     {
-        if (have_bounding_volume_)
+        if (have_bounding_volume_ &&
+            (fixed_bounding_volume_ || (bounding_volume_count_ == mVertices->getChangeCount())))
         {
             return bounding_volume;
         }
         mVertices->getBoundingVolume(bounding_volume);
+        bounding_volume_count_ = mVertices->getChangeCount();
         have_bounding_volume_ = true;
         return bounding_volume;
     }
 
     void Mesh::getTransformedBoundingBoxInfo(glm::mat4 *Mat, float* transformed_bounding_box)
     {
-        if (!have_bounding_volume_)
-        {
-            getBoundingVolume();
-        }
+        getBoundingVolume();
 
         glm::mat4 M = *Mat;
         float a, b;
@@ -267,11 +270,17 @@ namespace gvr
                                                   const float *v2, const float *v3)> func) const
     {
         int n = getIndexCount();
-        const float* vertData = mVertices->getVertexData();
+        std::vector<float> temp;
+        int stride;
+        const float* vertData = mVertices->getFloatData("a_position", temp, stride);
         const float *V1;
         const float *V2;
         const float *V3;
-        int stride = mVertices->getVertexSize();
+
+        if (vertData == NULL)
+        {
+            return;
+        }
         if (mIndices->getIndexSize() == 2)
         {
             const unsigned short* intData = reinterpret_cast<const unsigned short*>(mIndices->getIndexData());
@@ -36,6 +36,8 @@
 #include "objects/vertex_bone_data.h"
 #include "objects/vertex_buffer.h"
 #include "objects/index_buffer.h"
+#include "objects/mesh_bvh.h"
+#include "objects/morph_targets.h"
 #include "bounding_volume.h"
 
 namespace gvr {
@@ -86,6 +88,17 @@ public:
 
     const BoundingVolume& getBoundingVolume();
 
+    /*
+     * Use a bounding volume instead of the one of the vertices,
+     * for meshes whose vertices are rewritten every frame.
+     */
+    void setBoundingVolume(const BoundingVolume& bv)
+    {
+        bounding_volume = bv;
+        have_bounding_volume_ = true;
+        fixed_bounding_volume_ = true;
+    }
+
     bool hasBones() const
     {
         return vertexBoneData_.getNumBones();
@@ -101,8 +114,20 @@ public:
         return vertexBoneData_;
     }
 
+    MorphTargets& getMorphTargets()
+    {
+        return morphTargets_;
+    }
+
     bool isDirty() const { return mVertices->isDirty(); }
 
+    /*
+     * Get the triangle hierarchy used to ray cast this mesh.
+     * It is built on the first ray cast and kept up to date
+     * with the vertex and index buffers.
+     */
+    MeshBVH& getBVH() const { return mBVH; }
+
 private:
     Mesh(const Mesh& mesh);
     Mesh(Mesh&& mesh);
@@ -113,10 +138,14 @@ protected:
     IndexBuffer* mIndices;
     VertexBuffer* mVertices;
     bool have_bounding_volume_;
+    bool fixed_bounding_volume_;            // set by setBoundingVolume
+    unsigned int bounding_volume_count_;    // vertex change count it was computed at
     BoundingVolume bounding_volume;
+    mutable MeshBVH mBVH;
 
     // Bone data for the shader
     VertexBoneData vertexBoneData_;
+    MorphTargets morphTargets_;
     std::unordered_set<std::shared_ptr<u_short>> dirty_flags_;
 };
 }
@@ -0,0 +1,571 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Bounding volume hierarchy over the triangles of a mesh.
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "mesh_bvh.h"
+#include "mesh.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+/*
+ * If refitting makes the hierarchy this much more expensive
+ * to traverse than it was after building, it is rebuilt.
+ */
+static const float REBUILD_COST_RATIO = 2.0f;
+
+static float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 d(max - min);
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+/*
+ * Slab test of a ray against the box of a node.
+ * Directions are never exactly zero so there is no division
+ * by zero and the test needs no branches per axis.
+ * @param tnear gets the ray parameter where the ray enters the box
+ * @returns true if the ray hits the box in front of its origin
+ */
+static inline bool intersectBox(const MeshBVH::Node& node, const glm::vec3& rayStart,
+                                const glm::vec3& invDir, float& tnear)
+{
+    glm::vec3 t0((node.Min - rayStart) * invDir);
+    glm::vec3 t1((node.Max - rayStart) * invDir);
+    glm::vec3 tmin(glm::min(t0, t1));
+    glm::vec3 tmax(glm::max(t0, t1));
+    float enter = std::max(std::max(tmin.x, tmin.y), tmin.z);
+    float exit = std::min(std::min(tmax.x, tmax.y), tmax.z);
+
+    tnear = enter;
+    return exit >= std::max(enter, 0.0f);
+}
+
+MeshBVH::MeshBVH()
+    : mVertexBuffer(nullptr), mIndexBuffer(nullptr),
+      mVertexChanges(0), mIndexChanges(0),
+      mPadding(0), mBuildCost(0)
+{
+}
+
+void MeshBVH::invalidate()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    mNodes.clear();
+    mVertexBuffer = nullptr;
+    mIndexBuffer = nullptr;
+}
+
+/*
+ * Make sure the hierarchy matches the current mesh.
+ * It is built if the mesh has new indices and refit
+ * if only the vertices have changed.
+ */
+bool MeshBVH::update(const Mesh& mesh)
+{
+    const VertexBuffer* vbuf = mesh.getVertexBuffer();
+    const IndexBuffer* ibuf = mesh.getIndexBuffer();
+
+    if ((vbuf == nullptr) || (ibuf == nullptr))
+    {
+        mNodes.clear();
+        return false;
+    }
+    bool rebuild = (vbuf != mVertexBuffer) || (ibuf != mIndexBuffer) ||
+                   (ibuf->getChangeCount() != mIndexChanges);
+
+    if (!rebuild && (vbuf->getChangeCount() == mVertexChanges))
+    {
+        return true;
+    }
+    mVertexBuffer = vbuf;
+    mIndexBuffer = ibuf;
+    mVertexChanges = vbuf->getChangeCount();
+    mIndexChanges = ibuf->getChangeCount();
+    if (!rebuild && loadVertices(*vbuf))
+    {
+        refit();
+        if (calcCost() <= mBuildCost * REBUILD_COST_RATIO)
+        {
+            return true;
+        }
+        LOGD("MeshBVH: rebuilding %d triangles after refit", (int) mFaces.size());
+    }
+    else if (!loadIndices(*ibuf, vbuf->getVertexCount()) || !loadVertices(*vbuf))
+    {
+        mNodes.clear();
+        return false;
+    }
+    build();
+    return true;
+}
+
+/*
+ * Copy the triangles from the index buffer in face order.
+ * Triangles which reference missing vertices are skipped.
+ */
+bool MeshBVH::loadIndices(const IndexBuffer& ibuf, int vertexCount)
+{
+    int n = ibuf.getIndexCount();
+    std::vector<unsigned> indices(n);
+
+    mIndices.clear();
+    mFaces.clear();
+    if (n < 3)
+    {
+        return false;
+    }
+    if (ibuf.getIndexSize() == sizeof(unsigned short))
+    {
+        std::vector<unsigned short> shorts(n);
+        ibuf.getShortVec(shorts.data(), n);
+        std::copy(shorts.begin(), shorts.end(), indices.begin());
+    }
+    else
+    {
+        ibuf.getIntVec(indices.data(), n);
+    }
+    mIndices.reserve(n);
+    mFaces.reserve(n / 3);
+    for (int i = 0; i + 2 < n; i += 3)
+    {
+        if ((indices[i] >= vertexCount) ||
+            (indices[i + 1] >= vertexCount) ||
+            (indices[i + 2] >= vertexCount))
+        {
+            continue;
+        }
+        mIndices.insert(mIndices.end(), &indices[i], &indices[i + 3]);
+        mFaces.push_back(i / 3);
+    }
+    return !mFaces.empty();
+}
+
+/*
+ * Copy the vertex positions of each triangle in leaf order.
+ */
+bool MeshBVH::loadVertices(const VertexBuffer& vbuf)
+{
+    std::vector<float> unpacked;
+    int stride;
+    const float* positions = vbuf.getFloatData("a_position", unpacked, stride);
+    unsigned vertexCount = vbuf.getVertexCount();
+
+    if (positions == nullptr)
+    {
+        return false;
+    }
+    mVerts.resize(mIndices.size());
+    for (int i = 0; i < mIndices.size(); ++i)
+    {
+        unsigned v = mIndices[i];
+        if (v >= vertexCount)
+        {
+            return false;
+        }
+        const float* p = positions + v * stride;
+        mVerts[i] = glm::vec3(p[0], p[1], p[2]);
+    }
+    return true;
+}
+
+void MeshBVH::calcBounds(Node& node) const
+{
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    const glm::vec3* v = &mVerts[node.First * 3];
+
+    for (int i = 0; i < node.Count * 3; ++i)
+    {
+        min = glm::min(min, v[i]);
+        max = glm::max(max, v[i]);
+    }
+    node.Min = min - glm::vec3(mPadding);
+    node.Max = max + glm::vec3(mPadding);
+}
+
+/*
+ * Sum of the node areas relative to the root area,
+ * proportional to the expected cost of a random ray.
+ */
+float MeshBVH::calcCost() const
+{
+    if (mNodes.empty())
+    {
+        return 0;
+    }
+    float rootArea = surfaceArea(mNodes[0].Min, mNodes[0].Max);
+    float cost = 0;
+
+    if (rootArea <= 0)
+    {
+        return 0;
+    }
+    for (auto it = mNodes.begin(); it != mNodes.end(); ++it)
+    {
+        cost += surfaceArea(it->Min, it->Max) * std::max(it->Count, 1);
+    }
+    return cost / rootArea;
+}
+
+void MeshBVH::build()
+{
+    int ntris = mFaces.size();
+    std::vector<glm::vec3> centroids(ntris);
+    std::vector<int> order(ntris);
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+
+    for (int i = 0; i < ntris; ++i)
+    {
+        const glm::vec3* v = &mVerts[i * 3];
+        centroids[i] = (v[0] + v[1] + v[2]) / 3.0f;
+        order[i] = i;
+        min = glm::min(min, glm::min(v[0], glm::min(v[1], v[2])));
+        max = glm::max(max, glm::max(v[0], glm::max(v[1], v[2])));
+    }
+    /*
+     * Boxes are enlarged a little so rounding in the box test
+     * never culls a triangle the triangle test would hit,
+     * flat meshes give boxes with no thickness otherwise.
+     */
+    glm::vec3 extent(max - min);
+    mPadding = std::max(std::max(extent.x, extent.y), extent.z) * 1e-5f +
+               std::numeric_limits<float>::min();
+    mNodes.clear();
+    mNodes.reserve(2 * ntris / MAX_LEAF_SIZE + 1);
+    mNodes.push_back(Node());
+    buildNode(0, 0, ntris, 0, centroids, order);
+
+    /*
+     * Store the triangles in leaf order.
+     */
+    std::vector<unsigned> indices(mIndices.size());
+    std::vector<int> faces(ntris);
+    std::vector<glm::vec3> verts(mVerts.size());
+    for (int i = 0; i < ntris; ++i)
+    {
+        int t = order[i];
+        faces[i] = mFaces[t];
+        for (int j = 0; j < 3; ++j)
+        {
+            indices[i * 3 + j] = mIndices[t * 3 + j];
+            verts[i * 3 + j] = mVerts[t * 3 + j];
+        }
+    }
+    mIndices.swap(indices);
+    mFaces.swap(faces);
+    mVerts.swap(verts);
+    mBuildCost = calcCost();
+    LOGD("MeshBVH: built %d nodes for %d triangles", (int) mNodes.size(), ntris);
+}
+
+/*
+ * Split the triangles order[first, first + count) using the
+ * surface area heuristic evaluated at NUM_BINS positions along
+ * each axis of the centroid bounds.
+ * mVerts is still in face order, order maps to it.
+ */
+void MeshBVH::buildNode(int nodeIndex, int first, int count, int depth,
+                        const std::vector<glm::vec3>& centroids, std::vector<int>& order)
+{
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    glm::vec3 cmin(min);
+    glm::vec3 cmax(max);
+
+    for (int i = first; i < first + count; ++i)
+    {
+        const glm::vec3* v = &mVerts[order[i] * 3];
+        min = glm::min(min, glm::min(v[0], glm::min(v[1], v[2])));
+        max = glm::max(max, glm::max(v[0], glm::max(v[1], v[2])));
+        cmin = glm::min(cmin, centroids[order[i]]);
+        cmax = glm::max(cmax, centroids[order[i]]);
+    }
+    Node& node = mNodes[nodeIndex];
+    node.Min = min - glm::vec3(mPadding);
+    node.Max = max + glm::vec3(mPadding);
+    node.First = first;
+    node.Count = count;
+    if ((count <= MAX_LEAF_SIZE) || (depth >= MAX_DEPTH))
+    {
+        return;
+    }
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestScale = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = cmax[axis] - cmin[axis];
+        if (extent <= 0)
+        {
+            continue;
+        }
+        int binCount[NUM_BINS] = { 0 };
+        glm::vec3 binMin[NUM_BINS];
+        glm::vec3 binMax[NUM_BINS];
+        float scale = NUM_BINS / extent;
+
+        for (int b = 0; b < NUM_BINS; ++b)
+        {
+            binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+            binMax[b] = glm::vec3(-std::numeric_limits<float>::max());
+        }
+        for (int i = first; i < first + count; ++i)
+        {
+            int t = order[i];
+            const glm::vec3* v = &mVerts[t * 3];
+            int b = std::min(NUM_BINS - 1, (int) ((centroids[t][axis] - cmin[axis]) * scale));
+            ++binCount[b];
+            binMin[b] = glm::min(binMin[b], glm::min(v[0], glm::min(v[1], v[2])));
+            binMax[b] = glm::max(binMax[b], glm::max(v[0], glm::max(v[1], v[2])));
+        }
+        /*
+         * Sweep from the right to get the cost of everything
+         * after each split, then from the left to finish it.
+         */
+        float rightCost[NUM_BINS];
+        glm::vec3 rmin(std::numeric_limits<float>::max());
+        glm::vec3 rmax(-std::numeric_limits<float>::max());
+        int rcount = 0;
+        for (int b = NUM_BINS - 1; b > 0; --b)
+        {
+            rcount += binCount[b];
+            rmin = glm::min(rmin, binMin[b]);
+            rmax = glm::max(rmax, binMax[b]);
+            rightCost[b] = rcount ? rcount * surfaceArea(rmin, rmax) : 0;
+        }
+        glm::vec3 lmin(std::numeric_limits<float>::max());
+        glm::vec3 lmax(-std::numeric_limits<float>::max());
+        int lcount = 0;
+        for (int b = 0; b < NUM_BINS - 1; ++b)
+        {
+            lcount += binCount[b];
+            lmin = glm::min(lmin, binMin[b]);
+            lmax = glm::max(lmax, binMax[b]);
+            if ((lcount == 0) || (lcount == count))
+            {
+                continue;
+            }
+            float cost = lcount * surfaceArea(lmin, lmax) + rightCost[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+                bestScale = scale;
+            }
+        }
+    }
+
+    float leafCost = count * surfaceArea(min, max);
+    int mid;
+
+    if (bestAxis < 0)                           // all centroids in the same place
+    {
+        mid = first + count / 2;
+    }
+    else if ((bestCost >= leafCost) && (count <= MAX_LEAF_SIZE * 4))
+    {
+        return;                                 // splitting does not pay
+    }
+    else
+    {
+        float axisMin = cmin[bestAxis];
+        int* split = std::partition(&order[first], &order[first] + count,
+                                    [&centroids, bestAxis, bestSplit, bestScale, axisMin](int t)
+        {
+            int b = std::min(NUM_BINS - 1, (int) ((centroids[t][bestAxis] - axisMin) * bestScale));
+            return b <= bestSplit;
+        });
+        mid = split - &order[0];
+    }
+
+    int left = mNodes.size();
+    mNodes.push_back(Node());
+    mNodes.push_back(Node());
+    mNodes[nodeIndex].First = left;
+    mNodes[nodeIndex].Count = 0;
+    buildNode(left, first, mid - first, depth + 1, centroids, order);
+    buildNode(left + 1, mid, first + count - mid, depth + 1, centroids, order);
+}
+
+/*
+ * Recompute the node boxes from the current vertices.
+ * Children always follow their parent so walking the
+ * nodes backwards visits the children first.
+ */
+void MeshBVH::refit()
+{
+    for (int i = mNodes.size() - 1; i >= 0; --i)
+    {
+        Node& node = mNodes[i];
+        if (node.Count > 0)
+        {
+            calcBounds(node);
+        }
+        else
+        {
+            const Node& left = mNodes[node.First];
+            const Node& right = mNodes[node.First + 1];
+            node.Min = glm::min(left.Min, right.Min);
+            node.Max = glm::max(left.Max, right.Max);
+        }
+    }
+}
+
+bool MeshBVH::raycast(const Mesh& mesh, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                      glm::vec3& hitPos, float& distance, int& faceIndex)
+{
+    struct StackEntry
+    {
+        int     Node;
+        float   Near;
+    };
+    std::lock_guard<std::mutex> lock(mLock);
+    StackEntry stack[MAX_DEPTH + 2];
+    int sp = 0;
+    float best = std::numeric_limits<float>::max();
+    int bestFace = -1;
+    glm::vec3 invDir;
+    float tnear;
+
+    if (!update(mesh) || mNodes.empty())
+    {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        float d = rayDir[i];
+        if (fabsf(d) < 1e-30f)
+        {
+            d = (d < 0) ? -1e-30f : 1e-30f;
+        }
+        invDir[i] = 1.0f / d;
+    }
+    if (!intersectBox(mNodes[0], rayStart, invDir, tnear))
+    {
+        return false;
+    }
+    stack[sp].Node = 0;
+    stack[sp++].Near = tnear;
+    while (sp > 0)
+    {
+        StackEntry entry = stack[--sp];
+        if (entry.Near > best)                  // closer hit already found
+        {
+            continue;
+        }
+        const Node& node = mNodes[entry.Node];
+        if (node.Count > 0)
+        {
+            for (int i = node.First; i < node.First + node.Count; ++i)
+            {
+                const glm::vec3* v = &mVerts[i * 3];
+                glm::vec3 pos;
+                float d = rayTriangleIntersect(pos, rayStart, rayDir, v[0], v[1], v[2]);
+
+                if ((d > 0) && ((d < best) || ((d == best) && (mFaces[i] < bestFace))))
+                {
+                    best = d;
+                    bestFace = mFaces[i];
+                    hitPos = pos;
+                }
+            }
+            continue;
+        }
+        float tleft, tright;
+        bool hitLeft = intersectBox(mNodes[node.First], rayStart, invDir, tleft);
+        bool hitRight = intersectBox(mNodes[node.First + 1], rayStart, invDir, tright);
+
+        /*
+         * Push the farther child first so the nearer one is visited first.
+         */
+        if (hitLeft && hitRight)
+        {
+            bool leftFirst = tleft <= tright;
+            stack[sp].Node = leftFirst ? node.First + 1 : node.First;
+            stack[sp++].Near = leftFirst ? tright : tleft;
+            stack[sp].Node = leftFirst ? node.First : node.First + 1;
+            stack[sp++].Near = leftFirst ? tleft : tright;
+        }
+        else if (hitLeft)
+        {
+            stack[sp].Node = node.First;
+            stack[sp++].Near = tleft;
+        }
+        else if (hitRight)
+        {
+            stack[sp].Node = node.First + 1;
+            stack[sp++].Near = tright;
+        }
+    }
+    if (bestFace < 0)
+    {
+        return false;
+    }
+    distance = best;
+    faceIndex = bestFace;
+    return true;
+}
+
+float MeshBVH::rayTriangleIntersect(glm::vec3& hitPos, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                                    const glm::vec3& V1, const glm::vec3& V2, const glm::vec3& V3)
+{
+    glm::vec3 e1(V2 - V1);
+    glm::vec3 e2(V3 - V1);
+    glm::vec3 P = glm::cross(rayDir, e2);
+    glm::vec3 T(glm::vec3(rayStart) - V1);
+    float det = glm::dot(e1, P);
+    const float EPSILON = 0.00001f;
+
+    if (det > -EPSILON && det < EPSILON) {
+        return -1;
+    }
+
+    float inv_det = 1.0f / det;
+    float u = glm::dot(T, P) * inv_det;
+
+    if (u < 0.0f || u > 1.0f) {
+        return -1;
+    }
+
+    glm::vec3 Q = glm::cross(T, e1);
+    float v = glm::dot(glm::vec3(rayDir), Q) * inv_det;
+
+    if (v < 0.0f || (u + v) > 1.0f) {
+        return -1;
+    }
+
+    float t = glm::dot(e2, Q) * inv_det;
+
+    if (t > EPSILON) {
+        hitPos = (1.0f - u - v) * V1 + u * V2 + v * V3;
+        return t;
+    }
+    return -1;
+}
+
+}
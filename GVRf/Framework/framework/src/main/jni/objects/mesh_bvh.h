@@ -0,0 +1,127 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Bounding volume hierarchy over the triangles of a mesh.
+ ***************************************************************************/
+
+#ifndef MESH_BVH_H_
+#define MESH_BVH_H_
+
+#include <mutex>
+#include <vector>
+#include "glm/glm.hpp"
+
+namespace gvr {
+class Mesh;
+class VertexBuffer;
+class IndexBuffer;
+
+/*
+ * Accelerates ray casts against the triangles of a mesh.
+ *
+ * The hierarchy is built with the surface area heuristic over
+ * binned triangle centroids and stored as a flat array of nodes
+ * with the children of a node next to each other. Triangle
+ * vertices are copied in leaf order so a leaf is read from
+ * contiguous memory.
+ *
+ * The hierarchy is built the first time the mesh is ray cast.
+ * If the vertices change it is refit, if the indices change or
+ * refitting has made it too loose it is rebuilt.
+ *
+ * The closest hit is the same as testing every triangle in order:
+ * when two triangles are hit at the same distance the one with
+ * the lower face index wins.
+ */
+class MeshBVH {
+public:
+    /*
+     * A node in the hierarchy.
+     * Interior nodes have Count 0 and First is the index of the
+     * left child, the right child follows it. Leaf nodes have
+     * Count triangles starting at triangle First.
+     */
+    struct Node {
+        glm::vec3   Min;
+        int         First;
+        glm::vec3   Max;
+        int         Count;
+    };
+
+    static const int MAX_LEAF_SIZE = 4;
+    static const int NUM_BINS = 16;
+    static const int MAX_DEPTH = 48;
+
+    MeshBVH();
+
+    /*
+     * Find the closest triangle of the mesh hit by a ray.
+     * The hierarchy is built or updated first if necessary.
+     * @param mesh      mesh to test, must be the same mesh each time
+     * @param rayStart  origin of the ray in mesh coordinates
+     * @param rayDir    direction of the ray in mesh coordinates
+     * @param hitPos    gets the hit point in mesh coordinates
+     * @param distance  gets the ray parameter of the hit point
+     * @param faceIndex gets the index of the triangle hit
+     * @returns true if a triangle was hit, else false
+     */
+    bool raycast(const Mesh& mesh, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                 glm::vec3& hitPos, float& distance, int& faceIndex);
+
+    /*
+     * Discard the hierarchy so it is rebuilt on the next ray cast.
+     */
+    void invalidate();
+
+    int getNodeCount() const { return mNodes.size(); }
+
+    /*
+     * Intersect a ray with a triangle (Moller-Trumbore).
+     * @returns ray parameter of the hit point or -1 if not hit
+     */
+    static float rayTriangleIntersect(glm::vec3& hitPos, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                                      const glm::vec3& V1, const glm::vec3& V2, const glm::vec3& V3);
+
+private:
+    MeshBVH(const MeshBVH&);
+    MeshBVH& operator=(const MeshBVH&);
+
+    bool update(const Mesh& mesh);
+    bool loadVertices(const VertexBuffer& vbuf);
+    bool loadIndices(const IndexBuffer& ibuf, int vertexCount);
+    void build();
+    void buildNode(int nodeIndex, int first, int count, int depth,
+                   const std::vector<glm::vec3>& centroids, std::vector<int>& order);
+    void refit();
+    void calcBounds(Node& node) const;
+    float calcCost() const;
+
+    std::mutex              mLock;
+    std::vector<Node>       mNodes;
+    std::vector<unsigned>   mIndices;   // 3 vertex indices per triangle in leaf order
+    std::vector<int>        mFaces;     // face index of each triangle in leaf order
+    std::vector<glm::vec3>  mVerts;     // 3 vertices per triangle in leaf order
+    const VertexBuffer*     mVertexBuffer;
+    const IndexBuffer*      mIndexBuffer;
+    unsigned int            mVertexChanges;
+    unsigned int            mIndexChanges;
+    float                   mPadding;   // how much boxes are enlarged to absorb rounding
+    float                   mBuildCost; // surface area cost right after building
+};
+
+}
+#endif
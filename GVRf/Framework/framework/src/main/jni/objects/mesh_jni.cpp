@@ -38,6 +38,16 @@ namespace gvr {
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeMesh_setBones(JNIEnv* env,
                                          jobject obj, jlong jmesh, jlongArray jBonePtrArray);
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_addMorphTarget(JNIEnv* env,
+                                               jobject obj, jlong jmesh, jfloatArray jpositions,
+                                               jfloatArray jnormals, jboolean relative,
+                                               jboolean half_floats);
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_getMorphTargetCount(JNIEnv* env, jobject obj, jlong jmesh);
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_setMorphWeights(JNIEnv* env,
+                                                jobject obj, jlong jmesh, jfloatArray jweights);
 };
 
     JNIEXPORT jlong JNICALL
@@ -92,6 +102,55 @@ namespace gvr {
         env->ReleaseLongArrayElements(jBonePtrArray, bonesPtr, JNI_ABORT);
     }
 
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_addMorphTarget(JNIEnv* env,
+                                               jobject obj, jlong jmesh, jfloatArray jpositions,
+                                               jfloatArray jnormals, jboolean relative,
+                                               jboolean half_floats)
+    {
+        Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+        VertexBuffer* vbuf = mesh->getVertexBuffer();
+        int num_floats = 3 * vbuf->getVertexCount();
+
+        if ((env->GetArrayLength(jpositions) < num_floats) ||
+            (jnormals && (env->GetArrayLength(jnormals) < num_floats)))
+        {
+            LOGE("Mesh: morph target needs 3 floats for each of the %d vertices", vbuf->getVertexCount());
+            return -1;
+        }
+        jfloat* positions = env->GetFloatArrayElements(jpositions, 0);
+        jfloat* normals = jnormals ? env->GetFloatArrayElements(jnormals, 0) : nullptr;
+        int target = mesh->getMorphTargets().addTarget(*vbuf, positions, normals,
+                                                       relative, half_floats);
+
+        env->ReleaseFloatArrayElements(jpositions, positions, JNI_ABORT);
+        if (normals)
+        {
+            env->ReleaseFloatArrayElements(jnormals, normals, JNI_ABORT);
+        }
+        return target;
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_getMorphTargetCount(JNIEnv* env, jobject obj, jlong jmesh)
+    {
+        Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+        return mesh->getMorphTargets().getTargetCount();
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeMesh_setMorphWeights(JNIEnv* env,
+                                                jobject obj, jlong jmesh, jfloatArray jweights)
+    {
+        Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+        jfloat* weights = env->GetFloatArrayElements(jweights, 0);
+        int n = mesh->getMorphTargets().apply(*mesh->getVertexBuffer(), weights,
+                                              env->GetArrayLength(jweights));
+
+        env->ReleaseFloatArrayElements(jweights, weights, JNI_ABORT);
+        return n;
+    }
+
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeMesh_getSphereBound(JNIEnv * env,
                                                jobject obj, jlong jmesh, jfloatArray jsphere) {
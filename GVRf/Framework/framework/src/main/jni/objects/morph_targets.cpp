@@ -0,0 +1,257 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Morph targets (blend shapes) of a mesh.
+ ***************************************************************************/
+
+#include <math.h>
+
+#include "glm/gtc/packing.hpp"
+
+#include "objects/morph_targets.h"
+#include "objects/vertex_buffer.h"
+#include "util/gvr_log.h"
+#include "util/gvr_simd.h"
+
+namespace gvr {
+
+// Deltas smaller than this do not move a vertex
+static const float MIN_DELTA = 1e-6f;
+
+MorphTargets::MorphTargets()
+: has_normals_(false),
+  stamp_(0)
+{
+}
+
+int MorphTargets::addTarget(const VertexBuffer& vbuf, const float* positions, const float* normals,
+                            bool relative, bool half_floats) {
+    std::lock_guard<std::mutex> lock(lock_);
+    int num_verts = vbuf.getVertexCount();
+    std::vector<float> base_positions(num_verts * 3);
+    std::vector<float> base_normals;
+
+    if ((num_verts == 0) || !vbuf.isSet("a_position")) {
+        LOGE("MorphTargets: mesh does not have positions");
+        return -1;
+    }
+    if (targets_.empty()) {
+        has_normals_ = vbuf.isSet("a_normal");
+        slot_of_.assign(num_verts, -1);
+    } else if ((int) slot_of_.size() != num_verts) {
+        LOGE("MorphTargets: mesh has %d vertices, the targets have %d",
+             num_verts, (int) slot_of_.size());
+        return -1;
+    }
+    vbuf.getFloatVec("a_position", base_positions.data(), base_positions.size(), 3);
+    if (has_normals_) {
+        base_normals.resize(num_verts * 3);
+        vbuf.getFloatVec("a_normal", base_normals.data(), base_normals.size(), 3);
+    } else {
+        normals = nullptr;
+    }
+
+    /*
+     * Vertices which already have a slot may be morphed in the
+     * vertex buffer, their base is the one kept in the slot.
+     */
+    Target target;
+    for (int v = 0; v < num_verts; ++v) {
+        int slot = slot_of_[v];
+        const float* base_pos = (slot >= 0) ? &base_[slot * SLOT_SIZE] : &base_positions[v * 3];
+        const float* base_nml = (slot >= 0) ? &base_[slot * SLOT_SIZE + 4] :
+                                (has_normals_ ? &base_normals[v * 3] : nullptr);
+        float delta[SLOT_SIZE] = { 0 };
+        bool moved = false;
+
+        for (int k = 0; k < 3; ++k) {
+            delta[k] = relative ? positions[v * 3 + k] : (positions[v * 3 + k] - base_pos[k]);
+            if (normals) {
+                delta[4 + k] = relative ? normals[v * 3 + k] : (normals[v * 3 + k] - base_nml[k]);
+            }
+            moved |= (fabsf(delta[k]) > MIN_DELTA) || (fabsf(delta[4 + k]) > MIN_DELTA);
+        }
+        if (!moved) {
+            continue;
+        }
+        if (slot < 0) {
+            slot = addSlot(v, &base_positions[v * 3], base_nml);
+        }
+        target.slots.push_back(slot);
+        for (int k = 0; k < SLOT_SIZE; ++k) {
+            if (half_floats) {
+                target.half_deltas.push_back(glm::packHalf1x16(delta[k]));
+            } else {
+                target.deltas.push_back(delta[k]);
+            }
+        }
+    }
+    targets_.push_back(std::move(target));
+    return targets_.size() - 1;
+}
+
+int MorphTargets::addSlot(int vertex, const float* position, const float* normal) {
+    int slot = vertices_.size();
+
+    vertices_.push_back(vertex);
+    base_.insert(base_.end(), position, position + 3);
+    base_.push_back(0.0f);
+    if (normal) {
+        base_.insert(base_.end(), normal, normal + 3);
+    } else {
+        base_.insert(base_.end(), 3, 0.0f);
+    }
+    base_.push_back(0.0f);
+    stamps_.push_back(stamp_);
+    order_.push_back(0);
+    slot_of_[vertex] = slot;
+    return slot;
+}
+
+int MorphTargets::apply(VertexBuffer& vbuf, const float* weights, int num_weights) {
+    std::lock_guard<std::mutex> lock(lock_);
+    int num_targets = targets_.size();
+    bool changed = false;
+
+    weights_.resize(num_targets, 0.0f);
+    for (int t = 0; t < num_targets; ++t) {
+        float w = (t < num_weights) ? weights[t] : 0.0f;
+        changed |= (w != weights_[t]);
+    }
+    if (!changed) {
+        return 0;
+    }
+
+    /*
+     * Start from the base of the vertices moved by the previous
+     * weights, which go back to their base if no target moves
+     * them now, and of the vertices moved by the new weights.
+     */
+    ++stamp_;
+    out_vertices_.clear();
+    out_.clear();
+    for (auto it = active_.begin(); it != active_.end(); ++it) {
+        touchSlots(targets_[*it].slots);
+    }
+    active_.clear();
+    for (int t = 0; t < num_targets; ++t) {
+        float w = (t < num_weights) ? weights[t] : 0.0f;
+
+        weights_[t] = w;
+        if (w != 0.0f) {
+            active_.push_back(t);
+            touchSlots(targets_[t].slots);
+        }
+    }
+    for (auto it = active_.begin(); it != active_.end(); ++it) {
+        accumulate(targets_[*it], weights_[*it]);
+    }
+
+    int num_out = out_vertices_.size();
+    if (num_out == 0) {
+        return 0;
+    }
+    if (has_normals_) {
+        for (int i = 0; i < num_out; ++i) {
+            float* n = &out_[i * SLOT_SIZE + 4];
+            float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            if (len > 0.0f) {
+                n[0] /= len;
+                n[1] /= len;
+                n[2] /= len;
+            }
+        }
+    }
+    vbuf.setFloatVertices("a_position", out_vertices_.data(), num_out, out_.data(), SLOT_SIZE);
+    if (has_normals_) {
+        vbuf.setFloatVertices("a_normal", out_vertices_.data(), num_out, out_.data() + 4, SLOT_SIZE);
+    }
+    return num_out;
+}
+
+/*
+ * Add the slots not written yet in this apply to the output,
+ * starting from their base.
+ */
+void MorphTargets::touchSlots(const std::vector<int>& slots) {
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        int slot = *it;
+
+        if (stamps_[slot] == stamp_) {
+            continue;
+        }
+        stamps_[slot] = stamp_;
+        order_[slot] = out_vertices_.size();
+        out_vertices_.push_back(vertices_[slot]);
+        out_.insert(out_.end(), base_.begin() + slot * SLOT_SIZE,
+                    base_.begin() + (slot + 1) * SLOT_SIZE);
+    }
+}
+
+/*
+ * Add the weighted deltas of a target to the output,
+ * a position or a normal at a time.
+ */
+void MorphTargets::accumulate(const Target& target, float weight) {
+    float4 w = splat4(weight);
+    int n = target.slots.size();
+    float* out = out_.data();
+
+    if (!target.half_deltas.empty()) {
+        const uint16_t* d = target.half_deltas.data();
+
+        for (int i = 0; i < n; ++i, d += SLOT_SIZE) {
+            float* dst = out + order_[target.slots[i]] * SLOT_SIZE;
+
+            store4(dst, madd4(loadhalf4(d), w, load4(dst)));
+            store4(dst + 4, madd4(loadhalf4(d + 4), w, load4(dst + 4)));
+        }
+        return;
+    }
+    const float* d = target.deltas.data();
+    for (int i = 0; i < n; ++i, d += SLOT_SIZE) {
+        float* dst = out + order_[target.slots[i]] * SLOT_SIZE;
+
+        store4(dst, madd4(load4(d), w, load4(dst)));
+        store4(dst + 4, madd4(load4(d + 4), w, load4(dst + 4)));
+    }
+}
+
+void MorphTargets::remapVertices(const unsigned int* order, int vertex_count) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (vertices_.empty()) {
+        return;
+    }
+    std::vector<int> new_index(slot_of_.size(), -1);
+    for (int i = 0; i < vertex_count; ++i) {
+        if (order[i] < new_index.size()) {
+            new_index[order[i]] = i;
+        }
+    }
+    slot_of_.assign(vertex_count, -1);
+    for (int slot = 0; slot < (int) vertices_.size(); ++slot) {
+        int v = new_index[vertices_[slot]];
+
+        vertices_[slot] = v;
+        if (v >= 0) {
+            slot_of_[v] = slot;
+        }
+    }
+}
+
+}
@@ -0,0 +1,117 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Morph targets (blend shapes) of a mesh.
+ ***************************************************************************/
+
+#ifndef MORPH_TARGETS_H_
+#define MORPH_TARGETS_H_
+
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace gvr {
+class VertexBuffer;
+
+/*
+ * Deforms the vertices of a mesh with a weighted sum of targets.
+ *
+ * Each target only keeps the vertices it moves, with their
+ * position and normal deltas, as floats or half floats.
+ * The vertices moved by any target share a slot which keeps
+ * their base position and normal, so the mesh is always
+ * morphed from its base and the targets never accumulate
+ * errors.
+ *
+ * Applying the weights only writes the vertices of targets
+ * whose weight is not zero, and those of the previous weights
+ * to put them back, and the vertex buffer only copies the
+ * range of vertices written to the GPU.
+ */
+class MorphTargets {
+public:
+    // Floats per slot: position, 0, normal, 0
+    static const int SLOT_SIZE = 8;
+
+    MorphTargets();
+
+    /*
+     * Add a target. The vertices which it does not move are dropped.
+     * @param vbuf          vertex buffer of the mesh, its base is read from it
+     * @param positions     3 floats per vertex of the mesh
+     * @param normals       3 floats per vertex or null
+     * @param relative      true if the values are deltas, false if they
+     *                      replace the base values
+     * @param half_floats   true to store the deltas as half floats
+     * @returns index of the target or -1 if the mesh has no positions
+     */
+    int addTarget(const VertexBuffer& vbuf, const float* positions, const float* normals,
+                  bool relative, bool half_floats);
+
+    int getTargetCount() const { return targets_.size(); }
+
+    /*
+     * Number of vertices moved by a target.
+     */
+    int getVertexCount(int target) const { return targets_[target].slots.size(); }
+
+    /*
+     * Morph the vertices with one weight per target.
+     * Missing weights are zero.
+     * @returns number of vertices written to the vertex buffer
+     */
+    int apply(VertexBuffer& vbuf, const float* weights, int num_weights);
+
+    /*
+     * Follow vertices reordered in the vertex buffer.
+     * @param order     index of the old vertex for each new vertex
+     */
+    void remapVertices(const unsigned int* order, int vertex_count);
+
+private:
+    struct Target {
+        std::vector<int>        slots;
+        std::vector<float>      deltas;         // SLOT_SIZE floats per slot
+        std::vector<uint16_t>   half_deltas;    // or SLOT_SIZE halfs per slot
+    };
+
+    MorphTargets(const MorphTargets& morph);
+    MorphTargets(MorphTargets&& morph);
+    MorphTargets& operator=(const MorphTargets& morph);
+    MorphTargets& operator=(MorphTargets&& morph);
+
+    int addSlot(int vertex, const float* position, const float* normal);
+    void touchSlots(const std::vector<int>& slots);
+    void accumulate(const Target& target, float weight);
+
+    std::mutex              lock_;
+    std::vector<Target>     targets_;
+    bool                    has_normals_;
+    std::vector<int>        slot_of_;           // slot of each vertex or -1
+    std::vector<int>        vertices_;          // vertex of each slot
+    std::vector<float>      base_;              // SLOT_SIZE floats per slot
+    std::vector<float>      weights_;           // last weights applied
+    std::vector<int>        active_;            // targets with a weight last time
+    std::vector<unsigned int> stamps_;          // per slot, written in this apply
+    unsigned int            stamp_;
+    std::vector<int>        order_;             // per slot, index in the output
+    std::vector<int>        out_vertices_;
+    std::vector<float>      out_;               // SLOT_SIZE floats per vertex written
+};
+
+}
+#endif
@@ -36,8 +36,10 @@ Scene::Scene() :
         frustum_flag_(false),
         dirtyFlag_(0),
         occlusion_flag_(false),
+        lod_bias_(1.0f),
         bindShadersMethod_(0),
         pick_visible_(true),
+        visible_stamp_(1),
         is_shadowmap_invalid(true) {
 
 }
@@ -134,6 +136,7 @@ void Scene::clearAllColliders() {
     lockColliders();
     allColliders.clear();
     visibleColliders.clear();
+    collider_tree_.clear();
     unlockColliders();
 }
 
@@ -142,15 +145,21 @@ void Scene::pick(SceneObject* sceneobj) {
          Collider* collider = reinterpret_cast<Collider*>(sceneobj->getComponent(Collider::getComponentType()));
         if (collider) {
             visibleColliders.push_back(collider);
+            collider->set_visible_stamp(visible_stamp_);
         }
      }
 }
 
+bool Scene::isColliderPickable(const Collider* collider) const {
+    return !pick_visible_ || (collider->visible_stamp() == visible_stamp_);
+}
+
 void Scene::addCollider(Collider* collider) {
     auto it = std::find(allColliders.begin(), allColliders.end(), collider);
     if (it == allColliders.end()) {
         lockColliders();
         allColliders.push_back(collider);
+        collider_tree_.addCollider(collider);
         unlockColliders();
     }
 }
@@ -160,6 +169,7 @@ void Scene::removeCollider(Collider* collider) {
     if (it != allColliders.end()) {
         lockColliders();
         allColliders.erase(it);
+        collider_tree_.removeCollider(collider);
         unlockColliders();
     }
 }
@@ -29,6 +29,7 @@
 #include "objects/shader_data.h"
 #include "components/camera_rig.h"
 #include "engine/renderer/renderer.h"
+#include "engine/picker/collider_tree.h"
 #include "objects/light.h"
 
 
@@ -63,6 +64,14 @@ public:
     void set_occlusion_culling( bool occlusion_flag){ occlusion_flag_ = occlusion_flag; }
     bool get_occlusion_culling(){ return occlusion_flag_; }
 
+    /*
+     * Global bias applied to level of detail selection.
+     * Values greater than 1 select coarser levels and can
+     * be changed every frame to shed load.
+     */
+    void set_lod_bias(float bias) { lod_bias_ = (bias > 0) ? bias : 1.0f; }
+    float get_lod_bias() const { return lod_bias_; }
+
     /*
      * Adds a new light to the scene.
      * Return true if light was added, false if already there or too many lights.
@@ -101,6 +110,12 @@ public:
             return gRenderer->getNumberTriangles();
         }
     }
+    int getNumberLODTriangles(int level) {
+        if(nullptr!= gRenderer) {
+            return gRenderer->getNumberLODTriangles(level);
+        }
+        return 0;
+    }
 
     void exportToFile(std::string filepath);
 
@@ -151,7 +166,25 @@ public:
      * to contain only the pickable objects that are visible.
      * This function does not lock the collider list!
      */
-    void clearVisibleColliders() { visibleColliders.clear(); }
+    void clearVisibleColliders() {
+        visibleColliders.clear();
+        ++visible_stamp_;
+    }
+
+    /*
+     * Returns true if the collider is pickable.
+     * If only visible objects are picked the collider must
+     * have been found visible during the last cull.
+     */
+    bool isColliderPickable(const Collider* collider) const;
+
+    /*
+     * Request the world bounds of a collider be recomputed
+     * before the next pick. May be called from any thread.
+     */
+    void markColliderDirty(Collider* collider) {
+        collider_tree_.markDirty(collider);
+    }
 
     /*
      * Called during culling to add a scene object's
@@ -170,6 +203,17 @@ public:
         return pick_visible_ ? visibleColliders : allColliders;
     }
 
+    /*
+     * Lock the colliders and return the tree of collider bounds
+     * after updating the bounds of colliders that have moved.
+     * You should call unlockColliders after you are done with the tree.
+     */
+    ColliderTree& lockColliderTree() {
+        collider_mutex_.lock();
+        collider_tree_.update();
+        return collider_tree_;
+    }
+
     /*
      * Unlock the collider list.
      * Don't call this unless you have called lockColliders first.
@@ -210,11 +254,14 @@ private:
     int dirtyFlag_;
     bool frustum_flag_;
     bool occlusion_flag_;
+    float lod_bias_;
     bool pick_visible_;
     std::mutex collider_mutex_;
     std::vector<Light*> lightList;
     std::vector<Component*> allColliders;
     std::vector<Component*> visibleColliders;
+    ColliderTree collider_tree_;
+    unsigned int visible_stamp_;
     bool is_shadowmap_invalid;
 };
 
@@ -54,6 +54,10 @@ extern "C" {
     Java_org_gearvrf_NativeScene_setOcclusionQuery(JNIEnv * env,
             jobject obj, jlong jscene, jboolean flag);
 
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeScene_setLODBias(JNIEnv * env,
+            jobject obj, jlong jscene, jfloat bias);
+
     JNIEXPORT void JNICALL
     Java_org_gearvrf_NativeScene_resetStats(JNIEnv * env,
             jobject obj, jlong jscene);
@@ -70,6 +74,10 @@ extern "C" {
     Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
             jobject obj, jlong jscene);
 
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeScene_getNumberLODTriangles(JNIEnv * env,
+            jobject obj, jlong jscene, jint level);
+
     JNIEXPORT jboolean JNICALL
     Java_org_gearvrf_NativeScene_addLight(
             JNIEnv * env, jobject obj, jlong jscene, jlong light);
@@ -171,6 +179,13 @@ Java_org_gearvrf_NativeScene_setOcclusionQuery(JNIEnv * env,
     scene->set_occlusion_culling(static_cast<bool>(flag));
 }
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setLODBias(JNIEnv * env,
+        jobject obj, jlong jscene, jfloat bias) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_lod_bias(bias);
+}
+
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_resetStats(JNIEnv * env,
         jobject obj, jlong jscene) {
@@ -194,6 +209,13 @@ Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
     return scene->getNumberTriangles();
 }
 
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getNumberLODTriangles(JNIEnv * env,
+        jobject obj, jlong jscene, jint level) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getNumberLODTriangles(level);
+}
+
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_exportToFile(JNIEnv * env,
         jobject obj, jlong jscene, jstring filepath) {
@@ -23,6 +23,7 @@
 #include "objects/components/camera_rig.h"
 #include "objects/components/collider_group.h"
 #include "objects/components/render_data.h"
+#include "engine/picker/pick_volume.h"
 #include "util/gvr_log.h"
 #include "mesh.h"
 #include "scene.h"
@@ -254,7 +255,13 @@ void SceneObject::removeChildObject(SceneObject* child) {
 }
 
 void SceneObject::onTransformChanged() {
+    Collider* collider = static_cast<Collider*>(getComponent(Collider::getComponentType()));
+
     setTransformDirty();
+    if (collider)
+    {
+        collider->markBoundsDirty();
+    }
     if (getChildrenCount() > 0)
     {
         std::lock_guard<std::mutex> lock(children_mutex_);
@@ -391,83 +398,72 @@ bool SceneObject::isColliding(SceneObject *scene_object) {
 
 /**
  * Test the input ray against the scene objects HBV.
- *
- * This method uses the algorithm described in the paper:
- *
- * An Efficient and Robust Ray–Box Intersection Algorithm by
- * Amy Williams, Steve Barrus, R. Keith Morley and Peter Shirley.
- *
- * http://people.csail.mit.edu/amy/papers/box-jgt.pdf
  */
 bool SceneObject::intersectsBoundingVolume(float rox, float roy, float roz,
         float rdx, float rdy, float rdz) {
-    BoundingVolume bounding_volume_ = getBoundingVolume();
-
-    float tmin, tmax, tymin, tymax, tzmin, tzmax;
-
-    int sign[3];
-    glm::vec3 invdir;
-    invdir.x = 1 / rdx;
-    invdir.y = 1 / rdy;
-    invdir.z = 1 / rdz;
-    sign[0] = (invdir.x < 0);
-    sign[1] = (invdir.y < 0);
-    sign[2] = (invdir.z < 0);
-
-    glm::vec3 bounds[2];
-    bounds[0] = bounding_volume_.min_corner();
-    bounds[1] = bounding_volume_.max_corner();
-
-    tmin = (bounds[sign[0]].x - rox) * invdir.x;
-    tmax = (bounds[1 - sign[0]].x - rox) * invdir.x;
-    tymin = (bounds[sign[1]].y - roy) * invdir.y;
-    tymax = (bounds[1 - sign[1]].y - roy) * invdir.y;
-
-    if ((tmin > tymax) || (tymin > tmax))
-        return false;
-
-    if (tymin > tmin)
-        tmin = tymin;
-    if (tymax < tmax)
-        tmax = tymax;
-
-    tzmin = (bounds[sign[2]].z - roz) * invdir.z;
-    tzmax = (bounds[1 - sign[2]].z - roz) * invdir.z;
-
-    if ((tmin > tzmax) || (tzmin > tmax))
-        return false;
-
-    if (tzmin > tmin)
-        tmin = tzmin;
-    if (tzmax < tmax)
-        tmax = tzmax;
+    const BoundingVolume& bv = getBoundingVolume();
 
-    if (tmin < 0 && tmax < 0) {
-        return false;
-    }
-
-    return true;
+    return PickVolume::rayHitsBox(glm::vec3(rox, roy, roz), glm::vec3(rdx, rdy, rdz),
+                                  bv.min_corner(), bv.max_corner());
 }
 
 /**
  * Test this scene object's HBV against the HBV of the provided scene object.
  */
 bool SceneObject::intersectsBoundingVolume(SceneObject *scene_object) {
-    BoundingVolume this_bounding_volume_ = getBoundingVolume();
-    BoundingVolume that_bounding_volume = scene_object->getBoundingVolume();
+    const BoundingVolume& this_bv = getBoundingVolume();
+    const BoundingVolume& that_bv = scene_object->getBoundingVolume();
 
-    glm::vec3 this_min_corner = this_bounding_volume_.min_corner();
-    glm::vec3 this_max_corner = this_bounding_volume_.max_corner();
+    return PickVolume::boxesOverlap(this_bv.min_corner(), this_bv.max_corner(),
+                                    that_bv.min_corner(), that_bv.max_corner());
+}
 
-    glm::vec3 that_min_corner = that_bounding_volume.min_corner();
-    glm::vec3 that_max_corner = that_bounding_volume.max_corner();
+/**
+ * Collect the colliders of this object and its descendants
+ * whose HBV overlaps the volume. The HBV of an object contains
+ * all its descendants so a subtree outside the volume is skipped
+ * and a subtree inside the volume is not tested any further.
+ * An empty HBV, as for an object with a collider and no render
+ * data, says nothing: the collider bounds are tested instead
+ * and the children are always visited.
+ */
+void SceneObject::getCollidersInVolume(const PickVolume& volume, std::vector<Collider*>& colliders,
+                                       bool inside) {
+    Collider* collider = static_cast<Collider*>(getComponent(Collider::getComponentType()));
+
+    if (!inside) {
+        const BoundingVolume& bv = getBoundingVolume();
+        const glm::vec3& min_corner = bv.min_corner();
+        const glm::vec3& max_corner = bv.max_corner();
+
+        if (glm::any(glm::greaterThan(min_corner, max_corner))) {
+            glm::vec3 collider_min;
+            glm::vec3 collider_max;
+
+            if (collider && (!collider->getWorldBounds(collider_min, collider_max) ||
+                             (volume.classify(collider_min, collider_max) != PickVolume::OUTSIDE))) {
+                colliders.push_back(collider);
+            }
+            std::lock_guard < std::mutex > lock(children_mutex_);
+            for (auto it = children_.begin(); it != children_.end(); ++it) {
+                (*it)->getCollidersInVolume(volume, colliders, false);
+            }
+            return;
+        }
+        int result = volume.classify(min_corner, max_corner);
 
-    return  (this_max_corner.x >= that_min_corner.x) &&
-            (this_max_corner.y >= that_min_corner.y) &&
-            (this_max_corner.z >= that_min_corner.z) &&
-            (this_min_corner.x <= that_max_corner.x) &&
-            (this_min_corner.y <= that_max_corner.y) &&
-            (this_min_corner.z <= that_max_corner.z);
+        if (result == PickVolume::OUTSIDE) {
+            return;
+        }
+        inside = (result == PickVolume::INSIDE);
+    }
+    if (collider) {
+        colliders.push_back(collider);
+    }
+    std::lock_guard < std::mutex > lock(children_mutex_);
+    for (auto it = children_.begin(); it != children_.end(); ++it) {
+        (*it)->getCollidersInVolume(volume, colliders, inside);
+    }
 }
 
 
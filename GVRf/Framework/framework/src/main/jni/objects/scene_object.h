@@ -34,6 +34,8 @@
 #include "util/gvr_gl.h"
 
 namespace gvr {
+class Collider;
+class PickVolume;
 class Camera;
 class CameraRig;
 
@@ -145,6 +147,8 @@ public:
     bool intersectsBoundingVolume(float rox, float roy, float roz, float rdx,
             float rdy, float rdz);
     bool intersectsBoundingVolume(SceneObject *scene_object);
+    void getCollidersInVolume(const PickVolume& volume, std::vector<Collider*>& colliders,
+                              bool inside = false);
 
     void dirtyHierarchicalBoundingVolume();
     BoundingVolume& getBoundingVolume();
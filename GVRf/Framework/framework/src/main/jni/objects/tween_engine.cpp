@@ -0,0 +1,418 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Tweens of transform and material properties.
+ ***************************************************************************/
+
+#include <math.h>
+
+#include "objects/tween_engine.h"
+#include "objects/shader_data.h"
+#include "objects/components/transform.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+TweenEngine::TweenEngine() : HybridObject(), num_tweens_(0) {
+}
+
+TweenEngine::Batch& TweenEngine::findBatch(int property, int curve, const char* uniform,
+                                           int num_components) {
+    for (auto it = batches_.begin(); it != batches_.end(); ++it) {
+        if ((it->property == property) && (it->curve == curve) &&
+            (it->num_components == num_components) && (it->uniform == uniform)) {
+            return *it;
+        }
+    }
+    batches_.push_back(Batch());
+
+    Batch& batch = batches_.back();
+    batch.property = property;
+    batch.curve = curve;
+    batch.uniform = uniform;
+    batch.num_components = num_components;
+    return batch;
+}
+
+int TweenEngine::addTarget(Transform* transform) {
+    auto it = target_index_.find(transform);
+    int target;
+
+    if (it != target_index_.end()) {
+        targets_[it->second].refs++;
+        return it->second;
+    }
+    if (free_targets_.empty()) {
+        target = targets_.size();
+        targets_.push_back(Target());
+    } else {
+        target = free_targets_.back();
+        free_targets_.pop_back();
+    }
+    targets_[target].transform = transform;
+    targets_[target].refs = 1;
+    targets_[target].touched = false;
+    target_index_[transform] = target;
+    return target;
+}
+
+void TweenEngine::releaseTarget(int target) {
+    Target& t = targets_[target];
+
+    if (--t.refs == 0) {
+        target_index_.erase(t.transform);
+        t.transform = nullptr;
+        free_targets_.push_back(target);
+    }
+}
+
+int TweenEngine::addTween(Batch& batch, const float* start, const float* end,
+                          float duration, int repeat_mode, int repeat_count) {
+    int id;
+
+    if (free_ids_.empty()) {
+        id = tweens_.size();
+        tweens_.push_back(TweenRef());
+    } else {
+        id = free_ids_.back();
+        free_ids_.pop_back();
+    }
+    tweens_[id].batch = &batch - batches_.data();
+    tweens_[id].index = batch.size();
+    batch.ids.push_back(id);
+    batch.elapsed.push_back(0);
+    batch.durations.push_back(duration);
+    batch.repeat_modes.push_back(repeat_mode);
+    batch.repeats_left.push_back(repeat_count);
+    batch.cycles.push_back(0);
+    batch.ratios.push_back(0);
+    batch.finished.push_back(false);
+    for (int c = 0; c < batch.num_components; ++c) {
+        batch.start[c].push_back(start[c]);
+        batch.end[c].push_back(end[c]);
+    }
+    ++num_tweens_;
+    return id;
+}
+
+int TweenEngine::addTransformTween(int property, Transform* transform, const float* end,
+                                   float duration, int curve, int repeat_mode,
+                                   int repeat_count) {
+    std::lock_guard<std::mutex> lock(lock_);
+    glm::vec3 position, scale;
+    glm::quat rotation;
+    float start[4];
+    float rotation_end[4];
+
+    if ((transform == nullptr) || (property < POSITION) || (property > SCALE) ||
+        (curve < LINEAR) || (curve > EASE_IN_OUT) ||
+        (repeat_mode < ONCE) || (repeat_mode > PINGPONG)) {
+        return -1;
+    }
+    transform->getPose(position, rotation, scale);
+    switch (property) {
+    case POSITION:
+        start[0] = position.x; start[1] = position.y; start[2] = position.z;
+        break;
+
+    case SCALE:
+        start[0] = scale.x; start[1] = scale.y; start[2] = scale.z;
+        break;
+
+    case ROTATION: {
+        glm::quat q = glm::normalize(glm::quat(end[0], end[1], end[2], end[3]));
+
+        start[0] = rotation.w; start[1] = rotation.x; start[2] = rotation.y; start[3] = rotation.z;
+        rotation_end[0] = q.w; rotation_end[1] = q.x; rotation_end[2] = q.y; rotation_end[3] = q.z;
+        end = rotation_end;
+        break;
+    }
+    }
+
+    Batch& batch = findBatch(property, curve, "", (property == ROTATION) ? 4 : 3);
+    int id = addTween(batch, start, end, duration, repeat_mode, repeat_count);
+
+    batch.targets.push_back(addTarget(transform));
+    batch.materials.push_back(nullptr);
+    return id;
+}
+
+int TweenEngine::addUniformTween(ShaderData* material, const char* name, const float* end,
+                                 int num_components, float duration, int curve,
+                                 int repeat_mode, int repeat_count) {
+    std::lock_guard<std::mutex> lock(lock_);
+    float start[4];
+
+    if ((material == nullptr) || (name == nullptr) ||
+        (num_components < 1) || (num_components > 4) ||
+        (curve < LINEAR) || (curve > EASE_IN_OUT) ||
+        (repeat_mode < ONCE) || (repeat_mode > PINGPONG)) {
+        return -1;
+    }
+    if (!material->getFloatVec(name, start, num_components)) {
+        LOGE("TweenEngine: material has no uniform %s with %d floats", name, num_components);
+        return -1;
+    }
+
+    Batch& batch = findBatch(UNIFORM, curve, name, num_components);
+    int id = addTween(batch, start, end, duration, repeat_mode, repeat_count);
+
+    batch.targets.push_back(-1);
+    batch.materials.push_back(material);
+    return id;
+}
+
+/*
+ * Move the last tween of a batch in place of the removed one.
+ */
+void TweenEngine::removeTween(int b, int index) {
+    Batch& batch = batches_[b];
+    int last = batch.size() - 1;
+    int id = batch.ids[index];
+
+    if (batch.targets[index] >= 0) {
+        releaseTarget(batch.targets[index]);
+    }
+    tweens_[id].batch = -1;
+    free_ids_.push_back(id);
+    --num_tweens_;
+    if (index != last) {
+        tweens_[batch.ids[last]].index = index;
+        batch.ids[index] = batch.ids[last];
+        batch.targets[index] = batch.targets[last];
+        batch.materials[index] = batch.materials[last];
+        batch.elapsed[index] = batch.elapsed[last];
+        batch.durations[index] = batch.durations[last];
+        batch.repeat_modes[index] = batch.repeat_modes[last];
+        batch.repeats_left[index] = batch.repeats_left[last];
+        batch.cycles[index] = batch.cycles[last];
+        batch.ratios[index] = batch.ratios[last];
+        batch.finished[index] = batch.finished[last];
+        for (int c = 0; c < batch.num_components; ++c) {
+            batch.start[c][index] = batch.start[c][last];
+            batch.end[c][index] = batch.end[c][last];
+        }
+    }
+    batch.ids.pop_back();
+    batch.targets.pop_back();
+    batch.materials.pop_back();
+    batch.elapsed.pop_back();
+    batch.durations.pop_back();
+    batch.repeat_modes.pop_back();
+    batch.repeats_left.pop_back();
+    batch.cycles.pop_back();
+    batch.ratios.pop_back();
+    batch.finished.pop_back();
+    for (int c = 0; c < batch.num_components; ++c) {
+        batch.start[c].pop_back();
+        batch.end[c].pop_back();
+    }
+}
+
+bool TweenEngine::stop(int id) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if ((id < 0) || (id >= (int) tweens_.size()) || (tweens_[id].batch < 0)) {
+        return false;
+    }
+    removeTween(tweens_[id].batch, tweens_[id].index);
+    return true;
+}
+
+bool TweenEngine::isRunning(int id) {
+    std::lock_guard<std::mutex> lock(lock_);
+    return (id >= 0) && (id < (int) tweens_.size()) && (tweens_[id].batch >= 0);
+}
+
+/*
+ * Advance the time of the tweens of a batch and compute
+ * their linear ratio. Tweens going backwards in a ping
+ * pong cycle get a decreasing ratio.
+ */
+void TweenEngine::advance(Batch& batch, float frame_time) {
+    int n = batch.size();
+
+    for (int i = 0; i < n; ++i) {
+        float duration = batch.durations[i];
+        float elapsed = batch.elapsed[i] + frame_time;
+        int mode = batch.repeat_modes[i];
+
+        batch.finished[i] = false;
+        if ((elapsed < duration) && (duration > 0)) {
+            float ratio = elapsed / duration;
+
+            batch.elapsed[i] = elapsed;
+            batch.ratios[i] = ((mode == PINGPONG) && (batch.cycles[i] & 1)) ? 1 - ratio : ratio;
+            continue;
+        }
+        if ((mode == ONCE) || (duration <= 0)) {
+            batch.cycles[i] = 1;
+            batch.ratios[i] = 1;
+            batch.finished[i] = true;
+        } else {
+            int completed = (int) (elapsed / duration);
+
+            elapsed -= completed * duration;
+            while ((completed-- > 0) && !batch.finished[i]) {
+                batch.cycles[i]++;
+                if ((batch.repeats_left[i] > 0) && (--batch.repeats_left[i] == 0)) {
+                    batch.finished[i] = true;
+                }
+            }
+            if (batch.finished[i]) {
+                bool backwards = (mode == PINGPONG) && ((batch.cycles[i] - 1) & 1);
+                batch.ratios[i] = backwards ? 0 : 1;
+            } else {
+                float ratio = elapsed / duration;
+                batch.elapsed[i] = elapsed;
+                batch.ratios[i] = ((mode == PINGPONG) && (batch.cycles[i] & 1)) ? 1 - ratio : ratio;
+                events_.push_back(batch.ids[i]);
+                events_.push_back(REPEATED_CYCLE);
+                events_.push_back(batch.cycles[i]);
+                continue;
+            }
+        }
+        events_.push_back(batch.ids[i]);
+        events_.push_back(FINISHED);
+        events_.push_back(batch.cycles[i]);
+    }
+}
+
+void TweenEngine::applyCurve(Batch& batch) {
+    float* ratios = batch.ratios.data();
+    int n = batch.size();
+
+    switch (batch.curve) {
+    case EASE_IN:
+        for (int i = 0; i < n; ++i) {
+            ratios[i] = ratios[i] * ratios[i];
+        }
+        break;
+
+    case EASE_OUT:
+        for (int i = 0; i < n; ++i) {
+            ratios[i] = ratios[i] * (2 - ratios[i]);
+        }
+        break;
+
+    case EASE_IN_OUT:
+        // same as GVRAccelerateDecelerateInterpolator
+        for (int i = 0; i < n; ++i) {
+            ratios[i] = 0.5f - 0.5f * cosf(ratios[i] * (float) M_PI);
+        }
+        break;
+    }
+}
+
+/*
+ * Interpolate the tweens of a transform batch into the
+ * pose of their targets. The targets are written once
+ * all the batches are done.
+ */
+void TweenEngine::writeTransforms(Batch& batch) {
+    const float* ratios = batch.ratios.data();
+    int n = batch.size();
+
+    for (int i = 0; i < n; ++i) {
+        Target& target = targets_[batch.targets[i]];
+        float r = ratios[i];
+
+        if (!target.touched) {
+            target.transform->getPose(target.position, target.rotation, target.scale);
+            target.touched = true;
+            touched_.push_back(batch.targets[i]);
+        }
+        switch (batch.property) {
+        case POSITION:
+            for (int c = 0; c < 3; ++c) {
+                target.position[c] = batch.start[c][i] + (batch.end[c][i] - batch.start[c][i]) * r;
+            }
+            break;
+
+        case SCALE:
+            for (int c = 0; c < 3; ++c) {
+                target.scale[c] = batch.start[c][i] + (batch.end[c][i] - batch.start[c][i]) * r;
+            }
+            break;
+
+        case ROTATION:
+            target.rotation = glm::slerp(
+                    glm::quat(batch.start[0][i], batch.start[1][i], batch.start[2][i], batch.start[3][i]),
+                    glm::quat(batch.end[0][i], batch.end[1][i], batch.end[2][i], batch.end[3][i]), r);
+            break;
+        }
+    }
+}
+
+void TweenEngine::writeUniforms(Batch& batch) {
+    const float* ratios = batch.ratios.data();
+    const char* name = batch.uniform.c_str();
+    int n = batch.size();
+
+    for (int i = 0; i < n; ++i) {
+        float value[4];
+
+        for (int c = 0; c < batch.num_components; ++c) {
+            value[c] = batch.start[c][i] + (batch.end[c][i] - batch.start[c][i]) * ratios[i];
+        }
+        if (batch.num_components == 1) {
+            batch.materials[i]->setFloat(name, value[0]);
+        } else {
+            batch.materials[i]->setFloatVec(name, value, batch.num_components);
+        }
+    }
+}
+
+int TweenEngine::step(float frame_time) {
+    std::lock_guard<std::mutex> lock(lock_);
+
+    events_.clear();
+    for (auto it = batches_.begin(); it != batches_.end(); ++it) {
+        if (it->size() == 0) {
+            continue;
+        }
+        advance(*it, frame_time);
+        applyCurve(*it);
+        if (it->property == UNIFORM) {
+            writeUniforms(*it);
+        } else {
+            writeTransforms(*it);
+        }
+    }
+
+    // one change notification per transform
+    for (auto it = touched_.begin(); it != touched_.end(); ++it) {
+        Target& target = targets_[*it];
+
+        target.transform->setPose(target.position, target.rotation, target.scale);
+        target.touched = false;
+    }
+    touched_.clear();
+
+    for (int b = 0; b < (int) batches_.size(); ++b) {
+        Batch& batch = batches_[b];
+
+        for (int i = batch.size() - 1; i >= 0; --i) {
+            if (batch.finished[i]) {
+                removeTween(b, i);
+            }
+        }
+    }
+    return events_.size() / EVENT_SIZE;
+}
+
+}
@@ -0,0 +1,189 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Tweens of transform and material properties.
+ ***************************************************************************/
+
+#ifndef TWEEN_ENGINE_H_
+#define TWEEN_ENGINE_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "objects/hybrid_object.h"
+
+namespace gvr {
+class ShaderData;
+class Transform;
+
+/*
+ * Runs many simple animations of one property from its
+ * current value to an end value.
+ *
+ * Tweens are kept in batches of the same property and
+ * curve with one array per field, so a frame is a few
+ * tight loops per batch instead of one call per tween.
+ * All the tweens of a transform are written to it with
+ * one change notification. Material tweens set uniforms
+ * by name.
+ *
+ * Finished and repeated tweens are reported as events
+ * which the caller collects once per frame.
+ */
+class TweenEngine: public HybridObject {
+public:
+    enum Property {
+        POSITION = 0,
+        ROTATION = 1,       // quaternion as w, x, y, z
+        SCALE = 2,
+        UNIFORM = 3         // float uniform of one to four components
+    };
+
+    enum Curve {
+        LINEAR = 0,
+        EASE_IN = 1,
+        EASE_OUT = 2,
+        EASE_IN_OUT = 3
+    };
+
+    // Same values as GVRRepeatMode
+    enum RepeatMode {
+        ONCE = 0,
+        REPEATED = 1,
+        PINGPONG = 2
+    };
+
+    enum EventType {
+        FINISHED = 0,
+        REPEATED_CYCLE = 1
+    };
+
+    // Size in ints of an event: tween, type, completed cycles
+    static const int EVENT_SIZE = 3;
+
+    TweenEngine();
+    virtual ~TweenEngine() { }
+
+    /*
+     * Start a transform tween from the current value.
+     * @param end           end value, 3 floats or 4 for rotations
+     * @param repeat_count  cycles for REPEATED and PINGPONG, negative to loop
+     * @returns id of the tween or -1 if the arguments are invalid
+     */
+    int addTransformTween(int property, Transform* transform, const float* end,
+                          float duration, int curve, int repeat_mode, int repeat_count);
+
+    /*
+     * Start a tween of a float uniform of a material from its current value.
+     * @returns id of the tween or -1 if the material has no such uniform
+     */
+    int addUniformTween(ShaderData* material, const char* name, const float* end,
+                        int num_components, float duration, int curve,
+                        int repeat_mode, int repeat_count);
+
+    /*
+     * Stop a tween, leaving its property at its current value.
+     * Ids of stopped and finished tweens are reused.
+     */
+    bool stop(int id);
+    bool isRunning(int id);
+    int getTweenCount() const { return num_tweens_; }
+
+    /*
+     * Advance all the tweens by the frame time and write their values.
+     * @returns number of events, read them with getEvents
+     */
+    int step(float frame_time);
+
+    /*
+     * Events of the last step, EVENT_SIZE ints each.
+     */
+    const std::vector<int>& getEvents() const { return events_; }
+
+private:
+    // Tweens of one property and curve, one array per field
+    struct Batch {
+        int                         property;
+        int                         curve;
+        std::string                 uniform;
+        int                         num_components;
+        std::vector<int>            ids;
+        std::vector<int>            targets;        // index in targets_ or -1
+        std::vector<ShaderData*>    materials;
+        std::vector<float>          elapsed;
+        std::vector<float>          durations;
+        std::vector<int>            repeat_modes;
+        std::vector<int>            repeats_left;   // negative to loop
+        std::vector<int>            cycles;         // completed so far
+        std::vector<float>          start[4];
+        std::vector<float>          end[4];
+        std::vector<float>          ratios;         // of the current step
+        std::vector<char>           finished;       // in the current step
+
+        int size() const { return ids.size(); }
+    };
+
+    // Transform pose collected from all its tweens during a step
+    struct Target {
+        Transform*  transform;
+        int         refs;
+        bool        touched;
+        glm::vec3   position;
+        glm::quat   rotation;
+        glm::vec3   scale;
+    };
+
+    struct TweenRef {
+        int batch;          // -1 if the id is free
+        int index;
+    };
+
+    TweenEngine(const TweenEngine& engine);
+    TweenEngine(TweenEngine&& engine);
+    TweenEngine& operator=(const TweenEngine& engine);
+    TweenEngine& operator=(TweenEngine&& engine);
+
+    Batch& findBatch(int property, int curve, const char* uniform, int num_components);
+    int addTarget(Transform* transform);
+    void releaseTarget(int target);
+    int addTween(Batch& batch, const float* start, const float* end, float duration,
+                 int repeat_mode, int repeat_count);
+    void removeTween(int batch, int index);
+    void advance(Batch& batch, float frame_time);
+    static void applyCurve(Batch& batch);
+    void writeTransforms(Batch& batch);
+    void writeUniforms(Batch& batch);
+
+    std::mutex              lock_;
+    std::vector<Batch>      batches_;
+    std::vector<Target>     targets_;
+    std::vector<int>        free_targets_;
+    std::unordered_map<Transform*, int> target_index_;
+    std::vector<TweenRef>   tweens_;            // indexed by id
+    std::vector<int>        free_ids_;
+    std::vector<int>        touched_;           // targets written in this step
+    std::vector<int>        events_;
+    int                     num_tweens_;
+};
+
+}
+#endif
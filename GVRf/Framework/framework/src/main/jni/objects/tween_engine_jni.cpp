@@ -0,0 +1,142 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "objects/tween_engine.h"
+#include "objects/shader_data.h"
+#include "objects/components/transform.h"
+#include "util/gvr_jni.h"
+
+namespace gvr {
+extern "C"
+{
+    JNIEXPORT jlong JNICALL
+    Java_org_gearvrf_NativeTweenEngine_ctor(JNIEnv * env, jobject obj);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeTweenEngine_addTransformTween(JNIEnv * env,
+            jobject obj, jlong jengine, jint property, jlong jtransform,
+            jfloatArray jend, jfloat duration, jint curve, jint repeat_mode,
+            jint repeat_count);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeTweenEngine_addUniformTween(JNIEnv * env,
+            jobject obj, jlong jengine, jlong jmaterial, jstring jname,
+            jfloatArray jend, jfloat duration, jint curve, jint repeat_mode,
+            jint repeat_count);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeTweenEngine_stop(JNIEnv * env,
+            jobject obj, jlong jengine, jint id);
+
+    JNIEXPORT jboolean JNICALL
+    Java_org_gearvrf_NativeTweenEngine_isRunning(JNIEnv * env,
+            jobject obj, jlong jengine, jint id);
+
+    JNIEXPORT jint JNICALL
+    Java_org_gearvrf_NativeTweenEngine_step(JNIEnv * env,
+            jobject obj, jlong jengine, jfloat frame_time);
+
+    JNIEXPORT void JNICALL
+    Java_org_gearvrf_NativeTweenEngine_getEvents(JNIEnv * env,
+            jobject obj, jlong jengine, jintArray jevents);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_gearvrf_NativeTweenEngine_ctor(JNIEnv * env, jobject obj)
+{
+    return reinterpret_cast<jlong>(new TweenEngine());
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeTweenEngine_addTransformTween(JNIEnv * env,
+        jobject obj, jlong jengine, jint property, jlong jtransform,
+        jfloatArray jend, jfloat duration, jint curve, jint repeat_mode,
+        jint repeat_count)
+{
+    TweenEngine* engine = reinterpret_cast<TweenEngine*>(jengine);
+    Transform* transform = reinterpret_cast<Transform*>(jtransform);
+    int num_components = (property == TweenEngine::ROTATION) ? 4 : 3;
+
+    if (env->GetArrayLength(jend) < num_components)
+    {
+        return -1;
+    }
+    jfloat* end = env->GetFloatArrayElements(jend, 0);
+    int id = engine->addTransformTween(property, transform, end, duration, curve,
+                                       repeat_mode, repeat_count);
+
+    env->ReleaseFloatArrayElements(jend, end, JNI_ABORT);
+    return id;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeTweenEngine_addUniformTween(JNIEnv * env,
+        jobject obj, jlong jengine, jlong jmaterial, jstring jname,
+        jfloatArray jend, jfloat duration, jint curve, jint repeat_mode,
+        jint repeat_count)
+{
+    TweenEngine* engine = reinterpret_cast<TweenEngine*>(jengine);
+    ShaderData* material = reinterpret_cast<ShaderData*>(jmaterial);
+    const char* name = env->GetStringUTFChars(jname, 0);
+    jfloat* end = env->GetFloatArrayElements(jend, 0);
+    int id = engine->addUniformTween(material, name, end, env->GetArrayLength(jend),
+                                     duration, curve, repeat_mode, repeat_count);
+
+    env->ReleaseFloatArrayElements(jend, end, JNI_ABORT);
+    env->ReleaseStringUTFChars(jname, name);
+    return id;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeTweenEngine_stop(JNIEnv * env,
+        jobject obj, jlong jengine, jint id)
+{
+    TweenEngine* engine = reinterpret_cast<TweenEngine*>(jengine);
+    return engine->stop(id);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeTweenEngine_isRunning(JNIEnv * env,
+        jobject obj, jlong jengine, jint id)
+{
+    TweenEngine* engine = reinterpret_cast<TweenEngine*>(jengine);
+    return engine->isRunning(id);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_gearvrf_NativeTweenEngine_step(JNIEnv * env,
+        jobject obj, jlong jengine, jfloat frame_time)
+{
+    TweenEngine* engine = reinterpret_cast<TweenEngine*>(jengine);
+    return engine->step(frame_time);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeTweenEngine_getEvents(JNIEnv * env,
+        jobject obj, jlong jengine, jintArray jevents)
+{
+    TweenEngine* engine = reinterpret_cast<TweenEngine*>(jengine);
+    const std::vector<int>& events = engine->getEvents();
+    int size = std::min((int) events.size(), (int) env->GetArrayLength(jevents));
+
+    env->SetIntArrayRegion(jevents, 0, size, events.data());
+}
+
+}
@@ -302,6 +302,18 @@ namespace gvr
          */
         virtual bool updateGPU(Renderer *) = 0;
 
+        /**
+         * Copy a range of elements from the CPU into the GPU.
+         * Renderers which cannot update part of a buffer
+         * copy the whole block.
+         * @param firstElem index of the first element to copy
+         * @param numElems  number of elements to copy
+         */
+        virtual bool updateGPU(Renderer* renderer, int firstElem, int numElems)
+        {
+            return updateGPU(renderer);
+        }
+
         /**
          * Bind the uniform block to a shader
          */
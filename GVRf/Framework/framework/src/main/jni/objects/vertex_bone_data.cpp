@@ -6,6 +6,8 @@
 #include "scene.h"
 #include "objects/vertex_bone_data.h"
 #include "objects/components/bone.h"
+#include "objects/uniform_block.h"
+#include "engine/renderer/renderer.h"
 #include "util/gvr_log.h"
 
 #define TOL 1e-6
@@ -14,10 +16,16 @@ namespace gvr {
 
 VertexBoneData::VertexBoneData()
 : bones(),
-  boneMatrices()
+  boneMatrices(),
+  palette_(nullptr),
+  palette_rows_()
 {
 }
 
+VertexBoneData::~VertexBoneData() {
+    delete palette_;
+}
+
 void VertexBoneData::setBones(std::vector<Bone*>&& bonesVec) {
     bones = std::move(bonesVec);
 
@@ -31,6 +39,59 @@ void VertexBoneData::setBones(std::vector<Bone*>&& bonesVec) {
     for (auto it = bones.begin(); it != bones.end(); ++it, ++itMat) {
         (*it)->setFinalTransformMatrixPtr(&*itMat);
     }
+    palette_rows_.clear();
+}
+
+UniformBlock* VertexBoneData::updatePalette(Renderer* renderer) {
+    int numBones = boneMatrices.size();
+
+    if (numBones > MAX_BONES) {
+        LOGE("VertexBoneData: %d bones, only the first %d are skinned", numBones, MAX_BONES);
+        numBones = MAX_BONES;
+    }
+    if (palette_ == nullptr) {
+        palette_ = renderer->createUniformBlock("float4 u_bone_matrix", BONES_UBO_INDEX,
+                                                "Bones_ubo", MAX_BONES * BONE_PALETTE_ROWS);
+    }
+    int numRows = numBones * BONE_PALETTE_ROWS;
+    bool resized = (int) palette_rows_.size() != numRows;
+
+    if (resized) {
+        palette_rows_.resize(numRows);
+        palette_->setNumElems(numRows);
+    }
+
+    /*
+     * Row r of the palette entry is row r of the matrix,
+     * the last row of an affine matrix is always 0, 0, 0, 1.
+     */
+    int first = numBones;
+    int last = -1;
+    glm::vec4 rows[BONE_PALETTE_ROWS];
+
+    for (int b = 0; b < numBones; ++b) {
+        const glm::mat4& m = boneMatrices[b];
+        glm::vec4* dst = &palette_rows_[b * BONE_PALETTE_ROWS];
+
+        for (int r = 0; r < BONE_PALETTE_ROWS; ++r) {
+            rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+        }
+        if (resized || memcmp(dst, rows, sizeof(rows))) {
+            memcpy(dst, rows, sizeof(rows));
+            if (b < first) {
+                first = b;
+            }
+            last = b;
+        }
+    }
+    if (last >= first) {
+        int start = first * BONE_PALETTE_ROWS;
+        int count = (last - first + 1) * BONE_PALETTE_ROWS;
+
+        palette_->setRange(start, &palette_rows_[start], count);
+        palette_->updateGPU(renderer, start, count);
+    }
+    return palette_;
 }
 
 } // namespace gvr
@@ -31,20 +31,42 @@
 #include "glm/geometric.hpp"
 #include "util/gvr_log.h"
 
-#define MAX_BONES 60
+#define MAX_BONES 256
 #define BONES_PER_VERTEX 4
+#define BONE_PALETTE_ROWS 3
 
 namespace gvr {
 class Bone;
+class Renderer;
+class UniformBlock;
+
+/*
+ * Bones of a skinned mesh and their matrices.
+ *
+ * The bone matrices are sent to the shaders as a palette
+ * of 3x4 matrices, the top three rows of each matrix, so
+ * that MAX_BONES of them fit in a uniform block. The
+ * palette belongs to the mesh and is shared by all the
+ * render data which use it. Separate meshes skinned to
+ * the same skeleton each have their own palette. Only the
+ * bones which changed since the last update are copied
+ * to the GPU.
+ */
 class VertexBoneData {
 public:
     VertexBoneData();
+    ~VertexBoneData();
+
     void setBones(std::vector<Bone*>&& bonesVec);
 
     int getNumBones() const {
         return bones.size();
     }
 
+    Bone* getBone(int boneId) const {
+        return bones[boneId];
+    }
+
     glm::mat4 getFinalBoneTransform(int boneId) {
         return boneMatrices[boneId];
     }
@@ -57,12 +79,26 @@ public:
         boneMatrices[boneId] = transform;
     }
 
+    /*
+     * Pack the bone matrices into the palette and copy
+     * the bones which changed to the GPU.
+     * @returns the palette uniform block
+     */
+    UniformBlock* updatePalette(Renderer* renderer);
+
 public:
     std::vector<glm::mat4>  boneMatrices;
 
 private:
+    VertexBoneData(const VertexBoneData& vbd);
+    VertexBoneData(VertexBoneData&& vbd);
+    VertexBoneData& operator=(const VertexBoneData& vbd);
+    VertexBoneData& operator=(VertexBoneData&& vbd);
+
     // Static bone data loaded from model
     std::vector<Bone*> bones;
+    UniformBlock*           palette_;
+    std::vector<glm::vec4>  palette_rows_;  // as last sent to the GPU
 };
 
 } // namespace gvr
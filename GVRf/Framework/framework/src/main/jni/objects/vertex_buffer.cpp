@@ -6,14 +6,216 @@
  ****/
 #include "vertex_buffer.h"
 #include "util/gvr_log.h"
+#include "glm/gtc/packing.hpp"
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
 
 namespace gvr {
 
+    /*
+     * Packed attributes use less than 32 bits per component.
+     */
+    static bool isPacked(const DataDescriptor::DataEntry& e)
+    {
+        return e.ComponentSize < 4;
+    }
+
+    /*
+     * Number of floats or integers in one vertex of an
+     * attribute as seen by the application.
+     * Octahedral unit vectors are presented as 3 floats.
+     */
+    static int getElementCount(const DataDescriptor::DataEntry& e)
+    {
+        if (!isPacked(e))
+        {
+            return e.Size / sizeof(float);
+        }
+        return (e.IsOctahedral ? 3 : e.ComponentCount) * e.Count;
+    }
+
+    static float signNotZero(float v)
+    {
+        return (v >= 0.0f) ? 1.0f : -1.0f;
+    }
+
+    /*
+     * Map a unit vector onto an octahedron unfolded into the [-1, 1] square.
+     */
+    static void encodeOctahedral(const float* n, float* oct)
+    {
+        float l1 = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+        float x = (l1 > 0.0f) ? n[0] / l1 : 0.0f;
+        float y = (l1 > 0.0f) ? n[1] / l1 : 0.0f;
+
+        if (n[2] < 0.0f)
+        {
+            oct[0] = (1.0f - fabsf(y)) * signNotZero(x);
+            oct[1] = (1.0f - fabsf(x)) * signNotZero(y);
+        }
+        else
+        {
+            oct[0] = x;
+            oct[1] = y;
+        }
+    }
+
+    static void decodeOctahedral(const float* oct, float* n)
+    {
+        float x = oct[0];
+        float y = oct[1];
+        float z = 1.0f - fabsf(x) - fabsf(y);
+        float fold = (z < 0.0f) ? -z : 0.0f;
+
+        x += (x >= 0.0f) ? -fold : fold;
+        y += (y >= 0.0f) ? -fold : fold;
+        float len = sqrtf(x * x + y * y + z * z);
+        if (len > 0.0f)
+        {
+            len = 1.0f / len;
+        }
+        n[0] = x * len;
+        n[1] = y * len;
+        n[2] = z * len;
+    }
+
+    static void packComponent(const DataDescriptor::DataEntry& e, float v, char* dest)
+    {
+        if (e.ComponentSize == 2)
+        {
+            uint16_t c;
+            if (e.IsInt)
+            {
+                c = (uint16_t) (int) v;
+            }
+            else if (!e.IsNormalized)
+            {
+                c = glm::packHalf1x16(v);
+            }
+            else
+            {
+                c = e.IsUnsigned ? glm::packUnorm1x16(v) : glm::packSnorm1x16(v);
+            }
+            memcpy(dest, &c, sizeof(c));
+        }
+        else
+        {
+            uint8_t c;
+            if (e.IsInt)
+            {
+                c = (uint8_t) (int) v;
+            }
+            else
+            {
+                c = e.IsUnsigned ? glm::packUnorm1x8(v) : glm::packSnorm1x8(v);
+            }
+            *dest = (char) c;
+        }
+    }
+
+    static float unpackComponent(const DataDescriptor::DataEntry& e, const char* src)
+    {
+        if (e.ComponentSize == 2)
+        {
+            uint16_t c;
+            memcpy(&c, src, sizeof(c));
+            if (e.IsInt)
+            {
+                return e.IsUnsigned ? (float) c : (float) (int16_t) c;
+            }
+            if (!e.IsNormalized)
+            {
+                return glm::unpackHalf1x16(c);
+            }
+            return e.IsUnsigned ? glm::unpackUnorm1x16(c) : glm::unpackSnorm1x16(c);
+        }
+        uint8_t c = (uint8_t) *src;
+        if (e.IsInt)
+        {
+            return e.IsUnsigned ? (float) c : (float) (int8_t) c;
+        }
+        return e.IsUnsigned ? glm::unpackUnorm1x8(c) : glm::unpackSnorm1x8(c);
+    }
+
+    /*
+     * Quantize the values for one vertex of a packed attribute.
+     * @param e     attribute to pack
+     * @param src   getElementCount(e) floats to pack
+     * @param dest  vertex data for the attribute
+     */
+    static void packElement(const DataDescriptor::DataEntry& e, const float* src, char* dest)
+    {
+        int elemSize = e.Size / e.Count;
+
+        for (int k = 0; k < e.Count; ++k)
+        {
+            float oct[2];
+            const float* v = src;
+
+            if (e.IsOctahedral)
+            {
+                encodeOctahedral(src, oct);
+                v = oct;
+                src += 3;
+            }
+            else
+            {
+                src += e.ComponentCount;
+            }
+            for (int j = 0; j < e.ComponentCount; ++j)
+            {
+                packComponent(e, v[j], dest + j * e.ComponentSize);
+            }
+            dest += elemSize;
+        }
+    }
+
+    static void unpackElement(const DataDescriptor::DataEntry& e, const char* src, float* dest)
+    {
+        int elemSize = e.Size / e.Count;
+
+        for (int k = 0; k < e.Count; ++k)
+        {
+            if (e.IsOctahedral)
+            {
+                float oct[2];
+                oct[0] = unpackComponent(e, src);
+                oct[1] = unpackComponent(e, src + e.ComponentSize);
+                decodeOctahedral(oct, dest);
+                dest += 3;
+            }
+            else
+            {
+                for (int j = 0; j < e.ComponentCount; ++j)
+                {
+                    *dest++ = unpackComponent(e, src + j * e.ComponentSize);
+                }
+            }
+            src += elemSize;
+        }
+    }
+
+    /*
+     * Change counts come from one counter shared by all the
+     * vertex buffers so they are never the same for two buffers.
+     */
+    unsigned int VertexBuffer::newChangeCount()
+    {
+        static std::atomic<unsigned int> counter(0);
+        return ++counter;
+    }
+
     VertexBuffer::VertexBuffer(const char* layout_desc, int vertexCount)
     : DataDescriptor(layout_desc),
       mVertexCount(0),
       mBoneFlags(0),
+      mChangeCount(newChangeCount()),
+      mDirtyBegin(0),
+      mDirtyEnd(0),
       mVertexData(NULL)
     {
         mVertexData = NULL;
@@ -35,16 +237,29 @@ namespace gvr {
     {
         const float* verts = getVertexData();
         int stride = getVertexSize();
+        const DataEntry* pos = find("a_position");
 
         bv.reset();
-        for (int i = 0; i < mVertexCount; ++i)
+        if ((pos != NULL) && isPacked(*pos))
+        {
+            for (int i = 0; i < mVertexCount; ++i)
+            {
+                float v[4];
+                unpackElement(*pos, mVertexData + i * getTotalSize() + pos->Offset, v);
+                bv.expand(glm::vec3(v[0], v[1], v[2]));
+            }
+        }
+        else
         {
-            glm::vec3 v;
-            const float* src = verts + i * stride;
-            v.x = *src++;
-            v.y = *src++;
-            v.z = *src;
-            bv.expand(v);
+            for (int i = 0; i < mVertexCount; ++i)
+            {
+                glm::vec3 v;
+                const float* src = verts + i * stride;
+                v.x = *src++;
+                v.y = *src++;
+                v.z = *src;
+                bv.expand(v);
+            }
         }
         LOGV("VertexBuffer::getBoundingVolume (%f, %f, %f) (%f, %f, %f) %d verts",
             bv.min_corner().x, bv.min_corner().y, bv.min_corner().z,
@@ -93,7 +308,7 @@ namespace gvr {
         std::lock_guard<std::mutex> lock(mLock);
         DataEntry*      attr = find(attributeName);
         const float*    srcend;
-        float*          dest;
+        char*           dest;
         int             dstStride;
         int             nverts = mVertexCount;
         int             attrStride;
@@ -109,7 +324,7 @@ namespace gvr {
             LOGE("VertexBuffer: cannot set attribute %s, source array not found", attributeName);
             return false;
         }
-        attrStride = attr->Size / sizeof(float);    // # of floats in vertex attribute
+        attrStride = getElementCount(*attr);        // # of floats in vertex attribute
         if (srcStride == 0)
         {
             srcStride = attrStride;
@@ -135,15 +350,19 @@ namespace gvr {
         {
             setVertexCount(nverts);
         }
-        dest = reinterpret_cast<float*>(mVertexData) + attr->Offset / sizeof(float);
-        dstStride = getTotalSize() / sizeof(float);
+        dest = mVertexData + attr->Offset;
+        dstStride = getTotalSize();
         srcend = src + srcSize;
 
         for (int i = 0; i < mVertexCount; ++i)
         {
-            for (int j = 0; j < attrStride; ++j)
+            if (isPacked(*attr))                    // quantize to packed format
             {
-                dest[j] = src[j];
+                packElement(*attr, src, dest);
+            }
+            else
+            {
+                memcpy(dest, src, attrStride * sizeof(float));
             }
             dest += dstStride;
             if (src >= srcend)
@@ -164,9 +383,9 @@ namespace gvr {
         std::lock_guard<std::mutex> lock(mLock);
         const DataEntry* attr = find(attributeName);
         const float*    dstend;
-        const float*    src = reinterpret_cast<float*>(mVertexData);
-        int             attrSize = attr->Size / sizeof(float);
-        int             srcStride = getVertexSize();
+        const char*     src = mVertexData;
+        int             attrSize;
+        int             srcStride = getTotalSize();
 
         if ((attr == NULL) || !attr->IsSet)
         {
@@ -178,7 +397,8 @@ namespace gvr {
             LOGD("VertexBuffer: cannot set attribute %s", attributeName);
             return false;
         }
-        src += attr->Offset / sizeof(float);
+        attrSize = getElementCount(*attr);
+        src += attr->Offset;
         dstend = dest + destSize;
         if (destStride == 0)
         {
@@ -186,9 +406,13 @@ namespace gvr {
         }
         for (int i = 0; i < mVertexCount; ++i)
         {
-            for (int j = 0; j < attrSize; ++j)
+            if (isPacked(*attr))                    // expand packed format to floats
+            {
+                unpackElement(*attr, src, dest);
+            }
+            else
             {
-                dest[j] = src[j];
+                memcpy(dest, src, attrSize * sizeof(float));
             }
             src += srcStride;
             dest += destStride;
@@ -218,7 +442,7 @@ namespace gvr {
         std::lock_guard<std::mutex> lock(mLock);
         DataEntry*      attr = find(attributeName);
         const int*      srcend;
-        int*            dest;
+        char*           dest;
         int             dstStride;
         int             nverts = mVertexCount;
         int             attrStride;
@@ -234,7 +458,7 @@ namespace gvr {
             LOGE("VertexBuffer: cannot set attribute %s, source array not found", attributeName);
             return false;
         }
-        attrStride = attr->Size / sizeof(int);
+        attrStride = getElementCount(*attr);
         if (srcStride == 0)
         {
             srcStride = attrStride;
@@ -260,15 +484,22 @@ namespace gvr {
         {
             setVertexCount(nverts);
         }
-        dest = reinterpret_cast<int*>(mVertexData) + attr->Offset / sizeof(int);
-        dstStride = getTotalSize() / sizeof(int);
+        dest = mVertexData + attr->Offset;
+        dstStride = getTotalSize();
         srcend = src + srcSize;
 
         for (int i = 0; i < mVertexCount; ++i)
         {
-            for (int j = 0; j < attrStride; ++j)
+            if (isPacked(*attr))                    // narrow to packed format
             {
-                dest[j] = src[j];
+                for (int j = 0; j < attrStride; ++j)
+                {
+                    packComponent(*attr, (float) src[j], dest + j * attr->ComponentSize);
+                }
+            }
+            else
+            {
+                memcpy(dest, src, attrStride * sizeof(int));
             }
             dest += dstStride;
             if (src >= srcend)
@@ -288,9 +519,9 @@ namespace gvr {
         std::lock_guard<std::mutex> lock(mLock);
         const DataEntry* attr = find(attributeName);
         const int*      dstend;
-        const int*      src = reinterpret_cast<int*>(mVertexData);
-        int             attrSize = attr->Size / sizeof(int);
-        int             srcStride = getTotalSize() / sizeof(int);
+        const char*     src = mVertexData;
+        int             attrSize;
+        int             srcStride = getTotalSize();
 
         if ((attr == NULL) || !attr->IsSet)
         {
@@ -302,7 +533,8 @@ namespace gvr {
             LOGE("VertexBuffer: cannot set attribute %s", attributeName);
             return false;
         }
-        src += attr->Offset / sizeof(int);
+        attrSize = getElementCount(*attr);
+        src += attr->Offset;
         dstend = dest + destSize;
         if (destStride == 0)
         {
@@ -310,9 +542,16 @@ namespace gvr {
         }
         for (int i = 0; i < mVertexCount; ++i)
         {
-            for (int j = 0; j < attrSize; ++j)
+            if (isPacked(*attr))                    // widen packed format to integers
+            {
+                for (int j = 0; j < attrSize; ++j)
+                {
+                    dest[j] = (int) unpackComponent(*attr, src + j * attr->ComponentSize);
+                }
+            }
+            else
             {
-                dest[j] = src[j];
+                memcpy(dest, src, attrSize * sizeof(int));
             }
             src += srcStride;
             if (dest > dstend)
@@ -325,6 +564,134 @@ namespace gvr {
         return true;
     }
 
+    bool VertexBuffer::setFloatVertices(const char* attributeName, const int* vertices, int numVertices,
+                                        const float* src, int srcStride)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        DataEntry* attr = find(attributeName);
+
+        if ((attr == NULL) || !attr->IsSet || attr->IsInt)
+        {
+            LOGE("VertexBuffer: ERROR float attribute %s not found in vertex buffer", attributeName);
+            return false;
+        }
+        int attrStride = getElementCount(*attr);
+        if (attrStride > srcStride)
+        {
+            LOGE("VertexBuffer: cannot copy to vertex array %s, stride is %d should be >= %d", attributeName, srcStride, attrStride);
+            return false;
+        }
+        int vsize = getTotalSize();
+        int first = mVertexCount;
+        int last = -1;
+
+        for (int i = 0; i < numVertices; ++i, src += srcStride)
+        {
+            int v = vertices[i];
+
+            if ((v < 0) || (v >= mVertexCount))
+            {
+                LOGE("VertexBuffer: vertex %d out of range in %s", v, attributeName);
+                continue;
+            }
+            char* dest = mVertexData + v * vsize + attr->Offset;
+            if (isPacked(*attr))
+            {
+                packElement(*attr, src, dest);
+            }
+            else
+            {
+                memcpy(dest, src, attrStride * sizeof(float));
+            }
+            first = std::min(first, v);
+            last = std::max(last, v);
+        }
+        if (last >= first)
+        {
+            if (mDirtyEnd > mDirtyBegin)
+            {
+                first = std::min(first, mDirtyBegin);
+                last = std::max(last, mDirtyEnd - 1);
+            }
+            mDirtyBegin = first;
+            mDirtyEnd = last + 1;
+            mChangeCount = newChangeCount();
+        }
+        return true;
+    }
+
+    bool VertexBuffer::writeVertices(int firstVertex, int numVertices,
+                                     std::function<void(float* vertices, int stride)> func)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        int vsize = getTotalSize();
+
+        if ((firstVertex < 0) || (numVertices <= 0) || (firstVertex + numVertices > mVertexCount))
+        {
+            LOGE("VertexBuffer: cannot write vertices %d to %d of %d", firstVertex,
+                 firstVertex + numVertices - 1, mVertexCount);
+            return false;
+        }
+        func(reinterpret_cast<float*>(mVertexData + firstVertex * vsize), vsize / sizeof(float));
+        int last = firstVertex + numVertices;
+        if (mDirtyEnd > mDirtyBegin)
+        {
+            firstVertex = std::min(firstVertex, mDirtyBegin);
+            last = std::max(last, mDirtyEnd);
+        }
+        mDirtyBegin = firstVertex;
+        mDirtyEnd = last;
+        mChangeCount = newChangeCount();
+        return true;
+    }
+
+    bool VertexBuffer::getDirtyRange(int& firstVertex, int& numVertices) const
+    {
+        if (mDirtyEnd <= mDirtyBegin)
+        {
+            return false;
+        }
+        firstVertex = mDirtyBegin;
+        numVertices = mDirtyEnd - mDirtyBegin;
+        return true;
+    }
+
+    bool VertexBuffer::copyVertices(const VertexBuffer& src, const unsigned int* vertexMap, int vertexCount)
+    {
+        int vsize = getTotalSize();
+        std::vector<char> data(vsize * vertexCount);
+
+        if (mDescriptor != src.mDescriptor)
+        {
+            LOGE("VertexBuffer: cannot copy vertices with layout %s to %s", src.getDescriptor(), getDescriptor());
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(src.mLock);
+            for (int i = 0; i < vertexCount; ++i)
+            {
+                if (vertexMap[i] >= src.mVertexCount)
+                {
+                    LOGE("VertexBuffer: cannot copy vertex %d, source only has %d vertices", vertexMap[i], src.mVertexCount);
+                    return false;
+                }
+                memcpy(&data[i * vsize], src.mVertexData + vertexMap[i] * vsize, vsize);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mLock);
+        if (!setVertexCount(vertexCount))
+        {
+            return false;
+        }
+        memcpy(mVertexData, data.data(), data.size());
+        for (int i = 0; i < mLayout.size(); ++i)
+        {
+            mLayout[i].IsSet = src.mLayout[i].IsSet;
+        }
+        markDirty();
+        return true;
+    }
+
     bool VertexBuffer::getInfo(const char* attributeName, int& index, int& offset, int& size) const
     {
         std::lock_guard<std::mutex> lock(mLock);
@@ -400,6 +767,30 @@ namespace gvr {
             LOGD("VertexBuffer: cannot find attribute %s", attrName);
             return false;
         }
+        if (isPacked(*attr))                        // decode packed vertices one at a time
+        {
+            std::vector<float> temp(getElementCount(*attr));
+            const char* src = mVertexData + attr->Offset;
+
+            for (int i = 0; i < mVertexCount; ++i)
+            {
+                if (attr->IsInt)
+                {
+                    int* ival = reinterpret_cast<int*>(temp.data());
+                    for (int j = 0; j < temp.size(); ++j)
+                    {
+                        ival[j] = (int) unpackComponent(*attr, src + j * attr->ComponentSize);
+                    }
+                }
+                else
+                {
+                    unpackElement(*attr, src, temp.data());
+                }
+                func(i, temp.data());
+                src += getTotalSize();
+            }
+            return true;
+        }
         ofs = attr->Offset / sizeof(float);
         for (int i = 0; i < mVertexCount; ++i)
         {
@@ -409,6 +800,53 @@ namespace gvr {
         return true;
     }
 
+    int VertexBuffer::getAttributeSize(const char* attributeName) const
+    {
+        const DataEntry* attr = find(attributeName);
+
+        return (attr != NULL) ? getElementCount(*attr) : 0;
+    }
+
+    bool VertexBuffer::getFloatVertex(const char* attributeName, int vertexIndex, float* dest) const
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        const DataEntry* attr = find(attributeName);
+
+        if ((attr == NULL) || !attr->IsSet || (vertexIndex < 0) || (vertexIndex >= mVertexCount))
+        {
+            return false;
+        }
+        const char* src = mVertexData + vertexIndex * getTotalSize() + attr->Offset;
+        if (isPacked(*attr))
+        {
+            unpackElement(*attr, src, dest);
+        }
+        else
+        {
+            memcpy(dest, src, attr->Size);
+        }
+        return true;
+    }
+
+    const float* VertexBuffer::getFloatData(const char* attributeName, std::vector<float>& temp, int& stride) const
+    {
+        const DataEntry* attr = find(attributeName);
+
+        if ((attr == NULL) || !attr->IsSet)
+        {
+            return NULL;
+        }
+        if (isPacked(*attr))
+        {
+            stride = getElementCount(*attr);
+            temp.resize(stride * mVertexCount);
+            getFloatVec(attributeName, temp.data(), temp.size(), stride);
+            return temp.data();
+        }
+        stride = getVertexSize();
+        return getVertexData() + attr->Offset / sizeof(float);
+    }
+
     void VertexBuffer::dump() const
     {
         int vsize = getVertexSize();
@@ -440,7 +878,7 @@ namespace gvr {
         {
             std::ostringstream os;
             os.precision(3);
-            int asize = attr->Size / sizeof(float);
+            int asize = getElementCount(*attr);
             if (attr->IsInt)
             {
                 const int* iv = (const int*) vertex;
@@ -22,6 +22,11 @@ namespace gvr {
  * Typical vertex components include location (Vec3), normal (Vec3),
  * color (Color) and texture coordinates (Vec2).
  *
+ * Attributes may also use the packed types described in
+ * DataDescriptor to reduce memory and bandwidth. Packed attributes
+ * are quantized when set from floats or integers and expanded
+ * when they are read back, each attribute is padded to 32 bits.
+ *
  * The format of the vertex data in the array maps directly to
  * what is required by the underlying renderer so that vertices
  * may be quickly copied without reformatting.
@@ -41,7 +46,7 @@ namespace gvr {
         const float*    getVertexData() const   { return reinterpret_cast<const float*>(mVertexData); }
 
         /**
-         * Return the number of floats in a vertex.
+         * Return the number of 32 bit words in a vertex.
          */
         int getVertexSize() const   { return getTotalSize() / sizeof(float); }
 
@@ -58,6 +63,24 @@ namespace gvr {
          */
         int getDataSize() const     { return getTotalSize() * mVertexCount; }
 
+        /**
+         * Return the number of bytes the vertex data would need
+         * if packed attributes were stored as 32 bit floats or integers.
+         * Comparing this with getDataSize() shows the memory and
+         * vertex fetch bandwidth saved by packing.
+         */
+        int getUnpackedDataSize() const { return getUnpackedSize() * mVertexCount; }
+
+        /**
+         * Return the number of floats or integers in one vertex
+         * of an attribute as seen by the application.
+         * For packed attributes this is the number of values
+         * before packing, 3 for octahedral unit vectors.
+         * @param attributeName name of attribute
+         * @return number of values or 0 if the attribute is not found
+         */
+        int getAttributeSize(const char* attributeName) const;
+
         /**
          * Set all the values for an float vertex attribute.
          * If the named entry is not an float vector in the descriptor
@@ -128,10 +151,98 @@ namespace gvr {
          */
         bool            getIntVec(const char* attributeName, int* data, int dataByteSize, int dataStride) const;
 
+        /**
+         * Copy selected vertices from another vertex buffer.
+         * Both buffers must have the same layout. Vertex i of
+         * this buffer becomes vertex vertexMap[i] of the source.
+         * The source may be this buffer, which allows vertices
+         * to be reordered in place.
+         *
+         * @param src         vertex buffer to copy from.
+         * @param vertexMap   index of the source vertex for each destination vertex.
+         * @param vertexCount number of vertices to copy.
+         * @return true if vertices were copied, false on error.
+         */
+        bool            copyVertices(const VertexBuffer& src, const unsigned int* vertexMap, int vertexCount);
+
+        /**
+         * Set the values of a float attribute for some of the vertices.
+         * Packed attributes are quantized. Unlike setFloatVec this does
+         * not mark the whole buffer as changed, only the range from the
+         * lowest to the highest vertex set is copied to the GPU.
+         *
+         * @param attributeName name of attribute to set.
+         * @param vertices      0-based indices of the vertices to set.
+         * @param numVertices   number of vertices to set.
+         * @param src           values of the attribute in the same order as vertices.
+         * @param srcStride     number of floats to the next vertex.
+         * @return true if the vertices were set, false on error.
+         */
+        bool            setFloatVertices(const char* attributeName, const int* vertices, int numVertices,
+                                         const float* src, int srcStride);
+
+        /**
+         * Write a range of vertices in place. The function is called
+         * once with the first vertex of the range while the buffer is
+         * locked and may write all the attributes of the vertices in
+         * the range, which must not be packed. Like setFloatVertices
+         * only the range is copied to the GPU.
+         *
+         * @param firstVertex   0-based index of the first vertex to write.
+         * @param numVertices   number of vertices to write.
+         * @param func          called with the vertex data of the first vertex
+         *                      and the number of floats in a vertex.
+         * @return true if the vertices were written, false if the range is invalid.
+         */
+        bool            writeVertices(int firstVertex, int numVertices,
+                                      std::function<void(float* vertices, int stride)> func);
+
+        /**
+         * Get the float values of an attribute for a single vertex.
+         * Packed attributes are converted to floats.
+         *
+         * @param attributeName name of attribute to get.
+         * @param vertexIndex   0-based index of the vertex.
+         * @param dest          gets the values, an octahedral unit vector
+         *                      is returned as 3 floats.
+         * @return true if the vertex was found, false if not
+         */
+        bool            getFloatVertex(const char* attributeName, int vertexIndex, float* dest) const;
+
+        /**
+         * Get a pointer to the float values of an attribute for all vertices.
+         * If the attribute is packed it is converted to floats in
+         * the temporary array, otherwise the vertex data is returned
+         * without copying.
+         *
+         * @param attributeName name of attribute to get.
+         * @param temp          array to hold converted values.
+         * @param stride        gets the number of floats from one vertex to the next.
+         * @return pointer to the first value or null if the attribute is not set.
+         */
+        const float*    getFloatData(const char* attributeName, std::vector<float>& temp, int& stride) const;
+
         bool            forAllVertices(const char* attrName, std::function<void (int iter, const float* vertex)> func) const;
         bool            forAllVertices(std::function<void (int iter, const float* vertex)> func) const;
         bool            getInfo(const char* attributeName, int& index, int& offset, int& size) const;
         void            getBoundingVolume(BoundingVolume& bv) const;
+        virtual void    markDirty() { DataDescriptor::markDirty(); mChangeCount = newChangeCount(); }
+
+        /**
+         * Get a counter which changes every time the vertices change.
+         * Unlike isDirty() it is not reset when the GPU copy is updated,
+         * so CPU side caches can use it to tell if they are stale.
+         * No two vertex buffers have the same count, so a new buffer
+         * allocated where a deleted one was is not taken for it.
+         */
+        unsigned int    getChangeCount() const { return mChangeCount; }
+
+        /**
+         * Get the range of vertices changed by setFloatVertices
+         * since the GPU copy was last updated.
+         * @return false if no range is dirty
+         */
+        bool            getDirtyRange(int& firstVertex, int& numVertices) const;
         virtual bool    updateGPU(Renderer*, IndexBuffer*, Shader*) = 0;
         virtual void    bindToShader(Shader* shader, IndexBuffer* ibuf) = 0;
         void            dump() const;
@@ -139,6 +250,8 @@ namespace gvr {
 
     protected:
         bool            setVertexCount(int vertexCount);
+        void            clearDirtyRange() { mDirtyBegin = mDirtyEnd = 0; }
+        static unsigned int newChangeCount();
         const void*     getData(const char* attributeName, int& size) const;
         const void*     getData(int index, int& size) const;
 
@@ -146,6 +259,9 @@ namespace gvr {
         int             mVertexCount;       // current number of vertices
         char*           mVertexData;        // vertex data buffer
         int             mBoneFlags;         // indicates which vertex attributes are bones
+        unsigned int    mChangeCount;       // changed when vertices change
+        int             mDirtyBegin;        // vertices changed by setFloatVertices
+        int             mDirtyEnd;
     };
 
 } // end gvrf
@@ -76,6 +76,12 @@ namespace gvr {
     Java_org_gearvrf_NativeVertexBuffer_getAttributeSize(JNIEnv* env, jobject obj,
                                                         jlong jvbuf, jstring attribName);
 
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeVertexBuffer_getDataSize(JNIEnv* env, jobject obj, jlong jvbuf);
+
+    JNIEXPORT int JNICALL
+    Java_org_gearvrf_NativeVertexBuffer_getUnpackedDataSize(JNIEnv* env, jobject obj, jlong jvbuf);
+
     JNIEXPORT int JNICALL
     Java_org_gearvrf_NativeVertexBuffer_getBoundingVolume(JNIEnv* env, jobject obj,
                                                          jlong jvbuf, jobject floatbuf);
@@ -122,7 +128,7 @@ Java_org_gearvrf_NativeVertexBuffer_getFloatArray(JNIEnv * env, jobject obj,
 
     if (entry != NULL)
     {
-        int n = (vbuf->getVertexCount() * entry->Size) / sizeof(float);
+        int n = vbuf->getVertexCount() * vbuf->getAttributeSize(char_key);
         jdata = env->NewFloatArray(n);
         float *data = env->GetFloatArrayElements(jdata, 0);
         vbuf->getFloatVec(char_key, data, n, 0);
@@ -143,7 +149,7 @@ Java_org_gearvrf_NativeVertexBuffer_getIntArray(JNIEnv* env, jobject obj,
 
     if (entry != NULL)
     {
-        int n = (vbuf->getVertexCount() * entry->Size) / sizeof(float);
+        int n = vbuf->getVertexCount() * vbuf->getAttributeSize(char_key);
         jdata = env->NewIntArray(n);
         int* data = env->GetIntArrayElements(jdata, 0);
         vbuf->getIntVec(char_key, data, n, 0);
@@ -257,11 +263,25 @@ Java_org_gearvrf_NativeVertexBuffer_getAttributeSize(JNIEnv* env, jobject obj,
 {
     VertexBuffer* vbuf = reinterpret_cast<VertexBuffer*>(jvbuf);
     const char* char_key = env->GetStringUTFChars(attribName, 0);
-    int size = vbuf->getByteSize(char_key) / sizeof(float);
+    int size = vbuf->isSet(char_key) ? vbuf->getAttributeSize(char_key) : 0;
     env->ReleaseStringUTFChars(attribName, char_key);
     return size;
 }
 
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeVertexBuffer_getDataSize(JNIEnv* env, jobject obj, jlong jvbuf)
+{
+    VertexBuffer* vbuf = reinterpret_cast<VertexBuffer*>(jvbuf);
+    return vbuf->getDataSize();
+}
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeVertexBuffer_getUnpackedDataSize(JNIEnv* env, jobject obj, jlong jvbuf)
+{
+    VertexBuffer* vbuf = reinterpret_cast<VertexBuffer*>(jvbuf);
+    return vbuf->getUnpackedDataSize();
+}
+
 JNIEXPORT int JNICALL
 Java_org_gearvrf_NativeVertexBuffer_getBoundingVolume(JNIEnv* env, jobject obj,
                                                       jlong jvbuf, jobject jfloatbuf)
@@ -0,0 +1,112 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/***************************************************************************
+ * Four wide float operations, NEON when it is available.
+ ***************************************************************************/
+
+#ifndef GVR_SIMD_H_
+#define GVR_SIMD_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "glm/gtc/packing.hpp"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GVR_SIMD_NEON 1
+#endif
+
+namespace gvr {
+
+#ifdef GVR_SIMD_NEON
+
+typedef float32x4_t float4;
+
+inline float4 load4(const float* p) { return vld1q_f32(p); }
+inline void store4(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 splat4(float f) { return vdupq_n_f32(f); }
+inline float4 add4(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 sub4(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 mul4(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 abs4(float4 a) { return vabsq_f32(a); }
+inline float4 min4(float4 a, float4 b) { return vminq_f32(a, b); }
+inline float4 max4(float4 a, float4 b) { return vmaxq_f32(a, b); }
+
+// a * b + c
+inline float4 madd4(float4 a, float4 b, float4 c) { return vmlaq_f32(c, a, b); }
+
+// 1 / sqrt(a), estimate refined by two Newton-Raphson steps
+inline float4 rsqrt4(float4 a) {
+    float4 e = vrsqrteq_f32(a);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+    return vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+}
+
+// a with its sign flipped in the lanes where s is negative
+inline float4 flipsign4(float4 a, float4 s) {
+    uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(s), vdupq_n_u32(0x80000000));
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), sign));
+}
+
+#else
+
+struct float4 {
+    float v[4];
+};
+
+inline float4 load4(const float* p) { float4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+inline void store4(float* p, float4 a) { memcpy(p, a.v, sizeof(a.v)); }
+inline float4 splat4(float f) { float4 r = {{ f, f, f, f }}; return r; }
+
+#define GVR_FLOAT4_OP(expr)                 \
+    float4 r;                               \
+    for (int i = 0; i < 4; ++i) {           \
+        r.v[i] = expr;                      \
+    }                                       \
+    return r;
+
+inline float4 add4(float4 a, float4 b) { GVR_FLOAT4_OP(a.v[i] + b.v[i]) }
+inline float4 sub4(float4 a, float4 b) { GVR_FLOAT4_OP(a.v[i] - b.v[i]) }
+inline float4 mul4(float4 a, float4 b) { GVR_FLOAT4_OP(a.v[i] * b.v[i]) }
+inline float4 abs4(float4 a) { GVR_FLOAT4_OP(fabsf(a.v[i])) }
+inline float4 min4(float4 a, float4 b) { GVR_FLOAT4_OP((a.v[i] < b.v[i]) ? a.v[i] : b.v[i]) }
+inline float4 max4(float4 a, float4 b) { GVR_FLOAT4_OP((a.v[i] > b.v[i]) ? a.v[i] : b.v[i]) }
+inline float4 madd4(float4 a, float4 b, float4 c) { GVR_FLOAT4_OP(a.v[i] * b.v[i] + c.v[i]) }
+inline float4 rsqrt4(float4 a) { GVR_FLOAT4_OP(1.0f / sqrtf(a.v[i])) }
+inline float4 flipsign4(float4 a, float4 s) { GVR_FLOAT4_OP((s.v[i] < 0) ? -a.v[i] : a.v[i]) }
+
+#undef GVR_FLOAT4_OP
+
+#endif
+
+// Four half floats converted to floats
+inline float4 loadhalf4(const uint16_t* p) {
+#if defined(GVR_SIMD_NEON) && defined(__aarch64__)
+    return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p)));
+#else
+    float f[4];
+    for (int i = 0; i < 4; ++i) {
+        f[i] = glm::unpackHalf1x16(p[i]);
+    }
+    return load4(f);
+#endif
+}
+
+}
+#endif
@@ -43,7 +43,9 @@ namespace gvr {
     void VulkanVertexBuffer::generateVKBuffers(VulkanCore* vulkanCore, Shader* shader)
     {
 
-        if(mVerticesMap.find(shader) != mVerticesMap.end() && !isDirty())
+        int firstVertex, numVertices;
+        if(mVerticesMap.find(shader) != mVerticesMap.end() && !isDirty() &&
+           !getDirtyRange(firstVertex, numVertices))
             return;
 
         VkResult   err;
@@ -158,7 +160,7 @@ namespace gvr {
                     binding.binding = GVR_VK_VERTEX_BUFFER_BIND_ID;
                     binding.location = e.Index;
                     LOGE("location %d attrMapping[i].offset %d , name %s", entry->Index, entry->Offset, entry->Name);
-                    binding.format = getDataType(entry->Type); //float3
+                    binding.format = getDataType(*entry);
                     binding.offset = entry->Offset;
                     vertices->vi_attrs.push_back(binding);
                     i++;
@@ -181,6 +183,7 @@ namespace gvr {
 
         mVerticesMap[shader] = vertices;
         mIsDirty = false;
+        clearDirtyRange();
     }
 
     VkFormat VulkanVertexBuffer::getDataType(const std::string& type)
@@ -201,5 +204,56 @@ namespace gvr {
             return VK_FORMAT_R32G32B32A32_SINT;
 
     }
+
+    /*
+     * Packed attributes with 3 components use the 4 component
+     * format because the 3 component 8 and 16 bit formats are
+     * rarely supported for vertex input. The vertex data is
+     * padded so the extra component is always there.
+     */
+    VkFormat VulkanVertexBuffer::getDataType(const DataEntry& entry)
+    {
+        static const VkFormat halfFormats[] = { VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT,
+                                                VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT };
+        static const VkFormat snorm8Formats[] = { VK_FORMAT_R8_SNORM, VK_FORMAT_R8G8_SNORM,
+                                                  VK_FORMAT_R8G8B8A8_SNORM, VK_FORMAT_R8G8B8A8_SNORM };
+        static const VkFormat unorm8Formats[] = { VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8_UNORM,
+                                                  VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM };
+        static const VkFormat sint8Formats[] = { VK_FORMAT_R8_SINT, VK_FORMAT_R8G8_SINT,
+                                                 VK_FORMAT_R8G8B8A8_SINT, VK_FORMAT_R8G8B8A8_SINT };
+        static const VkFormat uint8Formats[] = { VK_FORMAT_R8_UINT, VK_FORMAT_R8G8_UINT,
+                                                 VK_FORMAT_R8G8B8A8_UINT, VK_FORMAT_R8G8B8A8_UINT };
+        static const VkFormat snorm16Formats[] = { VK_FORMAT_R16_SNORM, VK_FORMAT_R16G16_SNORM,
+                                                   VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R16G16B16A16_SNORM };
+        static const VkFormat unorm16Formats[] = { VK_FORMAT_R16_UNORM, VK_FORMAT_R16G16_UNORM,
+                                                   VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_UNORM };
+        static const VkFormat sint16Formats[] = { VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT,
+                                                  VK_FORMAT_R16G16B16A16_SINT, VK_FORMAT_R16G16B16A16_SINT };
+        static const VkFormat uint16Formats[] = { VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT,
+                                                  VK_FORMAT_R16G16B16A16_UINT, VK_FORMAT_R16G16B16A16_UINT };
+        int n = entry.ComponentCount - 1;
+
+        if ((entry.ComponentSize == sizeof(float)) || (n < 0) || (n > 3))
+        {
+            return getDataType(entry.Type);
+        }
+        if (entry.ComponentSize == 1)
+        {
+            if (entry.IsInt)
+            {
+                return entry.IsUnsigned ? uint8Formats[n] : sint8Formats[n];
+            }
+            return entry.IsUnsigned ? unorm8Formats[n] : snorm8Formats[n];
+        }
+        if (entry.IsInt)
+        {
+            return entry.IsUnsigned ? uint16Formats[n] : sint16Formats[n];
+        }
+        if (entry.IsNormalized)
+        {
+            return entry.IsUnsigned ? unorm16Formats[n] : snorm16Formats[n];
+        }
+        return halfFormats[n];
+    }
 } // end gvrf
 
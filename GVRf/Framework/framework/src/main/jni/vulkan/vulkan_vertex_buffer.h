@@ -28,6 +28,7 @@ namespace gvr {
     protected:
         void    freeGPUResources();
         VkFormat getDataType(const std::string& type);
+        VkFormat getDataType(const DataEntry& entry);
         std::unordered_map<Shader*,std::shared_ptr<GVR_VK_Vertices>> mVerticesMap;
      //   GVR_VK_Vertices m_vertices;
     };